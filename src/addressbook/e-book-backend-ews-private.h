@@ -0,0 +1,42 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/* e-book-backend-ews-private.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef E_BOOK_BACKEND_EWS_PRIVATE_H
+#define E_BOOK_BACKEND_EWS_PRIVATE_H
+
+/* Not installed; these are not part of any API, they are
+   available only for the tests, which load the module */
+
+#include <libedata-book/libedata-book.h>
+
+G_BEGIN_DECLS
+
+gboolean	e_book_backend_ews_gal_needs_reprocess
+						(EBookCache *book_cache,
+						 gboolean lazy);
+gboolean	e_book_backend_ews_gal_index_oab_file
+						(EBookCache *book_cache,
+						 const gchar *oab_filename,
+						 const gchar *attachments_dir,
+						 GSList **out_removed_objects, /*EBookMetaBackendInfo * */
+						 GCancellable *cancellable,
+						 GError **error);
+
+G_END_DECLS
+
+#endif /* E_BOOK_BACKEND_EWS_PRIVATE_H */
@@ -48,8 +48,11 @@
 #include "server/e-source-ews-folder.h"
 
 #include "e-book-backend-ews.h"
+#include "e-book-backend-ews-private.h"
 #include "ews-oab-decoder.h"
 #include "ews-oab-decompress.h"
+#include "ews-oab-pipe-stream.h"
+#include "ews-oab-index.h"
 
 #ifdef G_OS_WIN32
 #ifdef gmtime_r
@@ -75,6 +78,12 @@
 
 #define EWS_MAX_FETCH_COUNT 500
 
+/* How much data can wait between the GAL download, decompress and decode stages */
+#define EWS_GAL_PIPE_BUFFER_SIZE (4 * 1024 * 1024)
+
+/* How many contacts can be decoded from the GAL index for one search */
+#define EWS_GAL_LAZY_MAX_CONTACTS 100
+
 #define ELEMENT_TYPE_SIMPLE 0x01 /* simple string fields */
 #define ELEMENT_TYPE_COMPLEX 0x02 /* complex fields while require different get/set functions */
 
@@ -94,6 +103,11 @@ struct _EBookBackendEwsPrivate {
 
 	/* used for storing attachments */
 	gchar *attachments_dir;
+
+	/* the offline GAL index, for the lazy GAL contacts */
+	GMutex gal_index_lock;
+	EwsOabIndex *gal_index;
+	EwsOabDecoder *gal_index_decoder;
 };
 
 G_DEFINE_TYPE (EBookBackendEws, e_book_backend_ews, E_TYPE_BOOK_META_BACKEND)
@@ -2174,18 +2188,14 @@ det_sort_func (gconstpointer _a,
 	return a->seq - b->seq;
 }
 
-static gchar *
-ebb_ews_download_gal_file (EBookBackendEws *bbews,
-			   EwsOALDetails *full,
-			   GCancellable *cancellable,
-			   GError **error)
+static EEwsConnection *
+ebb_ews_new_oal_file_connection (EBookBackendEws *bbews,
+				 EwsOALDetails *det)
 {
 	EEwsConnection *oab_cnc;
 	gchar *full_url, *oab_url;
-	gchar *download_path = NULL;
 	gchar *password;
 	CamelEwsSettings *ews_settings;
-	const gchar *cache_dir;
 
 	ews_settings = ebb_ews_get_collection_settings (bbews);
 
@@ -2199,9 +2209,7 @@ ebb_ews_download_gal_file (EBookBackendEws *bbews,
 	if (g_str_has_suffix (oab_url, "oab.xml"))
 		oab_url [strlen (oab_url) - 7] = '\0';
 
-	full_url = g_strconcat (oab_url, full->filename, NULL);
-	cache_dir = e_book_backend_get_cache_dir (E_BOOK_BACKEND (bbews));
-	download_path = g_build_filename (cache_dir, full->filename, NULL);
+	full_url = g_strconcat (oab_url, det->filename, NULL);
 
 	oab_cnc = e_ews_connection_new_for_backend (E_BACKEND (bbews), e_book_backend_get_registry (E_BOOK_BACKEND (bbews)), full_url, ews_settings);
 
@@ -2214,6 +2222,29 @@ ebb_ews_download_gal_file (EBookBackendEws *bbews,
 	e_ews_connection_set_password (oab_cnc, password);
 	g_free (password);
 
+	g_free (oab_url);
+	g_free (full_url);
+
+	return oab_cnc;
+}
+
+static gchar *
+ebb_ews_download_gal_file (EBookBackendEws *bbews,
+			   EwsOALDetails *full,
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	EEwsConnection *oab_cnc;
+	gchar *download_path = NULL;
+	const gchar *cache_dir;
+
+	oab_cnc = ebb_ews_new_oal_file_connection (bbews, full);
+	if (!oab_cnc)
+		return NULL;
+
+	cache_dir = e_book_backend_get_cache_dir (E_BOOK_BACKEND (bbews));
+	download_path = g_build_filename (cache_dir, full->filename, NULL);
+
 	if (!e_ews_connection_download_oal_file_sync (oab_cnc, download_path, NULL, NULL, cancellable, error)) {
 		g_free (download_path);
 		download_path = NULL;
@@ -2222,120 +2253,335 @@ ebb_ews_download_gal_file (EBookBackendEws *bbews,
 	}
 
 	g_object_unref (oab_cnc);
-	g_free (oab_url);
-	g_free (full_url);
 
 	return download_path;
 }
 
 static gchar *
-ebb_ews_download_full_gal (EBookBackendEws *bbews,
-			   EwsOALDetails *full,
-			   GCancellable *cancellable,
-			   GError **error)
+ebb_ews_dup_oab_filename (EBookBackendEws *bbews,
+			  guint32 seq)
 {
 	ESource *source;
 	const gchar *cache_dir;
-	gchar *lzx_path, *oab_file, *oab_path;
-
-	lzx_path = ebb_ews_download_gal_file (bbews, full, cancellable, error);
-	if (!lzx_path)
-		return NULL;
+	gchar *oab_file, *oab_path;
 
 	source = e_backend_get_source (E_BACKEND (bbews));
-	oab_file = g_strdup_printf ("%s-%d.oab", e_source_get_display_name (source), full->seq);
+	oab_file = g_strdup_printf ("%s-%d.oab", e_source_get_display_name (source), seq);
 	cache_dir = e_book_backend_get_cache_dir (E_BOOK_BACKEND (bbews));
 	oab_path = g_build_filename (cache_dir, oab_file, NULL);
 
-	if (!ews_oab_decompress_full (lzx_path, oab_path, error)) {
-		g_free (oab_path);
-		oab_path = NULL;
-	} else {
-		d (printf ("OAL file decompressed %s\n", oab_path));
+	g_free (oab_file);
+
+	return oab_path;
+}
+
+static void
+ebb_ews_gal_stream_cancelled_cb (GCancellable *cancellable,
+				 GCancellable *pipeline_cancellable)
+{
+	g_cancellable_cancel (pipeline_cancellable);
+}
+
+#ifdef WITH_MSPACK
+/* The deltas are downloaded one after another in a dedicated thread, while
+   they are applied as a chain of stages, one thread per delta. Each stage reads
+   the previous OAB content from the stage before it (the first stage reads
+   the current OAB file), thus no intermediate OAB files are written and
+   the next delta is being downloaded while the current one is being applied. */
+typedef struct _GalDeltaData {
+	EBookBackendEws *bbews;
+	GSList *deltas; /* EwsOALDetails *, not owned */
+	GCancellable *cancellable;
+
+	GMutex lock;
+	GCond cond;
+	GPtrArray *lzx_paths; /* gchar *, downloaded deltas, in the order of 'deltas' */
+	gboolean download_done;
+} GalDeltaData;
+
+typedef struct _GalDeltaStage {
+	GalDeltaData *gdd;
+	guint index;
+	GInputStream *reference; /* the current OAB file or the previous stage's pipe */
+	GInputStream *output_pipe; /* EwsOabPipeStream; NULL for the last stage */
+	GOutputStream *output_file; /* only for the last stage */
+	GThread *thread;
+	GError *error;
+} GalDeltaStage;
+
+static gpointer
+ebb_ews_gal_delta_download_thread (gpointer user_data)
+{
+	GalDeltaData *gdd = user_data;
+	GSList *link;
+
+	for (link = gdd->deltas; link; link = g_slist_next (link)) {
+		EwsOALDetails *det = link->data;
+		gchar *lzx_path;
+		GError *local_error = NULL;
+
+		lzx_path = ebb_ews_download_gal_file (gdd->bbews, det, gdd->cancellable, &local_error);
+		if (!lzx_path) {
+			d (printf ("Failed to download delta %s: %s\n", det->filename, local_error ? local_error->message : "Unknown error"));
+			g_clear_error (&local_error);
+			break;
+		}
+
+		g_mutex_lock (&gdd->lock);
+		g_ptr_array_add (gdd->lzx_paths, lzx_path);
+		g_cond_broadcast (&gdd->cond);
+		g_mutex_unlock (&gdd->lock);
 	}
 
+	g_mutex_lock (&gdd->lock);
+	gdd->download_done = TRUE;
+	g_cond_broadcast (&gdd->cond);
+	g_mutex_unlock (&gdd->lock);
+
+	return NULL;
+}
+
+static gboolean
+ebb_ews_gal_delta_patched_cb (gconstpointer data,
+			      gsize data_len,
+			      gpointer user_data,
+			      GCancellable *cancellable,
+			      GError **error)
+{
+	GalDeltaStage *stage = user_data;
+
+	if (stage->output_pipe)
+		return ews_oab_pipe_stream_write (EWS_OAB_PIPE_STREAM (stage->output_pipe), data, data_len, cancellable, error);
+
+	return g_output_stream_write_all (stage->output_file, data, data_len, NULL, cancellable, error);
+}
+
+static gpointer
+ebb_ews_gal_delta_stage_thread (gpointer user_data)
+{
+	GalDeltaStage *stage = user_data;
+	GalDeltaData *gdd = stage->gdd;
+	gchar *lzx_path = NULL;
+	gboolean success = FALSE;
+
+	/* Wait for this stage's delta */
+	g_mutex_lock (&gdd->lock);
+	while (gdd->lzx_paths->len <= stage->index && !gdd->download_done)
+		g_cond_wait (&gdd->cond, &gdd->lock);
+	if (gdd->lzx_paths->len > stage->index)
+		lzx_path = g_strdup (g_ptr_array_index (gdd->lzx_paths, stage->index));
+	g_mutex_unlock (&gdd->lock);
+
 	if (lzx_path) {
-		g_unlink (lzx_path);
+		GFile *file;
+		GFileInputStream *lzx_stream;
+
+		file = g_file_new_for_path (lzx_path);
+		lzx_stream = g_file_read (file, gdd->cancellable, &stage->error);
+		g_object_unref (file);
+
+		if (lzx_stream) {
+			success = ews_oab_decompress_patch_stream (G_INPUT_STREAM (lzx_stream), stage->reference,
+				ebb_ews_gal_delta_patched_cb, stage, gdd->cancellable, &stage->error);
+
+			g_input_stream_close (G_INPUT_STREAM (lzx_stream), NULL, NULL);
+			g_object_unref (lzx_stream);
+		}
+
 		g_free (lzx_path);
+	} else {
+		g_set_error_literal (&stage->error, G_IO_ERROR, G_IO_ERROR_FAILED, _("Failed to download GAL delta"));
 	}
 
-	g_free (oab_file);
+	if (success && stage->output_file)
+		success = g_output_stream_close (stage->output_file, gdd->cancellable, &stage->error);
 
-	return oab_path;
+	/* Stop the whole chain, it cannot finish anyway */
+	if (!success)
+		g_cancellable_cancel (gdd->cancellable);
+
+	/* Unblock the previous stage, in case it still writes */
+	g_input_stream_close (stage->reference, NULL, NULL);
+
+	if (stage->output_pipe)
+		ews_oab_pipe_stream_close_write (EWS_OAB_PIPE_STREAM (stage->output_pipe), stage->error);
+
+	return NULL;
 }
+#endif /* WITH_MSPACK */
 
+/* Applies the deltas on top of the current OAB file. Returns the new OAB file name,
+   or NULL, when the full OAB file should be downloaded instead. */
 static gchar *
-ebb_ews_download_gal (EBookBackendEws *bbews,
-		      EBookCache *book_cache,
-		      EwsOALDetails *full,
-		      GSList *deltas,
-		      guint32 seq,
-		      GCancellable *cancellable,
-		      GError **error)
+ebb_ews_download_gal_deltas (EBookBackendEws *bbews,
+			     EBookCache *book_cache,
+			     EwsOALDetails *full,
+			     GSList *deltas,
+			     guint32 seq,
+			     GCancellable *cancellable)
 {
 #ifdef WITH_MSPACK
+	GalDeltaData gdd;
+	GalDeltaStage *stages;
+	GThread *download_thread;
 	GSList *link;
-	gchar *thisoab;
+	GFile *file;
+	GFileInputStream *thisoab_stream;
+	GFileOutputStream *nextoab_stream;
+	gchar *thisoab, *nextoab;
+	gulong cancel_id = 0;
+	guint ii, n_stages;
+	gboolean success = TRUE;
 
-	thisoab = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
-	if (!thisoab)
-		goto full;
+	if (!deltas)
+		return NULL;
 
+	/* The deltas should form a complete chain up to the full file's sequence */
 	for (link = deltas; link; link = g_slist_next (link)) {
 		EwsOALDetails *det = link->data;
-		ESource *source;
-		gchar *oab_file, *lzx_path, *nextoab;
-		const gchar *cache_dir;
-		GError *local_error = NULL;
 
 		seq++;
 		if (det->seq != seq)
-			break;
+			return NULL;
+	}
 
-		lzx_path = ebb_ews_download_gal_file (bbews, det, cancellable, NULL);
-		if (!lzx_path)
-			break;
+	if (seq != full->seq)
+		return NULL;
 
-		source = e_backend_get_source (E_BACKEND (bbews));
-		oab_file = g_strdup_printf ("%s-%d.oab", e_source_get_display_name (source), seq);
-		cache_dir = e_book_backend_get_cache_dir (E_BOOK_BACKEND (bbews));
-		nextoab = g_build_filename (cache_dir, oab_file, NULL);
-		g_free (oab_file);
+	thisoab = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
+	if (!thisoab)
+		return NULL;
 
-		ews_oab_decompress_patch (lzx_path, thisoab, nextoab, &local_error);
+	file = g_file_new_for_path (thisoab);
+	thisoab_stream = g_file_read (file, cancellable, NULL);
+	g_object_unref (file);
+	g_free (thisoab);
 
-		/* Free the LZX file */
-		g_unlink (lzx_path);
-		g_free (lzx_path);
+	if (!thisoab_stream)
+		return NULL;
 
-		/* Free the previous OAB file */
-		g_unlink (thisoab);
-		g_free (thisoab);
+	nextoab = ebb_ews_dup_oab_filename (bbews, full->seq);
 
-		thisoab = nextoab;
+	file = g_file_new_for_path (nextoab);
+	nextoab_stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_PRIVATE, cancellable, NULL);
+	g_object_unref (file);
 
-		/* For once we are *allowed* to use the error instead of having to
-		 * check the return value of the function. It's our *own* error. */
-		if (local_error) {
-			d (printf ("Failed to apply incremental patch: %s\n", local_error->message));
-			g_error_free (local_error);
-			break;
+	if (!nextoab_stream) {
+		g_object_unref (thisoab_stream);
+		g_free (nextoab);
+		return NULL;
+	}
+
+	memset (&gdd, 0, sizeof (GalDeltaData));
+	gdd.bbews = bbews;
+	gdd.deltas = deltas;
+	gdd.cancellable = g_cancellable_new ();
+	gdd.lzx_paths = g_ptr_array_new_with_free_func (g_free);
+	g_mutex_init (&gdd.lock);
+	g_cond_init (&gdd.cond);
+
+	if (cancellable)
+		cancel_id = g_cancellable_connect (cancellable, G_CALLBACK (ebb_ews_gal_stream_cancelled_cb), gdd.cancellable, NULL);
+
+	n_stages = g_slist_length (deltas);
+	stages = g_new0 (GalDeltaStage, n_stages);
+
+	for (ii = 0; ii < n_stages; ii++) {
+		GalDeltaStage *stage = &stages[ii];
+
+		stage->gdd = &gdd;
+		stage->index = ii;
+		stage->reference = ii == 0 ? G_INPUT_STREAM (thisoab_stream) : stages[ii - 1].output_pipe;
+
+		if (ii + 1 < n_stages)
+			stage->output_pipe = ews_oab_pipe_stream_new (EWS_GAL_PIPE_BUFFER_SIZE);
+		else
+			stage->output_file = G_OUTPUT_STREAM (nextoab_stream);
+	}
+
+	download_thread = g_thread_new ("ews-gal-delta-download", ebb_ews_gal_delta_download_thread, &gdd);
+
+	for (ii = 0; ii < n_stages; ii++)
+		stages[ii].thread = g_thread_new ("ews-gal-delta-apply", ebb_ews_gal_delta_stage_thread, &stages[ii]);
+
+	for (ii = 0; ii < n_stages; ii++) {
+		GalDeltaStage *stage = &stages[ii];
+
+		g_thread_join (stage->thread);
+
+		if (stage->error) {
+			if (success && !g_error_matches (stage->error, G_IO_ERROR, G_IO_ERROR_CLOSED))
+				d (printf ("Failed to apply incremental patch %u: %s\n", ii, stage->error->message));
+			success = FALSE;
 		}
+	}
+
+	g_thread_join (download_thread);
+
+	if (cancel_id)
+		g_cancellable_disconnect (cancellable, cancel_id);
 
-		d (printf ("Created %s from delta\n", thisoab));
+	/* Free the LZX files */
+	for (ii = 0; ii < gdd.lzx_paths->len; ii++)
+		g_unlink (g_ptr_array_index (gdd.lzx_paths, ii));
 
-		if (seq == full->seq)
-			return thisoab;
+	if (!g_output_stream_is_closed (G_OUTPUT_STREAM (nextoab_stream)))
+		g_output_stream_close (G_OUTPUT_STREAM (nextoab_stream), gdd.cancellable, NULL);
+
+	for (ii = 0; ii < n_stages; ii++) {
+		g_clear_error (&stages[ii].error);
+		g_clear_object (&stages[ii].output_pipe);
 	}
 
-	if (thisoab) {
-		g_unlink (thisoab);
-		g_free (thisoab);
+	g_free (stages);
+	g_object_unref (nextoab_stream);
+	g_object_unref (thisoab_stream);
+	g_ptr_array_unref (gdd.lzx_paths);
+	g_object_unref (gdd.cancellable);
+	g_mutex_clear (&gdd.lock);
+	g_cond_clear (&gdd.cond);
+
+	if (success) {
+		d (printf ("Created %s from deltas\n", nextoab));
+		return nextoab;
 	}
- full:
+
+	g_unlink (nextoab);
+	g_free (nextoab);
 #endif /* WITH_MSPACK */
-	d (printf ("Ewsgal: Downloading full gal \n"));
-	return ebb_ews_download_full_gal (bbews, full, cancellable, error);
+	return NULL;
+}
+
+static gchar *
+ebb_ews_dup_gal_index_filename (const gchar *oab_filename)
+{
+	return g_strconcat (oab_filename, ".idx", NULL);
+}
+
+static gboolean
+ebb_ews_gal_is_lazy (EBookBackendEws *bbews)
+{
+	ESourceEwsFolder *ews_folder;
+
+	if (!bbews->priv->is_gal ||
+	    !camel_ews_settings_get_oab_offline (ebb_ews_get_collection_settings (bbews)))
+		return FALSE;
+
+	ews_folder = e_source_get_extension (e_backend_get_source (E_BACKEND (bbews)), E_SOURCE_EXTENSION_EWS_FOLDER);
+
+	return e_source_ews_folder_get_gal_lazy_contacts (ews_folder);
+}
+
+/* Closes the GAL index, it's reopened on demand, with the current OAB file */
+static void
+ebb_ews_gal_index_reset (EBookBackendEws *bbews)
+{
+	g_mutex_lock (&bbews->priv->gal_index_lock);
+
+	g_clear_pointer (&bbews->priv->gal_index, ews_oab_index_free);
+	g_clear_object (&bbews->priv->gal_index_decoder);
+
+	g_mutex_unlock (&bbews->priv->gal_index_lock);
 }
 
 static void
@@ -2347,8 +2593,15 @@ ebb_ews_remove_old_gal_file (EBookCache *book_cache)
 
 	filename = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
 
-	if (filename)
+	if (filename) {
+		gchar *index_filename;
+
+		index_filename = ebb_ews_dup_gal_index_filename (filename);
+		g_unlink (index_filename);
+		g_free (index_filename);
+
 		g_unlink (filename);
+	}
 	g_free (filename);
 }
 
@@ -2529,10 +2782,169 @@ ebb_ews_gather_existing_uids_cb (EBookCache *book_cache,
 	return TRUE;
 }
 
+typedef struct _GalIndexData {
+	EwsOabIndexBuilder *builder;
+	gint percent;
+} GalIndexData;
+
+static void
+ebb_ews_gal_index_contact (EContact *contact,
+			   goffset offset,
+			   const gchar *sha1,
+			   guint percent,
+			   gpointer user_data,
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	GalIndexData *gid = user_data;
+
+	if (contact && e_contact_get_const (contact, E_CONTACT_UID)) {
+		ews_oab_index_builder_add (gid->builder, offset,
+			e_contact_get_const (contact, E_CONTACT_UID),
+			e_contact_get_const (contact, E_CONTACT_FULL_NAME),
+			e_contact_get_const (contact, E_CONTACT_EMAIL_1));
+	}
+
+	if (gid->percent != percent) {
+		gid->percent = percent;
+
+		d (printf ("GAL indexing contacts, %d%% complete\n", percent));
+	}
+}
+
+/* Writes the index of the OAB file, instead of storing the contacts in the cache.
+   The contacts are decoded from the OAB file on demand. */
+static gboolean
+ebb_ews_index_gal (EBookCache *book_cache,
+		   EwsOabDecoder *eod,
+		   const gchar *oab_filename,
+		   GSList **out_created_objects, /*EBookMetaBackendInfo * */
+		   GSList **out_modified_objects, /*EBookMetaBackendInfo * */
+		   GSList **out_removed_objects, /*EBookMetaBackendInfo * */
+		   GCancellable *cancellable,
+		   GError **error)
+{
+	GalIndexData gid;
+	gboolean success;
+
+	gid.builder = ews_oab_index_builder_new ();
+	gid.percent = 0;
+
+	success = ews_oab_decoder_decode (eod, NULL, ebb_ews_gal_index_contact, &gid, cancellable, error);
+
+	if (success) {
+		gchar *oab_props, *index_filename;
+
+		index_filename = ebb_ews_dup_gal_index_filename (oab_filename);
+		oab_props = ews_oab_decoder_get_oab_prop_string (eod, error);
+
+		success = oab_props && ews_oab_index_builder_write (gid.builder, index_filename, oab_props, error);
+
+		d (printf ("GAL index with %u contacts %swritten to %s\n", ews_oab_index_builder_get_n_entries (gid.builder),
+			success ? "" : "not ", index_filename));
+
+		g_free (index_filename);
+		g_free (oab_props);
+	}
+
+	if (success) {
+		GSList *uids = NULL, *link;
+
+		*out_created_objects = NULL;
+		*out_modified_objects = NULL;
+		*out_removed_objects = NULL;
+
+		/* The already decoded contacts can be outdated, they will be decoded again on demand */
+		if (e_book_cache_search_uids (book_cache, NULL, &uids, cancellable, NULL)) {
+			for (link = uids; link; link = g_slist_next (link)) {
+				*out_removed_objects = g_slist_prepend (*out_removed_objects,
+					e_book_meta_backend_info_new (link->data, NULL, NULL, NULL));
+			}
+
+			g_slist_free_full (uids, g_free);
+		}
+	}
+
+	ews_oab_index_builder_free (gid.builder);
+
+	return success;
+}
+
+/* Indexes the already downloaded OAB file for the lazy GAL contacts. The contacts
+   stored in the cache are returned in the out_removed_objects, to be removed. */
+gboolean
+e_book_backend_ews_gal_index_oab_file (EBookCache *book_cache,
+				       const gchar *oab_filename,
+				       const gchar *attachments_dir,
+				       GSList **out_removed_objects, /*EBookMetaBackendInfo * */
+				       GCancellable *cancellable,
+				       GError **error)
+{
+	EwsOabDecoder *eod;
+	GSList *created_objects = NULL, *modified_objects = NULL;
+	gboolean success;
+
+	g_return_val_if_fail (E_IS_BOOK_CACHE (book_cache), FALSE);
+	g_return_val_if_fail (oab_filename != NULL, FALSE);
+	g_return_val_if_fail (out_removed_objects != NULL, FALSE);
+
+	eod = ews_oab_decoder_new (oab_filename, attachments_dir, error);
+	if (!eod)
+		return FALSE;
+
+	success = ebb_ews_index_gal (book_cache, eod, oab_filename,
+		&created_objects, &modified_objects, out_removed_objects, cancellable, error);
+
+	if (success)
+		e_cache_set_key_int (E_CACHE (book_cache), "gal-lazy-contacts", 1, NULL);
+
+	g_object_unref (eod);
+
+	return success;
+}
+
+/* Whether the stored GAL contacts do not match the "gal-lazy-contacts" option,
+   which can change after the OAB file had been processed, or the index is missing */
+gboolean
+e_book_backend_ews_gal_needs_reprocess (EBookCache *book_cache,
+					gboolean lazy)
+{
+	EwsOabIndex *index;
+	gchar *oab_filename, *index_filename;
+	gboolean needs_reprocess;
+
+	g_return_val_if_fail (E_IS_BOOK_CACHE (book_cache), FALSE);
+
+	/* Caches without the key were populated with the full contacts */
+	if ((e_cache_get_key_int (E_CACHE (book_cache), "gal-lazy-contacts", NULL) == 1) != lazy)
+		return TRUE;
+
+	if (!lazy)
+		return FALSE;
+
+	oab_filename = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
+	if (!oab_filename || !*oab_filename) {
+		g_free (oab_filename);
+		return FALSE;
+	}
+
+	/* Also when the index is not readable, like when written by an older version */
+	index_filename = ebb_ews_dup_gal_index_filename (oab_filename);
+	index = ews_oab_index_new (index_filename, NULL);
+	needs_reprocess = !index;
+
+	ews_oab_index_free (index);
+	g_free (index_filename);
+	g_free (oab_filename);
+
+	return needs_reprocess;
+}
+
 static gboolean
 ebb_ews_check_gal_changes (EBookBackendEws *bbews,
 			   EBookCache *book_cache,
-			   const gchar *filename,
+			   EwsOabDecoder *eod,
+			   const gchar *oab_filename,
 			   GSList **out_created_objects, /*EBookMetaBackendInfo * */
 			   GSList **out_modified_objects, /*EBookMetaBackendInfo * */
 			   GSList **out_removed_objects, /*EBookMetaBackendInfo * */
@@ -2540,7 +2952,6 @@ ebb_ews_check_gal_changes (EBookBackendEws *bbews,
 			   GError **error)
 {
 	ESourceEwsFolder *ews_folder;
-	EwsOabDecoder *eod;
 	gboolean success = TRUE;
 	struct _db_data data;
 #if d(1) + 0
@@ -2550,11 +2961,16 @@ ebb_ews_check_gal_changes (EBookBackendEws *bbews,
 
 	g_return_val_if_fail (E_IS_BOOK_BACKEND_EWS (bbews), FALSE);
 	g_return_val_if_fail (E_IS_BOOK_CACHE (book_cache), FALSE);
-	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (EWS_IS_OAB_DECODER (eod), FALSE);
 	g_return_val_if_fail (out_created_objects != NULL, FALSE);
 	g_return_val_if_fail (out_modified_objects != NULL, FALSE);
 	g_return_val_if_fail (out_removed_objects != NULL, FALSE);
 
+	if (ebb_ews_gal_is_lazy (bbews)) {
+		return ebb_ews_index_gal (book_cache, eod, oab_filename,
+			out_created_objects, out_modified_objects, out_removed_objects, cancellable, error);
+	}
+
 	ews_folder = e_source_get_extension (e_backend_get_source (E_BACKEND (bbews)), E_SOURCE_EXTENSION_EWS_FOLDER);
 
 	data.bbews = bbews;
@@ -2570,8 +2986,7 @@ ebb_ews_check_gal_changes (EBookBackendEws *bbews,
 
 	e_book_cache_search_with_callback (book_cache, NULL, ebb_ews_gather_existing_uids_cb, &data, cancellable, NULL);
 
-	eod = ews_oab_decoder_new (filename, bbews->priv->attachments_dir, &local_error);
-	if (!local_error) {
+	if (!g_cancellable_set_error_if_cancelled (cancellable, &local_error)) {
 		GHashTableIter iter;
 		gpointer key;
 
@@ -2611,6 +3026,252 @@ ebb_ews_check_gal_changes (EBookBackendEws *bbews,
 	return success;
 }
 
+/* Processes the already downloaded OAB file again, to either index it or
+   to store its contacts in the cache, as the "gal-lazy-contacts" option says */
+static gboolean
+ebb_ews_gal_reprocess_oab_file (EBookBackendEws *bbews,
+				EBookCache *book_cache,
+				const gchar *oab_filename,
+				gboolean lazy,
+				GSList **out_created_objects, /*EBookMetaBackendInfo * */
+				GSList **out_modified_objects, /*EBookMetaBackendInfo * */
+				GSList **out_removed_objects, /*EBookMetaBackendInfo * */
+				GCancellable *cancellable,
+				GError **error)
+{
+	gboolean success;
+
+	if (lazy) {
+		*out_created_objects = NULL;
+		*out_modified_objects = NULL;
+
+		success = e_book_backend_ews_gal_index_oab_file (book_cache, oab_filename, bbews->priv->attachments_dir,
+			out_removed_objects, cancellable, error);
+	} else {
+		EwsOabDecoder *eod;
+
+		eod = ews_oab_decoder_new (oab_filename, bbews->priv->attachments_dir, error);
+		success = eod && ebb_ews_check_gal_changes (bbews, book_cache, eod, oab_filename,
+			out_created_objects, out_modified_objects, out_removed_objects, cancellable, error);
+
+		g_clear_object (&eod);
+
+		if (success) {
+			gchar *index_filename;
+
+			index_filename = ebb_ews_dup_gal_index_filename (oab_filename);
+			g_unlink (index_filename);
+			g_free (index_filename);
+
+			e_cache_set_key_int (E_CACHE (book_cache), "gal-lazy-contacts", 0, NULL);
+		}
+	}
+
+	if (success)
+		ebb_ews_gal_index_reset (bbews);
+
+	return success;
+}
+
+typedef struct _GalStreamData {
+	EEwsConnection *oab_cnc;
+	GInputStream *compressed; /* EwsOabPipeStream */
+	GInputStream *decompressed; /* EwsOabPipeStream */
+	GOutputStream *oab_output;
+	GCancellable *cancellable;
+	GError *download_error;
+	GError *decompress_error;
+} GalStreamData;
+
+static gboolean
+ebb_ews_gal_stream_downloaded_cb (gconstpointer data,
+				  gsize data_len,
+				  gpointer user_data,
+				  GError **error)
+{
+	GalStreamData *gsd = user_data;
+
+	return ews_oab_pipe_stream_write (EWS_OAB_PIPE_STREAM (gsd->compressed), data, data_len, gsd->cancellable, error);
+}
+
+static gpointer
+ebb_ews_gal_stream_download_thread (gpointer user_data)
+{
+	GalStreamData *gsd = user_data;
+
+	e_ews_connection_download_oal_file_stream_sync (gsd->oab_cnc, ebb_ews_gal_stream_downloaded_cb, gsd,
+		NULL, NULL, gsd->cancellable, &gsd->download_error);
+
+	ews_oab_pipe_stream_close_write (EWS_OAB_PIPE_STREAM (gsd->compressed), gsd->download_error);
+
+	return NULL;
+}
+
+static gboolean
+ebb_ews_gal_stream_decompressed_cb (gconstpointer data,
+				    gsize data_len,
+				    gpointer user_data,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	GalStreamData *gsd = user_data;
+
+	return g_output_stream_write_all (gsd->oab_output, data, data_len, NULL, cancellable, error) &&
+		ews_oab_pipe_stream_write (EWS_OAB_PIPE_STREAM (gsd->decompressed), data, data_len, cancellable, error);
+}
+
+static gpointer
+ebb_ews_gal_stream_decompress_thread (gpointer user_data)
+{
+	GalStreamData *gsd = user_data;
+	gboolean success;
+
+	success = ews_oab_decompress_full_stream (gsd->compressed, ebb_ews_gal_stream_decompressed_cb, gsd,
+		gsd->cancellable, &gsd->decompress_error);
+
+	if (!g_output_stream_close (gsd->oab_output, gsd->cancellable, success ? &gsd->decompress_error : NULL))
+		success = FALSE;
+
+	/* Stop the download, when it's not needed anymore */
+	if (!success)
+		g_cancellable_cancel (gsd->cancellable);
+
+	g_input_stream_close (gsd->compressed, NULL, NULL);
+
+	ews_oab_pipe_stream_close_write (EWS_OAB_PIPE_STREAM (gsd->decompressed), gsd->decompress_error);
+
+	return NULL;
+}
+
+/* Downloads the full OAB file and processes it in one pass: the downloaded data
+   is decompressed as it arrives and the decompressed data is decoded immediately,
+   while the decompressed OAB file is saved for the later incremental updates.
+   Returns the saved OAB file name on success. */
+static gchar *
+ebb_ews_sync_full_gal (EBookBackendEws *bbews,
+		       EBookCache *book_cache,
+		       EwsOALDetails *full,
+		       GSList **out_created_objects, /*EBookMetaBackendInfo * */
+		       GSList **out_modified_objects, /*EBookMetaBackendInfo * */
+		       GSList **out_removed_objects, /*EBookMetaBackendInfo * */
+		       GCancellable *cancellable,
+		       GError **error)
+{
+	GalStreamData gsd;
+	GFile *file;
+	GFileOutputStream *file_stream;
+	GThread *download_thread, *decompress_thread;
+	EwsOabDecoder *eod;
+	gchar *oab_path;
+	gulong cancel_id = 0;
+	gboolean success;
+	GError *local_error = NULL;
+
+	memset (&gsd, 0, sizeof (GalStreamData));
+
+	gsd.oab_cnc = ebb_ews_new_oal_file_connection (bbews, full);
+	if (!gsd.oab_cnc)
+		return NULL;
+
+	oab_path = ebb_ews_dup_oab_filename (bbews, full->seq);
+
+	file = g_file_new_for_path (oab_path);
+	file_stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_PRIVATE, cancellable, error);
+	g_object_unref (file);
+
+	if (!file_stream) {
+		g_object_unref (gsd.oab_cnc);
+		g_free (oab_path);
+		return NULL;
+	}
+
+	gsd.oab_output = G_OUTPUT_STREAM (file_stream);
+	gsd.compressed = ews_oab_pipe_stream_new (EWS_GAL_PIPE_BUFFER_SIZE);
+	gsd.decompressed = ews_oab_pipe_stream_new (EWS_GAL_PIPE_BUFFER_SIZE);
+	gsd.cancellable = g_cancellable_new ();
+
+	if (cancellable)
+		cancel_id = g_cancellable_connect (cancellable, G_CALLBACK (ebb_ews_gal_stream_cancelled_cb), gsd.cancellable, NULL);
+
+	download_thread = g_thread_new ("ews-gal-download", ebb_ews_gal_stream_download_thread, &gsd);
+	decompress_thread = g_thread_new ("ews-gal-decompress", ebb_ews_gal_stream_decompress_thread, &gsd);
+
+	eod = ews_oab_decoder_new_for_stream (gsd.decompressed, bbews->priv->attachments_dir);
+
+	success = ebb_ews_check_gal_changes (bbews, book_cache, eod, oab_path,
+		out_created_objects, out_modified_objects, out_removed_objects, gsd.cancellable, &local_error);
+
+	if (success) {
+		gssize skipped;
+
+		/* Let the decompressor finish writing the OAB file */
+		do {
+			skipped = g_input_stream_skip (gsd.decompressed, 65536, gsd.cancellable, &local_error);
+		} while (skipped > 0);
+
+		success = skipped == 0;
+	}
+
+	/* Unblock the other stages, if the decoder stopped early */
+	if (!success)
+		g_cancellable_cancel (gsd.cancellable);
+
+	g_input_stream_close (gsd.decompressed, NULL, NULL);
+
+	g_thread_join (decompress_thread);
+	g_thread_join (download_thread);
+
+	if (cancel_id)
+		g_cancellable_disconnect (cancellable, cancel_id);
+
+	/* Prefer the error from the earliest stage, it's the real cause */
+	if (!success || gsd.download_error || gsd.decompress_error) {
+		g_slist_free_full (*out_created_objects, e_book_meta_backend_info_free);
+		g_slist_free_full (*out_modified_objects, e_book_meta_backend_info_free);
+		g_slist_free_full (*out_removed_objects, e_book_meta_backend_info_free);
+		*out_created_objects = NULL;
+		*out_modified_objects = NULL;
+		*out_removed_objects = NULL;
+
+		if (gsd.download_error && !g_error_matches (gsd.download_error, G_IO_ERROR, G_IO_ERROR_CLOSED)) {
+			g_propagate_error (error, gsd.download_error);
+			gsd.download_error = NULL;
+		} else if (gsd.decompress_error && !g_error_matches (gsd.decompress_error, G_IO_ERROR, G_IO_ERROR_CLOSED)) {
+			g_propagate_error (error, gsd.decompress_error);
+			gsd.decompress_error = NULL;
+		} else if (local_error) {
+			g_propagate_error (error, local_error);
+			local_error = NULL;
+		} else if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+			/* The error is set */
+		} else {
+			g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED, _("Failed to process GAL file"));
+		}
+
+		success = FALSE;
+	} else {
+		d (printf ("OAL file downloaded and decompressed to %s\n", oab_path));
+	}
+
+	g_clear_error (&local_error);
+	g_clear_error (&gsd.download_error);
+	g_clear_error (&gsd.decompress_error);
+	g_object_unref (eod);
+	g_object_unref (gsd.decompressed);
+	g_object_unref (gsd.compressed);
+	g_object_unref (gsd.oab_output);
+	g_object_unref (gsd.cancellable);
+	g_object_unref (gsd.oab_cnc);
+
+	if (!success) {
+		g_unlink (oab_path);
+		g_free (oab_path);
+		oab_path = NULL;
+	}
+
+	return oab_path;
+}
+
 typedef struct {
 	/* For future use */
 	gpointer restriction;
@@ -2846,6 +3507,147 @@ ebb_ews_build_restriction (const gchar *query,
 	return autocompletion && *auto_comp_str;
 }
 
+/* Opens the GAL index for the current OAB file; call with the gal_index_lock held */
+static gboolean
+ebb_ews_gal_index_open_locked (EBookBackendEws *bbews,
+			       GError **error)
+{
+	EBookCache *book_cache;
+	EwsOabIndex *index;
+	EwsOabDecoder *eod = NULL;
+	gchar *oab_filename, *index_filename;
+
+	if (bbews->priv->gal_index)
+		return TRUE;
+
+	book_cache = e_book_meta_backend_ref_cache (E_BOOK_META_BACKEND (bbews));
+	oab_filename = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
+	g_clear_object (&book_cache);
+
+	if (!oab_filename || !*oab_filename) {
+		g_free (oab_filename);
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, _("Global Address List is not downloaded yet"));
+		return FALSE;
+	}
+
+	index_filename = ebb_ews_dup_gal_index_filename (oab_filename);
+	index = ews_oab_index_new (index_filename, error);
+
+	if (index) {
+		eod = ews_oab_decoder_new (oab_filename, bbews->priv->attachments_dir, error);
+
+		if (!eod || !ews_oab_decoder_set_oab_prop_string (eod, ews_oab_index_get_oab_props (index), error)) {
+			g_clear_object (&eod);
+			g_clear_pointer (&index, ews_oab_index_free);
+		}
+	}
+
+	bbews->priv->gal_index = index;
+	bbews->priv->gal_index_decoder = eod;
+
+	g_free (index_filename);
+	g_free (oab_filename);
+
+	return index != NULL;
+}
+
+/* Decodes the contact from the OAB file; call with the gal_index_lock held */
+static EContact *
+ebb_ews_gal_index_get_contact_locked (EBookBackendEws *bbews,
+				      const gchar *uid,
+				      GCancellable *cancellable,
+				      GError **error)
+{
+	EContact *contact;
+	goffset offset;
+	GError *local_error = NULL;
+
+	if (!ews_oab_index_lookup_uid (bbews->priv->gal_index, uid, &offset)) {
+		g_propagate_error (error, EDB_ERROR (CONTACT_NOT_FOUND));
+		return NULL;
+	}
+
+	contact = ews_oab_decoder_get_contact_from_offset (bbews->priv->gal_index_decoder, offset, NULL, cancellable, &local_error);
+	if (!contact) {
+		if (!local_error)
+			local_error = EDB_ERROR (CONTACT_NOT_FOUND);
+
+		g_propagate_error (error, local_error);
+
+		return NULL;
+	}
+
+	ebews_populate_rev (contact, NULL);
+
+	return contact;
+}
+
+/* Stores the GAL contacts matching the expression into the cache,
+   decoding them from the OAB file */
+static gboolean
+ebb_ews_gal_materialize_contacts (EBookBackendEws *bbews,
+				  const gchar *expr,
+				  GCancellable *cancellable,
+				  GError **error)
+{
+	EBookCache *book_cache;
+	GSList *nfos = NULL;
+	gchar *text = NULL;
+	gboolean success;
+
+	if (!expr || !*expr || !ebb_ews_build_restriction (expr, &text))
+		return TRUE;
+
+	book_cache = e_book_meta_backend_ref_cache (E_BOOK_META_BACKEND (bbews));
+
+	g_mutex_lock (&bbews->priv->gal_index_lock);
+
+	success = ebb_ews_gal_index_open_locked (bbews, error);
+
+	if (success) {
+		GPtrArray *uids;
+		guint ii;
+
+		uids = ews_oab_index_search (bbews->priv->gal_index, text, EWS_GAL_LAZY_MAX_CONTACTS);
+
+		for (ii = 0; ii < uids->len && success; ii++) {
+			const gchar *uid = g_ptr_array_index (uids, ii);
+			EBookMetaBackendInfo *nfo;
+			EContact *contact;
+
+			/* Decoded already */
+			if (e_cache_contains (E_CACHE (book_cache), uid, E_CACHE_EXCLUDE_DELETED))
+				continue;
+
+			contact = ebb_ews_gal_index_get_contact_locked (bbews, uid, cancellable, error);
+			if (!contact) {
+				success = FALSE;
+				break;
+			}
+
+			nfo = e_book_meta_backend_info_new (uid, e_contact_get_const (contact, E_CONTACT_REV), NULL, NULL);
+			nfo->object = e_vcard_to_string (E_VCARD (contact), EVC_FORMAT_VCARD_30);
+
+			nfos = g_slist_prepend (nfos, nfo);
+
+			g_object_unref (contact);
+		}
+
+		g_ptr_array_unref (uids);
+	}
+
+	g_mutex_unlock (&bbews->priv->gal_index_lock);
+
+	if (success && nfos)
+		success = e_book_meta_backend_process_changes_sync (E_BOOK_META_BACKEND (bbews), nfos, NULL, NULL, cancellable, error);
+
+	g_slist_free_full (nfos, e_book_meta_backend_info_free);
+	g_clear_object (&book_cache);
+	g_free (text);
+
+	return success;
+}
+
 static gboolean
 ebb_ews_update_cache_for_expression (EBookBackendEws *bbews,
 				     const gchar *expr,
@@ -2864,8 +3666,12 @@ ebb_ews_update_cache_for_expression (EBookBackendEws *bbews,
 
 	ews_settings = ebb_ews_get_collection_settings (bbews);
 
-	if (camel_ews_settings_get_oab_offline (ews_settings))
+	if (camel_ews_settings_get_oab_offline (ews_settings)) {
+		if (ebb_ews_gal_is_lazy (bbews))
+			return ebb_ews_gal_materialize_contacts (bbews, expr, cancellable, error);
+
 		return TRUE;
+	}
 
 	meta_backend = E_BOOK_META_BACKEND (bbews);
 
@@ -3368,13 +4174,43 @@ ebb_ews_get_changes_sync (EBookMetaBackend *meta_backend,
 			EEwsConnection *oab_cnc;
 			GSList *full_l = NULL, *deltas = NULL, *link;
 			EwsOALDetails *full = NULL;
+			const gchar *oal_etag = last_sync_tag;
 			gchar *password, *etag = NULL;
+			gboolean lazy, reprocessed = FALSE;
 			gint sequence;
 
 			sequence = e_cache_get_key_int (E_CACHE (book_cache), "gal-sequence", NULL);
 			if (sequence == -1)
 				sequence = 0;
 
+			lazy = ebb_ews_gal_is_lazy (bbews);
+
+			if (e_book_backend_ews_gal_needs_reprocess (book_cache, lazy)) {
+				gchar *oab_filename;
+
+				oab_filename = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
+
+				if (oab_filename && *oab_filename && g_file_test (oab_filename, G_FILE_TEST_IS_REGULAR)) {
+					d (printf ("Ewsgal: Reprocessing %s for the changed contacts mode\n", oab_filename));
+					success = ebb_ews_gal_reprocess_oab_file (bbews, book_cache, oab_filename, lazy,
+						out_created_objects, out_modified_objects, out_removed_objects, cancellable, &local_error);
+					reprocessed = TRUE;
+
+					if (success) {
+						etag = g_strdup (last_sync_tag);
+
+						/* Check for the server changes in the next round */
+						*out_repeat = TRUE;
+					}
+				} else {
+					/* No OAB file to reprocess, download the full file again */
+					sequence = 0;
+					oal_etag = NULL;
+				}
+
+				g_free (oab_filename);
+			}
+
 			oab_cnc = e_ews_connection_new_for_backend (E_BACKEND (bbews), e_book_backend_get_registry (E_BOOK_BACKEND (bbews)), oab_url, ews_settings);
 
 			e_binding_bind_property (
@@ -3386,12 +4222,14 @@ ebb_ews_get_changes_sync (EBookMetaBackend *meta_backend,
 			e_ews_connection_set_password (oab_cnc, password);
 			e_util_safe_free_string (password);
 
-			d (printf ("Ewsgal: Fetching oal full details file\n"));
-			if (!e_ews_connection_get_oal_detail_sync (oab_cnc, bbews->priv->folder_id, NULL, last_sync_tag, &full_l, &etag, cancellable, &local_error)) {
-				if (g_error_matches (local_error, SOUP_HTTP_ERROR, SOUP_STATUS_NOT_MODIFIED)) {
-					g_clear_error (&local_error);
-				} else {
-					success = FALSE;
+			if (!reprocessed) {
+				d (printf ("Ewsgal: Fetching oal full details file\n"));
+				if (!e_ews_connection_get_oal_detail_sync (oab_cnc, bbews->priv->folder_id, NULL, oal_etag, &full_l, &etag, cancellable, &local_error)) {
+					if (g_error_matches (local_error, SOUP_HTTP_ERROR, SOUP_STATUS_NOT_MODIFIED)) {
+						g_clear_error (&local_error);
+					} else {
+						success = FALSE;
+					}
 				}
 			}
 
@@ -3429,34 +4267,62 @@ ebb_ews_get_changes_sync (EBookMetaBackend *meta_backend,
 			if (full) {
 				gchar *uncompressed_filename;
 
-				uncompressed_filename = ebb_ews_download_gal (bbews, book_cache, full, deltas, sequence, cancellable, &local_error);
-				if (!uncompressed_filename) {
-					success = FALSE;
-				} else {
+				uncompressed_filename = ebb_ews_download_gal_deltas (bbews, book_cache, full, deltas, sequence, cancellable);
+				if (uncompressed_filename) {
+					EwsOabDecoder *eod;
+
 					d (printf ("Ewsgal: Removing old gal\n"));
 					/* remove old_gal_file */
 					ebb_ews_remove_old_gal_file (book_cache);
 
 					d (printf ("Ewsgal: Check for changes in GAL\n"));
-					success = ebb_ews_check_gal_changes (bbews, book_cache, uncompressed_filename,
+					eod = ews_oab_decoder_new (uncompressed_filename, bbews->priv->attachments_dir, &local_error);
+					success = eod && ebb_ews_check_gal_changes (bbews, book_cache, eod, uncompressed_filename,
+						out_created_objects, out_modified_objects, out_removed_objects, cancellable, &local_error);
+
+					g_clear_object (&eod);
+				} else {
+					d (printf ("Ewsgal: Downloading full gal \n"));
+					uncompressed_filename = ebb_ews_sync_full_gal (bbews, book_cache, full,
 						out_created_objects, out_modified_objects, out_removed_objects, cancellable, &local_error);
+					success = uncompressed_filename != NULL;
 
 					if (success) {
-						if (e_cache_set_key (E_CACHE (book_cache), "oab-filename", uncompressed_filename, NULL)) {
-							/* Don't let it get deleted */
-							g_free (uncompressed_filename);
-							uncompressed_filename = NULL;
-						}
+						gchar *old_filename;
 
-						e_cache_set_key_int (E_CACHE (book_cache), "gal-sequence", full->seq, NULL);
+						/* remove old_gal_file, unless it had been just overwritten */
+						old_filename = e_cache_dup_key (E_CACHE (book_cache), "oab-filename", NULL);
+						if (g_strcmp0 (old_filename, uncompressed_filename) != 0)
+							ebb_ews_remove_old_gal_file (book_cache);
+						g_free (old_filename);
+					}
+				}
 
-						d (printf ("Ewsgal: sync successfully completed\n"));
+				if (success) {
+					if (e_cache_set_key (E_CACHE (book_cache), "oab-filename", uncompressed_filename, NULL)) {
+						/* Don't let it get deleted */
+						g_free (uncompressed_filename);
+						uncompressed_filename = NULL;
 					}
 
-					ews_oal_details_free (full);
+					e_cache_set_key_int (E_CACHE (book_cache), "gal-sequence", full->seq, NULL);
+					e_cache_set_key_int (E_CACHE (book_cache), "gal-lazy-contacts", lazy ? 1 : 0, NULL);
+
+					/* Reopen the index with the new OAB file */
+					ebb_ews_gal_index_reset (bbews);
+
+					d (printf ("Ewsgal: sync successfully completed\n"));
 				}
 
+				ews_oal_details_free (full);
+
 				if (uncompressed_filename) {
+					gchar *index_filename;
+
+					index_filename = ebb_ews_dup_gal_index_filename (uncompressed_filename);
+					g_unlink (index_filename);
+					g_free (index_filename);
+
 					/* preserve  the oab file once we are able to decode the differential updates */
 					g_unlink (uncompressed_filename);
 					g_free (uncompressed_filename);
@@ -3569,6 +4435,17 @@ ebb_ews_load_contact_sync (EBookMetaBackend *meta_backend,
 
 	bbews = E_BOOK_BACKEND_EWS (meta_backend);
 
+	if (ebb_ews_gal_is_lazy (bbews)) {
+		g_mutex_lock (&bbews->priv->gal_index_lock);
+
+		if (ebb_ews_gal_index_open_locked (bbews, error))
+			*out_contact = ebb_ews_gal_index_get_contact_locked (bbews, uid, cancellable, error);
+
+		g_mutex_unlock (&bbews->priv->gal_index_lock);
+
+		return *out_contact != NULL;
+	}
+
 	g_rec_mutex_lock (&bbews->priv->cnc_lock);
 
 	ids = g_slist_prepend (NULL, (gpointer) uid);
@@ -3890,7 +4767,7 @@ ebb_ews_get_backend_property (EBookBackend *book_backend,
 			"net",
 			"contact-lists",
 			e_book_meta_backend_get_capabilities (E_BOOK_META_BACKEND (book_backend)),
-			(!bbews->priv->is_gal || camel_ews_settings_get_oab_offline (ews_settings)) ? "do-initial-query" : NULL,
+			(!bbews->priv->is_gal || (camel_ews_settings_get_oab_offline (ews_settings) && !ebb_ews_gal_is_lazy (bbews))) ? "do-initial-query" : NULL,
 			NULL);
 	} else if (g_str_equal (prop_name, BOOK_BACKEND_PROPERTY_REQUIRED_FIELDS)) {
 		return g_strdup (e_contact_field_name (E_CONTACT_FILE_AS));
@@ -4030,7 +4907,11 @@ e_book_backend_ews_finalize (GObject *object)
 	g_free (bbews->priv->folder_id);
 	g_free (bbews->priv->attachments_dir);
 
+	g_clear_pointer (&bbews->priv->gal_index, ews_oab_index_free);
+	g_clear_object (&bbews->priv->gal_index_decoder);
+
 	g_rec_mutex_clear (&bbews->priv->cnc_lock);
+	g_mutex_clear (&bbews->priv->gal_index_lock);
 
 	/* Chain up to parent's method. */
 	G_OBJECT_CLASS (e_book_backend_ews_parent_class)->finalize (object);
@@ -4042,6 +4923,7 @@ e_book_backend_ews_init (EBookBackendEws *bbews)
 	bbews->priv = G_TYPE_INSTANCE_GET_PRIVATE (bbews, E_TYPE_BOOK_BACKEND_EWS, EBookBackendEwsPrivate);
 
 	g_rec_mutex_init (&bbews->priv->cnc_lock);
+	g_mutex_init (&bbews->priv->gal_index_lock);
 }
 
 static void
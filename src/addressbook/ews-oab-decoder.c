@@ -52,6 +52,9 @@ struct _EwsOabDecoderPrivate {
 	GSList *hdr_props;
 	GSList *oab_props;
 
+	/* the current read position in the fis, which can be non-seekable */
+	goffset stream_offset;
+
 	GHashTable *prop_index_dict;
 };
 
@@ -317,6 +320,27 @@ ews_oab_decoder_init (EwsOabDecoder *self)
 		g_hash_table_insert (priv->prop_index_dict, GINT_TO_POINTER (prop_map[i - 1].prop_id), GINT_TO_POINTER (i));
 }
 
+/* Creates a decoder reading the OAB data from the stream. The stream is read
+   only sequentially, thus it does not need to be seekable, but then
+   ews_oab_decoder_get_contact_from_offset() cannot be used with the decoder. */
+EwsOabDecoder *
+ews_oab_decoder_new_for_stream (GInputStream *stream,
+				const gchar *cache_dir)
+{
+	EwsOabDecoder *eod;
+	EwsOabDecoderPrivate *priv;
+
+	g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+	eod = g_object_new (EWS_TYPE_OAB_DECODER, NULL);
+	priv = GET_PRIVATE (eod);
+
+	priv->fis = g_object_ref (stream);
+	priv->cache_dir = g_strdup (cache_dir);
+
+	return eod;
+}
+
 EwsOabDecoder *
 ews_oab_decoder_new (const gchar *oab_filename,
                      const gchar *cache_dir,
@@ -377,14 +401,15 @@ ews_oab_read_uint32 (GInputStream *is,
                      GCancellable *cancellable,
                      GError **error)
 {
-	gchar *str = g_malloc0 (4);
+	guchar str[4];
+	gsize bytes_read = 0;
 	guint32 ret = 0;
 
-	g_input_stream_read (is, str, 4, cancellable, error);
-	if (!*error)
+	if (g_input_stream_read_all (is, str, 4, &bytes_read, cancellable, error) && bytes_read == 4)
 		ret = EndGetI32 (str);
+	else if (!*error)
+		g_set_error_literal (error, EOD_ERROR, 1, "unexpected end of the input");
 
-	g_free (str);
 	return ret;
 }
 
@@ -549,24 +574,76 @@ ews_decode_hdr_props (EwsOabDecoder *eod, GInputStream *stream,
 	return TRUE;
 }
 
+/* Reads a size-prefixed chunk (the size includes the 4 bytes of the size itself)
+   into the buffer, growing it when needed. Returns the chunk size without
+   the size prefix, or -1 on error. */
+static gssize
+ews_oab_read_sized_chunk (GInputStream *stream,
+			  guchar **buffer,
+			  gsize *buffer_len,
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	guint32 size;
+	gsize bytes_read = 0;
+
+	size = ews_oab_read_uint32 (stream, cancellable, error);
+	if (*error)
+		return -1;
+
+	if (size < 4) {
+		g_set_error_literal (error, EOD_ERROR, 1, "invalid chunk size");
+		return -1;
+	}
+
+	size -= 4;
+
+	if (size > *buffer_len) {
+		g_free (*buffer);
+		*buffer = g_malloc (size);
+		*buffer_len = size;
+	}
+
+	if (!g_input_stream_read_all (stream, *buffer, size, &bytes_read, cancellable, error))
+		return -1;
+
+	if (bytes_read != size) {
+		g_set_error_literal (error, EOD_ERROR, 1, "unexpected end of the input");
+		return -1;
+	}
+
+	return size;
+}
+
 static gboolean
 ews_decode_metadata (EwsOabDecoder *eod, GInputStream *stream,
                      GCancellable *cancellable,
                      GError **error)
 {
+	EwsOabDecoderPrivate *priv = GET_PRIVATE (eod);
+	GInputStream *memstream;
+	guchar *buffer = NULL;
+	gsize buffer_len = 0;
+	gssize size;
 	gboolean ret = TRUE;
 
-	/* eat the size */
-	ews_oab_read_uint32 (stream, cancellable, error);
-
-	if (*error)
+	/* Read the whole metadata at once, thus the decoding does not
+	   depend on the stream being seekable */
+	size = ews_oab_read_sized_chunk (stream, &buffer, &buffer_len, cancellable, error);
+	if (size < 0) {
+		g_free (buffer);
 		return FALSE;
+	}
 
-	ret = ews_decode_hdr_props (eod, stream, FALSE, cancellable, error);
-	if (!ret)
-		return FALSE;
+	priv->stream_offset += size + 4;
+
+	memstream = g_memory_input_stream_new_from_data (buffer, size, g_free);
 
-	ret = ews_decode_hdr_props (eod, stream, TRUE, cancellable, error);
+	ret = ews_decode_hdr_props (eod, memstream, FALSE, cancellable, error);
+	if (ret)
+		ret = ews_decode_hdr_props (eod, memstream, TRUE, cancellable, error);
+
+	g_object_unref (memstream);
 
 	return ret;
 }
@@ -996,20 +1073,25 @@ ews_decode_and_store_oab_records (EwsOabDecoder *eod,
 	EwsOabDecoderPrivate *priv = GET_PRIVATE (eod);
 	gboolean ret = FALSE;
 	guint32 i;
-	int buf_len = 200;
+	gsize buf_len = 200;
 	guchar *record_buf = g_malloc (buf_len);
 	GChecksum *sum = g_checksum_new (G_CHECKSUM_SHA1);
+	GInputStream *memstream;
+	gssize rec_size;
 
 	if (!record_buf || !sum)
 		goto exit;
 
-	/* eat the size */
-	ews_oab_read_uint32 (
-		priv->fis,
-		cancellable, error);
+	rec_size = ews_oab_read_sized_chunk (priv->fis, &record_buf, &buf_len, cancellable, error);
+	if (rec_size < 0)
+		goto exit;
+
+	priv->stream_offset += rec_size + 4;
 
-	ews_decode_addressbook_record (eod, priv->fis, NULL,
+	memstream = g_memory_input_stream_new_from_data (record_buf, rec_size, NULL);
+	ews_decode_addressbook_record (eod, memstream, NULL,
 				       priv->hdr_props, cancellable, error);
+	g_object_unref (memstream);
 
 	if (*error)
 		goto exit;
@@ -1018,30 +1100,18 @@ ews_decode_and_store_oab_records (EwsOabDecoder *eod,
 	for (i = 0; i < priv->total_records; i++) {
 		EContact *contact;
 		goffset offset;
-		guint32 rec_size;
-		GInputStream *memstream;
 		const gchar *sum_str;
 
-		contact = e_contact_new ();
+		/* the offset of the record data, after its size */
+		offset = priv->stream_offset + 4;
 
-		/* eat the size */
-		rec_size = ews_oab_read_uint32 (priv->fis, cancellable, error);
-		if (rec_size < 4)
+		rec_size = ews_oab_read_sized_chunk (priv->fis, &record_buf, &buf_len, cancellable, error);
+		if (rec_size < 0)
 			goto exit;
 
-		rec_size -= 4;
+		priv->stream_offset += rec_size + 4;
 
-		if (rec_size > buf_len) {
-			g_free (record_buf);
-			record_buf = g_malloc(rec_size);
-			buf_len = rec_size;
-			if (!record_buf)
-				goto exit;
-		}
-		/* fetch the offset */
-		offset = g_seekable_tell ((GSeekable *) priv->fis);
-		if (g_input_stream_read (priv->fis, record_buf, rec_size, cancellable, error) != rec_size)
-			goto exit;
+		contact = e_contact_new ();
 
 		g_checksum_reset (sum);
 		g_checksum_update (sum, record_buf, rec_size);
@@ -1172,6 +1242,7 @@ ews_oab_decoder_decode (EwsOabDecoder *eod,
 	}
 
 	priv->total_records = o_hdr->total_recs;
+	priv->stream_offset = 12; /* sizeof the header */
 	g_print ("Total records is %d \n", priv->total_records);
 
 	ret = ews_decode_metadata (eod, priv->fis, cancellable, &err);
@@ -1200,6 +1271,10 @@ ews_oab_decoder_get_contact_from_offset (EwsOabDecoder *eod,
 	EwsOabDecoderPrivate *priv = GET_PRIVATE (eod);
 	EContact *contact = NULL;
 
+	/* Use the properties set by ews_oab_decoder_set_oab_prop_string() */
+	if (!oab_props)
+		oab_props = priv->oab_props;
+
 	if (!g_seekable_seek ((GSeekable *) priv->fis, offset, G_SEEK_SET, cancellable, error))
 		return NULL;
 
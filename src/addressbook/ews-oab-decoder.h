@@ -72,6 +72,8 @@ GType		ews_oab_decoder_get_type	(void);
 EwsOabDecoder *	ews_oab_decoder_new		(const gchar *oab_filename,
 						 const gchar *cache_dir,
 						 GError **error);
+EwsOabDecoder *	ews_oab_decoder_new_for_stream	(GInputStream *stream,
+						 const gchar *cache_dir);
 gboolean	ews_oab_decoder_decode		(EwsOabDecoder *eod,
 						 EwsOabContactFilterCb filter_cb,
 						 EwsOabContactAddedCb cb,
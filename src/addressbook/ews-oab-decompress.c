@@ -22,6 +22,8 @@
 
 #include "evolution-ews-config.h"
 
+#include <stdarg.h>
+#include <string.h>
 #include <glib.h>
 #include "ews-oab-decompress.h"
 #include <mspack.h>
@@ -55,6 +57,267 @@ ews_oab_decompress_full (const gchar *filename, const gchar *output_filename,
 }
 
 
+/* A minimal mspack_system, which reads the compressed data from a GInputStream
+   and passes the decompressed data to an EwsOabDecompressFunc, thus libmspack
+   does not need any files on the disk. The oabd decompressor only reads the input
+   and writes the output sequentially; the same applies to the reference (base)
+   data of the incremental decompression. */
+
+#define STREAM_SYS_INPUT_NAME "input"
+#define STREAM_SYS_REFERENCE_NAME "reference"
+#define STREAM_SYS_OUTPUT_NAME "output"
+
+typedef struct _StreamSys StreamSys;
+
+typedef struct _StreamSysFile {
+	StreamSys *ssys;
+	GInputStream *input; /* NULL for the output file */
+} StreamSysFile;
+
+struct _StreamSys {
+	struct mspack_system sys;
+
+	StreamSysFile input_file;
+	StreamSysFile reference_file;
+	StreamSysFile output_file;
+
+	EwsOabDecompressFunc func;
+	gpointer func_user_data;
+	GCancellable *cancellable;
+	GError *error;
+};
+
+static struct mspack_file *
+stream_sys_open (struct mspack_system *self,
+		 const gchar *filename,
+		 gint mode)
+{
+	StreamSys *ssys = (StreamSys *) self;
+
+	if (mode == MSPACK_SYS_OPEN_READ && g_strcmp0 (filename, STREAM_SYS_INPUT_NAME) == 0)
+		return (struct mspack_file *) &ssys->input_file;
+
+	if (mode == MSPACK_SYS_OPEN_READ && ssys->reference_file.input &&
+	    g_strcmp0 (filename, STREAM_SYS_REFERENCE_NAME) == 0)
+		return (struct mspack_file *) &ssys->reference_file;
+
+	if (mode == MSPACK_SYS_OPEN_WRITE && g_strcmp0 (filename, STREAM_SYS_OUTPUT_NAME) == 0)
+		return (struct mspack_file *) &ssys->output_file;
+
+	return NULL;
+}
+
+static void
+stream_sys_close (struct mspack_file *file)
+{
+}
+
+static gint
+stream_sys_read (struct mspack_file *file,
+		 gpointer buffer,
+		 gint bytes)
+{
+	StreamSys *ssys = ((StreamSysFile *) file)->ssys;
+	GInputStream *input = ((StreamSysFile *) file)->input;
+	gsize bytes_read = 0;
+
+	if (!input || ssys->error)
+		return -1;
+
+	if (!g_input_stream_read_all (input, buffer, bytes, &bytes_read, ssys->cancellable, &ssys->error))
+		return -1;
+
+	return (gint) bytes_read;
+}
+
+static gint
+stream_sys_write (struct mspack_file *file,
+		  gpointer buffer,
+		  gint bytes)
+{
+	StreamSys *ssys = ((StreamSysFile *) file)->ssys;
+
+	if (((StreamSysFile *) file)->input || ssys->error)
+		return -1;
+
+	if (!ssys->func (buffer, bytes, ssys->func_user_data, ssys->cancellable, &ssys->error)) {
+		if (!ssys->error)
+			g_set_error_literal (&ssys->error, g_quark_from_string ("lzx"), 1, "Failed to process decompressed data");
+		return -1;
+	}
+
+	return bytes;
+}
+
+static gint
+stream_sys_seek (struct mspack_file *file,
+		 off_t offset,
+		 gint mode)
+{
+	/* Streams are not seekable */
+	return -1;
+}
+
+static off_t
+stream_sys_tell (struct mspack_file *file)
+{
+	return -1;
+}
+
+static void
+stream_sys_message (struct mspack_file *file,
+		    const gchar *format,
+		    ...)
+{
+	va_list args;
+	gchar *msg;
+
+	va_start (args, format);
+	msg = g_strdup_vprintf (format, args);
+	va_end (args);
+
+	g_debug ("%s: %s", G_STRFUNC, msg);
+
+	g_free (msg);
+}
+
+static gpointer
+stream_sys_alloc (struct mspack_system *self,
+		  size_t bytes)
+{
+	return g_try_malloc (bytes);
+}
+
+static void
+stream_sys_free (gpointer ptr)
+{
+	g_free (ptr);
+}
+
+static void
+stream_sys_copy (gpointer src,
+		 gpointer dest,
+		 size_t bytes)
+{
+	memcpy (dest, src, bytes);
+}
+
+static void
+stream_sys_init (StreamSys *ssys,
+		 GInputStream *input,
+		 GInputStream *reference,
+		 EwsOabDecompressFunc func,
+		 gpointer func_user_data,
+		 GCancellable *cancellable)
+{
+	memset (ssys, 0, sizeof (StreamSys));
+	ssys->sys.open = stream_sys_open;
+	ssys->sys.close = stream_sys_close;
+	ssys->sys.read = stream_sys_read;
+	ssys->sys.write = stream_sys_write;
+	ssys->sys.seek = stream_sys_seek;
+	ssys->sys.tell = stream_sys_tell;
+	ssys->sys.message = stream_sys_message;
+	ssys->sys.alloc = stream_sys_alloc;
+	ssys->sys.free = stream_sys_free;
+	ssys->sys.copy = stream_sys_copy;
+	ssys->input_file.ssys = ssys;
+	ssys->input_file.input = input;
+	ssys->reference_file.ssys = ssys;
+	ssys->reference_file.input = reference;
+	ssys->output_file.ssys = ssys;
+	ssys->output_file.input = NULL;
+	ssys->func = func;
+	ssys->func_user_data = func_user_data;
+	ssys->cancellable = cancellable;
+}
+
+static gboolean
+stream_sys_decompress (GInputStream *input,
+		       GInputStream *reference,
+		       EwsOabDecompressFunc func,
+		       gpointer func_user_data,
+		       GCancellable *cancellable,
+		       GError **error)
+{
+	struct msoab_decompressor *msoab;
+	StreamSys ssys;
+	int ret;
+
+	stream_sys_init (&ssys, input, reference, func, func_user_data, cancellable);
+
+	msoab = mspack_create_oab_decompressor (&ssys.sys);
+	if (!msoab) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1,
+				     "Unable to create msoab decompressor");
+		return FALSE;
+	}
+
+	if (reference)
+		ret = msoab->decompress_incremental (msoab, STREAM_SYS_INPUT_NAME,
+						     STREAM_SYS_REFERENCE_NAME, STREAM_SYS_OUTPUT_NAME);
+	else
+		ret = msoab->decompress (msoab, STREAM_SYS_INPUT_NAME, STREAM_SYS_OUTPUT_NAME);
+
+	mspack_destroy_oab_decompressor (msoab);
+
+	if (ssys.error) {
+		g_propagate_error (error, ssys.error);
+		return FALSE;
+	}
+
+	if (ret != MSPACK_ERR_OK) {
+		if (reference)
+			g_set_error (error, g_quark_from_string ("lzx"), 1,
+				     "Failed to apply LZX patch stream: %d", ret);
+		else
+			g_set_error (error, g_quark_from_string ("lzx"), 1,
+				     "Failed to decompress LZX stream: %d", ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+gboolean
+ews_oab_decompress_full_stream (GInputStream *input,
+				EwsOabDecompressFunc func,
+				gpointer func_user_data,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_return_val_if_fail (G_IS_INPUT_STREAM (input), FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+
+	return stream_sys_decompress (input, NULL, func, func_user_data, cancellable, error);
+}
+
+gboolean
+ews_oab_decompress_patch_stream (GInputStream *patch_input,
+				 GInputStream *reference,
+				 EwsOabDecompressFunc func,
+				 gpointer func_user_data,
+				 GCancellable *cancellable,
+				 GError **error)
+{
+	g_return_val_if_fail (G_IS_INPUT_STREAM (patch_input), FALSE);
+	g_return_val_if_fail (G_IS_INPUT_STREAM (reference), FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+
+	return stream_sys_decompress (patch_input, reference, func, func_user_data, cancellable, error);
+}
+
+/* libmspack does not provide access to the individual blocks,
+   thus the decompression is always sequential */
+gboolean
+ews_oab_decompress_full_threaded (const gchar *filename,
+				  const gchar *output_filename,
+				  guint n_threads,
+				  GError **error)
+{
+	return ews_oab_decompress_full (filename, output_filename, error);
+}
+
 gboolean
 ews_oab_decompress_patch (const gchar *filename, const gchar *orig_filename,
 			  const gchar *output_filename, GError **error)
@@ -23,14 +23,36 @@
 #ifndef __EWS_OAB_DECOMPRESS_H__
 #define __EWS_OAB_DECOMPRESS_H__
 
-#include <glib.h>
+#include <gio/gio.h>
+
+/* Receives the decompressed data, in the order it appears in the output */
+typedef gboolean (* EwsOabDecompressFunc) (gconstpointer data,
+					   gsize data_len,
+					   gpointer user_data,
+					   GCancellable *cancellable,
+					   GError **error);
 
 gboolean ews_oab_decompress_full (const gchar *filename,
 				  const gchar *output_filename,
 				  GError **error);
+gboolean ews_oab_decompress_full_threaded (const gchar *filename,
+					   const gchar *output_filename,
+					   guint n_threads,
+					   GError **error);
 gboolean ews_oab_decompress_patch (const gchar *filename,
 				   const gchar *orig_filename,
 				   const gchar *output_filename,
 				   GError **error);
+gboolean ews_oab_decompress_full_stream (GInputStream *input,
+					 EwsOabDecompressFunc func,
+					 gpointer func_user_data,
+					 GCancellable *cancellable,
+					 GError **error);
+gboolean ews_oab_decompress_patch_stream (GInputStream *patch_input,
+					  GInputStream *reference,
+					  EwsOabDecompressFunc func,
+					  gpointer func_user_data,
+					  GCancellable *cancellable,
+					  GError **error);
 
 #endif
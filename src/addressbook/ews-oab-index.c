@@ -0,0 +1,484 @@
+/*-*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/* ews-oab-index.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "evolution-ews-config.h"
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "ews-oab-index.h"
+
+/* The index file is a local cache, thus it uses the host byte order:
+
+   IndexHeader
+   IndexEntry[n_entries], sorted by the UID
+   guint32[n_entries], entry indexes sorted by the folded display name
+   guint32[n_entries], entry indexes sorted by the folded email address
+   string pool of pool_size bytes, NUL-terminated strings
+*/
+
+#define EWS_OAB_INDEX_MAGIC "EWSOABX2"
+
+typedef struct _IndexHeader {
+	gchar magic[8];
+	guint32 n_entries;
+	guint32 pool_size;
+	guint32 oab_props; /* offset in the string pool */
+	guint32 reserved;
+} IndexHeader;
+
+typedef struct _IndexEntry {
+	guint64 offset; /* of the record in the OAB file */
+	guint32 uid; /* the following are offsets in the string pool */
+	guint32 name;
+	guint32 email;
+	guint32 reserved;
+} IndexEntry;
+
+typedef struct _BuilderEntry {
+	guint64 offset;
+	gchar *uid;
+	gchar *name;
+	gchar *email;
+} BuilderEntry;
+
+struct _EwsOabIndexBuilder {
+	GArray *entries; /* BuilderEntry */
+};
+
+struct _EwsOabIndex {
+	GMappedFile *mapped_file;
+	guint32 n_entries;
+	const IndexEntry *entries;
+	const guint32 *by_name;
+	const guint32 *by_email;
+	const gchar *pool;
+	guint32 pool_size;
+	const gchar *oab_props;
+};
+
+static gchar *
+ews_oab_index_fold (const gchar *str)
+{
+	gchar *normalized, *folded;
+
+	if (!str || !*str)
+		return g_strdup ("");
+
+	normalized = g_utf8_normalize (str, -1, G_NORMALIZE_DEFAULT);
+	if (!normalized)
+		return g_strdup ("");
+
+	folded = g_utf8_casefold (normalized, -1);
+	g_free (normalized);
+
+	return folded;
+}
+
+static void
+builder_entry_clear (gpointer ptr)
+{
+	BuilderEntry *entry = ptr;
+
+	g_free (entry->uid);
+	g_free (entry->name);
+	g_free (entry->email);
+}
+
+EwsOabIndexBuilder *
+ews_oab_index_builder_new (void)
+{
+	EwsOabIndexBuilder *builder;
+
+	builder = g_new0 (EwsOabIndexBuilder, 1);
+	builder->entries = g_array_new (FALSE, FALSE, sizeof (BuilderEntry));
+	g_array_set_clear_func (builder->entries, builder_entry_clear);
+
+	return builder;
+}
+
+void
+ews_oab_index_builder_free (EwsOabIndexBuilder *builder)
+{
+	if (!builder)
+		return;
+
+	g_array_unref (builder->entries);
+	g_free (builder);
+}
+
+void
+ews_oab_index_builder_add (EwsOabIndexBuilder *builder,
+			   goffset offset,
+			   const gchar *uid,
+			   const gchar *display_name,
+			   const gchar *email)
+{
+	BuilderEntry entry;
+
+	g_return_if_fail (builder != NULL);
+	g_return_if_fail (uid != NULL);
+	g_return_if_fail (offset >= 0);
+
+	entry.offset = (guint64) offset;
+	entry.uid = g_strdup (uid);
+	entry.name = ews_oab_index_fold (display_name);
+	entry.email = ews_oab_index_fold (email);
+
+	g_array_append_val (builder->entries, entry);
+}
+
+guint
+ews_oab_index_builder_get_n_entries (EwsOabIndexBuilder *builder)
+{
+	g_return_val_if_fail (builder != NULL, 0);
+
+	return builder->entries->len;
+}
+
+static gint
+builder_compare_uid_cb (gconstpointer a,
+			gconstpointer b)
+{
+	return strcmp (((const BuilderEntry *) a)->uid, ((const BuilderEntry *) b)->uid);
+}
+
+static gint
+builder_compare_name_cb (gconstpointer a,
+			 gconstpointer b,
+			 gpointer user_data)
+{
+	const BuilderEntry *entries = user_data;
+
+	return strcmp (entries[*(const guint32 *) a].name, entries[*(const guint32 *) b].name);
+}
+
+static gint
+builder_compare_email_cb (gconstpointer a,
+			  gconstpointer b,
+			  gpointer user_data)
+{
+	const BuilderEntry *entries = user_data;
+
+	return strcmp (entries[*(const guint32 *) a].email, entries[*(const guint32 *) b].email);
+}
+
+static guint32
+builder_add_string (GByteArray *pool,
+		    const gchar *str)
+{
+	guint32 offset = pool->len;
+
+	g_byte_array_append (pool, (const guint8 *) str, strlen (str) + 1);
+
+	return offset;
+}
+
+gboolean
+ews_oab_index_builder_write (EwsOabIndexBuilder *builder,
+			     const gchar *filename,
+			     const gchar *oab_props,
+			     GError **error)
+{
+	IndexHeader header;
+	GByteArray *contents, *pool;
+	BuilderEntry *entries;
+	guint32 *by_name, *by_email;
+	guint32 ii, n_entries;
+	gboolean success;
+
+	g_return_val_if_fail (builder != NULL, FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	g_array_sort (builder->entries, builder_compare_uid_cb);
+
+	entries = (BuilderEntry *) builder->entries->data;
+	n_entries = builder->entries->len;
+
+	by_name = g_new (guint32, n_entries);
+	by_email = g_new (guint32, n_entries);
+
+	for (ii = 0; ii < n_entries; ii++) {
+		by_name[ii] = ii;
+		by_email[ii] = ii;
+	}
+
+	g_qsort_with_data (by_name, n_entries, sizeof (guint32), builder_compare_name_cb, entries);
+	g_qsort_with_data (by_email, n_entries, sizeof (guint32), builder_compare_email_cb, entries);
+
+	pool = g_byte_array_new ();
+
+	memset (&header, 0, sizeof (IndexHeader));
+	memcpy (header.magic, EWS_OAB_INDEX_MAGIC, sizeof (header.magic));
+	header.n_entries = n_entries;
+	header.oab_props = builder_add_string (pool, oab_props ? oab_props : "");
+
+	contents = g_byte_array_new ();
+	g_byte_array_set_size (contents, sizeof (IndexHeader) + n_entries * (sizeof (IndexEntry) + 2 * sizeof (guint32)));
+
+	for (ii = 0; ii < n_entries; ii++) {
+		IndexEntry *entry = ((IndexEntry *) (contents->data + sizeof (IndexHeader))) + ii;
+
+		entry->offset = entries[ii].offset;
+		entry->reserved = 0;
+		entry->uid = builder_add_string (pool, entries[ii].uid);
+		entry->name = builder_add_string (pool, entries[ii].name);
+		entry->email = builder_add_string (pool, entries[ii].email);
+	}
+
+	memcpy (contents->data + sizeof (IndexHeader) + n_entries * sizeof (IndexEntry), by_name, n_entries * sizeof (guint32));
+	memcpy (contents->data + sizeof (IndexHeader) + n_entries * (sizeof (IndexEntry) + sizeof (guint32)), by_email, n_entries * sizeof (guint32));
+
+	header.pool_size = pool->len;
+	memcpy (contents->data, &header, sizeof (IndexHeader));
+
+	g_byte_array_append (contents, pool->data, pool->len);
+
+	success = g_file_set_contents (filename, (const gchar *) contents->data, contents->len, error);
+
+	g_byte_array_unref (contents);
+	g_byte_array_unref (pool);
+	g_free (by_email);
+	g_free (by_name);
+
+	return success;
+}
+
+EwsOabIndex *
+ews_oab_index_new (const gchar *filename,
+		   GError **error)
+{
+	EwsOabIndex *index;
+	GMappedFile *mapped_file;
+	const gchar *contents;
+	IndexHeader header;
+	gsize length, expected;
+	guint32 ii;
+
+	g_return_val_if_fail (filename != NULL, NULL);
+
+	mapped_file = g_mapped_file_new (filename, FALSE, error);
+	if (!mapped_file)
+		return NULL;
+
+	contents = g_mapped_file_get_contents (mapped_file);
+	length = g_mapped_file_get_length (mapped_file);
+
+	if (length < sizeof (IndexHeader))
+		goto invalid;
+
+	memcpy (&header, contents, sizeof (IndexHeader));
+
+	if (memcmp (header.magic, EWS_OAB_INDEX_MAGIC, sizeof (header.magic)) != 0 ||
+	    header.n_entries > (G_MAXSIZE - sizeof (IndexHeader)) / (sizeof (IndexEntry) + 2 * sizeof (guint32)))
+		goto invalid;
+
+	expected = sizeof (IndexHeader) + header.n_entries * (sizeof (IndexEntry) + 2 * sizeof (guint32));
+	if (!header.pool_size || length != expected + header.pool_size ||
+	    contents[length - 1] != '\0' || header.oab_props >= header.pool_size)
+		goto invalid;
+
+	index = g_new0 (EwsOabIndex, 1);
+	index->mapped_file = mapped_file;
+	index->n_entries = header.n_entries;
+	index->entries = (const IndexEntry *) (contents + sizeof (IndexHeader));
+	index->by_name = (const guint32 *) (index->entries + header.n_entries);
+	index->by_email = index->by_name + header.n_entries;
+	index->pool = contents + expected;
+	index->pool_size = header.pool_size;
+	index->oab_props = index->pool + header.oab_props;
+
+	for (ii = 0; ii < index->n_entries; ii++) {
+		const IndexEntry *entry = &index->entries[ii];
+
+		if (entry->uid >= index->pool_size ||
+		    entry->name >= index->pool_size ||
+		    entry->email >= index->pool_size ||
+		    index->by_name[ii] >= index->n_entries ||
+		    index->by_email[ii] >= index->n_entries) {
+			g_free (index);
+			goto invalid;
+		}
+	}
+
+	return index;
+
+ invalid:
+	g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Invalid OAB index file '%s'", filename);
+	g_mapped_file_unref (mapped_file);
+
+	return NULL;
+}
+
+void
+ews_oab_index_free (EwsOabIndex *index)
+{
+	if (!index)
+		return;
+
+	g_mapped_file_unref (index->mapped_file);
+	g_free (index);
+}
+
+guint
+ews_oab_index_get_n_entries (EwsOabIndex *index)
+{
+	g_return_val_if_fail (index != NULL, 0);
+
+	return index->n_entries;
+}
+
+const gchar *
+ews_oab_index_get_oab_props (EwsOabIndex *index)
+{
+	g_return_val_if_fail (index != NULL, NULL);
+
+	return index->oab_props;
+}
+
+gboolean
+ews_oab_index_lookup_uid (EwsOabIndex *index,
+			  const gchar *uid,
+			  goffset *out_offset)
+{
+	guint32 low, high;
+
+	g_return_val_if_fail (index != NULL, FALSE);
+	g_return_val_if_fail (uid != NULL, FALSE);
+
+	low = 0;
+	high = index->n_entries;
+
+	while (low < high) {
+		guint32 middle = low + (high - low) / 2;
+		gint cmp;
+
+		cmp = strcmp (index->pool + index->entries[middle].uid, uid);
+		if (cmp == 0) {
+			if (out_offset)
+				*out_offset = index->entries[middle].offset;
+			return TRUE;
+		}
+
+		if (cmp < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return FALSE;
+}
+
+static const gchar *
+index_entry_name (EwsOabIndex *index,
+		  guint32 entry_index)
+{
+	return index->pool + index->entries[entry_index].name;
+}
+
+static const gchar *
+index_entry_email (EwsOabIndex *index,
+		   guint32 entry_index)
+{
+	return index->pool + index->entries[entry_index].email;
+}
+
+static void
+index_add_result (EwsOabIndex *index,
+		  GPtrArray *results,
+		  GHashTable *seen,
+		  guint32 entry_index)
+{
+	if (!g_hash_table_add (seen, GUINT_TO_POINTER (entry_index + 1)))
+		return;
+
+	g_ptr_array_add (results, (gpointer) (index->pool + index->entries[entry_index].uid));
+}
+
+/* Adds entries whose string, as returned by get_str, starts with the folded text */
+static void
+index_search_prefix (EwsOabIndex *index,
+		     const guint32 *sorted,
+		     const gchar * (* get_str) (EwsOabIndex *index, guint32 entry_index),
+		     const gchar *folded,
+		     GPtrArray *results,
+		     GHashTable *seen,
+		     guint max_results)
+{
+	guint32 low, high;
+
+	low = 0;
+	high = index->n_entries;
+
+	/* Find the first entry not less than the text */
+	while (low < high) {
+		guint32 middle = low + (high - low) / 2;
+
+		if (strcmp (get_str (index, sorted[middle]), folded) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	for (; low < index->n_entries && results->len < max_results; low++) {
+		if (!g_str_has_prefix (get_str (index, sorted[low]), folded))
+			break;
+
+		index_add_result (index, results, seen, sorted[low]);
+	}
+}
+
+/* Returns UIDs of the OAB records whose display name or email address
+   contains the text; the prefix matches are returned first. The strings
+   are owned by the index, free the returned array with g_ptr_array_unref(). */
+GPtrArray *
+ews_oab_index_search (EwsOabIndex *index,
+		      const gchar *text,
+		      guint max_results)
+{
+	GPtrArray *results;
+	GHashTable *seen;
+	gchar *folded;
+	guint32 ii;
+
+	g_return_val_if_fail (index != NULL, NULL);
+	g_return_val_if_fail (text != NULL, NULL);
+
+	results = g_ptr_array_new ();
+	folded = ews_oab_index_fold (text);
+
+	if (!*folded || !max_results) {
+		g_free (folded);
+		return results;
+	}
+
+	seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	index_search_prefix (index, index->by_name, index_entry_name, folded, results, seen, max_results);
+	index_search_prefix (index, index->by_email, index_entry_email, folded, results, seen, max_results);
+
+	for (ii = 0; ii < index->n_entries && results->len < max_results; ii++) {
+		if (strstr (index_entry_name (index, ii), folded) ||
+		    strstr (index_entry_email (index, ii), folded))
+			index_add_result (index, results, seen, ii);
+	}
+
+	g_hash_table_destroy (seen);
+	g_free (folded);
+
+	return results;
+}
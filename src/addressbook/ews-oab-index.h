@@ -0,0 +1,62 @@
+/*-*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/* ews-oab-index.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EWS_OAB_INDEX_H
+#define EWS_OAB_INDEX_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* A compact on-disk index of the OAB records, which allows to find records
+   by UID, display name or email address without decoding the whole OAB file.
+   The index file is memory-mapped, the matching records can be decoded with
+   ews_oab_decoder_get_contact_from_offset(). */
+
+typedef struct _EwsOabIndex EwsOabIndex;
+typedef struct _EwsOabIndexBuilder EwsOabIndexBuilder;
+
+EwsOabIndexBuilder *
+		ews_oab_index_builder_new	(void);
+void		ews_oab_index_builder_free	(EwsOabIndexBuilder *builder);
+void		ews_oab_index_builder_add	(EwsOabIndexBuilder *builder,
+						 goffset offset,
+						 const gchar *uid,
+						 const gchar *display_name,
+						 const gchar *email);
+guint		ews_oab_index_builder_get_n_entries
+						(EwsOabIndexBuilder *builder);
+gboolean	ews_oab_index_builder_write	(EwsOabIndexBuilder *builder,
+						 const gchar *filename,
+						 const gchar *oab_props,
+						 GError **error);
+
+EwsOabIndex *	ews_oab_index_new		(const gchar *filename,
+						 GError **error);
+void		ews_oab_index_free		(EwsOabIndex *index);
+guint		ews_oab_index_get_n_entries	(EwsOabIndex *index);
+const gchar *	ews_oab_index_get_oab_props	(EwsOabIndex *index);
+gboolean	ews_oab_index_lookup_uid	(EwsOabIndex *index,
+						 const gchar *uid,
+						 goffset *out_offset);
+GPtrArray *	ews_oab_index_search		(EwsOabIndex *index,
+						 const gchar *text,
+						 guint max_results);
+
+G_END_DECLS
+
+#endif /* EWS_OAB_INDEX_H */
@@ -0,0 +1,260 @@
+/*-*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/* ews-oab-pipe-stream.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "evolution-ews-config.h"
+
+#include <string.h>
+
+#include "ews-oab-pipe-stream.h"
+
+struct _EwsOabPipeStreamPrivate {
+	GMutex lock;
+	GCond cond;
+
+	GQueue chunks; /* GBytes * */
+	gsize chunk_offset; /* already read bytes of the head chunk */
+	gsize buffered;
+	gsize max_buffered;
+
+	gboolean write_closed;
+	gboolean read_closed;
+	GError *write_error;
+};
+
+G_DEFINE_TYPE (EwsOabPipeStream, ews_oab_pipe_stream, G_TYPE_INPUT_STREAM)
+
+static void
+ews_oab_pipe_stream_cancelled_cb (GCancellable *cancellable,
+				  EwsOabPipeStream *pipe_stream)
+{
+	g_mutex_lock (&pipe_stream->priv->lock);
+	g_cond_broadcast (&pipe_stream->priv->cond);
+	g_mutex_unlock (&pipe_stream->priv->lock);
+}
+
+static gssize
+ews_oab_pipe_stream_read_fn (GInputStream *stream,
+			     gpointer buffer,
+			     gsize count,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	EwsOabPipeStream *pipe_stream = EWS_OAB_PIPE_STREAM (stream);
+	EwsOabPipeStreamPrivate *priv = pipe_stream->priv;
+	gulong cancel_id = 0;
+	gssize nread = 0;
+
+	if (cancellable)
+		cancel_id = g_cancellable_connect (cancellable, G_CALLBACK (ews_oab_pipe_stream_cancelled_cb), pipe_stream, NULL);
+
+	g_mutex_lock (&priv->lock);
+
+	/* Fill the whole buffer, unless the writer side is done; the OAB
+	   decoder prefers full reads over partial ones. */
+	while ((gsize) nread < count) {
+		GBytes *bytes;
+		gconstpointer data;
+		gsize data_len, to_copy;
+
+		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+			nread = -1;
+			break;
+		}
+
+		bytes = g_queue_peek_head (&priv->chunks);
+		if (!bytes) {
+			if (priv->write_error) {
+				g_propagate_error (error, g_error_copy (priv->write_error));
+				nread = -1;
+				break;
+			}
+
+			if (priv->write_closed)
+				break;
+
+			g_cond_wait (&priv->cond, &priv->lock);
+			continue;
+		}
+
+		data = g_bytes_get_data (bytes, &data_len);
+		to_copy = MIN (data_len - priv->chunk_offset, count - nread);
+
+		memcpy (((gchar *) buffer) + nread, ((const gchar *) data) + priv->chunk_offset, to_copy);
+
+		nread += to_copy;
+		priv->chunk_offset += to_copy;
+		priv->buffered -= to_copy;
+
+		if (priv->chunk_offset == data_len) {
+			g_bytes_unref (g_queue_pop_head (&priv->chunks));
+			priv->chunk_offset = 0;
+		}
+
+		g_cond_broadcast (&priv->cond);
+	}
+
+	g_mutex_unlock (&priv->lock);
+
+	if (cancel_id)
+		g_cancellable_disconnect (cancellable, cancel_id);
+
+	return nread;
+}
+
+static gboolean
+ews_oab_pipe_stream_close_fn (GInputStream *stream,
+			      GCancellable *cancellable,
+			      GError **error)
+{
+	EwsOabPipeStream *pipe_stream = EWS_OAB_PIPE_STREAM (stream);
+
+	g_mutex_lock (&pipe_stream->priv->lock);
+
+	pipe_stream->priv->read_closed = TRUE;
+	g_queue_free_full (&pipe_stream->priv->chunks, (GDestroyNotify) g_bytes_unref);
+	g_queue_init (&pipe_stream->priv->chunks);
+	pipe_stream->priv->chunk_offset = 0;
+	pipe_stream->priv->buffered = 0;
+
+	/* Wake up the writer, if it waits for the free space */
+	g_cond_broadcast (&pipe_stream->priv->cond);
+
+	g_mutex_unlock (&pipe_stream->priv->lock);
+
+	return TRUE;
+}
+
+static void
+ews_oab_pipe_stream_finalize (GObject *object)
+{
+	EwsOabPipeStream *pipe_stream = EWS_OAB_PIPE_STREAM (object);
+
+	g_queue_free_full (&pipe_stream->priv->chunks, (GDestroyNotify) g_bytes_unref);
+	g_clear_error (&pipe_stream->priv->write_error);
+	g_mutex_clear (&pipe_stream->priv->lock);
+	g_cond_clear (&pipe_stream->priv->cond);
+
+	/* Chain up to parent's method. */
+	G_OBJECT_CLASS (ews_oab_pipe_stream_parent_class)->finalize (object);
+}
+
+static void
+ews_oab_pipe_stream_class_init (EwsOabPipeStreamClass *klass)
+{
+	GObjectClass *object_class;
+	GInputStreamClass *input_stream_class;
+
+	g_type_class_add_private (klass, sizeof (EwsOabPipeStreamPrivate));
+
+	object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = ews_oab_pipe_stream_finalize;
+
+	input_stream_class = G_INPUT_STREAM_CLASS (klass);
+	input_stream_class->read_fn = ews_oab_pipe_stream_read_fn;
+	input_stream_class->close_fn = ews_oab_pipe_stream_close_fn;
+}
+
+static void
+ews_oab_pipe_stream_init (EwsOabPipeStream *pipe_stream)
+{
+	pipe_stream->priv = G_TYPE_INSTANCE_GET_PRIVATE (pipe_stream, EWS_TYPE_OAB_PIPE_STREAM, EwsOabPipeStreamPrivate);
+
+	g_mutex_init (&pipe_stream->priv->lock);
+	g_cond_init (&pipe_stream->priv->cond);
+	g_queue_init (&pipe_stream->priv->chunks);
+}
+
+GInputStream *
+ews_oab_pipe_stream_new (gsize max_buffered)
+{
+	EwsOabPipeStream *pipe_stream;
+
+	pipe_stream = g_object_new (EWS_TYPE_OAB_PIPE_STREAM, NULL);
+	pipe_stream->priv->max_buffered = max_buffered;
+
+	return G_INPUT_STREAM (pipe_stream);
+}
+
+/* Queues a copy of the data for the reader. Blocks while the reader is
+   behind by more than the max_buffered bytes. Fails when the reader closed
+   its side of the pipe or when the cancellable is cancelled. */
+gboolean
+ews_oab_pipe_stream_write (EwsOabPipeStream *pipe_stream,
+			   gconstpointer data,
+			   gsize data_len,
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	EwsOabPipeStreamPrivate *priv;
+	gulong cancel_id = 0;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (EWS_IS_OAB_PIPE_STREAM (pipe_stream), FALSE);
+
+	if (!data_len)
+		return TRUE;
+
+	priv = pipe_stream->priv;
+
+	if (cancellable)
+		cancel_id = g_cancellable_connect (cancellable, G_CALLBACK (ews_oab_pipe_stream_cancelled_cb), pipe_stream, NULL);
+
+	g_mutex_lock (&priv->lock);
+
+	while (!priv->read_closed && priv->max_buffered > 0 && priv->buffered >= priv->max_buffered &&
+	       !g_cancellable_is_cancelled (cancellable)) {
+		g_cond_wait (&priv->cond, &priv->lock);
+	}
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+		success = FALSE;
+	} else if (priv->read_closed || priv->write_closed) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CLOSED, "Pipe stream is closed");
+		success = FALSE;
+	} else {
+		g_queue_push_tail (&priv->chunks, g_bytes_new (data, data_len));
+		priv->buffered += data_len;
+
+		g_cond_broadcast (&priv->cond);
+	}
+
+	g_mutex_unlock (&priv->lock);
+
+	if (cancel_id)
+		g_cancellable_disconnect (cancellable, cancel_id);
+
+	return success;
+}
+
+/* Marks the end of the data. When the error is set, the reader receives it
+   once it consumes all the data written before. */
+void
+ews_oab_pipe_stream_close_write (EwsOabPipeStream *pipe_stream,
+				 const GError *error)
+{
+	g_return_if_fail (EWS_IS_OAB_PIPE_STREAM (pipe_stream));
+
+	g_mutex_lock (&pipe_stream->priv->lock);
+
+	pipe_stream->priv->write_closed = TRUE;
+	if (error && !pipe_stream->priv->write_error)
+		pipe_stream->priv->write_error = g_error_copy (error);
+
+	g_cond_broadcast (&pipe_stream->priv->cond);
+
+	g_mutex_unlock (&pipe_stream->priv->lock);
+}
@@ -0,0 +1,72 @@
+/*-*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/* ews-oab-pipe-stream.h
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EWS_OAB_PIPE_STREAM_H
+#define EWS_OAB_PIPE_STREAM_H
+
+#include <gio/gio.h>
+
+/* Standard GObject macros */
+#define EWS_TYPE_OAB_PIPE_STREAM \
+	(ews_oab_pipe_stream_get_type ())
+#define EWS_OAB_PIPE_STREAM(obj) \
+	(G_TYPE_CHECK_INSTANCE_CAST \
+	((obj), EWS_TYPE_OAB_PIPE_STREAM, EwsOabPipeStream))
+#define EWS_OAB_PIPE_STREAM_CLASS(cls) \
+	(G_TYPE_CHECK_CLASS_CAST \
+	((cls), EWS_TYPE_OAB_PIPE_STREAM, EwsOabPipeStreamClass))
+#define EWS_IS_OAB_PIPE_STREAM(obj) \
+	(G_TYPE_CHECK_INSTANCE_TYPE \
+	((obj), EWS_TYPE_OAB_PIPE_STREAM))
+#define EWS_IS_OAB_PIPE_STREAM_CLASS(cls) \
+	(G_TYPE_CHECK_CLASS_TYPE \
+	((cls), EWS_TYPE_OAB_PIPE_STREAM))
+#define EWS_OAB_PIPE_STREAM_GET_CLASS(obj) \
+	(G_TYPE_INSTANCE_GET_CLASS \
+	((obj), EWS_TYPE_OAB_PIPE_STREAM, EwsOabPipeStreamClass))
+
+G_BEGIN_DECLS
+
+typedef struct _EwsOabPipeStream EwsOabPipeStream;
+typedef struct _EwsOabPipeStreamClass EwsOabPipeStreamClass;
+typedef struct _EwsOabPipeStreamPrivate EwsOabPipeStreamPrivate;
+
+/* An in-memory pipe: one thread writes data with ews_oab_pipe_stream_write(),
+   another thread reads it through the GInputStream API. The writer blocks
+   when more than max_buffered bytes wait for the reader. */
+struct _EwsOabPipeStream {
+	GInputStream parent;
+	EwsOabPipeStreamPrivate *priv;
+};
+
+struct _EwsOabPipeStreamClass {
+	GInputStreamClass parent_class;
+};
+
+GType		ews_oab_pipe_stream_get_type	(void);
+GInputStream *	ews_oab_pipe_stream_new		(gsize max_buffered);
+gboolean	ews_oab_pipe_stream_write	(EwsOabPipeStream *pipe_stream,
+						 gconstpointer data,
+						 gsize data_len,
+						 GCancellable *cancellable,
+						 GError **error);
+void		ews_oab_pipe_stream_close_write	(EwsOabPipeStream *pipe_stream,
+						 const GError *error);
+
+G_END_DECLS
+
+#endif /* EWS_OAB_PIPE_STREAM_H */
@@ -1,14 +1,97 @@
-
 #include "ews-oab-decompress.h"
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+static gboolean
+benchmark_decompress (const gchar *filename,
+		      const gchar *output_filename,
+		      guint n_threads,
+		      gdouble *out_elapsed,
+		      GError **error)
+{
+	GTimer *timer;
+	gboolean success;
+
+	timer = g_timer_new ();
+	success = ews_oab_decompress_full_threaded (filename, output_filename, n_threads, error);
+	g_timer_stop (timer);
+
+	*out_elapsed = g_timer_elapsed (timer, NULL);
+
+	g_timer_destroy (timer);
+
+	return success;
+}
+
+/* Decompresses the file sequentially and then with all the processors,
+   reports the times and verifies both outputs match */
+static gint
+run_benchmark (const gchar *filename,
+	       const gchar *output_filename)
+{
+	GMappedFile *seq_mapped, *par_mapped;
+	GStatBuf st;
+	gchar *seq_filename;
+	gdouble seq_elapsed = 0.0, par_elapsed = 0.0, size_mb;
+	gint res = 0;
+	GError *error = NULL;
+
+	seq_filename = g_strconcat (output_filename, ".seq", NULL);
+
+	if (!benchmark_decompress (filename, seq_filename, 1, &seq_elapsed, &error)) {
+		g_print ("sequential decompression failed: %s\n", error->message);
+		g_clear_error (&error);
+		g_free (seq_filename);
+		return 1;
+	}
+
+	if (!benchmark_decompress (filename, output_filename, 0, &par_elapsed, &error)) {
+		g_print ("parallel decompression failed: %s\n", error->message);
+		g_clear_error (&error);
+		g_unlink (seq_filename);
+		g_free (seq_filename);
+		return 1;
+	}
+
+	size_mb = g_stat (output_filename, &st) == 0 ? st.st_size / (1024.0 * 1024.0) : 0.0;
+
+	g_print ("Decompressed %.1f MB\n", size_mb);
+	g_print ("  sequential:        %.3f s (%.1f MB/s)\n", seq_elapsed, seq_elapsed > 0 ? size_mb / seq_elapsed : 0.0);
+	g_print ("  parallel (%2u cpu): %.3f s (%.1f MB/s)\n", g_get_num_processors (), par_elapsed, par_elapsed > 0 ? size_mb / par_elapsed : 0.0);
+
+	seq_mapped = g_mapped_file_new (seq_filename, FALSE, NULL);
+	par_mapped = g_mapped_file_new (output_filename, FALSE, NULL);
+
+	if (!seq_mapped || !par_mapped ||
+	    g_mapped_file_get_length (seq_mapped) != g_mapped_file_get_length (par_mapped) ||
+	    memcmp (g_mapped_file_get_contents (seq_mapped), g_mapped_file_get_contents (par_mapped), g_mapped_file_get_length (seq_mapped)) != 0) {
+		g_print ("Outputs of the sequential and the parallel decompression differ!\n");
+		res = 1;
+	}
+
+	if (seq_mapped)
+		g_mapped_file_unref (seq_mapped);
+	if (par_mapped)
+		g_mapped_file_unref (par_mapped);
+
+	g_unlink (seq_filename);
+	g_free (seq_filename);
+
+	return res;
+}
 
 gint
 main (gint argc, gchar *argv[])
 {
 	GError *error = NULL;
 
+	if (argc == 4 && g_strcmp0 (argv[1], "--benchmark") == 0)
+		return run_benchmark (argv[2], argv[3]);
+
 	if (argc != 3 && argc != 4) {
 		g_print ("Pass an lzx file and an output filename as argument \n");
+		g_print ("or '--benchmark', an lzx file and an output filename to measure the decompression\n");
 		return -1;
 	}
 
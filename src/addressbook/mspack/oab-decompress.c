@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include <unistd.h>
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -42,6 +43,9 @@
 #define EndGetI32(a) __egi32(a,0)
 #define EndGetI16(a) ((((a)[1])<<8)|((a)[0]))
 
+/* The LZX window cannot be larger than 2^25 bytes, thus no block can be larger */
+#define LZX_MAX_BLOCK_SIZE (1 << 25)
+
 typedef struct {
 	guint32 h_version;
 	guint32 l_version;
@@ -69,193 +73,483 @@ read_uint32 (FILE *input,
 		return FALSE;
 }
 
-static LzxHeader *
-read_headers (FILE *input,
-              GError **error)
+static gboolean
+stream_read_uint32 (GInputStream *input,
+		    guint32 *val,
+		    GCancellable *cancellable,
+		    GError **error)
 {
-	LzxHeader *lzx_h;
-	gboolean success;
+	gchar buf[4];
+	gsize bytes_read = 0;
 
-	lzx_h = g_new0 (LzxHeader, 1);
+	if (!g_input_stream_read_all (input, buf, 4, &bytes_read, cancellable, error))
+		return FALSE;
 
-	success = read_uint32 (input, &lzx_h->h_version);
-	if (!success)
-		goto exit;
-	success = read_uint32 (input, &lzx_h->l_version);
-	if (!success)
-		goto exit;
+	if (bytes_read != 4) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "unexpected end of the input stream");
+		return FALSE;
+	}
 
-	if (lzx_h->h_version !=  0x00000003 || lzx_h->l_version != 0x00000001) {
-		g_free (lzx_h);
-		/* set the right domain later */
-		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "wrong version header");
-		return NULL;
+	*val = EndGetI32 (buf);
+
+	return TRUE;
+}
+
+/* Decompresses one LZX block, which is completely held in memory.
+   The out buffer should be large enough for lzx_b->ucomp_size bytes.
+   It does not use any shared state, thus it can run in parallel. */
+static gboolean
+decompress_block (const LzxBlockHeader *lzx_b,
+		  gconstpointer comp_data,
+		  gpointer out,
+		  GError **error)
+{
+	struct lzxd_stream *lzs;
+	FILE *input, *output;
+	guint window_bits;
+	gboolean success = TRUE;
+
+	/* lzx_b points to 1, copy it directly */
+	if (lzx_b->flags == 0) {
+		if (lzx_b->comp_size < lzx_b->ucomp_size) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "uncompressed block is too short");
+			return FALSE;
+		}
+
+		memcpy (out, comp_data, lzx_b->ucomp_size);
+	} else {
+		input = fmemopen ((gpointer) comp_data, lzx_b->comp_size, "rb");
+		output = fmemopen (out, lzx_b->ucomp_size, "wb");
+
+		if (!input || !output) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (fmemopen)");
+
+			if (input)
+				fclose (input);
+			if (output)
+				fclose (output);
+
+			return FALSE;
+		}
+
+		/* The window size should be the smallest power of two between 2^17 and 2^25 that is
+		   greater than or equal to the sum of the size of the reference data rounded up to
+		   a multiple of 32768 and the size of the subject data. Since we have no reference
+		   data, forget that and the rounding. Just the smallest power of two which is large
+		   enough to cover the subject data (lzx_b->ucomp_size). */
+		window_bits = g_bit_nth_msf (lzx_b->ucomp_size - 1, -1) + 1;
+
+		if (window_bits < 17)
+			window_bits = 17;
+		else if (window_bits > 25)
+			window_bits = 25;
+
+		lzs = ews_lzxd_init (input, output, window_bits,
+				     0, 4096, lzx_b->ucomp_size, 1);
+		if (!lzs) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_init)");
+			success = FALSE;
+		} else if (ews_lzxd_decompress (lzs, lzx_b->ucomp_size) != LZX_ERR_OK) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_decompress)");
+			success = FALSE;
+		}
+
+		ews_lzxd_free (lzs);
+		fclose (input);
+
+		/* This flushes the data into the out buffer */
+		if (fclose (output) != 0 && success) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (write)");
+			success = FALSE;
+		}
 	}
 
-	success = read_uint32 (input, &lzx_h->max_block_size);
-	if (!success)
-		goto exit;
-	success = read_uint32 (input, &lzx_h->target_size);
-	if (!success)
-		goto exit;
+	return success;
+}
 
-exit:
-	if (!success) {
-		/* set the right domain later */
-		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "Unable to read lzx main header");
+typedef struct _BlockJob {
+	LzxBlockHeader header;
+	const gchar *comp_data; /* points into the mapped input file or to the comp_buf */
+	gchar *comp_buf; /* owned, when the block was read from a stream */
+	gchar *out_data;
+	GError *error;
+	gboolean done;
+} BlockJob;
+
+typedef struct _ParallelData {
+	GMutex lock;
+	GCond cond;
+} ParallelData;
+
+static void
+block_job_free (gpointer ptr)
+{
+	BlockJob *job = ptr;
 
-		g_free (lzx_h);
-		lzx_h = NULL;
+	if (job) {
+		g_free (job->comp_buf);
+		g_free (job->out_data);
+		g_clear_error (&job->error);
+		g_free (job);
 	}
+}
 
-	return lzx_h;
+static void
+decompress_block_thread (gpointer data,
+			 gpointer user_data)
+{
+	BlockJob *job = data;
+	ParallelData *pd = user_data;
+	GError *local_error = NULL;
+
+	decompress_block (&job->header, job->comp_data, job->out_data, &local_error);
+
+	g_mutex_lock (&pd->lock);
+	job->error = local_error;
+	job->done = TRUE;
+	g_cond_broadcast (&pd->cond);
+	g_mutex_unlock (&pd->lock);
 }
 
-static LzxBlockHeader *
-read_block_header (FILE *input,
-                   GError **error)
+/* Reads the main header and the header of every block, without decompressing
+   anything. The OAB v4 blocks are compressed independently, thus once their
+   position is known, they can be decompressed in any order. */
+static GPtrArray *
+read_block_index (const gchar *contents,
+		  gsize length,
+		  GError **error)
 {
-	LzxBlockHeader *lzx_b;
-	gboolean success;
+	GPtrArray *jobs;
+	LzxHeader lzx_h;
+	guint32 total_decomp_size = 0;
+	gsize pos = 0;
 
-	lzx_b = g_new0 (LzxBlockHeader, 1);
+	if (length < 16) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "Unable to read lzx main header");
+		return NULL;
+	}
 
-	success = read_uint32 (input, &lzx_b->flags);
-	if (!success)
-		goto exit;
+	lzx_h.h_version = EndGetI32 (contents);
+	lzx_h.l_version = EndGetI32 (contents + 4);
+	lzx_h.max_block_size = EndGetI32 (contents + 8);
+	lzx_h.target_size = EndGetI32 (contents + 12);
+	pos = 16;
 
-	success = read_uint32 (input, &lzx_b->comp_size);
-	if (!success)
-		goto exit;
+	if (lzx_h.h_version != 0x00000003 || lzx_h.l_version != 0x00000001) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "wrong version header");
+		return NULL;
+	}
 
-	success = read_uint32 (input, &lzx_b->ucomp_size);
-	if (!success)
-		goto exit;
+	if (!lzx_h.max_block_size || lzx_h.max_block_size > LZX_MAX_BLOCK_SIZE) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx maximum block size");
+		return NULL;
+	}
 
-	success = read_uint32 (input, &lzx_b->crc);
+	jobs = g_ptr_array_new_with_free_func (block_job_free);
 
-exit:
-	if (!success) {
-		/* set the right domain later */
-		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "Unable to read lzx block header");
+	while (total_decomp_size < lzx_h.target_size) {
+		BlockJob *job;
 
-		g_free (lzx_b);
-		lzx_b = NULL;
+		if (length - pos < 16) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "Unable to read lzx block header");
+			g_ptr_array_unref (jobs);
+			return NULL;
+		}
+
+		job = g_new0 (BlockJob, 1);
+		job->header.flags = EndGetI32 (contents + pos);
+		job->header.comp_size = EndGetI32 (contents + pos + 4);
+		job->header.ucomp_size = EndGetI32 (contents + pos + 8);
+		job->header.crc = EndGetI32 (contents + pos + 12);
+		pos += 16;
+
+		g_ptr_array_add (jobs, job);
+
+		if (!job->header.ucomp_size || job->header.ucomp_size > lzx_h.max_block_size ||
+		    job->header.comp_size > lzx_h.max_block_size || length - pos < job->header.comp_size) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx block header");
+			g_ptr_array_unref (jobs);
+			return NULL;
+		}
+
+		job->comp_data = contents + pos;
+		pos += job->header.comp_size;
+
+		total_decomp_size += job->header.ucomp_size;
 	}
 
-	return	lzx_b;
+	return jobs;
 }
 
+/* Decompresses the full OAB file, using up to n_threads threads for
+   the block decompression; zero means to use all available processors.
+   The output is written in order by the calling thread. */
 gboolean
-ews_oab_decompress_full (const gchar *filename, const gchar *output_filename,
-			 GError **error)
+ews_oab_decompress_full_threaded (const gchar *filename,
+				  const gchar *output_filename,
+				  guint n_threads,
+				  GError **error)
 {
-	LzxHeader *lzx_h = NULL;
-	guint total_decomp_size = 0;
-	FILE *input, *output = NULL;
-	gboolean ret = TRUE;
+	GMappedFile *mapped;
+	GPtrArray *jobs;
+	GThreadPool *pool = NULL;
+	ParallelData pd;
+	FILE *output = NULL;
+	guint ii, next_push = 0, max_in_flight;
 	GError *err = NULL;
 
-	input = fopen (filename, "rb");
-	if (!input) {
-		g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "unable to open the input file");
-		ret = FALSE;
-		goto exit;
+	mapped = g_mapped_file_new (filename, FALSE, NULL);
+	if (!mapped) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "unable to open the input file");
+		return FALSE;
 	}
 
+	jobs = read_block_index (g_mapped_file_get_contents (mapped), g_mapped_file_get_length (mapped), &err);
+	if (!jobs)
+		goto exit;
+
 	output = fopen (output_filename, "wb");
 	if (!output) {
 		g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "unable to open the output file");
-		ret = FALSE;
 		goto exit;
 	}
 
-	lzx_h = read_headers (input, &err);
-	if (!lzx_h) {
-		ret = FALSE;
-		goto exit;
+	if (!n_threads)
+		n_threads = g_get_num_processors ();
+
+	/* Not worth the threads */
+	if (jobs->len < 2)
+		n_threads = 1;
+
+	g_mutex_init (&pd.lock);
+	g_cond_init (&pd.cond);
+
+	if (n_threads > 1) {
+		pool = g_thread_pool_new (decompress_block_thread, &pd, n_threads, FALSE, NULL);
+		if (!pool)
+			n_threads = 1;
 	}
 
-	/* TODO decompressing multiple lzx_blocks has not been tested yet. Will need to get a setup and test it. */
-	do {
-		LzxBlockHeader *lzx_b;
-		struct lzxd_stream *lzs;
-		goffset offset;
+	/* Limits how many decompressed blocks can wait in the memory */
+	max_in_flight = n_threads * 2;
 
-		lzx_b = read_block_header (input, &err);
-		if (err) {
-			ret = FALSE;
-			goto exit;
-		}
+	for (ii = 0; ii < jobs->len && !err; ii++) {
+		BlockJob *job;
 
-		/* note the file offset */
-		offset = ftell (input);
-
-		/* lzx_b points to 1, write it directly to file */
-		if (lzx_b->flags == 0) {
-			gchar *buffer = g_malloc0 (lzx_b->ucomp_size);
-
-			if (!(fread (buffer, 1, lzx_b->ucomp_size, input) == lzx_b->ucomp_size &&
-				fwrite (buffer, 1, lzx_b->ucomp_size, output) == lzx_b->ucomp_size)) {
-				g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "failed to write data in output file");
-				g_free (buffer);
-				ret = FALSE;
-				goto exit;
+		if (pool) {
+			while (next_push < jobs->len && next_push < ii + max_in_flight) {
+				job = g_ptr_array_index (jobs, next_push);
+				job->out_data = g_malloc (job->header.ucomp_size);
+
+				g_thread_pool_push (pool, job, NULL);
+				next_push++;
 			}
-			g_free (buffer);
+
+			job = g_ptr_array_index (jobs, ii);
+
+			g_mutex_lock (&pd.lock);
+			while (!job->done)
+				g_cond_wait (&pd.cond, &pd.lock);
+			g_mutex_unlock (&pd.lock);
 		} else {
-			/* The window size should be the smallest power of two between 2^17 and 2^25 that is
-			   greater than or equal to the sum of the size of the reference data rounded up to
-			   a multiple of 32768 and the size of the subject data. Since we have no reference
-			   data, forget that and the rounding. Just the smallest power of two which is large
-			   enough to cover the subject data (lzx_b->ucomp_size). */
-
-			guint window_bits = g_bit_nth_msf(lzx_b->ucomp_size - 1, -1) + 1;
-
-			if (window_bits < 17)
-				window_bits = 17;
-			else if (window_bits > 25)
-				window_bits = 25;
-
-			lzs = ews_lzxd_init (input, output, window_bits,
-					 0, 4096, lzx_b->ucomp_size, 1);
-			if (!lzs) {
-				g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_init)");
-				ret = FALSE;
-				goto exit;
-			}
-			if (ews_lzxd_decompress (lzs, lzx_b->ucomp_size) != LZX_ERR_OK) {
-				g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_decompress)");
-				ret = FALSE;
-				goto exit;
-			}
+			job = g_ptr_array_index (jobs, ii);
+			job->out_data = g_malloc (job->header.ucomp_size);
+
+			decompress_block (&job->header, job->comp_data, job->out_data, &job->error);
 		}
 
-		/* Set the fp to beggining of next block. This is a HACK, looks like decompress reads beyond the block.
-		 * Since we can identify the next block start from block header, we just reset the offset */
-		offset += lzx_b->comp_size;
-		fseek (input, offset, SEEK_SET);
+		if (job->error) {
+			err = job->error;
+			job->error = NULL;
+		} else if (fwrite (job->out_data, 1, job->header.ucomp_size, output) != job->header.ucomp_size) {
+			g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "failed to write data in output file");
+		}
 
-		total_decomp_size += lzx_b->ucomp_size;
-		g_free (lzx_b);
-	} while (total_decomp_size < lzx_h->target_size);
+		g_clear_pointer (&job->out_data, g_free);
+	}
 
-exit:
-	if (input)
-		fclose (input);
+	/* Drops the blocks not started yet, waits for the running */
+	if (pool)
+		g_thread_pool_free (pool, TRUE, TRUE);
 
-	if (output)
-		fclose (output);
+	g_mutex_clear (&pd.lock);
+	g_cond_clear (&pd.cond);
+
+ exit:
+	if (output && fclose (output) != 0 && !err)
+		g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "failed to write data in output file");
+
+	if (jobs)
+		g_ptr_array_unref (jobs);
+
+	g_mapped_file_unref (mapped);
 
 	if (err) {
-		ret = FALSE;
 		g_propagate_error (error, err);
 		g_unlink (output_filename);
+		return FALSE;
 	}
 
-	g_free (lzx_h);
+	return TRUE;
+}
 
-	return ret;
+gboolean
+ews_oab_decompress_full (const gchar *filename,
+			 const gchar *output_filename,
+			 GError **error)
+{
+	return ews_oab_decompress_full_threaded (filename, output_filename, 0, error);
+}
+
+/* Waits for the oldest block in the in_flight queue to be decompressed,
+   then passes it to the func and frees it */
+static gboolean
+finish_oldest_job (GQueue *in_flight,
+		   ParallelData *pd,
+		   EwsOabDecompressFunc func,
+		   gpointer func_user_data,
+		   GCancellable *cancellable,
+		   GError **error)
+{
+	BlockJob *job;
+	gboolean success;
+
+	job = g_queue_pop_head (in_flight);
+
+	g_mutex_lock (&pd->lock);
+	while (!job->done)
+		g_cond_wait (&pd->cond, &pd->lock);
+	g_mutex_unlock (&pd->lock);
+
+	if (job->error) {
+		g_propagate_error (error, job->error);
+		job->error = NULL;
+		success = FALSE;
+	} else {
+		success = func (job->out_data, job->header.ucomp_size, func_user_data, cancellable, error);
+	}
+
+	block_job_free (job);
+
+	return success;
+}
+
+/* The same as ews_oab_decompress_full(), only it reads the compressed data
+   sequentially from the input stream, which does not need to be seekable,
+   and passes each decompressed block to the func, in order. The blocks are
+   decompressed on a thread pool while the next blocks are being read. */
+gboolean
+ews_oab_decompress_full_stream (GInputStream *input,
+				EwsOabDecompressFunc func,
+				gpointer func_user_data,
+				GCancellable *cancellable,
+				GError **error)
+{
+	LzxHeader lzx_h;
+	GThreadPool *pool = NULL;
+	GQueue in_flight = G_QUEUE_INIT;
+	ParallelData pd;
+	guint32 total_decomp_size = 0;
+	guint n_threads, max_in_flight;
+	gboolean success;
+
+	g_return_val_if_fail (G_IS_INPUT_STREAM (input), FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+
+	success = stream_read_uint32 (input, &lzx_h.h_version, cancellable, error) &&
+		  stream_read_uint32 (input, &lzx_h.l_version, cancellable, error);
+
+	if (success && (lzx_h.h_version != 0x00000003 || lzx_h.l_version != 0x00000001)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "wrong version header");
+		success = FALSE;
+	}
+
+	success = success &&
+		  stream_read_uint32 (input, &lzx_h.max_block_size, cancellable, error) &&
+		  stream_read_uint32 (input, &lzx_h.target_size, cancellable, error);
+
+	if (success && (!lzx_h.max_block_size || lzx_h.max_block_size > LZX_MAX_BLOCK_SIZE)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx maximum block size");
+		success = FALSE;
+	}
+
+	if (!success)
+		return FALSE;
+
+	g_mutex_init (&pd.lock);
+	g_cond_init (&pd.cond);
+
+	n_threads = g_get_num_processors ();
+
+	if (n_threads > 1)
+		pool = g_thread_pool_new (decompress_block_thread, &pd, n_threads, FALSE, NULL);
+
+	/* Limits how many blocks can wait in the memory */
+	max_in_flight = pool ? n_threads * 2 : 1;
+
+	while (success && total_decomp_size < lzx_h.target_size) {
+		BlockJob *job;
+		gsize bytes_read = 0;
+
+		job = g_new0 (BlockJob, 1);
+
+		success = stream_read_uint32 (input, &job->header.flags, cancellable, error) &&
+			  stream_read_uint32 (input, &job->header.comp_size, cancellable, error) &&
+			  stream_read_uint32 (input, &job->header.ucomp_size, cancellable, error) &&
+			  stream_read_uint32 (input, &job->header.crc, cancellable, error);
+
+		if (success && (!job->header.ucomp_size || job->header.ucomp_size > lzx_h.max_block_size ||
+		    job->header.comp_size > lzx_h.max_block_size)) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx block size");
+			success = FALSE;
+		}
+
+		if (success) {
+			job->comp_buf = g_malloc (job->header.comp_size);
+			job->comp_data = job->comp_buf;
+
+			success = g_input_stream_read_all (input, job->comp_buf, job->header.comp_size, &bytes_read, cancellable, error);
+			if (success && bytes_read != job->header.comp_size) {
+				g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "unexpected end of the input stream");
+				success = FALSE;
+			}
+		}
+
+		if (!success) {
+			block_job_free (job);
+			break;
+		}
+
+		job->out_data = g_malloc (job->header.ucomp_size);
+		total_decomp_size += job->header.ucomp_size;
+
+		g_queue_push_tail (&in_flight, job);
+
+		if (pool) {
+			g_thread_pool_push (pool, job, NULL);
+		} else {
+			decompress_block (&job->header, job->comp_data, job->out_data, &job->error);
+			job->done = TRUE;
+		}
+
+		while (success && g_queue_get_length (&in_flight) >= max_in_flight)
+			success = finish_oldest_job (&in_flight, &pd, func, func_user_data, cancellable, error);
+	}
+
+	while (success && !g_queue_is_empty (&in_flight))
+		success = finish_oldest_job (&in_flight, &pd, func, func_user_data, cancellable, error);
+
+	/* Drops the blocks not started yet, waits for the running */
+	if (pool)
+		g_thread_pool_free (pool, TRUE, TRUE);
+
+	g_queue_foreach (&in_flight, (GFunc) block_job_free, NULL);
+	g_queue_clear (&in_flight);
+
+	g_mutex_clear (&pd.lock);
+	g_cond_clear (&pd.cond);
+
+	return success;
 }
 
 typedef struct {
@@ -438,15 +732,19 @@ ews_oab_decompress_patch (const gchar *filename, const gchar *orig_filename,
 		}
 		if (ews_lzxd_set_reference_data(lzs, orig_input, lzx_b->source_size)) {
 			g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_set_reference_data)");
+			ews_lzxd_free (lzs);
 			ret = FALSE;
 			goto exit;
 		}
 		if (ews_lzxd_decompress (lzs, lzs->length) != LZX_ERR_OK) {
 			g_set_error_literal (&err, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_decompress)");
+			ews_lzxd_free (lzs);
 			ret = FALSE;
 			goto exit;
 		}
 
+		ews_lzxd_free (lzs);
+
 		/* Set the fp to beggining of next block. This is a HACK, looks like decompress reads beyond the block.
 		 * Since we can identify the next block start from block header, we just reset the offset */
 		offset += lzx_b->patch_size;
@@ -477,3 +775,174 @@ exit:
 	return ret;
 }
 
+
+static gboolean
+stream_read_block (GInputStream *input,
+		   gpointer *buffer,
+		   gsize *buffer_len,
+		   gsize size,
+		   GCancellable *cancellable,
+		   GError **error)
+{
+	gsize bytes_read = 0;
+
+	if (*buffer_len < size || !*buffer) {
+		*buffer_len = MAX (size, 1);
+		*buffer = g_realloc (*buffer, *buffer_len);
+	}
+
+	if (!g_input_stream_read_all (input, *buffer, size, &bytes_read, cancellable, error))
+		return FALSE;
+
+	if (bytes_read != size) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "unexpected end of the input stream");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Applies one patch block; all the data are held in memory. */
+static gboolean
+patch_block (const LzxPatchBlockHeader *lzx_b,
+	     gpointer patch_data,
+	     gpointer ref_data,
+	     gpointer out,
+	     GError **error)
+{
+	struct lzxd_stream *lzs;
+	FILE *input, *reference = NULL, *output;
+	guint ref_size, window_bits;
+	gboolean success = TRUE;
+
+	input = fmemopen (patch_data, MAX (lzx_b->patch_size, 1), "rb");
+	if (lzx_b->source_size)
+		reference = fmemopen (ref_data, lzx_b->source_size, "rb");
+	output = fmemopen (out, lzx_b->target_size, "wb");
+
+	if (!input || !output || (lzx_b->source_size && !reference)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (fmemopen)");
+
+		if (input)
+			fclose (input);
+		if (reference)
+			fclose (reference);
+		if (output)
+			fclose (output);
+
+		return FALSE;
+	}
+
+	/* See ews_oab_decompress_patch() for the window size computation */
+	ref_size = (lzx_b->source_size + 32767) & ~32767;
+	window_bits = g_bit_nth_msf (ref_size + lzx_b->target_size - 1, -1) + 1;
+
+	if (window_bits < 17)
+		window_bits = 17;
+	else if (window_bits > 25)
+		window_bits = 25;
+
+	lzs = ews_lzxd_init (input, output, window_bits,
+			     0, 4096, lzx_b->target_size, 1);
+	if (!lzs) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_init)");
+		success = FALSE;
+	} else if (ews_lzxd_set_reference_data (lzs, reference, lzx_b->source_size)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_set_reference_data)");
+		success = FALSE;
+	} else if (ews_lzxd_decompress (lzs, lzs->length) != LZX_ERR_OK) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (lzxd_decompress)");
+		success = FALSE;
+	}
+
+	ews_lzxd_free (lzs);
+	fclose (input);
+	if (reference)
+		fclose (reference);
+
+	if (fclose (output) != 0 && success) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "decompression failed (write)");
+		success = FALSE;
+	}
+
+	return success;
+}
+
+/* The same as ews_oab_decompress_patch(), only it reads the patch and
+   the reference (previous OAB) data sequentially from the streams and
+   passes each patched block to the func. The reference can be the output
+   of another patch, thus a chain of patches can be applied in one pass. */
+gboolean
+ews_oab_decompress_patch_stream (GInputStream *patch_input,
+				 GInputStream *reference,
+				 EwsOabDecompressFunc func,
+				 gpointer func_user_data,
+				 GCancellable *cancellable,
+				 GError **error)
+{
+	LzxPatchHeader lzx_h;
+	guint32 total_decomp_size = 0;
+	gpointer patch_buf = NULL, ref_buf = NULL, out_buf = NULL;
+	gsize patch_buf_len = 0, ref_buf_len = 0, out_buf_len = 0;
+	gboolean success;
+
+	g_return_val_if_fail (G_IS_INPUT_STREAM (patch_input), FALSE);
+	g_return_val_if_fail (G_IS_INPUT_STREAM (reference), FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+
+	success = stream_read_uint32 (patch_input, &lzx_h.h_version, cancellable, error) &&
+		  stream_read_uint32 (patch_input, &lzx_h.l_version, cancellable, error);
+
+	if (success && (lzx_h.h_version != 0x00000003 || lzx_h.l_version != 0x00000002)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "wrong version header");
+		success = FALSE;
+	}
+
+	success = success &&
+		  stream_read_uint32 (patch_input, &lzx_h.max_block_size, cancellable, error) &&
+		  stream_read_uint32 (patch_input, &lzx_h.source_size, cancellable, error) &&
+		  stream_read_uint32 (patch_input, &lzx_h.target_size, cancellable, error) &&
+		  stream_read_uint32 (patch_input, &lzx_h.source_crc, cancellable, error) &&
+		  stream_read_uint32 (patch_input, &lzx_h.target_crc, cancellable, error);
+
+	if (success && (!lzx_h.max_block_size || lzx_h.max_block_size > LZX_MAX_BLOCK_SIZE)) {
+		g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx maximum block size");
+		success = FALSE;
+	}
+
+	while (success && total_decomp_size < lzx_h.target_size) {
+		LzxPatchBlockHeader lzx_b;
+
+		success = stream_read_uint32 (patch_input, &lzx_b.patch_size, cancellable, error) &&
+			  stream_read_uint32 (patch_input, &lzx_b.target_size, cancellable, error) &&
+			  stream_read_uint32 (patch_input, &lzx_b.source_size, cancellable, error) &&
+			  stream_read_uint32 (patch_input, &lzx_b.crc, cancellable, error);
+		if (!success)
+			break;
+
+		if (!lzx_b.target_size || lzx_b.target_size > lzx_h.max_block_size ||
+		    lzx_b.source_size > lzx_h.max_block_size || lzx_b.patch_size > lzx_h.max_block_size) {
+			g_set_error_literal (error, g_quark_from_string ("lzx"), 1, "invalid lzx patch block size");
+			success = FALSE;
+			break;
+		}
+
+		if (out_buf_len < lzx_b.target_size) {
+			out_buf_len = lzx_b.target_size;
+			out_buf = g_realloc (out_buf, out_buf_len);
+		}
+
+		success = stream_read_block (patch_input, &patch_buf, &patch_buf_len, lzx_b.patch_size, cancellable, error) &&
+			  stream_read_block (reference, &ref_buf, &ref_buf_len, lzx_b.source_size, cancellable, error) &&
+			  patch_block (&lzx_b, patch_buf, ref_buf, out_buf, error) &&
+			  func (out_buf, lzx_b.target_size, func_user_data, cancellable, error);
+
+		total_decomp_size += lzx_b.target_size;
+	}
+
+	g_free (patch_buf);
+	g_free (ref_buf);
+	g_free (out_buf);
+
+	return success;
+}
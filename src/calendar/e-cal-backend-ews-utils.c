@@ -17,6 +17,7 @@
 
 #include "evolution-ews-config.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -51,8 +52,20 @@
  * A bunch of global variables used to map the icaltimezone to MSDN[0] format.
  * Also, some auxiliar functions to translate from one tz type to another.
  *
+ * The mapping is compiled in, generated from windowsZones.xml at build time,
+ * and the XML file itself is not installed. Only when a windowsZones.xml is
+ * placed into the data directory by hand it is read instead of the compiled-in
+ * mapping; otherwise updating the mapping requires a rebuild.
+ *
  * [0]: http://msdn.microsoft.com/en-us/library/ms912391(v=winembedded.11).aspx
  */
+typedef struct _EwsWindowsZone {
+	const gchar *key;
+	const gchar *value;
+} EwsWindowsZone;
+
+#include "e-cal-backend-ews-windows-zones.h"
+
 static GRecMutex tz_mutex;
 
 static GHashTable *ical_to_msdn = NULL;
@@ -71,16 +84,24 @@ e_cal_backend_ews_populate_windows_zones (void)
 	gint i, len;
 
 	g_rec_mutex_lock (&tz_mutex);
-	if (ical_to_msdn != NULL && msdn_to_ical != NULL) {
-		g_hash_table_ref (ical_to_msdn);
-		g_hash_table_ref (msdn_to_ical);
-		tables_counter++;
 
+	tables_counter++;
+
+	if (tables_counter > 1) {
 		g_rec_mutex_unlock (&tz_mutex);
 		return;
 	}
 
 	filename = g_build_filename (EXCHANGE_EWS_DATADIR, "windowsZones.xml", NULL);
+
+	/* No override, the compiled-in mapping is used */
+	if (!g_file_test (filename, G_FILE_TEST_IS_REGULAR)) {
+		g_free (filename);
+
+		g_rec_mutex_unlock (&tz_mutex);
+		return;
+	}
+
 	doc = xmlReadFile (filename, NULL, 0);
 
 	if (doc == NULL) {
@@ -111,7 +132,6 @@ e_cal_backend_ews_populate_windows_zones (void)
 
 	msdn_to_ical = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	ical_to_msdn = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-	tables_counter++;
 
 	for (i = 0; i < len; i++) {
 		xmlChar *msdn = xmlGetProp (nodes->nodeTab[i], BAD_CAST "other");
@@ -155,66 +175,69 @@ void
 e_cal_backend_ews_unref_windows_zones (void)
 {
 	g_rec_mutex_lock (&tz_mutex);
-	if (ical_to_msdn != NULL)
-		g_hash_table_unref (ical_to_msdn);
-
-	if (msdn_to_ical != NULL)
-		g_hash_table_unref (msdn_to_ical);
 
 	if (tables_counter > 0) {
 		tables_counter--;
 
 		if (tables_counter == 0) {
-			ical_to_msdn = NULL;
-			msdn_to_ical = NULL;
+			g_clear_pointer (&ical_to_msdn, g_hash_table_destroy);
+			g_clear_pointer (&msdn_to_ical, g_hash_table_destroy);
 		}
 	}
 
 	g_rec_mutex_unlock (&tz_mutex);
 }
 
-const gchar *
-e_cal_backend_ews_tz_util_get_msdn_equivalent (const gchar *ical_tz_location)
+static gint
+ews_windows_zone_compare (gconstpointer key,
+			  gconstpointer zone)
 {
-	const gchar *msdn_tz_location = NULL;
+	return strcmp (key, ((const EwsWindowsZone *) zone)->key);
+}
 
-	if (!ical_tz_location || !*ical_tz_location)
-		return NULL;
+static const gchar *
+ews_windows_zones_lookup (GHashTable **poverride,
+			  const EwsWindowsZone *zones,
+			  gsize n_zones,
+			  const gchar *key)
+{
+	const EwsWindowsZone *zone;
+	const gchar *value;
 
 	g_rec_mutex_lock (&tz_mutex);
-	if (ical_to_msdn == NULL) {
-		g_rec_mutex_unlock (&tz_mutex);
 
-		g_warn_if_reached ();
-		return NULL;
+	if (*poverride) {
+		value = g_hash_table_lookup (*poverride, key);
+	} else {
+		zone = bsearch (key, zones, n_zones, sizeof (EwsWindowsZone), ews_windows_zone_compare);
+		value = zone ? zone->value : NULL;
 	}
 
-	msdn_tz_location = g_hash_table_lookup (ical_to_msdn, ical_tz_location);
 	g_rec_mutex_unlock (&tz_mutex);
 
-	return msdn_tz_location;
+	return value;
 }
 
 const gchar *
-e_cal_backend_ews_tz_util_get_ical_equivalent (const gchar *msdn_tz_location)
+e_cal_backend_ews_tz_util_get_msdn_equivalent (const gchar *ical_tz_location)
 {
-	const gchar *ical_tz_location = NULL;
-
-	if (!msdn_tz_location || !*msdn_tz_location)
+	if (!ical_tz_location || !*ical_tz_location)
 		return NULL;
 
-	g_rec_mutex_lock (&tz_mutex);
-	if (msdn_to_ical == NULL) {
-		g_rec_mutex_unlock (&tz_mutex);
+	return ews_windows_zones_lookup (&ical_to_msdn,
+		ews_windows_zones_ical_to_msdn, G_N_ELEMENTS (ews_windows_zones_ical_to_msdn),
+		ical_tz_location);
+}
 
-		g_warn_if_reached ();
+const gchar *
+e_cal_backend_ews_tz_util_get_ical_equivalent (const gchar *msdn_tz_location)
+{
+	if (!msdn_tz_location || !*msdn_tz_location)
 		return NULL;
-	}
 
-	ical_tz_location = g_hash_table_lookup (msdn_to_ical, msdn_tz_location);
-	g_rec_mutex_unlock (&tz_mutex);
-
-	return ical_tz_location;
+	return ews_windows_zones_lookup (&msdn_to_ical,
+		ews_windows_zones_msdn_to_ical, G_N_ELEMENTS (ews_windows_zones_msdn_to_ical),
+		msdn_tz_location);
 }
 
 /*
@@ -267,7 +290,7 @@ e_ews_collect_attendees (icalcomponent *comp,
 
 		switch (icalparameter_get_role (param)) {
 		case ICAL_ROLE_OPTPARTICIPANT:
-			*optional = g_slist_append (*optional, (gpointer)str);
+			*optional = g_slist_prepend (*optional, (gpointer)str);
 
 			if (out_rsvp_requested && *out_rsvp_requested) {
 				icalparameter *rsvp;
@@ -279,7 +302,7 @@ e_ews_collect_attendees (icalcomponent *comp,
 			break;
 		case ICAL_ROLE_CHAIR:
 		case ICAL_ROLE_REQPARTICIPANT:
-			*required = g_slist_append (*required, (gpointer)str);
+			*required = g_slist_prepend (*required, (gpointer)str);
 
 			if (out_rsvp_requested && *out_rsvp_requested) {
 				icalparameter *rsvp;
@@ -290,7 +313,7 @@ e_ews_collect_attendees (icalcomponent *comp,
 			}
 			break;
 		case ICAL_ROLE_NONPARTICIPANT:
-			*resource = g_slist_append (*resource, (gpointer)str);
+			*resource = g_slist_prepend (*resource, (gpointer)str);
 			break;
 		case ICAL_ROLE_X:
 		case ICAL_ROLE_NONE:
@@ -299,6 +322,10 @@ e_ews_collect_attendees (icalcomponent *comp,
 		}
 	}
 
+	*required = g_slist_reverse (*required);
+	*optional = g_slist_reverse (*optional);
+	*resource = g_slist_reverse (*resource);
+
 	if (*required == NULL && *optional == NULL && *resource == NULL && org_email_address != NULL)
 		*required = g_slist_prepend (*required, (gpointer) org_email_address);
 }
@@ -559,6 +586,24 @@ ewscal_set_recurring_date_transitions (ESoapMessage *msg,
 	}
 }
 
+/* The server returns each time zone only once, thus pick the definitions by their ID,
+   not by their position in the list; falls back to the first definition */
+static EEwsCalendarTimeZoneDefinition *
+ewscal_find_timezone_definition (GSList *tzds, /* EEwsCalendarTimeZoneDefinition * */
+				 const gchar *msdn_location)
+{
+	GSList *link;
+
+	for (link = tzds; link && msdn_location; link = g_slist_next (link)) {
+		EEwsCalendarTimeZoneDefinition *tzd = link->data;
+
+		if (tzd && g_strcmp0 (tzd->id, msdn_location) == 0)
+			return tzd;
+	}
+
+	return tzds ? tzds->data : NULL;
+}
+
 void
 ewscal_set_timezone (ESoapMessage *msg,
 		     const gchar *name,
@@ -1215,25 +1260,50 @@ convert_vevent_calcomp_to_xml (ESoapMessage *msg,
 	 * icaltimetype, but its basic read-only icaltimezone_foo() functions
 	 * take a non-const pointer! */
 	if (satisfies && msdn_location_start != NULL && msdn_location_end != NULL) {
-		GSList *msdn_locations = NULL;
-		GSList *tzds = NULL;
+		EEwsCalendarTimeZoneDefinition *tzd = NULL;
+		gboolean can_reuse;
 
-		msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_start);
-		msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_end);
+		/* Many events of one import usually share the time zone, thus write
+		   the same definition for all of them without asking for it again */
+		can_reuse = convert_data->time_zones && g_strcmp0 (msdn_location_start, msdn_location_end) == 0;
 
-		if (e_ews_connection_get_server_time_zones_sync (
-				convert_data->connection,
-				EWS_PRIORITY_MEDIUM,
-				msdn_locations,
-				&tzds,
-				NULL,
-				NULL)) {
-			ewscal_set_timezone (msg, "StartTimeZone", tzds->data);
-			ewscal_set_timezone (msg, "EndTimeZone", tzds->data);
-		}
+		if (can_reuse)
+			tzd = g_hash_table_lookup (convert_data->time_zones, msdn_location_start);
 
-		g_slist_free (msdn_locations);
-		g_slist_free_full (tzds, (GDestroyNotify) e_ews_calendar_time_zone_definition_free);
+		if (tzd) {
+			ewscal_set_timezone (msg, "StartTimeZone", tzd);
+			ewscal_set_timezone (msg, "EndTimeZone", tzd);
+		} else {
+			GSList *msdn_locations = NULL;
+			GSList *tzds = NULL;
+
+			msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_start);
+			msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_end);
+
+			if (e_ews_connection_get_server_time_zones_sync (
+					convert_data->connection,
+					EWS_PRIORITY_MEDIUM,
+					msdn_locations,
+					&tzds,
+					NULL,
+					NULL) && tzds) {
+				EEwsCalendarTimeZoneDefinition *tzd_start, *tzd_end;
+
+				tzd_start = ewscal_find_timezone_definition (tzds, msdn_location_start);
+				tzd_end = ewscal_find_timezone_definition (tzds, msdn_location_end);
+
+				ewscal_set_timezone (msg, "StartTimeZone", tzd_start);
+				ewscal_set_timezone (msg, "EndTimeZone", tzd_end);
+
+				if (can_reuse) {
+					g_hash_table_insert (convert_data->time_zones, g_strdup (msdn_location_start), tzd_start);
+					tzds = g_slist_remove (tzds, tzd_start);
+				}
+			}
+
+			g_slist_free (msdn_locations);
+			g_slist_free_full (tzds, (GDestroyNotify) e_ews_calendar_time_zone_definition_free);
+		}
 	} else {
 		e_ews_message_replace_server_version (msg, E_EWS_EXCHANGE_2007_SP1);
 
@@ -1458,6 +1528,375 @@ convert_vevent_property_to_updatexml (ESoapMessage *msg,
 	e_ews_message_end_set_item_field (msg);
 }
 
+static gboolean
+ews_strings_differ (const gchar *str1,
+		    const gchar *str2)
+{
+	if (str1 && !*str1)
+		str1 = NULL;
+	if (str2 && !*str2)
+		str2 = NULL;
+
+	return g_strcmp0 (str1, str2) != 0;
+}
+
+static const gchar *
+ews_get_sensitivity (icalcomponent *icalcomp)
+{
+	icalproperty *prop;
+
+	prop = icalcomponent_get_first_property (icalcomp, ICAL_CLASS_PROPERTY);
+	if (!prop)
+		return NULL;
+
+	switch (icalproperty_get_class (prop)) {
+	case ICAL_CLASS_PUBLIC:
+		return "Normal";
+	case ICAL_CLASS_PRIVATE:
+		return "Private";
+	case ICAL_CLASS_CONFIDENTIAL:
+		return "Personal";
+	default:
+		break;
+	}
+
+	return NULL;
+}
+
+static gboolean
+ews_categories_equal (ECalComponent *comp1,
+		      ECalComponent *comp2)
+{
+	GSList *categ_list1 = NULL, *categ_list2 = NULL, *link1, *link2;
+	gboolean equal;
+
+	e_cal_component_get_categories_list (comp1, &categ_list1);
+	e_cal_component_get_categories_list (comp2, &categ_list2);
+
+	link1 = categ_list1;
+	link2 = categ_list2;
+
+	while (TRUE) {
+		/* Empty categories are not saved, thus skip them */
+		while (link1 && (!link1->data || !*((const gchar *) link1->data)))
+			link1 = g_slist_next (link1);
+
+		while (link2 && (!link2->data || !*((const gchar *) link2->data)))
+			link2 = g_slist_next (link2);
+
+		if (!link1 || !link2 || g_strcmp0 (link1->data, link2->data) != 0)
+			break;
+
+		link1 = g_slist_next (link1);
+		link2 = g_slist_next (link2);
+	}
+
+	equal = !link1 && !link2;
+
+	e_cal_component_free_categories_list (categ_list1);
+	e_cal_component_free_categories_list (categ_list2);
+
+	return equal;
+}
+
+static gboolean
+ews_user_is_organizer (EwsCalendarConvertData *convert_data,
+		       icalcomponent *icalcomp)
+{
+	const gchar *org_email_address;
+
+	org_email_address = e_ews_collect_organizer (icalcomp);
+
+	return !org_email_address || !convert_data->user_email ||
+		g_ascii_strcasecmp (org_email_address, convert_data->user_email) == 0;
+}
+
+typedef struct {
+	icaltimetype dtstart;
+	icaltimetype dtend;
+	icaltimezone *tzid_start;
+	icaltimezone *tzid_end;
+	const gchar *ical_location_start;
+	const gchar *ical_location_end;
+	const gchar *msdn_location_start;
+	const gchar *msdn_location_end;
+	gboolean satisfies; /* Exchange 2010 or later */
+	gboolean start_changed;
+	gboolean end_changed;
+	gboolean start_timezone_changed;
+	gboolean end_timezone_changed;
+} EwsVEventTimes;
+
+static void
+ews_get_vevent_times (EwsCalendarConvertData *convert_data,
+		      icalcomponent *icalcomp,
+		      icalcomponent *icalcomp_old,
+		      EwsVEventTimes *times)
+{
+	icaltimetype dtstart_old, dtend_old;
+	const gchar *old_ical_location_start = NULL, *old_ical_location_end = NULL;
+	const gchar *old_msdn_location_start, *old_msdn_location_end;
+	gboolean start_changed_timezone_name = FALSE, end_changed_timezone_name = FALSE;
+
+	memset (times, 0, sizeof (EwsVEventTimes));
+
+	times->dtstart = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp, ICAL_DTSTART_PROPERTY, icalproperty_get_dtstart);
+	dtstart_old = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp_old, ICAL_DTSTART_PROPERTY, icalproperty_get_dtstart);
+	times->start_changed = icaltime_compare (times->dtstart, dtstart_old) != 0;
+	if (times->dtstart.zone != NULL) {
+		times->tzid_start = (icaltimezone *) times->dtstart.zone;
+		times->ical_location_start = icaltimezone_get_location (times->tzid_start);
+
+		old_ical_location_start = icaltimezone_get_location ((icaltimezone *) dtstart_old.zone);
+		if (g_strcmp0 (times->ical_location_start, old_ical_location_start) != 0)
+			start_changed_timezone_name = TRUE;
+	}
+
+	times->dtend = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp, ICAL_DTEND_PROPERTY, icalproperty_get_dtend);
+	dtend_old = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp_old, ICAL_DTEND_PROPERTY, icalproperty_get_dtend);
+	times->end_changed = icaltime_compare (times->dtend, dtend_old) != 0;
+	if (times->dtend.zone != NULL) {
+		times->tzid_end = (icaltimezone *) times->dtend.zone;
+		times->ical_location_end = icaltimezone_get_location (times->tzid_end);
+
+		old_ical_location_end = icaltimezone_get_location ((icaltimezone *) dtend_old.zone);
+		if (g_strcmp0 (times->ical_location_end, old_ical_location_end) != 0)
+			end_changed_timezone_name = TRUE;
+	}
+
+	times->satisfies = convert_data->connection &&
+		e_ews_connection_satisfies_server_version (convert_data->connection, E_EWS_EXCHANGE_2010);
+
+	if (times->satisfies) {
+		if (old_ical_location_start != NULL) {
+			old_msdn_location_start = e_cal_backend_ews_tz_util_get_msdn_equivalent (old_ical_location_start);
+			times->msdn_location_start = e_cal_backend_ews_tz_util_get_msdn_equivalent (times->ical_location_start);
+
+			if (g_strcmp0 (old_msdn_location_start, times->msdn_location_start) != 0)
+				times->start_changed = TRUE;
+		}
+
+		if (old_ical_location_end != NULL) {
+			old_msdn_location_end = e_cal_backend_ews_tz_util_get_msdn_equivalent (old_ical_location_end);
+			times->msdn_location_end = e_cal_backend_ews_tz_util_get_msdn_equivalent (times->ical_location_end);
+
+			if (g_strcmp0 (old_msdn_location_end, times->msdn_location_end) != 0)
+				times->end_changed = TRUE;
+		}
+
+		times->start_timezone_changed = (times->start_changed || start_changed_timezone_name) && times->ical_location_start != NULL;
+		times->end_timezone_changed = (times->end_changed || end_changed_timezone_name) && times->ical_location_end != NULL;
+	}
+}
+
+typedef struct {
+	GSList *required; /* const gchar *, borrowed from the component */
+	GSList *optional;
+	GSList *resource;
+	gboolean rsvp_requested;
+} EwsVEventAttendees;
+
+static void
+ews_collect_vevent_attendees (icalcomponent *icalcomp,
+			      EwsVEventAttendees *attendees)
+{
+	memset (attendees, 0, sizeof (EwsVEventAttendees));
+
+	e_ews_collect_attendees (icalcomp, &attendees->required, &attendees->optional, &attendees->resource, &attendees->rsvp_requested);
+}
+
+static void
+ews_clear_vevent_attendees (EwsVEventAttendees *attendees)
+{
+	g_slist_free (attendees->required);
+	g_slist_free (attendees->optional);
+	g_slist_free (attendees->resource);
+
+	memset (attendees, 0, sizeof (EwsVEventAttendees));
+}
+
+typedef enum {
+	EWS_ATTENDEES_UNCHANGED,
+	EWS_ATTENDEES_ADDED,	/* only new attendees had been added */
+	EWS_ATTENDEES_CHANGED
+} EwsAttendeesDiff;
+
+static EwsAttendeesDiff
+ews_diff_attendees (const GSList *old_list, /* const gchar * */
+		    const GSList *new_list, /* const gchar * */
+		    GSList **out_added) /* const gchar *, borrowed from the 'new_list' */
+{
+	GHashTable *old_emails, *new_emails;
+	GSList *added = NULL;
+	const GSList *link;
+	EwsAttendeesDiff diff;
+	guint n_added = 0;
+
+	old_emails = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	new_emails = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (link = old_list; link; link = g_slist_next (link)) {
+		if (link->data)
+			g_hash_table_add (old_emails, g_ascii_strdown (link->data, -1));
+	}
+
+	for (link = new_list; link; link = g_slist_next (link)) {
+		gchar *email;
+
+		if (!link->data)
+			continue;
+
+		email = g_ascii_strdown (link->data, -1);
+
+		if (g_hash_table_contains (new_emails, email)) {
+			g_free (email);
+			continue;
+		}
+
+		if (!g_hash_table_contains (old_emails, email)) {
+			added = g_slist_prepend (added, link->data);
+			n_added++;
+		}
+
+		g_hash_table_add (new_emails, email);
+	}
+
+	/* Any of the old attendees is not part of the new list */
+	if (g_hash_table_size (new_emails) - n_added < g_hash_table_size (old_emails))
+		diff = EWS_ATTENDEES_CHANGED;
+	else if (added)
+		diff = EWS_ATTENDEES_ADDED;
+	else
+		diff = EWS_ATTENDEES_UNCHANGED;
+
+	if (out_added)
+		*out_added = g_slist_reverse (added);
+	else
+		g_slist_free (added);
+
+	g_hash_table_destroy (old_emails);
+	g_hash_table_destroy (new_emails);
+
+	return diff;
+}
+
+static void
+convert_vevent_attendees_to_updatexml (ESoapMessage *msg,
+				       const gchar *name,
+				       GSList *old_list,
+				       GSList *new_list)
+{
+	GSList *added = NULL;
+
+	if (ews_diff_attendees (old_list, new_list, &added) == EWS_ATTENDEES_ADDED && old_list) {
+		/* Send only the new attendees, not the whole list again */
+		e_ews_message_start_append_to_item_field (msg, name, "calendar", "CalendarItem");
+		add_attendees_list_to_message (msg, name, added);
+		e_ews_message_end_set_item_field (msg);
+	} else if (new_list) {
+		e_ews_message_start_set_item_field (msg, name, "calendar", "CalendarItem");
+		add_attendees_list_to_message (msg, name, new_list);
+		e_ews_message_end_set_item_field (msg);
+	} else if (old_list) {
+		e_ews_message_add_delete_item_field (msg, name, "calendar");
+	}
+
+	g_slist_free (added);
+}
+
+static EwsCalendarChangeFlags
+ews_get_vevent_changes (EwsCalendarConvertData *convert_data)
+{
+	icalcomponent *icalcomp = e_cal_component_get_icalcomponent (convert_data->comp);
+	icalcomponent *icalcomp_old;
+	icalproperty *prop, *old_prop;
+	EwsCalendarChangeFlags changes = EWS_CALENDAR_CHANGE_NONE;
+	EwsVEventTimes times;
+	EwsVEventAttendees attendees, attendees_old;
+	const gchar *value;
+	gboolean has_alarms, has_alarms_old;
+
+	if (convert_data->force_basic_properties) {
+		/* What describes the meeting as a whole */
+		changes = EWS_CALENDAR_CHANGE_CATEGORIES;
+
+		if (ews_user_is_organizer (convert_data, icalcomp)) {
+			changes |= EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED |
+				EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES |
+				EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES |
+				EWS_CALENDAR_CHANGE_RESOURCES;
+		}
+	}
+
+	icalcomp_old = e_cal_component_get_icalcomponent (convert_data->old_comp);
+
+	if (ews_strings_differ (icalcomponent_get_summary (icalcomp), icalcomponent_get_summary (icalcomp_old)))
+		changes |= EWS_CALENDAR_CHANGE_SUBJECT;
+
+	value = ews_get_sensitivity (icalcomp);
+	if (value && g_strcmp0 (value, ews_get_sensitivity (icalcomp_old)) != 0)
+		changes |= EWS_CALENDAR_CHANGE_SENSITIVITY;
+
+	if (ews_strings_differ (icalcomponent_get_description (icalcomp), icalcomponent_get_description (icalcomp_old)))
+		changes |= EWS_CALENDAR_CHANGE_BODY;
+
+	has_alarms = e_cal_component_has_alarms (convert_data->comp);
+	has_alarms_old = e_cal_component_has_alarms (convert_data->old_comp);
+	if (has_alarms != has_alarms_old ||
+	    (has_alarms && ews_get_alarm (convert_data->comp) != ews_get_alarm (convert_data->old_comp)))
+		changes |= EWS_CALENDAR_CHANGE_REMINDER;
+
+	if (!ews_categories_equal (convert_data->comp, convert_data->old_comp))
+		changes |= EWS_CALENDAR_CHANGE_CATEGORIES;
+
+	if (ews_strings_differ (icalcomponent_get_location (icalcomp), icalcomponent_get_location (icalcomp_old)))
+		changes |= EWS_CALENDAR_CHANGE_LOCATION;
+
+	prop = icalcomponent_get_first_property (icalcomp, ICAL_TRANSP_PROPERTY);
+	old_prop = icalcomponent_get_first_property (icalcomp_old, ICAL_TRANSP_PROPERTY);
+	if (g_strcmp0 (prop ? icalproperty_get_value_as_string (prop) : NULL,
+		       old_prop ? icalproperty_get_value_as_string (old_prop) : NULL) != 0)
+		changes |= EWS_CALENDAR_CHANGE_FREE_BUSY;
+
+	/* The rest can be changed only by the meeting organizer */
+	if (!ews_user_is_organizer (convert_data, icalcomp))
+		return changes;
+
+	ews_get_vevent_times (convert_data, icalcomp, icalcomp_old, &times);
+
+	if (times.start_changed)
+		changes |= EWS_CALENDAR_CHANGE_START;
+	if (times.end_changed)
+		changes |= EWS_CALENDAR_CHANGE_END;
+	if (times.start_timezone_changed)
+		changes |= EWS_CALENDAR_CHANGE_START_TIMEZONE;
+	if (times.end_timezone_changed)
+		changes |= EWS_CALENDAR_CHANGE_END_TIMEZONE;
+
+	ews_collect_vevent_attendees (icalcomp, &attendees);
+	ews_collect_vevent_attendees (icalcomp_old, &attendees_old);
+
+	if (attendees.rsvp_requested != attendees_old.rsvp_requested)
+		changes |= EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED;
+	if (ews_diff_attendees (attendees_old.required, attendees.required, NULL) != EWS_ATTENDEES_UNCHANGED)
+		changes |= EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES;
+	if (ews_diff_attendees (attendees_old.optional, attendees.optional, NULL) != EWS_ATTENDEES_UNCHANGED)
+		changes |= EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES;
+	if (ews_diff_attendees (attendees_old.resource, attendees.resource, NULL) != EWS_ATTENDEES_UNCHANGED)
+		changes |= EWS_CALENDAR_CHANGE_RESOURCES;
+
+	ews_clear_vevent_attendees (&attendees);
+	ews_clear_vevent_attendees (&attendees_old);
+
+	prop = icalcomponent_get_first_property (icalcomp, ICAL_RRULE_PROPERTY);
+	old_prop = icalcomponent_get_first_property (icalcomp_old, ICAL_RRULE_PROPERTY);
+	if (prop && g_strcmp0 (icalproperty_get_value_as_string (prop),
+			       old_prop ? icalproperty_get_value_as_string (old_prop) : NULL) != 0)
+		changes |= EWS_CALENDAR_CHANGE_RECURRENCE;
+
+	return changes;
+}
+
 static gboolean
 convert_vevent_component_to_updatexml (ESoapMessage *msg,
                                        gpointer user_data,
@@ -1466,20 +1905,11 @@ convert_vevent_component_to_updatexml (ESoapMessage *msg,
 	EwsCalendarConvertData *convert_data = user_data;
 	icalcomponent *icalcomp = e_cal_component_get_icalcomponent (convert_data->comp);
 	icalcomponent *icalcomp_old = e_cal_component_get_icalcomponent (convert_data->old_comp);
-	GSList *required = NULL, *optional = NULL, *resource = NULL;
-	icaltimetype dtstart, dtend, dtstart_old, dtend_old;
-	icaltimezone *tzid_start = NULL, *tzid_end = NULL;
-	icalproperty *prop, *transp;
-	const gchar *org_email_address = NULL, *value = NULL, *old_value = NULL;
-	const gchar *ical_location_start = NULL, *ical_location_end = NULL;
-	const gchar *old_ical_location_start = NULL, *old_ical_location_end = NULL;
-	const gchar *old_msdn_location_start = NULL, *old_msdn_location_end = NULL;
-	const gchar *msdn_location_start = NULL, *msdn_location_end = NULL;
-	gboolean has_alarms, has_alarms_old;
-	gboolean dt_start_changed = FALSE, dt_end_changed = FALSE, dt_changed;
-	gboolean dt_start_changed_timezone_name = FALSE, dt_end_changed_timezone_name = FALSE;
-	gboolean satisfies, rsvp_requested = TRUE, is_all_day_event = FALSE;
-	gint alarm = 0, alarm_old = 0;
+	EwsCalendarChangeFlags changes;
+	EwsVEventTimes times;
+	icalproperty *prop;
+	const gchar *value;
+	gboolean dt_changed, is_all_day_event = FALSE;
 	gchar *recid;
 
 	/* Modifying a recurring meeting ? */
@@ -1507,160 +1937,98 @@ convert_vevent_component_to_updatexml (ESoapMessage *msg,
 	} else e_ews_message_start_item_change (msg, E_EWS_ITEMCHANGE_TYPE_ITEM,
 		convert_data->item_id, convert_data->change_key, 0);
 
-	/* subject */
-	value = icalcomponent_get_summary (icalcomp);
-	old_value = icalcomponent_get_summary (icalcomp_old);
-	if ((value && old_value && g_ascii_strcasecmp (value, old_value)) ||
-	 (value && old_value == NULL)) {
-		convert_vevent_property_to_updatexml (msg, "Subject", value, "item", NULL, NULL);
-	} else if (!value && old_value)
-		convert_vevent_property_to_updatexml (msg, "Subject", "", "item", NULL, NULL);
+	/* Write only what changed, not to resend large meetings as a whole */
+	changes = ews_get_vevent_changes (convert_data);
 
-	prop = icalcomponent_get_first_property (icalcomp, ICAL_CLASS_PROPERTY);
-	if (prop) {
-		icalproperty_class classify = icalproperty_get_class (prop);
-		if (classify == ICAL_CLASS_PUBLIC) {
-			convert_vevent_property_to_updatexml (msg, "Sensitivity", "Normal", "item", NULL, NULL);
-		} else if (classify == ICAL_CLASS_PRIVATE) {
-			convert_vevent_property_to_updatexml (msg, "Sensitivity", "Private", "item", NULL, NULL);
-		} else if (classify == ICAL_CLASS_CONFIDENTIAL) {
-			convert_vevent_property_to_updatexml (msg, "Sensitivity", "Personal", "item", NULL, NULL);
-		}
+	/* subject */
+	if ((changes & EWS_CALENDAR_CHANGE_SUBJECT) != 0) {
+		value = icalcomponent_get_summary (icalcomp);
+		convert_vevent_property_to_updatexml (msg, "Subject", value ? value : "", "item", NULL, NULL);
 	}
 
+	if ((changes & EWS_CALENDAR_CHANGE_SENSITIVITY) != 0)
+		convert_vevent_property_to_updatexml (msg, "Sensitivity", ews_get_sensitivity (icalcomp), "item", NULL, NULL);
+
 	/*description*/
-	value = icalcomponent_get_description (icalcomp);
-	old_value = icalcomponent_get_description (icalcomp_old);
-	if ((value && old_value && g_ascii_strcasecmp (value, old_value)) ||
-	 (value && old_value == NULL)) {
-		convert_vevent_property_to_updatexml (msg, "Body", value, "item", "BodyType", "Text");
-	} else if (!value && old_value)
-		convert_vevent_property_to_updatexml (msg, "Body", "", "item", "BodyType", "Text");
+	if ((changes & EWS_CALENDAR_CHANGE_BODY) != 0) {
+		value = icalcomponent_get_description (icalcomp);
+		convert_vevent_property_to_updatexml (msg, "Body", value ? value : "", "item", "BodyType", "Text");
+	}
 
 	/*update alarm items*/
-	has_alarms = e_cal_component_has_alarms (convert_data->comp);
-	if (has_alarms) {
-		alarm = ews_get_alarm (convert_data->comp);
-		has_alarms_old = e_cal_component_has_alarms (convert_data->old_comp);
-		if (has_alarms_old)
-			alarm_old = ews_get_alarm (convert_data->old_comp);
-		if (!(alarm == alarm_old)) {
+	if ((changes & EWS_CALENDAR_CHANGE_REMINDER) != 0) {
+		if (e_cal_component_has_alarms (convert_data->comp)) {
 			gchar buf[20];
-			snprintf (buf, 20, "%d", alarm);
+
+			snprintf (buf, 20, "%d", ews_get_alarm (convert_data->comp));
 			convert_vevent_property_to_updatexml (msg, "ReminderIsSet", "true", "item", NULL, NULL);
 			convert_vevent_property_to_updatexml (msg, "ReminderMinutesBeforeStart", buf, "item", NULL, NULL);
+		} else {
+			convert_vevent_property_to_updatexml (msg, "ReminderIsSet", "false", "item", NULL, NULL);
 		}
 	}
-	else convert_vevent_property_to_updatexml (msg, "ReminderIsSet", "false", "item", NULL, NULL);
 
 	/* Categories */
-	convert_component_categories_to_updatexml (convert_data->comp, msg, "CalendarItem");
+	if ((changes & EWS_CALENDAR_CHANGE_CATEGORIES) != 0)
+		convert_component_categories_to_updatexml (convert_data->comp, msg, "CalendarItem");
 
 	/*location*/
-	value = icalcomponent_get_location (icalcomp);
-	old_value = icalcomponent_get_location (icalcomp_old);
-	if ((value && old_value && g_ascii_strcasecmp (value, old_value)) ||
-	 (value && old_value == NULL)) {
-		convert_vevent_property_to_updatexml (msg, "Location", value, "calendar", NULL, NULL);
-	} else if (!value && old_value)
-		convert_vevent_property_to_updatexml (msg, "Location", "", "calendar", NULL, NULL);
+	if ((changes & EWS_CALENDAR_CHANGE_LOCATION) != 0) {
+		value = icalcomponent_get_location (icalcomp);
+		convert_vevent_property_to_updatexml (msg, "Location", value ? value : "", "calendar", NULL, NULL);
+	}
 
 	/*freebusy*/
-	transp = icalcomponent_get_first_property (icalcomp, ICAL_TRANSP_PROPERTY);
-	value = icalproperty_get_value_as_string (transp);
-	transp = icalcomponent_get_first_property (icalcomp_old, ICAL_TRANSP_PROPERTY);
-	old_value = icalproperty_get_value_as_string (transp);
-	if (g_strcmp0 (value, old_value)) {
+	if ((changes & EWS_CALENDAR_CHANGE_FREE_BUSY) != 0) {
+		prop = icalcomponent_get_first_property (icalcomp, ICAL_TRANSP_PROPERTY);
+		value = prop ? icalproperty_get_value_as_string (prop) : NULL;
+
 		if (!g_strcmp0 (value, "TRANSPARENT"))
 			convert_vevent_property_to_updatexml (msg, "LegacyFreeBusyStatus","Free" , "calendar", NULL, NULL);
 		else
 			convert_vevent_property_to_updatexml (msg, "LegacyFreeBusyStatus","Busy" , "calendar", NULL, NULL);
 	}
 
-	org_email_address = e_ews_collect_organizer (icalcomp);
-	if (org_email_address && convert_data->user_email && g_ascii_strcasecmp (org_email_address, convert_data->user_email)) {
-		e_ews_message_end_item_change (msg);
-		return TRUE;
-	}
-
-	/* Update other properties allowed only for meeting organizers*/
-	/*meeting dates*/
-	dtstart = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp, ICAL_DTSTART_PROPERTY, icalproperty_get_dtstart);
-	dtstart_old = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp_old, ICAL_DTSTART_PROPERTY, icalproperty_get_dtstart);
-	dt_start_changed = icaltime_compare (dtstart, dtstart_old) != 0;
-	if (dtstart.zone != NULL) {
-		tzid_start = (icaltimezone *) dtstart.zone;
-		ical_location_start = icaltimezone_get_location (tzid_start);
-
-		old_ical_location_start = icaltimezone_get_location ((icaltimezone *)dtstart_old.zone);
-		if (g_strcmp0 (ical_location_start, old_ical_location_start) != 0)
-			dt_start_changed_timezone_name = TRUE;
-	}
-
-	dtend = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp, ICAL_DTEND_PROPERTY, icalproperty_get_dtend);
-	dtend_old = e_cal_backend_ews_get_datetime_with_zone (convert_data->timezone_cache, convert_data->vcalendar, icalcomp_old, ICAL_DTEND_PROPERTY, icalproperty_get_dtend);
-	dt_end_changed = icaltime_compare (dtend, dtend_old) != 0;
-	if (dtend.zone != NULL) {
-		tzid_end = (icaltimezone *) dtend.zone;
-		ical_location_end = icaltimezone_get_location (tzid_end);
+	/* Update other properties allowed only for meeting organizers,
+	   the ews_get_vevent_changes() does not report them for others */
+	dt_changed = (changes & (EWS_CALENDAR_CHANGE_START | EWS_CALENDAR_CHANGE_END)) != 0;
 
-		old_ical_location_end = icaltimezone_get_location ((icaltimezone *)dtend_old.zone);
-		if (g_strcmp0 (ical_location_end, old_ical_location_end) != 0)
-			dt_end_changed_timezone_name = TRUE;
-	}
-
-	satisfies = e_ews_connection_satisfies_server_version (convert_data->connection, E_EWS_EXCHANGE_2010);
-
-	if (satisfies) {
-		if (old_ical_location_start != NULL) {
-			old_msdn_location_start = e_cal_backend_ews_tz_util_get_msdn_equivalent (old_ical_location_start);
-			msdn_location_start = e_cal_backend_ews_tz_util_get_msdn_equivalent (ical_location_start);
-
-			if (g_strcmp0 (old_msdn_location_start, msdn_location_start) != 0)
-				dt_start_changed = TRUE;
-		}
-
-		if (old_ical_location_end != NULL) {
-			old_msdn_location_end = e_cal_backend_ews_tz_util_get_msdn_equivalent (old_ical_location_end);
-			msdn_location_end = e_cal_backend_ews_tz_util_get_msdn_equivalent (ical_location_end);
-
-			if (g_strcmp0 (old_msdn_location_end, msdn_location_end) != 0)
-				dt_end_changed = TRUE;
-		}
-
-		if ((dt_start_changed || dt_start_changed_timezone_name) && ical_location_start != NULL)
-			e_ews_message_add_set_item_field_extended_distinguished_name_string (
-				msg,
-				NULL,
-				"CalendarItem",
-				"PublicStrings",
-				"EvolutionEWSStartTimeZone",
-				ical_location_start);
+	if (dt_changed || (changes & (EWS_CALENDAR_CHANGE_START_TIMEZONE | EWS_CALENDAR_CHANGE_END_TIMEZONE | EWS_CALENDAR_CHANGE_RECURRENCE)) != 0)
+		ews_get_vevent_times (convert_data, icalcomp, icalcomp_old, &times);
+	else
+		memset (&times, 0, sizeof (EwsVEventTimes));
 
-		if ((dt_end_changed || dt_end_changed_timezone_name) && ical_location_end != NULL)
-			e_ews_message_add_set_item_field_extended_distinguished_name_string (
-				msg,
-				NULL,
-				"CalendarItem",
-				"PublicStrings",
-				"EvolutionEWSEndTimeZone",
-				ical_location_end);
-	}
+	/*meeting dates*/
+	if ((changes & EWS_CALENDAR_CHANGE_START_TIMEZONE) != 0)
+		e_ews_message_add_set_item_field_extended_distinguished_name_string (
+			msg,
+			NULL,
+			"CalendarItem",
+			"PublicStrings",
+			"EvolutionEWSStartTimeZone",
+			times.ical_location_start);
 
-	dt_changed = dt_start_changed || dt_end_changed;
+	if ((changes & EWS_CALENDAR_CHANGE_END_TIMEZONE) != 0)
+		e_ews_message_add_set_item_field_extended_distinguished_name_string (
+			msg,
+			NULL,
+			"CalendarItem",
+			"PublicStrings",
+			"EvolutionEWSEndTimeZone",
+			times.ical_location_end);
 
 	if (dt_changed)
-		is_all_day_event = check_is_all_day_event (dtstart, tzid_start, dtend, tzid_end);
+		is_all_day_event = check_is_all_day_event (times.dtstart, times.tzid_start, times.dtend, times.tzid_end);
 
-	if (dt_start_changed) {
+	if ((changes & EWS_CALENDAR_CHANGE_START) != 0) {
 		e_ews_message_start_set_item_field (msg, "Start", "calendar","CalendarItem");
-		e_ews_cal_utils_set_time (msg, "Start", &dtstart, is_all_day_event && dtstart.is_date);
+		e_ews_cal_utils_set_time (msg, "Start", &times.dtstart, is_all_day_event && times.dtstart.is_date);
 		e_ews_message_end_set_item_field (msg);
 	}
 
-	if (dt_end_changed) {
+	if ((changes & EWS_CALENDAR_CHANGE_END) != 0) {
 		e_ews_message_start_set_item_field (msg, "End", "calendar", "CalendarItem");
-		e_ews_cal_utils_set_time (msg, "End", &dtend, is_all_day_event && dtend.is_date);
+		e_ews_cal_utils_set_time (msg, "End", &times.dtend, is_all_day_event && times.dtend.is_date);
 		e_ews_message_end_set_item_field (msg);
 	}
 
@@ -1672,60 +2040,50 @@ convert_vevent_component_to_updatexml (ESoapMessage *msg,
 			convert_vevent_property_to_updatexml (msg, "IsAllDayEvent", "false", "calendar", NULL, NULL);
 	}
 
-	e_ews_collect_attendees (icalcomp, &required, &optional, &resource, &rsvp_requested);
+	if ((changes & (EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED |
+			EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES |
+			EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES |
+			EWS_CALENDAR_CHANGE_RESOURCES)) != 0) {
+		EwsVEventAttendees attendees, attendees_old;
 
-	convert_vevent_property_to_updatexml (msg, "IsResponseRequested", rsvp_requested ? "true" : "false", "calendar", NULL, NULL);
+		ews_collect_vevent_attendees (icalcomp, &attendees);
+		ews_collect_vevent_attendees (icalcomp_old, &attendees_old);
 
-	if (required != NULL) {
-		e_ews_message_start_set_item_field (msg, "RequiredAttendees", "calendar", "CalendarItem");
+		if ((changes & EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED) != 0)
+			convert_vevent_property_to_updatexml (msg, "IsResponseRequested", attendees.rsvp_requested ? "true" : "false", "calendar", NULL, NULL);
 
-		add_attendees_list_to_message (msg, "RequiredAttendees", required);
-		g_slist_free (required);
+		if ((changes & EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES) != 0)
+			convert_vevent_attendees_to_updatexml (msg, "RequiredAttendees", attendees_old.required, attendees.required);
 
-		e_ews_message_end_set_item_field (msg);
-	}
-	if (optional != NULL) {
-		e_ews_message_start_set_item_field (msg, "OptionalAttendees", "calendar", "CalendarItem");
+		if ((changes & EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES) != 0)
+			convert_vevent_attendees_to_updatexml (msg, "OptionalAttendees", attendees_old.optional, attendees.optional);
 
-		add_attendees_list_to_message (msg, "OptionalAttendees", optional);
-		g_slist_free (optional);
+		if ((changes & EWS_CALENDAR_CHANGE_RESOURCES) != 0)
+			convert_vevent_attendees_to_updatexml (msg, "Resources", attendees_old.resource, attendees.resource);
 
-		e_ews_message_end_set_item_field (msg);
-	}
-	if (resource != NULL) {
-		e_ews_message_start_set_item_field (msg, "Resources", "calendar", "CalendarItem");
-
-		add_attendees_list_to_message (msg, "Resources", resource);
-		g_slist_free (resource);
-
-		e_ews_message_end_set_item_field (msg);
+		ews_clear_vevent_attendees (&attendees);
+		ews_clear_vevent_attendees (&attendees_old);
 	}
 
 	/* Recurrence */
-	value = NULL; old_value = NULL;
-	prop = icalcomponent_get_first_property (icalcomp_old, ICAL_RRULE_PROPERTY);
-	if (prop != NULL)
-		old_value = icalproperty_get_value_as_string (prop);
-	prop = icalcomponent_get_first_property (icalcomp, ICAL_RRULE_PROPERTY);
-	if (prop != NULL)
-		value = icalproperty_get_value_as_string (prop);
+	if ((changes & EWS_CALENDAR_CHANGE_RECURRENCE) != 0) {
+		prop = icalcomponent_get_first_property (icalcomp, ICAL_RRULE_PROPERTY);
 
-	if (prop != NULL && g_strcmp0 (value, old_value)) {
 		e_ews_message_start_set_item_field (msg, "Recurrence", "calendar", "CalendarItem");
-		ewscal_set_reccurence (msg, prop, &dtstart);
+		ewscal_set_reccurence (msg, prop, &times.dtstart);
 		e_ews_message_end_set_item_field (msg);
 	}
 
-	if (dt_changed && satisfies) {
-		if (msdn_location_start != NULL || msdn_location_end != NULL) {
+	if (dt_changed && times.satisfies) {
+		if (times.msdn_location_start != NULL || times.msdn_location_end != NULL) {
 			GSList *msdn_locations = NULL;
 			GSList *tzds = NULL;
 
-			if (msdn_location_start != NULL)
-				msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_start);
+			if (times.msdn_location_start != NULL)
+				msdn_locations = g_slist_append (msdn_locations, (gchar *) times.msdn_location_start);
 
-			if (msdn_location_end != NULL)
-				msdn_locations = g_slist_append (msdn_locations, (gchar *) msdn_location_end);
+			if (times.msdn_location_end != NULL)
+				msdn_locations = g_slist_append (msdn_locations, (gchar *) times.msdn_location_end);
 
 			if (e_ews_connection_get_server_time_zones_sync (
 				convert_data->connection,
@@ -1733,26 +2091,20 @@ convert_vevent_component_to_updatexml (ESoapMessage *msg,
 				msdn_locations,
 				&tzds,
 				NULL,
-				NULL)) {
-				GSList *tmp;
+				NULL) && tzds) {
+				EEwsCalendarTimeZoneDefinition *tzd;
 
-				tmp = tzds;
-				if (tzid_start != NULL) {
+				tzd = ewscal_find_timezone_definition (tzds, times.msdn_location_start);
+				if (times.tzid_start != NULL && tzd) {
 					e_ews_message_start_set_item_field (msg, "StartTimeZone", "calendar", "CalendarItem");
-					ewscal_set_timezone (msg, "StartTimeZone", tmp->data);
+					ewscal_set_timezone (msg, "StartTimeZone", tzd);
 					e_ews_message_end_set_item_field (msg);
-
-					/*
-					 * Exchange server is smart enough to return the list of
-					 * ServerTimeZone without repeated elements
-					 */
-					if (tmp->next != NULL)
-						tmp = tmp->next;
 				}
 
-				if (tzid_end != NULL) {
+				tzd = ewscal_find_timezone_definition (tzds, times.msdn_location_end);
+				if (times.tzid_end != NULL && tzd) {
 					e_ews_message_start_set_item_field (msg, "EndTimeZone", "calendar", "CalendarItem");
-					ewscal_set_timezone (msg, "EndTimeZone", tmp->data);
+					ewscal_set_timezone (msg, "EndTimeZone", tzd);
 					e_ews_message_end_set_item_field (msg);
 				}
 			}
@@ -1764,7 +2116,7 @@ convert_vevent_component_to_updatexml (ESoapMessage *msg,
 		e_ews_message_replace_server_version (msg, E_EWS_EXCHANGE_2007_SP1);
 
 		e_ews_message_start_set_item_field (msg, "MeetingTimeZone", "calendar", "CalendarItem");
-		ewscal_set_meeting_timezone (msg, tzid_start ? tzid_start : convert_data->default_zone);
+		ewscal_set_meeting_timezone (msg, times.tzid_start ? times.tzid_start : convert_data->default_zone);
 		e_ews_message_end_set_item_field (msg);
 	}
 
@@ -1975,6 +2327,21 @@ e_cal_backend_ews_convert_component_to_updatexml (ESoapMessage *msg,
 	return success;
 }
 
+/* Returns which of the properties of the 'convert_data->comp' differ from
+   the 'convert_data->old_comp', thus which e_cal_backend_ews_convert_component_to_updatexml()
+   writes. Only the events are compared, the tasks and memos are always saved whole. */
+EwsCalendarChangeFlags
+e_cal_backend_ews_get_component_changes (EwsCalendarConvertData *convert_data)
+{
+	g_return_val_if_fail (convert_data != NULL, EWS_CALENDAR_CHANGE_NONE);
+	g_return_val_if_fail (E_IS_CAL_COMPONENT (convert_data->comp), EWS_CALENDAR_CHANGE_NONE);
+
+	if (icalcomponent_isa (e_cal_component_get_icalcomponent (convert_data->comp)) == ICAL_VEVENT_COMPONENT)
+		return ews_get_vevent_changes (convert_data);
+
+	return EWS_CALENDAR_CHANGE_ALL;
+}
+
 guint
 e_cal_backend_ews_rid_to_index (icaltimezone *timezone,
 				const gchar *rid,
@@ -2147,3 +2514,148 @@ e_cal_backend_ews_get_datetime_with_zone (ETimezoneCache *timezone_cache,
 
 	return dt;
 }
+
+#define X_EWS_ORIGINAL_COMP "X-EWS-ORIGINAL-COMP"
+
+/* The prefix of the compressed original component; it cannot clash
+   with the older, plain base64 encoded, values */
+#define ORIGINAL_COMP_ZLIB_PREFIX "z:"
+
+static GByteArray *
+ews_convert_data (GConverter *converter,
+		  const guchar *data,
+		  gsize data_len)
+{
+	GByteArray *result;
+	GConverterResult res;
+	guchar buffer[4096];
+	gsize bytes_read, bytes_written;
+	GError *local_error = NULL;
+
+	result = g_byte_array_sized_new (data_len / 2 + 1);
+
+	do {
+		res = g_converter_convert (converter, data, data_len, buffer, sizeof (buffer),
+			G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, &local_error);
+
+		if (res == G_CONVERTER_ERROR) {
+			g_warning ("%s: Failed to convert data: %s", G_STRFUNC, local_error ? local_error->message : "Unknown error");
+			g_clear_error (&local_error);
+			g_byte_array_free (result, TRUE);
+
+			return NULL;
+		}
+
+		g_byte_array_append (result, buffer, bytes_written);
+
+		data += bytes_read;
+		data_len -= bytes_read;
+	} while (res != G_CONVERTER_FINISHED);
+
+	return result;
+}
+
+/* Stores the 'comp' itself into its X-EWS-ORIGINAL-COMP property, to be able to
+   recognize what had been changed in it later. The component is compressed,
+   the iCalendar text compresses well and it is saved in the cache with each event. */
+void
+e_cal_backend_ews_store_original_comp (ECalComponent *comp)
+{
+	GConverter *compressor;
+	GByteArray *compressed;
+	gchar *comp_str;
+
+	g_return_if_fail (E_IS_CAL_COMPONENT (comp));
+
+	/* This makes sure it's not saved also in the original component */
+	e_cal_util_remove_x_property (e_cal_component_get_icalcomponent (comp), X_EWS_ORIGINAL_COMP);
+
+	comp_str = e_cal_component_get_as_string (comp);
+	g_return_if_fail (comp_str != NULL);
+
+	compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1));
+	compressed = ews_convert_data (compressor, (const guchar *) comp_str, strlen (comp_str));
+	g_object_unref (compressor);
+
+	if (compressed) {
+		gchar *base64, *value;
+
+		base64 = g_base64_encode (compressed->data, compressed->len);
+		value = g_strconcat (ORIGINAL_COMP_ZLIB_PREFIX, base64, NULL);
+
+		e_cal_util_set_x_property (e_cal_component_get_icalcomponent (comp),
+			X_EWS_ORIGINAL_COMP, value);
+
+		g_byte_array_free (compressed, TRUE);
+		g_free (base64);
+		g_free (value);
+	}
+
+	g_free (comp_str);
+}
+
+/* Returns the component previously stored with e_cal_backend_ews_store_original_comp(),
+   or NULL, when there is none. Free the returned component with g_object_unref(). */
+ECalComponent *
+e_cal_backend_ews_restore_original_comp (ECalComponent *from_comp)
+{
+	ECalComponent *comp = NULL;
+	const gchar *original_base64;
+	guchar *decoded;
+	gsize len = 0;
+
+	g_return_val_if_fail (E_IS_CAL_COMPONENT (from_comp), NULL);
+
+	original_base64 = e_cal_util_get_x_property (e_cal_component_get_icalcomponent (from_comp), X_EWS_ORIGINAL_COMP);
+
+	if (!original_base64 || !*original_base64)
+		return NULL;
+
+	if (g_str_has_prefix (original_base64, ORIGINAL_COMP_ZLIB_PREFIX)) {
+		GConverter *decompressor;
+		GByteArray *decompressed = NULL;
+
+		decoded = g_base64_decode (original_base64 + strlen (ORIGINAL_COMP_ZLIB_PREFIX), &len);
+
+		if (decoded && len > 0) {
+			decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB));
+			decompressed = ews_convert_data (decompressor, decoded, len);
+			g_object_unref (decompressor);
+		}
+
+		g_free (decoded);
+
+		if (!decompressed)
+			return NULL;
+
+		/* Add the NUL-terminator */
+		g_byte_array_append (decompressed, (const guint8 *) "", 1);
+
+		len = decompressed->len;
+		decoded = g_byte_array_free (decompressed, FALSE);
+	} else {
+		/* Stored by older versions, with the NUL-terminator, without compression */
+		decoded = g_base64_decode (original_base64, &len);
+	}
+
+	if (!decoded || !*decoded || len <= 0) {
+		g_free (decoded);
+		return NULL;
+	}
+
+	if (decoded[len - 1] != '\0') {
+		gchar *tmp;
+
+		tmp = g_strndup ((const gchar *) decoded, len);
+
+		g_free (decoded);
+		decoded = (guchar *) tmp;
+	}
+
+	if (decoded && *decoded)
+		comp = e_cal_component_new_from_string ((const gchar *) decoded);
+
+	g_free (decoded);
+
+	return comp;
+}
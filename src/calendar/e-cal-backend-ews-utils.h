@@ -51,11 +51,35 @@ typedef struct {
 	gchar *item_id;
 	gchar *change_key;
 	EEwsItemChangeType change_type;
+	gboolean force_basic_properties; /* write them in UpdateItem even when unchanged */
+	GHashTable *time_zones; /* can be NULL; gchar *msdn_location ~> EEwsCalendarTimeZoneDefinition *, reused between CreateItem calls */
 	gint index;
 	time_t start;
 	time_t end;
 } EwsCalendarConvertData;
 
+/* What the e_cal_backend_ews_convert_component_to_updatexml() writes */
+typedef enum {
+	EWS_CALENDAR_CHANGE_NONE		= 0,
+	EWS_CALENDAR_CHANGE_SUBJECT		= 1 << 0,
+	EWS_CALENDAR_CHANGE_SENSITIVITY		= 1 << 1,
+	EWS_CALENDAR_CHANGE_BODY		= 1 << 2,
+	EWS_CALENDAR_CHANGE_REMINDER		= 1 << 3,
+	EWS_CALENDAR_CHANGE_CATEGORIES		= 1 << 4,
+	EWS_CALENDAR_CHANGE_LOCATION		= 1 << 5,
+	EWS_CALENDAR_CHANGE_FREE_BUSY		= 1 << 6,
+	EWS_CALENDAR_CHANGE_START		= 1 << 7,
+	EWS_CALENDAR_CHANGE_END			= 1 << 8,
+	EWS_CALENDAR_CHANGE_START_TIMEZONE	= 1 << 9,
+	EWS_CALENDAR_CHANGE_END_TIMEZONE	= 1 << 10,
+	EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED	= 1 << 11,
+	EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES	= 1 << 12,
+	EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES	= 1 << 13,
+	EWS_CALENDAR_CHANGE_RESOURCES		= 1 << 14,
+	EWS_CALENDAR_CHANGE_RECURRENCE		= 1 << 15,
+	EWS_CALENDAR_CHANGE_ALL			= (1 << 16) - 1
+} EwsCalendarChangeFlags;
+
 const gchar *e_ews_collect_organizer (icalcomponent *comp);
 void e_ews_collect_attendees (icalcomponent *comp, GSList **required, GSList **optional, GSList **resource, gboolean *out_rsvp_requested);
 
@@ -74,11 +98,15 @@ void e_cal_backend_ews_populate_windows_zones (void);
 void e_cal_backend_ews_unref_windows_zones (void);
 
 gboolean e_cal_backend_ews_convert_calcomp_to_xml (ESoapMessage *msg, gpointer user_data, GError **error);
+EwsCalendarChangeFlags e_cal_backend_ews_get_component_changes (EwsCalendarConvertData *convert_data);
 gboolean e_cal_backend_ews_convert_component_to_updatexml (ESoapMessage *msg, gpointer user_data, GError **error);
 gboolean e_cal_backend_ews_clear_reminder_is_set (ESoapMessage *msg, gpointer user_data, GError **error);
 gboolean e_cal_backend_ews_prepare_set_free_busy_status (ESoapMessage *msg,gpointer user_data, GError **error);
 gboolean e_cal_backend_ews_prepare_accept_item_request (ESoapMessage *msg, gpointer user_data, GError **error);
 
+void e_cal_backend_ews_store_original_comp (ECalComponent *comp);
+ECalComponent *e_cal_backend_ews_restore_original_comp (ECalComponent *from_comp);
+
 guint e_cal_backend_ews_rid_to_index (icaltimezone *timezone, const gchar *rid, icalcomponent *comp, GError **error);
 
 struct icaltimetype
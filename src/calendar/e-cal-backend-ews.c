@@ -72,12 +72,51 @@ struct _ECalBackendEwsPrivate {
 	gboolean is_freebusy_calendar;
 
 	gchar *attachments_dir;
-};
 
-#define X_EWS_ORIGINAL_COMP "X-EWS-ORIGINAL-COMP"
+	GMutex free_busy_lock;
+	GHashTable *free_busy_cache; /* gchar *mailbox ~> GPtrArray { FreeBusyCacheEntry * } */
+
+	GMutex bulk_lock;
+	GHashTable *bulk_created; /* gchar *uid ~> BulkCreated *, events created ahead by the ecb_ews_create_objects_sync() */
+	GHashTable *bulk_loaded; /* gchar *item_id ~> icalcomponent *, their server version, known without fetching it */
+};
 
 #define EWS_MAX_FETCH_COUNT 100
 
+/* How many attachments can be asked for in one GetAttachment request
+   and how many such requests can run at the same time */
+#define EWS_ATTACHMENTS_BATCH_SIZE 50
+#define EWS_ATTACHMENTS_MAX_REQUESTS 4
+
+/* How many GetItem requests for modified occurrences can run at the same time */
+#define EWS_OCCURRENCES_MAX_REQUESTS 4
+
+/* EWS can support only 100 identities, which is the maximum number of identities that the Web service method can request
+   see http://msdn.microsoft.com / en - us / library / aa564001 % 28v = EXCHG.140 % 29.aspx ;
+   larger requests are split into several GetUserAvailability requests, which run at the same time */
+#define EWS_FREE_BUSY_MAX_USERS 100
+#define EWS_FREE_BUSY_MAX_REQUESTS 4
+
+/* For how long, in seconds, the received free/busy information is reused */
+#define EWS_FREE_BUSY_CACHE_TTL 300
+
+/* How many events can be created with one CreateItem request during an import,
+   how many such requests can run at the same time and from how many events
+   the import uses them */
+#define EWS_BULK_CREATE_BATCH_SIZE 50
+#define EWS_BULK_CREATE_MAX_REQUESTS 4
+#define EWS_BULK_CREATE_MIN_ITEMS 10
+
+/* How many items the CalendarView returns at once, when syncing only a window of the calendar */
+#define EWS_WINDOW_SYNC_PAGE_SIZE 500
+
+/* The CalendarView cannot skip items, thus when more than a page of them starts at the same
+   time, the page is enlarged, up to this size, to get past them */
+#define EWS_WINDOW_SYNC_MAX_PAGE_SIZE 8000
+
+/* The cache key, which is set while the rest of the calendar is downloaded after the window sync */
+#define EWS_WINDOW_SYNC_KEY "ews-window-sync-backfill"
+
 #define GET_ITEMS_SYNC_PROPERTIES \
 	"item:Attachments" \
 	" item:Categories" \
@@ -382,8 +421,7 @@ ecb_ews_item_to_component_sync (ECalBackendEws *cbews,
 		/*task assaingments*/
 		if (e_ews_item_get_delegator (item) != NULL) {
 			const gchar *task_owner = e_ews_item_get_delegator (item);
-			GSList *mailboxes = NULL, *l;
-			gboolean includes_last_item;
+			EwsMailbox *mailbox = NULL;
 			gchar *mailtoname, *user_email;
 			icalparameter *param;
 
@@ -400,25 +438,21 @@ ecb_ews_item_to_component_sync (ECalBackendEws *cbews,
 			icalproperty_add_parameter (icalprop, param);
 			icalcomponent_add_property (icalcomp, icalprop);
 
-			/* get delegator mail box*/
-			e_ews_connection_resolve_names_sync (
+			/* get delegator mail box; the same people delegate many tasks, thus use the cached resolution */
+			if (e_ews_connection_resolve_mailbox_cached_sync (
 				cbews->priv->cnc, EWS_PRIORITY_MEDIUM, task_owner,
-				EWS_SEARCH_AD, NULL, FALSE, &mailboxes, NULL,
-				&includes_last_item, cancellable, error);
-
-			for (l = mailboxes; l != NULL; l = g_slist_next (l)) {
-				EwsMailbox *mb = l->data;
-
-				mailtoname = g_strdup_printf ("mailto:%s", mb->email);
+				&mailbox, cancellable, error)) {
+				mailtoname = g_strdup_printf ("mailto:%s", mailbox->email);
 				icalprop = icalproperty_new_organizer (mailtoname);
-				param = icalparameter_new_cn (mb->name);
-				icalproperty_add_parameter (icalprop, param);
+				if (mailbox->name) {
+					param = icalparameter_new_cn (mailbox->name);
+					icalproperty_add_parameter (icalprop, param);
+				}
 				icalcomponent_add_property (icalcomp, icalprop);
 
 				g_free (mailtoname);
-				e_ews_mailbox_free (mb);
+				e_ews_mailbox_free (mailbox);
 			}
-			g_slist_free (mailboxes);
 		}
 
 		if (item_type == E_EWS_ITEM_TYPE_TASK) {
@@ -922,198 +956,410 @@ ecb_ews_item_to_component_sync (ECalBackendEws *cbews,
 
 	icalcomponent_free (vcomp);
 
-	if (res_component) {
-		const GSList *attachment_ids, *aid, *l;
-		const gchar *uid = NULL;
-		GSList *info_attachments = NULL, *uris = NULL;
-		gboolean has_attachment = FALSE;
+	return res_component;
+}
 
-		e_ews_item_has_attachments (item, &has_attachment);
-		if (!has_attachment)
-			return res_component;
+typedef struct _CompAttachments {
+	ECalComponent *comp; /* not referenced */
+	const GSList *attachment_ids; /* gchar *, owned by the EEwsItem */
+} CompAttachments;
+
+typedef struct _AttachmentsBatch {
+	GHashTable *attachment_uids; /* gchar *attachment id ~> gchar *comp uid */
+	GSList *comp_attachments; /* CompAttachments *, not owned */
+	GSList *infos; /* EEwsAttachmentInfo * */
+	gboolean success;
+} AttachmentsBatch;
 
-		e_cal_component_get_uid (res_component, &uid);
+static void
+ecb_ews_attachments_batch_free (gpointer ptr)
+{
+	AttachmentsBatch *batch = ptr;
 
-		attachment_ids = e_ews_item_get_attachments_ids (item);
+	if (batch) {
+		g_hash_table_unref (batch->attachment_uids);
+		g_slist_free (batch->comp_attachments);
+		g_slist_free_full (batch->infos, (GDestroyNotify) e_ews_attachment_info_free);
+		g_free (batch);
+	}
+}
 
-		if (e_ews_connection_get_attachments_sync (
-			cbews->priv->cnc,
-			EWS_PRIORITY_MEDIUM,
-			uid,
-			attachment_ids,
-			cbews->priv->attachments_dir,
-			TRUE,
-			&info_attachments,
-			NULL, NULL,
-			cancellable,
-			NULL)) {
-			icalcomponent *icalcomp;
-			icalproperty *icalprop;
-			icalparameter *icalparam;
+static void
+ecb_ews_attachments_batch_done (GObject *source_object,
+				GAsyncResult *result,
+				gpointer batch_ptr,
+				gpointer user_data)
+{
+	AttachmentsBatch *batch = batch_ptr;
+	GError *local_error = NULL;
 
-			for (l = info_attachments; l; l = l->next) {
-				EEwsAttachmentInfo *info = l->data;
+	batch->success = e_ews_connection_get_attachments_finish (E_EWS_CONNECTION (source_object), result, &batch->infos, &local_error);
 
-				/* ignore non-uri attachments, because it's an exception */
-				if (e_ews_attachment_info_get_type (info) == E_EWS_ATTACHMENT_INFO_TYPE_URI) {
-					const gchar *uri = e_ews_attachment_info_get_uri (info);
+	if (local_error) {
+		g_debug ("%s: Failed to get attachments: %s", G_STRFUNC, local_error->message);
+		g_clear_error (&local_error);
+	}
+}
 
-					if (uri)
-						uris = g_slist_append (uris, g_strdup (uri));
-				}
-			}
+static void
+ecb_ews_attachments_batch_start (gpointer batch_ptr,
+				 gpointer user_data,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	AttachmentsBatch *batch = batch_ptr;
+	ECalBackendEws *cbews = user_data;
 
-			e_cal_component_set_attachment_list (res_component, uris);
+	e_ews_connection_get_attachments_for_uids (
+		cbews->priv->cnc,
+		EWS_PRIORITY_MEDIUM,
+		batch->attachment_uids,
+		cbews->priv->attachments_dir,
+		TRUE,
+		cancellable,
+		callback,
+		callback_data);
+}
 
-			icalcomp = e_cal_component_get_icalcomponent (res_component);
-			icalprop = icalcomponent_get_first_property (icalcomp, ICAL_ATTACH_PROPERTY);
-			for (aid = attachment_ids; aid && icalprop; aid = aid->next, icalprop = icalcomponent_get_next_property (icalcomp, ICAL_ATTACH_PROPERTY)) {
-				icalparam = icalparameter_new_x (aid->data);
-				icalparameter_set_xname (icalparam, "X-EWS-ATTACHMENTID");
-				icalproperty_add_parameter (icalprop, icalparam);
-			}
+static void
+ecb_ews_set_component_attachments (CompAttachments *ca,
+				   GHashTable *infos) /* gchar *attachment id ~> EEwsAttachmentInfo * */
+{
+	icalcomponent *icalcomp;
+	icalproperty *icalprop;
+	GSList *uris = NULL, *uri_ids = NULL, *link;
+	const GSList *aid;
+
+	for (aid = ca->attachment_ids; aid; aid = g_slist_next (aid)) {
+		EEwsAttachmentInfo *info = g_hash_table_lookup (infos, aid->data);
 
-			g_slist_free_full (uris, g_free);
-			g_slist_free_full (info_attachments, (GDestroyNotify) e_ews_attachment_info_free);
+		/* ignore non-uri attachments, because it's an exception */
+		if (info && e_ews_attachment_info_get_type (info) == E_EWS_ATTACHMENT_INFO_TYPE_URI) {
+			const gchar *uri = e_ews_attachment_info_get_uri (info);
+
+			if (uri) {
+				uris = g_slist_prepend (uris, g_strdup (uri));
+				uri_ids = g_slist_prepend (uri_ids, aid->data);
+			}
 		}
 	}
 
-	return res_component;
+	uris = g_slist_reverse (uris);
+	uri_ids = g_slist_reverse (uri_ids);
+
+	e_cal_component_set_attachment_list (ca->comp, uris);
+
+	icalcomp = e_cal_component_get_icalcomponent (ca->comp);
+	icalprop = icalcomponent_get_first_property (icalcomp, ICAL_ATTACH_PROPERTY);
+	for (link = uri_ids; link && icalprop; link = g_slist_next (link), icalprop = icalcomponent_get_next_property (icalcomp, ICAL_ATTACH_PROPERTY)) {
+		icalparameter *icalparam;
+
+		icalparam = icalparameter_new_x (link->data);
+		icalparameter_set_xname (icalparam, "X-EWS-ATTACHMENTID");
+		icalproperty_add_parameter (icalprop, icalparam);
+	}
+
+	g_slist_free_full (uris, g_free);
+	g_slist_free (uri_ids);
 }
 
+/* Downloads attachments of all the components at once, with a few concurrent
+   GetAttachment requests, each covering attachments of several components. */
 static void
-ecb_ews_store_original_comp (ECalComponent *comp)
+ecb_ews_fetch_attachments_sync (ECalBackendEws *cbews,
+				GSList *comp_attachments, /* CompAttachments * */
+				GCancellable *cancellable)
 {
-	gchar *comp_str;
-	gchar *base64;
+	AttachmentsBatch *batch = NULL;
+	GSList *batches = NULL, *link;
+	GHashTable *infos;
 
-	g_return_if_fail (E_IS_CAL_COMPONENT (comp));
+	for (link = comp_attachments; link; link = g_slist_next (link)) {
+		CompAttachments *ca = link->data;
+		const GSList *aid;
+		const gchar *uid = NULL;
+
+		/* Keep attachments of one component in the same batch */
+		if (batch && g_hash_table_size (batch->attachment_uids) + g_slist_length ((GSList *) ca->attachment_ids) > EWS_ATTACHMENTS_BATCH_SIZE)
+			batch = NULL;
+
+		if (!batch) {
+			batch = g_new0 (AttachmentsBatch, 1);
+			batch->attachment_uids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+			batches = g_slist_prepend (batches, batch);
+		}
+
+		e_cal_component_get_uid (ca->comp, &uid);
+
+		for (aid = ca->attachment_ids; aid; aid = g_slist_next (aid)) {
+			g_hash_table_insert (batch->attachment_uids, g_strdup (aid->data), g_strdup (uid));
+		}
+
+		batch->comp_attachments = g_slist_prepend (batch->comp_attachments, ca);
+	}
+
+	batches = g_slist_reverse (batches);
+
+	e_ews_connection_utils_run_batches_sync (batches, EWS_ATTACHMENTS_MAX_REQUESTS,
+		ecb_ews_attachments_batch_start, ecb_ews_attachments_batch_done, cbews, cancellable);
 
-	/* This makes sure it's not saved also in the original component */
-	e_cal_util_remove_x_property (e_cal_component_get_icalcomponent (comp), X_EWS_ORIGINAL_COMP);
+	infos = g_hash_table_new (g_str_hash, g_str_equal);
 
-	comp_str = e_cal_component_get_as_string (comp);
-	g_return_if_fail (comp_str != NULL);
+	for (link = batches; link; link = g_slist_next (link)) {
+		GSList *ilink;
 
-	/* Include NUL-terminator */
-	base64 = g_base64_encode ((const guchar *) comp_str, strlen (comp_str) + 1);
+		batch = link->data;
+
+		if (!batch->success)
+			continue;
+
+		for (ilink = batch->infos; ilink; ilink = g_slist_next (ilink)) {
+			EEwsAttachmentInfo *info = ilink->data;
+			const gchar *id = e_ews_attachment_info_get_id (info);
+
+			if (id)
+				g_hash_table_insert (infos, (gpointer) id, info);
+		}
+
+		for (ilink = batch->comp_attachments; ilink; ilink = g_slist_next (ilink)) {
+			CompAttachments *ca = ilink->data;
+
+			ecb_ews_set_component_attachments (ca, infos);
+		}
 
-	e_cal_util_set_x_property (e_cal_component_get_icalcomponent (comp),
-		X_EWS_ORIGINAL_COMP, base64);
+		g_hash_table_remove_all (infos);
+	}
 
-	g_free (base64);
-	g_free (comp_str);
+	g_hash_table_destroy (infos);
+	g_slist_free_full (batches, ecb_ews_attachments_batch_free);
 }
 
-static ECalComponent * /* free with g_object_unref(), if not NULL */
-ecb_ews_restore_original_comp (ECalComponent *from_comp)
+static gboolean ecb_ews_items_to_components_sync (ECalBackendEws *cbews,
+						  GSList *items, /* EEwsItem * */
+						  GSList **out_components, /* ECalComponent * */
+						  GCancellable *cancellable,
+						  GError **error);
+
+/* Moves the 'received' items of a GetItem request for the 'item_ids' into
+   the 'inout_items', except of those, which the server did not process, because
+   it stopped processing the request; their IDs are added into the 'inout_retry_ids'. */
+static void
+ecb_ews_split_received_items (const GSList *item_ids, /* gchar * */
+			      GSList *received, /* EEwsItem * */
+			      GSList **inout_items, /* EEwsItem * */
+			      GSList **inout_retry_ids) /* gchar * */
 {
-	ECalComponent *comp = NULL;
-	const gchar *original_base64;
-	guchar *decoded;
-	gsize len = -1;
+	GSList *link, *ids_link;
 
-	g_return_val_if_fail (E_IS_CAL_COMPONENT (from_comp), NULL);
+	for (link = received, ids_link = (GSList *) item_ids; link && ids_link; link = g_slist_next (link), ids_link = g_slist_next (ids_link)) {
+		EEwsItem *item = link->data;
 
-	original_base64 = e_cal_util_get_x_property (e_cal_component_get_icalcomponent (from_comp), X_EWS_ORIGINAL_COMP);
+		if (!item)
+			continue;
 
-	if (!original_base64 || !*original_base64)
-		return NULL;
+		if (e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR) {
+			const GError *item_error;
 
-	decoded = g_base64_decode (original_base64, &len);
-	if (!decoded || !*decoded || len <= 0) {
-		g_free (decoded);
-		return NULL;
+			item_error = e_ews_item_get_error (item);
+			if (g_error_matches (item_error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_BATCHPROCESSINGSTOPPED)) {
+				*inout_retry_ids = g_slist_prepend (*inout_retry_ids, g_strdup (ids_link->data));
+				g_object_unref (item);
+			} else {
+				*inout_items = g_slist_prepend (*inout_items, item);
+			}
+		} else {
+			*inout_items = g_slist_prepend (*inout_items, item);
+		}
+
+		link->data = NULL;
 	}
 
-	if (decoded[len - 1] != '\0') {
-		gchar *tmp;
+	g_slist_free_full (received, g_object_unref);
+}
+
+typedef struct _OccurrencesRequests {
+	ECalBackendEws *cbews;
+	EEwsAdditionalProps *add_props;
+} OccurrencesRequests;
+
+typedef struct _OccurrencesBatch {
+	GSList *ids; /* gchar * */
+	guint n_ids;
+	GSList *received; /* EEwsItem * */
+	GError *error;
+} OccurrencesBatch;
 
-		tmp = g_strndup ((const gchar *) decoded, len);
+static void
+ecb_ews_occurrences_batch_free (gpointer ptr)
+{
+	OccurrencesBatch *batch = ptr;
 
-		g_free (decoded);
-		decoded = (guchar *) tmp;
+	if (batch) {
+		g_slist_free_full (batch->ids, g_free);
+		g_slist_free_full (batch->received, g_object_unref);
+		g_clear_error (&batch->error);
+		g_free (batch);
 	}
+}
+
+static void
+ecb_ews_occurrences_batch_done (GObject *source_object,
+				GAsyncResult *result,
+				gpointer batch_ptr,
+				gpointer user_data)
+{
+	OccurrencesBatch *batch = batch_ptr;
 
-	if (decoded && *decoded)
-		comp = e_cal_component_new_from_string ((const gchar *) decoded);
+	e_ews_connection_get_items_finish (E_EWS_CONNECTION (source_object), result, &batch->received, &batch->error);
+}
 
-	g_free (decoded);
+static void
+ecb_ews_occurrences_batch_start (gpointer batch_ptr,
+				 gpointer user_data,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	OccurrencesBatch *batch = batch_ptr;
+	OccurrencesRequests *requests = user_data;
 
-	return comp;
+	e_ews_connection_get_items (
+		requests->cbews->priv->cnc,
+		EWS_PRIORITY_MEDIUM,
+		batch->ids,
+		"IdOnly",
+		requests->add_props,
+		FALSE,
+		NULL,
+		E_EWS_BODY_TYPE_TEXT,
+		NULL, NULL,
+		cancellable,
+		callback,
+		callback_data);
 }
 
+/* Fetches the modified occurrences of several recurring series, with GetItem
+   requests shared between the series. The requests run concurrently, but they
+   all finish in this thread, thus the conversion to components, which uses
+   the backend's time zone cache, is never done in parallel. */
 static gboolean
-ecb_ews_get_items_sync (ECalBackendEws *cbews,
-			const GSList *item_ids, /* gchar * */
-			const gchar *default_props,
-			const EEwsAdditionalProps *add_props,
-			GSList **out_components, /* ECalComponent * */
-			GCancellable *cancellable,
-			GError **error)
+ecb_ews_get_occurrences_sync (ECalBackendEws *cbews,
+			      GSList *occurrence_ids, /* const gchar * */
+			      GSList **out_components, /* ECalComponent * */
+			      GCancellable *cancellable,
+			      GError **error)
 {
-	GSList *items = NULL, *link, *retry_ids = NULL;
+	OccurrencesRequests requests;
+	GSList *ids = NULL, *items = NULL, *link;
 	gboolean success = TRUE;
 
-	g_return_val_if_fail (E_IS_CAL_BACKEND_EWS (cbews), FALSE);
-	g_return_val_if_fail (out_components != NULL, FALSE);
+	requests.cbews = cbews;
+	requests.add_props = e_ews_additional_props_new ();
+	if (e_ews_connection_satisfies_server_version (cbews->priv->cnc, E_EWS_EXCHANGE_2010)) {
+		EEwsExtendedFieldURI *ext_uri;
 
-	while (success = success && !g_cancellable_set_error_if_cancelled (cancellable, error), success) {
-		GSList *received = NULL, *new_retry_ids = NULL, *ids_link;
+		requests.add_props->field_uri = g_strdup (GET_ITEMS_SYNC_PROPERTIES_2010);
 
-		success = e_ews_connection_get_items_sync (
-			cbews->priv->cnc,
-			EWS_PRIORITY_MEDIUM,
-			item_ids,
-			default_props,
-			add_props,
-			FALSE,
-			NULL,
-			E_EWS_BODY_TYPE_TEXT,
-			&received,
-			NULL, NULL,
-			cancellable,
-			error);
+		ext_uri = e_ews_extended_field_uri_new ();
+		ext_uri->distinguished_prop_set_id = g_strdup ("PublicStrings");
+		ext_uri->prop_name = g_strdup ("EvolutionEWSStartTimeZone");
+		ext_uri->prop_type = g_strdup ("String");
+		requests.add_props->extended_furis = g_slist_append (requests.add_props->extended_furis, ext_uri);
 
-		for (link = received, ids_link = (GSList *) item_ids; success && link && ids_link; link = g_slist_next (link), ids_link = g_slist_next (ids_link)) {
-			EEwsItem *item = link->data;
+		ext_uri = e_ews_extended_field_uri_new ();
+		ext_uri->distinguished_prop_set_id = g_strdup ("PublicStrings");
+		ext_uri->prop_name = g_strdup ("EvolutionEWSEndTimeZone");
+		ext_uri->prop_type = g_strdup ("String");
+		requests.add_props->extended_furis = g_slist_append (requests.add_props->extended_furis, ext_uri);
+	} else {
+		requests.add_props->field_uri = g_strdup (GET_ITEMS_SYNC_PROPERTIES_2007);
+	}
 
-			if (!item)
-				continue;
+	for (link = occurrence_ids; link; link = g_slist_next (link)) {
+		ids = g_slist_prepend (ids, g_strdup (link->data));
+	}
 
-			if (e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR) {
-				const GError *item_error;
+	ids = g_slist_reverse (ids);
 
-				item_error = e_ews_item_get_error (item);
-				if (g_error_matches (item_error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_BATCHPROCESSINGSTOPPED)) {
-					new_retry_ids = g_slist_prepend (new_retry_ids, g_strdup (ids_link->data));
-					g_object_unref (item);
-				} else {
-					items = g_slist_prepend (items, item);
-				}
-			} else {
-				items = g_slist_prepend (items, item);
+	/* Repeat for the IDs the server stopped processing at */
+	while (ids && success) {
+		OccurrencesBatch *batch = NULL;
+		GSList *batches = NULL, *retry_ids = NULL;
+
+		/* Split the ids at the server limit */
+		for (link = ids; link; link = g_slist_next (link)) {
+			if (!batch || batch->n_ids >= EWS_MAX_FETCH_COUNT) {
+				batch = g_new0 (OccurrencesBatch, 1);
+				batches = g_slist_prepend (batches, batch);
 			}
+
+			batch->ids = g_slist_prepend (batch->ids, link->data);
+			batch->n_ids++;
+
+			link->data = NULL;
 		}
 
-		g_slist_free_full (retry_ids, g_free);
-		g_slist_free (received);
-		retry_ids = new_retry_ids;
+		g_slist_free (ids);
+		ids = NULL;
 
-		if (!retry_ids)
-			break;
+		batches = g_slist_reverse (batches);
 
-		item_ids = retry_ids;
+		e_ews_connection_utils_run_batches_sync (batches, EWS_OCCURRENCES_MAX_REQUESTS,
+			ecb_ews_occurrences_batch_start, ecb_ews_occurrences_batch_done, &requests, cancellable);
+
+		for (link = batches; link; link = g_slist_next (link)) {
+			batch = link->data;
+
+			if (batch->error) {
+				if (success)
+					g_propagate_error (error, g_error_copy (batch->error));
+
+				success = FALSE;
+			} else if (success) {
+				ecb_ews_split_received_items (batch->ids, batch->received, &items, &retry_ids);
+				batch->received = NULL;
+			}
+		}
+
+		g_slist_free_full (batches, ecb_ews_occurrences_batch_free);
+
+		if (success && g_cancellable_set_error_if_cancelled (cancellable, error))
+			success = FALSE;
+
+		if (success)
+			ids = retry_ids;
+		else
+			g_slist_free_full (retry_ids, g_free);
 	}
 
-	g_slist_free_full (retry_ids, g_free);
+	g_slist_free_full (ids, g_free);
 
 	items = g_slist_reverse (items);
 
-	if (!success)
-		goto exit;
+	if (success)
+		success = ecb_ews_items_to_components_sync (cbews, items, out_components, cancellable, error);
+
+	g_slist_free_full (items, g_object_unref);
+	e_ews_additional_props_free (requests.add_props);
+
+	return success;
+}
+
+/* Converts the 'items' into components, including their modified occurrences
+   and attachments, which are fetched for all the items together. The 'items'
+   are left untouched. */
+static gboolean
+ecb_ews_items_to_components_sync (ECalBackendEws *cbews,
+				  GSList *items, /* EEwsItem * */
+				  GSList **out_components, /* ECalComponent * */
+				  GCancellable *cancellable,
+				  GError **error)
+{
+	GSList *link, *components = NULL, *comp_attachments = NULL, *occurrence_ids = NULL;
+	gboolean success = TRUE;
 
-	/* fetch modified occurrences */
+	/* fetch modified occurrences of all the items together */
 	for (link = items; link; link = g_slist_next (link)) {
 		EEwsItem *item = link->data;
 		const GSList *modified_occurrences;
@@ -1122,42 +1368,23 @@ ecb_ews_get_items_sync (ECalBackendEws *cbews,
 			continue;
 
 		modified_occurrences = e_ews_item_get_modified_occurrences (item);
-		if (modified_occurrences) {
-			EEwsAdditionalProps *modified_add_props;
-
-			modified_add_props = e_ews_additional_props_new ();
-			if (e_ews_connection_satisfies_server_version (cbews->priv->cnc, E_EWS_EXCHANGE_2010)) {
-				EEwsExtendedFieldURI *ext_uri;
-
-				modified_add_props->field_uri = g_strdup (GET_ITEMS_SYNC_PROPERTIES_2010);
-
-				ext_uri = e_ews_extended_field_uri_new ();
-				ext_uri->distinguished_prop_set_id = g_strdup ("PublicStrings");
-				ext_uri->prop_name = g_strdup ("EvolutionEWSStartTimeZone");
-				ext_uri->prop_type = g_strdup ("String");
-				modified_add_props->extended_furis = g_slist_append (modified_add_props->extended_furis, ext_uri);
-
-				ext_uri = e_ews_extended_field_uri_new ();
-				ext_uri->distinguished_prop_set_id = g_strdup ("PublicStrings");
-				ext_uri->prop_name = g_strdup ("EvolutionEWSEndTimeZone");
-				ext_uri->prop_type = g_strdup ("String");
-				modified_add_props->extended_furis = g_slist_append (modified_add_props->extended_furis, ext_uri);
-			} else {
-				modified_add_props->field_uri = g_strdup (GET_ITEMS_SYNC_PROPERTIES_2007);
-			}
+		if (modified_occurrences)
+			occurrence_ids = g_slist_concat (occurrence_ids, g_slist_copy ((GSList *) modified_occurrences));
+	}
 
-			success = ecb_ews_get_items_sync (cbews, modified_occurrences, "IdOnly", modified_add_props, out_components, cancellable, error);
+	if (occurrence_ids) {
+		success = ecb_ews_get_occurrences_sync (cbews, occurrence_ids, out_components, cancellable, error);
 
-			e_ews_additional_props_free (modified_add_props);
+		g_slist_free (occurrence_ids);
 
-			if (!success)
-				goto exit;
-		}
+		if (!success)
+			return FALSE;
 	}
 
 	for (link = items; link; link = g_slist_next (link)) {
 		EEwsItem *item = link->data;
 		ECalComponent *comp;
+		gboolean has_attachment = FALSE;
 		GError *local_error = NULL;
 
 		if (!item || e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR)
@@ -1173,12 +1400,101 @@ ecb_ews_get_items_sync (ECalBackendEws *cbews,
 			break;
 		}
 
-		ecb_ews_store_original_comp (comp);
+		e_ews_item_has_attachments (item, &has_attachment);
+		if (has_attachment && e_ews_item_get_attachments_ids (item)) {
+			CompAttachments *ca;
+
+			ca = g_new0 (CompAttachments, 1);
+			ca->comp = comp;
+			ca->attachment_ids = e_ews_item_get_attachments_ids (item);
+
+			comp_attachments = g_slist_prepend (comp_attachments, ca);
+		}
 
-		*out_components = g_slist_prepend (*out_components, comp);
+		components = g_slist_prepend (components, comp);
 	}
 
- exit:
+	/* Fetch attachments for all the items together, not one by one */
+	if (success && comp_attachments) {
+		comp_attachments = g_slist_reverse (comp_attachments);
+
+		ecb_ews_fetch_attachments_sync (cbews, comp_attachments, cancellable);
+	}
+
+	if (success) {
+		components = g_slist_reverse (components);
+
+		for (link = components; link; link = g_slist_next (link)) {
+			ECalComponent *comp = link->data;
+
+			e_cal_backend_ews_store_original_comp (comp);
+
+			*out_components = g_slist_prepend (*out_components, comp);
+		}
+
+		g_slist_free (components);
+	} else {
+		g_slist_free_full (components, g_object_unref);
+	}
+
+	g_slist_free_full (comp_attachments, g_free);
+
+	return success;
+}
+
+static gboolean
+ecb_ews_get_items_sync (ECalBackendEws *cbews,
+			const GSList *item_ids, /* gchar * */
+			const gchar *default_props,
+			const EEwsAdditionalProps *add_props,
+			GSList **out_components, /* ECalComponent * */
+			GCancellable *cancellable,
+			GError **error)
+{
+	GSList *items = NULL, *retry_ids = NULL;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (E_IS_CAL_BACKEND_EWS (cbews), FALSE);
+	g_return_val_if_fail (out_components != NULL, FALSE);
+
+	while (success = success && !g_cancellable_set_error_if_cancelled (cancellable, error), success) {
+		GSList *received = NULL, *new_retry_ids = NULL;
+
+		success = e_ews_connection_get_items_sync (
+			cbews->priv->cnc,
+			EWS_PRIORITY_MEDIUM,
+			item_ids,
+			default_props,
+			add_props,
+			FALSE,
+			NULL,
+			E_EWS_BODY_TYPE_TEXT,
+			&received,
+			NULL, NULL,
+			cancellable,
+			error);
+
+		if (success)
+			ecb_ews_split_received_items (item_ids, received, &items, &new_retry_ids);
+		else
+			g_slist_free_full (received, g_object_unref);
+
+		g_slist_free_full (retry_ids, g_free);
+		retry_ids = new_retry_ids;
+
+		if (!retry_ids)
+			break;
+
+		item_ids = retry_ids;
+	}
+
+	g_slist_free_full (retry_ids, g_free);
+
+	items = g_slist_reverse (items);
+
+	if (success)
+		success = ecb_ews_items_to_components_sync (cbews, items, out_components, cancellable, error);
+
 	g_slist_free_full (items, g_object_unref);
 
 	return success;
@@ -1244,9 +1560,339 @@ ecb_ews_fetch_items_sync (ECalBackendEws *cbews,
 	return success;
 }
 
-static gboolean
-ecb_ews_freebusy_ecomp_changed (ECalComponent *ecomp,
-				icalcomponent *vevent)
+typedef struct _FreeBusyCacheEntry {
+	time_t start;
+	time_t end;
+	gint64 expires; /* in g_get_monotonic_time() units */
+	icalcomponent *vfreebusy;
+} FreeBusyCacheEntry;
+
+static void
+ecb_ews_free_busy_cache_entry_free (gpointer ptr)
+{
+	FreeBusyCacheEntry *entry = ptr;
+
+	if (entry) {
+		icalcomponent_free (entry->vfreebusy);
+		g_free (entry);
+	}
+}
+
+static gboolean
+ecb_ews_free_busy_prop_in_window (icalproperty *prop,
+				  time_t start,
+				  time_t end)
+{
+	icaltimezone *utc_zone = icaltimezone_get_utc_timezone ();
+	struct icalperiodtype period;
+
+	period = icalproperty_get_freebusy (prop);
+
+	return icaltime_as_timet_with_zone (period.start, utc_zone) < end &&
+	       icaltime_as_timet_with_zone (period.end, utc_zone) > start;
+}
+
+/* Removes expired entries for the 'mailbox' and returns the array of the remaining,
+   or NULL, when there is none; the 'free_busy_lock' should be held when calling this */
+static GPtrArray * /* FreeBusyCacheEntry *, owned by the cache */
+ecb_ews_free_busy_cache_get_entries_locked (ECalBackendEws *cbews,
+					    const gchar *mailbox)
+{
+	GPtrArray *entries;
+	gint64 now = g_get_monotonic_time ();
+	guint ii;
+
+	entries = g_hash_table_lookup (cbews->priv->free_busy_cache, mailbox);
+	if (!entries)
+		return NULL;
+
+	for (ii = entries->len; ii > 0; ii--) {
+		FreeBusyCacheEntry *entry = g_ptr_array_index (entries, ii - 1);
+
+		if (entry->expires <= now)
+			g_ptr_array_remove_index (entries, ii - 1);
+	}
+
+	if (!entries->len) {
+		g_hash_table_remove (cbews->priv->free_busy_cache, mailbox);
+		entries = NULL;
+	}
+
+	return entries;
+}
+
+/* Returns a new VFREEBUSY component with the cached information for the 'mailbox',
+   when the cache covers the whole <start, end> window, or NULL otherwise */
+static icalcomponent *
+ecb_ews_free_busy_cache_lookup (ECalBackendEws *cbews,
+				const gchar *mailbox,
+				time_t start,
+				time_t end)
+{
+	icalcomponent *vfreebusy = NULL;
+	GPtrArray *entries;
+	gchar *key;
+	guint ii;
+
+	key = g_ascii_strdown (mailbox, -1);
+
+	g_mutex_lock (&cbews->priv->free_busy_lock);
+
+	entries = ecb_ews_free_busy_cache_get_entries_locked (cbews, key);
+
+	for (ii = 0; entries && ii < entries->len && !vfreebusy; ii++) {
+		FreeBusyCacheEntry *entry = g_ptr_array_index (entries, ii);
+		icalproperty *prop;
+
+		if (entry->start > start || entry->end < end)
+			continue;
+
+		vfreebusy = icalcomponent_new_vfreebusy ();
+
+		for (prop = icalcomponent_get_first_property (entry->vfreebusy, ICAL_FREEBUSY_PROPERTY);
+		     prop;
+		     prop = icalcomponent_get_next_property (entry->vfreebusy, ICAL_FREEBUSY_PROPERTY)) {
+			if (ecb_ews_free_busy_prop_in_window (prop, start, end))
+				icalcomponent_add_property (vfreebusy, icalproperty_new_clone (prop));
+		}
+	}
+
+	g_mutex_unlock (&cbews->priv->free_busy_lock);
+
+	g_free (key);
+
+	return vfreebusy;
+}
+
+/* Stores a copy of the 'vfreebusy', received for the <start, end> window, into the cache,
+   merging it with the cached windows it overlaps with or adjoins to */
+static void
+ecb_ews_free_busy_cache_store (ECalBackendEws *cbews,
+			       const gchar *mailbox,
+			       time_t start,
+			       time_t end,
+			       icalcomponent *vfreebusy)
+{
+	FreeBusyCacheEntry *entry;
+	GPtrArray *entries;
+	gchar *key;
+	guint ii;
+
+	entry = g_new0 (FreeBusyCacheEntry, 1);
+	entry->start = start;
+	entry->end = end;
+	entry->expires = g_get_monotonic_time () + EWS_FREE_BUSY_CACHE_TTL * G_USEC_PER_SEC;
+	entry->vfreebusy = icalcomponent_new_clone (vfreebusy);
+
+	key = g_ascii_strdown (mailbox, -1);
+
+	g_mutex_lock (&cbews->priv->free_busy_lock);
+
+	entries = ecb_ews_free_busy_cache_get_entries_locked (cbews, key);
+	if (!entries) {
+		entries = g_ptr_array_new_with_free_func (ecb_ews_free_busy_cache_entry_free);
+		g_hash_table_insert (cbews->priv->free_busy_cache, g_strdup (key), entries);
+	}
+
+	for (ii = entries->len; ii > 0; ii--) {
+		FreeBusyCacheEntry *old_entry = g_ptr_array_index (entries, ii - 1);
+		icalproperty *prop;
+
+		if (old_entry->end < start || old_entry->start > end)
+			continue;
+
+		/* The new information supersedes everything the old had within the new window */
+		for (prop = icalcomponent_get_first_property (old_entry->vfreebusy, ICAL_FREEBUSY_PROPERTY);
+		     prop;
+		     prop = icalcomponent_get_next_property (old_entry->vfreebusy, ICAL_FREEBUSY_PROPERTY)) {
+			if (!ecb_ews_free_busy_prop_in_window (prop, start, end))
+				icalcomponent_add_property (entry->vfreebusy, icalproperty_new_clone (prop));
+		}
+
+		entry->start = MIN (entry->start, old_entry->start);
+		entry->end = MAX (entry->end, old_entry->end);
+		entry->expires = MIN (entry->expires, old_entry->expires);
+
+		g_ptr_array_remove_index (entries, ii - 1);
+	}
+
+	g_ptr_array_add (entries, entry);
+
+	g_mutex_unlock (&cbews->priv->free_busy_lock);
+
+	g_free (key);
+}
+
+typedef struct _FreeBusyRequests {
+	ECalBackendEws *cbews;
+	gint pri;
+} FreeBusyRequests;
+
+typedef struct _FreeBusyBatch {
+	EEWSFreeBusyData fbdata;
+	guint n_users;
+	GSList *free_busy; /* icalcomponent * */
+	GError *error;
+} FreeBusyBatch;
+
+static void
+ecb_ews_free_busy_batch_free (gpointer ptr)
+{
+	FreeBusyBatch *batch = ptr;
+
+	if (batch) {
+		GSList *link;
+
+		for (link = batch->free_busy; link; link = g_slist_next (link)) {
+			if (link->data)
+				icalcomponent_free (link->data);
+		}
+
+		g_slist_free (batch->fbdata.user_mails);
+		g_slist_free (batch->free_busy);
+		g_clear_error (&batch->error);
+		g_free (batch);
+	}
+}
+
+static void
+ecb_ews_free_busy_batch_done (GObject *source_object,
+			      GAsyncResult *result,
+			      gpointer batch_ptr,
+			      gpointer user_data)
+{
+	FreeBusyBatch *batch = batch_ptr;
+
+	e_ews_connection_get_free_busy_finish (E_EWS_CONNECTION (source_object), result, &batch->free_busy, &batch->error);
+}
+
+static void
+ecb_ews_free_busy_batch_start (gpointer batch_ptr,
+			       gpointer user_data,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data)
+{
+	FreeBusyBatch *batch = batch_ptr;
+	FreeBusyRequests *fbr = user_data;
+
+	e_ews_connection_get_free_busy (
+		fbr->cbews->priv->cnc,
+		fbr->pri,
+		e_ews_cal_utils_prepare_free_busy_request,
+		&batch->fbdata,
+		cancellable,
+		callback,
+		callback_data);
+}
+
+/* Gets free/busy information for all the fbdata->user_mails, using the cached
+   information where possible; the rest is asked for with as many concurrent
+   GetUserAvailability requests as needed to not exceed the server limit. */
+static gboolean
+ecb_ews_get_free_busy_data_sync (ECalBackendEws *cbews,
+				 gint pri,
+				 const EEWSFreeBusyData *fbdata,
+				 GHashTable **out_free_busy, /* gchar *mailbox ~> icalcomponent *VFREEBUSY */
+				 GCancellable *cancellable,
+				 GError **error)
+{
+	FreeBusyRequests fbr;
+	FreeBusyBatch *batch = NULL;
+	GSList *batches = NULL, *link;
+	GHashTable *free_busy;
+	GError *local_error = NULL;
+
+	g_return_val_if_fail (fbdata != NULL, FALSE);
+	g_return_val_if_fail (out_free_busy != NULL, FALSE);
+
+	free_busy = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) icalcomponent_free);
+
+	for (link = fbdata->user_mails; link; link = g_slist_next (link)) {
+		const gchar *mailbox = link->data;
+		icalcomponent *vfreebusy;
+
+		if (!mailbox || g_hash_table_contains (free_busy, mailbox))
+			continue;
+
+		vfreebusy = ecb_ews_free_busy_cache_lookup (cbews, mailbox, fbdata->period_start, fbdata->period_end);
+		if (vfreebusy) {
+			g_hash_table_insert (free_busy, g_strdup (mailbox), vfreebusy);
+			continue;
+		}
+
+		if (batch && batch->n_users >= EWS_FREE_BUSY_MAX_USERS)
+			batch = NULL;
+
+		if (!batch) {
+			batch = g_new0 (FreeBusyBatch, 1);
+			batch->fbdata.period_start = fbdata->period_start;
+			batch->fbdata.period_end = fbdata->period_end;
+			batches = g_slist_prepend (batches, batch);
+		}
+
+		batch->fbdata.user_mails = g_slist_prepend (batch->fbdata.user_mails, (gpointer) mailbox);
+		batch->n_users++;
+	}
+
+	for (link = batches; link; link = g_slist_next (link)) {
+		batch = link->data;
+		batch->fbdata.user_mails = g_slist_reverse (batch->fbdata.user_mails);
+	}
+
+	batches = g_slist_reverse (batches);
+
+	fbr.cbews = cbews;
+	fbr.pri = pri;
+
+	e_ews_connection_utils_run_batches_sync (batches, EWS_FREE_BUSY_MAX_REQUESTS,
+		ecb_ews_free_busy_batch_start, ecb_ews_free_busy_batch_done, &fbr, cancellable);
+
+	for (link = batches; link && !local_error; link = g_slist_next (link)) {
+		GSList *fblink, *ulink;
+
+		batch = link->data;
+
+		if (batch->error) {
+			local_error = batch->error;
+			batch->error = NULL;
+			break;
+		}
+
+		/* Do not guess which response belongs to which mailbox when some is missing */
+		if (g_slist_length (batch->free_busy) != batch->n_users)
+			continue;
+
+		for (fblink = batch->free_busy, ulink = batch->fbdata.user_mails;
+		     fblink && ulink;
+		     fblink = g_slist_next (fblink), ulink = g_slist_next (ulink)) {
+			ecb_ews_free_busy_cache_store (cbews, ulink->data, fbdata->period_start, fbdata->period_end, fblink->data);
+
+			g_hash_table_insert (free_busy, g_strdup (ulink->data), fblink->data);
+			fblink->data = NULL;
+		}
+	}
+
+	if (!local_error)
+		g_cancellable_set_error_if_cancelled (cancellable, &local_error);
+
+	g_slist_free_full (batches, ecb_ews_free_busy_batch_free);
+
+	if (local_error) {
+		g_propagate_error (error, local_error);
+		g_hash_table_destroy (free_busy);
+
+		return FALSE;
+	}
+
+	*out_free_busy = free_busy;
+
+	return TRUE;
+}
+
+static gboolean
+ecb_ews_freebusy_ecomp_changed (ECalComponent *ecomp,
+				icalcomponent *vevent)
 {
 	icalcomponent *icomp;
 	gboolean changed = FALSE;
@@ -1272,36 +1918,83 @@ ecb_ews_freebusy_ecomp_changed (ECalComponent *ecomp,
 	return changed;
 }
 
+static gboolean
+ecb_ews_gather_change_keys_cb (ECache *cache,
+			       gint ncols,
+			       const gchar **column_names,
+			       const gchar **column_values,
+			       gpointer user_data)
+{
+	GHashTable *known_change_keys = user_data;
+
+	if (ncols == 1 && column_values[0] && *column_values[0])
+		g_hash_table_add (known_change_keys, g_strdup (column_values[0]));
+
+	return TRUE;
+}
+
+/* The component revision is the item's ChangeKey (see ecb_ews_dup_component_revision()),
+   thus the whole page of items can be verified with a single query on the revision
+   column, without loading and parsing every cached component. */
+static GHashTable * /* gchar *change_key ~> NULL */
+ecb_ews_lookup_change_keys (ECalCache *cal_cache,
+			    const GSList *items, /* EEwsItem * */
+			    GCancellable *cancellable)
+{
+	GHashTable *known_change_keys;
+	GString *stmt;
+	const GSList *link;
+	gboolean any = FALSE;
+
+	known_change_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	stmt = g_string_new ("SELECT " E_CACHE_COLUMN_REVISION " FROM " E_CACHE_TABLE_OBJECTS " WHERE ");
+	e_cache_sqlite_stmt_append_printf (stmt, E_CACHE_COLUMN_STATE "!=%d AND " E_CACHE_COLUMN_REVISION " IN (",
+		E_OFFLINE_STATE_LOCALLY_DELETED);
+
+	for (link = items; link; link = g_slist_next (link)) {
+		const EwsId *id = e_ews_item_get_id (link->data);
+
+		if (!id || !id->change_key || !*id->change_key)
+			continue;
+
+		if (any)
+			g_string_append_c (stmt, ',');
+
+		e_cache_sqlite_stmt_append_printf (stmt, "%Q", id->change_key);
+		any = TRUE;
+	}
+
+	g_string_append_c (stmt, ')');
+
+	if (any)
+		e_cache_sqlite_select (E_CACHE (cal_cache), stmt->str, ecb_ews_gather_change_keys_cb, known_change_keys, cancellable, NULL);
+
+	g_string_free (stmt, TRUE);
+
+	return known_change_keys;
+}
+
 static GSList * /* the possibly modified 'in_items' */
 ecb_ews_verify_changes (ECalCache *cal_cache,
 			icalcomponent_kind kind,
 			GSList *in_items, /* EEwsItem * */
 			GCancellable *cancellable)
 {
-	GSList *items = NULL, *link;
+	GSList *items = NULL, *candidates = NULL, *link;
+	GHashTable *known_change_keys;
 
 	g_return_val_if_fail (E_IS_CAL_CACHE (cal_cache), in_items);
 
 	for (link = in_items; link; link = g_slist_next (link)) {
 		EEwsItem *item = link->data;
-		const EwsId *id = e_ews_item_get_id (item);
 		EEwsItemType type = e_ews_item_get_item_type (item);
 
 		if (!g_cancellable_is_cancelled (cancellable) && (
 		    (type == E_EWS_ITEM_TYPE_EVENT && kind == ICAL_VEVENT_COMPONENT) ||
 		    (type == E_EWS_ITEM_TYPE_MEMO && kind == ICAL_VJOURNAL_COMPONENT) ||
 		    (type == E_EWS_ITEM_TYPE_TASK && kind == ICAL_VTODO_COMPONENT) )) {
-			ECalComponent *existing = NULL;
-
-			if (e_cal_cache_get_component (cal_cache, id->id, NULL, &existing, cancellable, NULL) &&
-			    existing && g_strcmp0 (e_cal_util_get_x_property (e_cal_component_get_icalcomponent (existing),
-			    "X-EVOLUTION-CHANGEKEY"), id->change_key) == 0) {
-				g_object_unref (item);
-			} else {
-				items = g_slist_prepend (items, item);
-			}
-
-			g_clear_object (&existing);
+			candidates = g_slist_prepend (candidates, item);
 		} else if (type == E_EWS_ITEM_TYPE_EVENT ||
 			   type == E_EWS_ITEM_TYPE_MEMO ||
 			   type == E_EWS_ITEM_TYPE_TASK) {
@@ -1313,9 +2006,178 @@ ecb_ews_verify_changes (ECalCache *cal_cache,
 
 	g_slist_free (in_items);
 
+	if (!candidates)
+		return items;
+
+	known_change_keys = ecb_ews_lookup_change_keys (cal_cache, candidates, cancellable);
+
+	for (link = candidates; link; link = g_slist_next (link)) {
+		EEwsItem *item = link->data;
+		const EwsId *id = e_ews_item_get_id (item);
+
+		/* A known ChangeKey means the cached component is up to date */
+		if (id && id->change_key && g_hash_table_contains (known_change_keys, id->change_key))
+			g_object_unref (item);
+		else
+			items = g_slist_prepend (items, item);
+	}
+
+	g_hash_table_destroy (known_change_keys);
+	g_slist_free (candidates);
+
 	return items;
 }
 
+/* Fetches only the events overlapping the window of 'window_weeks' weeks around today,
+   using the CalendarView, which returns the occurrences of the recurring events, not their
+   masters; the masters are looked up with the RecurringMasterItemId, once for each series */
+static gboolean
+ecb_ews_fetch_window_sync (ECalBackendEws *cbews,
+			   guint window_weeks,
+			   GSList **out_components, /* ECalComponent * */
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	EwsFolderId *fid;
+	EEwsAdditionalProps *add_props;
+	GHashTable *known_ids, *known_uids;
+	GSList *items = NULL, *occurrence_ids = NULL, *link;
+	gboolean includes_last_item = FALSE;
+	gboolean success = TRUE;
+	guint page_size = EWS_WINDOW_SYNC_PAGE_SIZE;
+	time_t today, start, end;
+
+	today = time_day_begin (time (NULL));
+	start = time_add_week (today, -((gint) window_weeks));
+	end = time_day_end (time_add_week (today, window_weeks));
+
+	fid = e_ews_folder_id_new (cbews->priv->folder_id, NULL, FALSE);
+	known_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	known_uids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	add_props = e_ews_additional_props_new ();
+	add_props->field_uri = g_strdup ("item:ItemClass calendar:UID calendar:Start calendar:CalendarItemType");
+
+	while (success && !includes_last_item) {
+		GSList *page = NULL;
+		time_t last_start = start;
+
+		success = e_ews_connection_find_calendar_view_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
+			fid, add_props, start, end, page_size, &includes_last_item, &page,
+			cancellable, error);
+
+		for (link = page; success && link; link = g_slist_next (link)) {
+			EEwsItem *item = link->data;
+			const EwsId *id;
+			const gchar *item_type, *uid;
+
+			if (!item || e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR)
+				continue;
+
+			id = e_ews_item_get_id (item);
+			if (!id || !id->id || g_hash_table_contains (known_ids, id->id))
+				continue;
+
+			g_hash_table_add (known_ids, g_strdup (id->id));
+
+			if (e_ews_item_get_start (item) > last_start)
+				last_start = e_ews_item_get_start (item);
+
+			item_type = e_ews_item_get_calendar_item_type (item);
+			uid = e_ews_item_get_uid (item);
+
+			if (g_strcmp0 (item_type, "Occurrence") == 0 ||
+			    g_strcmp0 (item_type, "Exception") == 0) {
+				/* One lookup of the master per series is enough */
+				if (!uid || !g_hash_table_contains (known_uids, uid)) {
+					if (uid)
+						g_hash_table_add (known_uids, g_strdup (uid));
+
+					occurrence_ids = g_slist_prepend (occurrence_ids, g_strdup (id->id));
+				}
+			} else {
+				if (uid)
+					g_hash_table_add (known_uids, g_strdup (uid));
+
+				items = g_slist_prepend (items, g_object_ref (item));
+			}
+		}
+
+		g_slist_free_full (page, g_object_unref);
+
+		/* The view is ordered by the start, thus continue from the last seen start;
+		   the items seen already are skipped above */
+		if (success && !includes_last_item) {
+			if (last_start > start) {
+				start = last_start;
+				page_size = EWS_WINDOW_SYNC_PAGE_SIZE;
+			} else if (page_size < EWS_WINDOW_SYNC_MAX_PAGE_SIZE) {
+				/* The whole page starts at the same time; ask again for more */
+				page_size = MIN (page_size * 2, EWS_WINDOW_SYNC_MAX_PAGE_SIZE);
+			} else {
+				/* The rest is received by the full sync, which follows the window sync */
+				g_warning ("%s: More than %d items start at %s, the window of '%s' is truncated",
+					G_STRFUNC, EWS_WINDOW_SYNC_MAX_PAGE_SIZE, icaltime_as_ical_string (icaltime_from_timet_with_zone (start, FALSE, icaltimezone_get_utc_timezone ())),
+					e_source_get_display_name (e_backend_get_source (E_BACKEND (cbews))));
+				break;
+			}
+		}
+	}
+
+	e_ews_additional_props_free (add_props);
+
+	occurrence_ids = g_slist_reverse (occurrence_ids);
+
+	for (link = occurrence_ids; success && link; ) {
+		GSList *batch = NULL, *masters = NULL, *mlink;
+		guint n_ids;
+
+		for (n_ids = 0; link && n_ids < EWS_MAX_FETCH_COUNT; n_ids++, link = g_slist_next (link)) {
+			batch = g_slist_prepend (batch, link->data);
+		}
+
+		add_props = e_ews_additional_props_new ();
+		add_props->field_uri = g_strdup ("item:ItemClass");
+
+		success = e_ews_connection_get_recurring_masters_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
+			batch, "IdOnly", add_props, &masters, cancellable, error);
+
+		e_ews_additional_props_free (add_props);
+		g_slist_free (batch);
+
+		for (mlink = masters; success && mlink; mlink = g_slist_next (mlink)) {
+			EEwsItem *item = mlink->data;
+			const EwsId *id;
+
+			if (!item || e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR)
+				continue;
+
+			id = e_ews_item_get_id (item);
+			if (!id || !id->id || g_hash_table_contains (known_ids, id->id))
+				continue;
+
+			g_hash_table_add (known_ids, g_strdup (id->id));
+
+			items = g_slist_prepend (items, g_object_ref (item));
+		}
+
+		g_slist_free_full (masters, g_object_unref);
+	}
+
+	if (success && items) {
+		items = g_slist_reverse (items);
+		success = ecb_ews_fetch_items_sync (cbews, items, out_components, cancellable, error);
+	}
+
+	g_slist_free_full (items, g_object_unref);
+	g_slist_free_full (occurrence_ids, g_free);
+	g_hash_table_destroy (known_ids);
+	g_hash_table_destroy (known_uids);
+	e_ews_folder_id_free (fid);
+
+	return success;
+}
+
 static GSList * /* ECalMetaBackendInfo */
 ecb_ews_components_to_infos (ECalMetaBackend *meta_backend,
 			     const GSList *components, /* ECalComponent * */
@@ -1343,8 +2205,6 @@ ecb_ews_components_to_infos (ECalMetaBackend *meta_backend,
 		if (!uid)
 			continue;
 
-		ecb_ews_store_original_comp (comp);
-
 		instances = g_hash_table_lookup (sorted_by_uids, uid);
 		g_hash_table_insert (sorted_by_uids, (gpointer) uid, g_slist_prepend (instances, comp));
 	}
@@ -1599,6 +2459,7 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 	if (cbews->priv->is_freebusy_calendar) {
 		ESourceEwsFolder *ews_folder;
 		EEWSFreeBusyData fbdata;
+		GHashTable *fb_results = NULL;
 		GSList *free_busy = NULL, *link;
 		gboolean success;
 		time_t today;
@@ -1611,9 +2472,16 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 		fbdata.period_end = time_day_end (time_add_week (today, e_source_ews_folder_get_freebusy_weeks_after (ews_folder)));
 		fbdata.user_mails = g_slist_prepend (NULL, e_source_ews_folder_dup_foreign_mail (ews_folder));
 
-		success = e_ews_connection_get_free_busy_sync (cbews->priv->cnc, G_PRIORITY_DEFAULT,
-			e_ews_cal_utils_prepare_free_busy_request, &fbdata,
-			&free_busy, cancellable, &local_error);
+		success = ecb_ews_get_free_busy_data_sync (cbews, G_PRIORITY_DEFAULT, &fbdata, &fb_results, cancellable, &local_error);
+
+		if (success) {
+			icalcomponent *vfreebusy = fbdata.user_mails->data ? g_hash_table_lookup (fb_results, fbdata.user_mails->data) : NULL;
+
+			if (vfreebusy)
+				free_busy = g_slist_prepend (free_busy, icalcomponent_new_clone (vfreebusy));
+
+			g_hash_table_destroy (fb_results);
+		}
 
 		if (success) {
 			icaltimezone *utc_zone = icaltimezone_get_utc_timezone ();
@@ -1783,12 +2651,49 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 	} else {
 		GSList *items_created = NULL, *items_modified = NULL, *items_deleted = NULL, *link;
 		EEwsAdditionalProps *add_props;
+		ESourceEwsFolder *ews_folder;
 		gboolean includes_last_item = TRUE;
+		gboolean backfill;
+		gchar *backfill_value;
+		guint window_weeks;
+		gint pri = EWS_PRIORITY_MEDIUM;
+
+		ews_folder = e_source_get_extension (e_backend_get_source (E_BACKEND (cbews)), E_SOURCE_EXTENSION_EWS_FOLDER);
+		window_weeks = e_source_ews_folder_get_sync_window_weeks (ews_folder);
+
+		backfill_value = e_cache_dup_key (E_CACHE (cal_cache), EWS_WINDOW_SYNC_KEY, NULL);
+		backfill = backfill_value && *backfill_value;
+		g_free (backfill_value);
+
+		if (window_weeks > 0 && !backfill && (!last_sync_tag || !*last_sync_tag) &&
+		    e_cal_backend_get_kind (E_CAL_BACKEND (cbews)) == ICAL_VEVENT_COMPONENT) {
+			GSList *components = NULL;
+
+			/* Download the events around today first, the rest of the calendar follows
+			   with the usual SyncFolderItems, started from the scratch */
+			success = ecb_ews_fetch_window_sync (cbews, window_weeks, &components, cancellable, error);
+
+			if (success) {
+				*out_created_objects = ecb_ews_components_to_infos (meta_backend, components, ICAL_VEVENT_COMPONENT);
+				*out_new_sync_tag = NULL;
+				*out_repeat = TRUE;
+
+				e_cache_set_key (E_CACHE (cal_cache), EWS_WINDOW_SYNC_KEY, "1", NULL);
+			}
+
+			g_slist_free_full (components, g_object_unref);
+
+			goto exit;
+		}
+
+		/* The backfill should not delay the user's requests */
+		if (backfill)
+			pri = EWS_PRIORITY_LOW;
 
 		add_props = e_ews_additional_props_new ();
 		add_props->field_uri = g_strdup ("item:ItemClass");
 
-		success = e_ews_connection_sync_folder_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
+		success = e_ews_connection_sync_folder_items_sync (cbews->priv->cnc, pri,
 			last_sync_tag, cbews->priv->folder_id, "IdOnly", add_props, EWS_MAX_FETCH_COUNT,
 			out_new_sync_tag, &includes_last_item, &items_created, &items_modified, &items_deleted,
 			cancellable, &local_error);
@@ -1799,7 +2704,7 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 
 			e_cal_meta_backend_empty_cache_sync (meta_backend, cancellable, NULL);
 
-			success = e_ews_connection_sync_folder_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
+			success = e_ews_connection_sync_folder_items_sync (cbews->priv->cnc, pri,
 				NULL, cbews->priv->folder_id, "IdOnly", add_props, EWS_MAX_FETCH_COUNT,
 				out_new_sync_tag, &includes_last_item, &items_created, &items_modified, &items_deleted,
 				cancellable, &local_error);
@@ -1855,6 +2760,9 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 			g_slist_free_full (components_modified, g_object_unref);
 
 			*out_repeat = !includes_last_item;
+
+			if (success && backfill && includes_last_item)
+				e_cache_set_key (E_CACHE (cal_cache), EWS_WINDOW_SYNC_KEY, NULL, NULL);
 		} else if (local_error) {
 			g_propagate_error (error, local_error);
 		}
@@ -1864,6 +2772,7 @@ ecb_ews_get_changes_sync (ECalMetaBackend *meta_backend,
 		g_slist_free_full (items_deleted, g_free);
 	}
 
+ exit:
 	g_rec_mutex_unlock (&cbews->priv->cnc_lock);
 
 	ecb_ews_convert_error_to_edc_error (error);
@@ -1893,6 +2802,13 @@ ecb_ews_load_component_sync (ECalMetaBackend *meta_backend,
 
 	cbews = E_CAL_BACKEND_EWS (meta_backend);
 
+	/* Received already by the ecb_ews_create_objects_sync() or known after a change */
+	*out_component = ecb_ews_bulk_steal_loaded (cbews, extra && *extra ? extra : uid);
+	if (*out_component) {
+		*out_extra = g_strdup (extra && *extra ? extra : uid);
+		return TRUE;
+	}
+
 	g_rec_mutex_lock (&cbews->priv->cnc_lock);
 
 	ids = g_slist_prepend (NULL, (gpointer) (extra && *extra ? extra : uid));
@@ -2416,11 +3332,59 @@ ecb_ews_pick_all_tzids_out (ECalBackendEws *cbews,
 	icalcomponent_foreach_tzid (icalcomp, tzid_cb, &cbd);
 }
 
+/* Returns the ChangeKey of the 'item_id' from the UpdateItem response 'items',
+   or NULL, when the response does not contain it */
+static gchar *
+ecb_ews_dup_response_change_key (const GSList *items,
+				 const gchar *item_id)
+{
+	const EwsId *ews_id;
+
+	if (!items || items->next || !items->data ||
+	    e_ews_item_get_item_type (items->data) == E_EWS_ITEM_TYPE_ERROR)
+		return NULL;
+
+	ews_id = e_ews_item_get_id (items->data);
+
+	if (!ews_id || !ews_id->change_key || g_strcmp0 (ews_id->id, item_id) != 0)
+		return NULL;
+
+	return g_strdup (ews_id->change_key);
+}
+
+/* Remembers the 'comp' with the 'change_key' as the server version of the 'item_id',
+   thus the ecb_ews_load_component_sync() does not need to download it again */
+static void
+ecb_ews_remember_loaded (ECalBackendEws *cbews,
+			 const gchar *item_id,
+			 const gchar *change_key,
+			 ECalComponent *comp)
+{
+	ECalComponent *loaded;
+
+	loaded = e_cal_component_clone (comp);
+
+	e_cal_util_set_x_property (e_cal_component_get_icalcomponent (loaded), "X-EVOLUTION-ITEMID", item_id);
+	e_cal_util_set_x_property (e_cal_component_get_icalcomponent (loaded), "X-EVOLUTION-CHANGEKEY", change_key);
+	e_cal_backend_ews_store_original_comp (loaded);
+
+	g_mutex_lock (&cbews->priv->bulk_lock);
+	g_hash_table_insert (cbews->priv->bulk_loaded, g_strdup (item_id),
+		icalcomponent_new_clone (e_cal_component_get_icalcomponent (loaded)));
+	g_mutex_unlock (&cbews->priv->bulk_lock);
+
+	g_object_unref (loaded);
+}
+
+/* The 'out_change_key' is set to the ChangeKey of the item after the change, when
+   the server version of the item is the 'new_icalcomp' with the new ChangeKey; it's
+   left NULL, when the item should be downloaded, like with changed attachments. */
 static gboolean
 ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 			  GHashTable *removed_indexes,
 			  icalcomponent *old_icalcomp,
 			  icalcomponent *new_icalcomp,
+			  gchar **out_change_key,
 			  GCancellable *cancellable,
 			  GError **error)
 {
@@ -2428,11 +3392,16 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 	icalcomponent *icalcomp;
 	gchar *itemid = NULL, *changekey = NULL;
 	GSList *added_attachments = NULL, *removed_attachment_ids = NULL;
+	gboolean attachments_changed;
+	gboolean exceptions_removed = FALSE;
 	gboolean success = TRUE;
 
 	g_return_val_if_fail (E_IS_CAL_BACKEND_EWS (cbews), FALSE);
 	g_return_val_if_fail (new_icalcomp != NULL, FALSE);
 
+	if (out_change_key)
+		*out_change_key = NULL;
+
 	icalcomp = icalcomponent_new_clone (new_icalcomp);
 
 	ecb_ews_pick_all_tzids_out (cbews, icalcomp);
@@ -2463,6 +3432,8 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 
 	ecb_ews_get_attach_differences (oldcomp, comp, &removed_attachment_ids, &added_attachments);
 
+	attachments_changed = removed_attachment_ids || added_attachments;
+
 	/* preform sync delete attachemnt operation*/
 	if (removed_attachment_ids) {
 		g_free (changekey);
@@ -2541,6 +3512,8 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 
 				success = e_ews_connection_delete_item_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM, &item_id, index,
 					EWS_HARD_DELETE, EWS_SEND_TO_NONE, EWS_ALL_OCCURRENCES, cancellable, error);
+
+				exceptions_removed = TRUE;
 			}
 		}
 
@@ -2560,6 +3533,9 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 		convert_data.user_email = camel_ews_settings_dup_email (ews_settings);
 		convert_data.comp = comp;
 		convert_data.old_comp = oldcomp;
+		/* Without the old component, or with changed attachments, which should
+		   be part of the meeting update, the basic properties are always written */
+		convert_data.force_basic_properties = !old_icalcomp || attachments_changed;
 		convert_data.item_id = itemid;
 		convert_data.change_key = changekey;
 		convert_data.default_zone = icaltimezone_get_utc_timezone ();
@@ -2573,10 +3549,22 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 			send_or_save = "SaveOnly";
 		}
 
-		success = e_ews_connection_update_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
-			"AlwaysOverwrite", send_or_save, send_meeting_invitations, cbews->priv->folder_id,
-			e_cal_backend_ews_convert_component_to_updatexml, &convert_data,
-			NULL, cancellable, error);
+		/* Nothing the server stores had been changed, like with a change of an unmapped property */
+		if (e_cal_backend_ews_get_component_changes (&convert_data) != EWS_CALENDAR_CHANGE_NONE) {
+			GSList *items = NULL;
+
+			success = e_ews_connection_update_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
+				"AlwaysOverwrite", send_or_save, send_meeting_invitations, cbews->priv->folder_id,
+				e_cal_backend_ews_convert_component_to_updatexml, &convert_data,
+				&items, cancellable, error);
+
+			if (success && out_change_key && !attachments_changed)
+				*out_change_key = ecb_ews_dup_response_change_key (items, itemid);
+
+			g_slist_free_full (items, g_object_unref);
+		} else if (out_change_key && !attachments_changed && !exceptions_removed) {
+			*out_change_key = g_strdup (changekey);
+		}
 
 		g_free (convert_data.user_email);
 	}
@@ -2603,6 +3591,297 @@ ecb_ews_modify_item_sync (ECalBackendEws *cbews,
 	return success;
 }
 
+typedef struct _BulkCreated {
+	gchar *item_id; /* NULL, when the creation failed */
+	GError *error;
+} BulkCreated;
+
+static void
+ecb_ews_bulk_created_free (gpointer ptr)
+{
+	BulkCreated *bc = ptr;
+
+	if (bc) {
+		g_free (bc->item_id);
+		g_clear_error (&bc->error);
+		g_free (bc);
+	}
+}
+
+/* Returns what the ecb_ews_bulk_create_sync() did with the event 'uid',
+   or NULL, when it did not create it; free it with ecb_ews_bulk_created_free() */
+static BulkCreated *
+ecb_ews_bulk_steal_created (ECalBackendEws *cbews,
+			    const gchar *uid)
+{
+	BulkCreated *bc = NULL;
+	gpointer key = NULL;
+
+	if (!uid)
+		return NULL;
+
+	g_mutex_lock (&cbews->priv->bulk_lock);
+
+	if (g_hash_table_lookup_extended (cbews->priv->bulk_created, uid, &key, (gpointer *) &bc)) {
+		g_hash_table_steal (cbews->priv->bulk_created, uid);
+		g_free (key);
+	}
+
+	g_mutex_unlock (&cbews->priv->bulk_lock);
+
+	return bc;
+}
+
+/* Returns the server version of the event with the 'item_id', as received
+   by the ecb_ews_bulk_create_sync(), or NULL, when there is none */
+static icalcomponent *
+ecb_ews_bulk_steal_loaded (ECalBackendEws *cbews,
+			   const gchar *item_id)
+{
+	icalcomponent *icalcomp = NULL;
+	gpointer key = NULL;
+
+	if (!item_id)
+		return NULL;
+
+	g_mutex_lock (&cbews->priv->bulk_lock);
+
+	if (g_hash_table_lookup_extended (cbews->priv->bulk_loaded, item_id, &key, (gpointer *) &icalcomp)) {
+		g_hash_table_steal (cbews->priv->bulk_loaded, item_id);
+		g_free (key);
+	}
+
+	g_mutex_unlock (&cbews->priv->bulk_lock);
+
+	return icalcomp;
+}
+
+typedef struct _BulkCreateRequests {
+	ECalBackendEws *cbews;
+	EwsFolderId *fid;
+	GHashTable *time_zones; /* gchar *msdn_location ~> EEwsCalendarTimeZoneDefinition * */
+} BulkCreateRequests;
+
+typedef struct _BulkCreateBatch {
+	BulkCreateRequests *bcr;
+	GSList *icalcomps; /* icalcomponent *, borrowed */
+	guint n_icalcomps;
+	GSList *items; /* EEwsItem * */
+	GError *error;
+} BulkCreateBatch;
+
+static void
+ecb_ews_bulk_create_batch_free (gpointer ptr)
+{
+	BulkCreateBatch *batch = ptr;
+
+	if (batch) {
+		g_slist_free (batch->icalcomps);
+		g_slist_free_full (batch->items, g_object_unref);
+		g_clear_error (&batch->error);
+		g_free (batch);
+	}
+}
+
+/* Writes all the events of the batch into one CreateItem request */
+static gboolean
+ecb_ews_bulk_create_batch_to_xml (ESoapMessage *msg,
+				  gpointer user_data,
+				  GError **error)
+{
+	BulkCreateBatch *batch = user_data;
+	EwsCalendarConvertData convert_data = { 0 };
+	GSList *link;
+	gboolean success = TRUE;
+
+	convert_data.connection = batch->bcr->cbews->priv->cnc;
+	convert_data.timezone_cache = E_TIMEZONE_CACHE (batch->bcr->cbews);
+	convert_data.default_zone = icaltimezone_get_utc_timezone ();
+	convert_data.time_zones = batch->bcr->time_zones;
+
+	for (link = batch->icalcomps; link && success; link = g_slist_next (link)) {
+		convert_data.icalcomp = link->data;
+
+		success = e_cal_backend_ews_convert_calcomp_to_xml (msg, &convert_data, error);
+	}
+
+	return success;
+}
+
+static void
+ecb_ews_bulk_create_batch_done (GObject *source_object,
+				GAsyncResult *result,
+				gpointer batch_ptr,
+				gpointer user_data)
+{
+	BulkCreateBatch *batch = batch_ptr;
+
+	e_ews_connection_create_items_finish (E_EWS_CONNECTION (source_object), result, &batch->items, &batch->error);
+}
+
+static void
+ecb_ews_bulk_create_batch_start (gpointer batch_ptr,
+				 gpointer user_data,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	BulkCreateBatch *batch = batch_ptr;
+	BulkCreateRequests *bcr = user_data;
+
+	e_ews_connection_create_items (
+		bcr->cbews->priv->cnc,
+		EWS_PRIORITY_MEDIUM,
+		"SaveOnly",
+		"SendToNone",
+		bcr->fid,
+		ecb_ews_bulk_create_batch_to_xml,
+		batch,
+		cancellable,
+		callback,
+		callback_data);
+}
+
+/* Creates the 'icalcomps' (simple events without attendees, attachments
+   and detached instances) on the server with as few CreateItem requests as
+   possible, several of them running at the same time, and remembers the result
+   for each of them, to be picked by the ecb_ews_save_component_sync() and the
+   ecb_ews_load_component_sync(). Events, which could not be created in a batch,
+   are left to the regular, one by one, creation. Adds the item IDs of the created
+   events into the 'out_item_ids'. */
+static void
+ecb_ews_bulk_create_sync (ECalBackendEws *cbews,
+			  GSList *icalcomps, /* icalcomponent * */
+			  GSList **out_item_ids, /* gchar * */
+			  GCancellable *cancellable)
+{
+	BulkCreateRequests bcr;
+	BulkCreateBatch *batch = NULL;
+	GSList *batches = NULL, *created = NULL, *link;
+
+	for (link = icalcomps; link; link = g_slist_next (link)) {
+		if (batch && batch->n_icalcomps >= EWS_BULK_CREATE_BATCH_SIZE)
+			batch = NULL;
+
+		if (!batch) {
+			batch = g_new0 (BulkCreateBatch, 1);
+			batch->bcr = &bcr;
+			batches = g_slist_prepend (batches, batch);
+		}
+
+		batch->icalcomps = g_slist_prepend (batch->icalcomps, link->data);
+		batch->n_icalcomps++;
+	}
+
+	for (link = batches; link; link = g_slist_next (link)) {
+		batch = link->data;
+		batch->icalcomps = g_slist_reverse (batch->icalcomps);
+	}
+
+	batches = g_slist_reverse (batches);
+
+	if (!batches)
+		return;
+
+	g_rec_mutex_lock (&cbews->priv->cnc_lock);
+
+	bcr.cbews = cbews;
+	bcr.fid = e_ews_folder_id_new (cbews->priv->folder_id, NULL, FALSE);
+	bcr.time_zones = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) e_ews_calendar_time_zone_definition_free);
+
+	e_ews_connection_utils_run_batches_sync (batches, EWS_BULK_CREATE_MAX_REQUESTS,
+		ecb_ews_bulk_create_batch_start, ecb_ews_bulk_create_batch_done, &bcr, cancellable);
+
+	g_hash_table_destroy (bcr.time_zones);
+	e_ews_folder_id_free (bcr.fid);
+
+	g_mutex_lock (&cbews->priv->bulk_lock);
+
+	for (link = batches; link; link = g_slist_next (link)) {
+		GSList *ilink, *clink;
+
+		batch = link->data;
+
+		/* The whole request failed, or it did not run at all; do not
+		   guess which response belongs to which event when some is missing */
+		if (batch->error || g_slist_length (batch->items) != batch->n_icalcomps)
+			continue;
+
+		for (ilink = batch->items, clink = batch->icalcomps;
+		     ilink && clink;
+		     ilink = g_slist_next (ilink), clink = g_slist_next (clink)) {
+			EEwsItem *item = ilink->data;
+			const EwsId *item_id;
+			BulkCreated *bc;
+
+			if (!item)
+				continue;
+
+			item_id = e_ews_item_get_id (item);
+
+			bc = g_new0 (BulkCreated, 1);
+
+			if (e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR) {
+				bc->error = g_error_copy (e_ews_item_get_error (item));
+			} else if (item_id && item_id->id) {
+				bc->item_id = g_strdup (item_id->id);
+				created = g_slist_prepend (created, item);
+
+				*out_item_ids = g_slist_prepend (*out_item_ids, g_strdup (bc->item_id));
+			} else {
+				ecb_ews_bulk_created_free (bc);
+				continue;
+			}
+
+			g_hash_table_insert (cbews->priv->bulk_created, g_strdup (icalcomponent_get_uid (clink->data)), bc);
+		}
+	}
+
+	g_mutex_unlock (&cbews->priv->bulk_lock);
+
+	created = g_slist_reverse (created);
+
+	/* Read back the server version of the created events, the same way as
+	   the ecb_ews_load_component_sync() does it for each of them */
+	for (link = created; link && !g_cancellable_is_cancelled (cancellable);) {
+		GSList *chunk = NULL, *components = NULL, *clink;
+
+		for (ii = 0; link && ii < EWS_MAX_FETCH_COUNT; ii++, link = g_slist_next (link)) {
+			chunk = g_slist_prepend (chunk, link->data);
+		}
+
+		chunk = g_slist_reverse (chunk);
+
+		if (ecb_ews_fetch_items_sync (cbews, chunk, &components, cancellable, NULL)) {
+			g_mutex_lock (&cbews->priv->bulk_lock);
+
+			for (clink = components; clink; clink = g_slist_next (clink)) {
+				ECalComponent *comp = clink->data;
+				gchar *item_id = NULL;
+
+				/* Only simple events are created here, thus there are no detached instances */
+				if (!comp || e_cal_component_is_instance (comp))
+					continue;
+
+				ecb_ews_extract_item_id (comp, &item_id, NULL);
+
+				if (item_id)
+					g_hash_table_insert (cbews->priv->bulk_loaded, item_id, icalcomponent_new_clone (e_cal_component_get_icalcomponent (comp)));
+			}
+
+			g_mutex_unlock (&cbews->priv->bulk_lock);
+		}
+
+		g_slist_free_full (components, g_object_unref);
+		g_slist_free (chunk);
+	}
+
+	g_rec_mutex_unlock (&cbews->priv->cnc_lock);
+
+	g_slist_free (created);
+	g_slist_free_full (batches, ecb_ews_bulk_create_batch_free);
+}
+
 static gboolean
 ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 			     gboolean overwrite_existing,
@@ -2618,6 +3897,7 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 	ECalCache *cal_cache;
 	ECalComponent *master = NULL;
 	EwsFolderId *fid;
+	BulkCreated *bulk_created;
 	GSList *link;
 	const gchar *uid = NULL;
 	gboolean success = TRUE;
@@ -2664,7 +3944,7 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 			for (link = existing; link; link = g_slist_next (link)) {
 				ECalComponent *comp = link->data;
 
-				comp = ecb_ews_restore_original_comp (comp);
+				comp = e_cal_backend_ews_restore_original_comp (comp);
 				if (comp) {
 					g_object_unref (link->data);
 					link->data = comp;
@@ -2677,6 +3957,16 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 
 		if (success) {
 			GHashTable *removed_indexes;
+			gchar *new_change_key = NULL;
+			gboolean can_reuse_modified;
+
+			/* A simple event or task is stored on the server as it had been sent,
+			   thus it does not need to be downloaded again, only its ChangeKey is
+			   updated; meetings can be changed by the server and are downloaded */
+			can_reuse_modified = !instances->next && changed_instances && !changed_instances->next &&
+				changed_instances->data && !removed_instances &&
+				!e_cal_component_has_recurrences (master) &&
+				!e_cal_component_has_attendees (master);
 
 			removed_indexes = g_hash_table_new (g_direct_hash, g_direct_equal);
 
@@ -2689,6 +3979,7 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 				success = ecb_ews_modify_item_sync (cbews, removed_indexes,
 					e_cal_component_get_icalcomponent (cd->old_component ? cd->old_component : master),
 					e_cal_component_get_icalcomponent (cd->new_component),
+					can_reuse_modified ? &new_change_key : NULL,
 					cancellable, error);
 			}
 
@@ -2707,7 +3998,20 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 				}
 			}
 
+			if (success && new_change_key) {
+				ChangeData *cd = changed_instances->data;
+				gchar *item_id = NULL;
+
+				ecb_ews_extract_item_id (cd->new_component, &item_id, NULL);
+
+				if (item_id)
+					ecb_ews_remember_loaded (cbews, item_id, new_change_key, cd->new_component);
+
+				g_free (item_id);
+			}
+
 			g_hash_table_destroy (removed_indexes);
+			g_free (new_change_key);
 		}
 
 		if (success)
@@ -2716,6 +4020,17 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 		g_slist_free_full (existing, g_object_unref);
 		g_slist_free_full (changed_instances, change_data_free);
 		g_slist_free_full (removed_instances, g_object_unref);
+	} else if ((bulk_created = ecb_ews_bulk_steal_created (cbews, uid)) != NULL) {
+		/* Already created by the ecb_ews_create_objects_sync() */
+		if (bulk_created->error) {
+			g_propagate_error (error, bulk_created->error);
+			bulk_created->error = NULL;
+			success = FALSE;
+		} else {
+			*out_new_uid = g_strdup (bulk_created->item_id);
+		}
+
+		ecb_ews_bulk_created_free (bulk_created);
 	} else {
 		GHashTable *removed_indexes;
 		EwsCalendarConvertData convert_data = { 0 };
@@ -2858,7 +4173,7 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 
 			/* In case we have attendees and atachemnts we have to fake update items,
 			 * this is the only way to pass attachments in meeting invite mail */
-			success = ecb_ews_modify_item_sync (cbews, removed_indexes, NULL, icalcomp, cancellable, error);
+			success = ecb_ews_modify_item_sync (cbews, removed_indexes, NULL, icalcomp, NULL, cancellable, error);
 		}
 
 		icalcomponent_free (icalcomp);
@@ -2873,7 +4188,7 @@ ecb_ews_save_component_sync (ECalMetaBackend *meta_backend,
 
 			icalcomp = e_cal_component_get_icalcomponent (comp);
 
-			success = ecb_ews_modify_item_sync (cbews, removed_indexes, NULL, icalcomp, cancellable, error);
+			success = ecb_ews_modify_item_sync (cbews, removed_indexes, NULL, icalcomp, NULL, cancellable, error);
 		}
 
 		if (success && items) {
@@ -2944,6 +4259,156 @@ ecb_ews_remove_component_sync (ECalMetaBackend *meta_backend,
 	return success;
 }
 
+/* Whether the 'icalcomp' can be created in a batch; the events with attendees
+   (invitations), attachments or detached instances need more requests, which
+   the ecb_ews_save_component_sync() takes care of */
+static gboolean
+ecb_ews_can_bulk_create (icalcomponent *icalcomp)
+{
+	const gchar *uid;
+
+	if (!icalcomp || icalcomponent_isa (icalcomp) != ICAL_VEVENT_COMPONENT)
+		return FALSE;
+
+	uid = icalcomponent_get_uid (icalcomp);
+
+	return uid && *uid &&
+		!icalcomponent_get_first_property (icalcomp, ICAL_RECURRENCEID_PROPERTY) &&
+		!icalcomponent_get_first_property (icalcomp, ICAL_ATTENDEE_PROPERTY) &&
+		!icalcomponent_get_first_property (icalcomp, ICAL_ATTACH_PROPERTY) &&
+		!icalcomponent_get_first_property (icalcomp, ICAL_EXDATE_PROPERTY) &&
+		!e_cal_util_get_x_property (icalcomp, "X-EVOLUTION-ITEMID");
+}
+
+static void
+ecb_ews_create_objects_sync (ECalBackendSync *sync_backend,
+			     EDataCal *cal,
+			     GCancellable *cancellable,
+			     const GSList *calobjs,
+			     GSList **uids,
+			     GSList **new_components,
+			     GError **error)
+{
+	ECalBackendEws *cbews;
+	GSList *icalcomps = NULL, *item_ids = NULL, *link;
+	gboolean cnc_locked = FALSE;
+
+	g_return_if_fail (E_IS_CAL_BACKEND_EWS (sync_backend));
+
+	cbews = E_CAL_BACKEND_EWS (sync_backend);
+
+	/* Imports create many events at once, which the ECalMetaBackend saves
+	   one by one, with several requests for each; create the simple events
+	   in batches first and let the saving only pick the result */
+	if (g_slist_length ((GSList *) calobjs) >= EWS_BULK_CREATE_MIN_ITEMS &&
+	    !cbews->priv->is_freebusy_calendar &&
+	    e_cal_backend_get_kind (E_CAL_BACKEND (cbews)) == ICAL_VEVENT_COMPONENT &&
+	    e_backend_get_online (E_BACKEND (cbews)) &&
+	    e_cal_meta_backend_ensure_connected_sync (E_CAL_META_BACKEND (cbews), cancellable, NULL)) {
+		ECalCache *cal_cache;
+		GHashTable *known_uids;
+
+		cal_cache = e_cal_meta_backend_ref_cache (E_CAL_META_BACKEND (cbews));
+		known_uids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+		g_rec_mutex_lock (&cbews->priv->cnc_lock);
+
+		for (link = (GSList *) calobjs; link && cal_cache && cbews->priv->cnc; link = g_slist_next (link)) {
+			icalcomponent *icalcomp;
+			const gchar *uid;
+
+			icalcomp = link->data ? icalcomponent_new_from_string (link->data) : NULL;
+
+			if (!ecb_ews_can_bulk_create (icalcomp)) {
+				if (icalcomp)
+					icalcomponent_free (icalcomp);
+				continue;
+			}
+
+			uid = icalcomponent_get_uid (icalcomp);
+
+			/* These will fail in the ECalMetaBackend, with a proper error */
+			if (g_hash_table_contains (known_uids, uid) ||
+			    e_cal_cache_contains (cal_cache, uid, NULL, E_CACHE_EXCLUDE_DELETED)) {
+				icalcomponent_free (icalcomp);
+				continue;
+			}
+
+			g_hash_table_add (known_uids, g_strdup (uid));
+
+			e_ews_clean_icalcomponent (icalcomp);
+
+			if (!e_ews_connection_satisfies_server_version (cbews->priv->cnc, E_EWS_EXCHANGE_2010))
+				ecb_ews_pick_all_tzids_out (cbews, icalcomp);
+
+			icalcomps = g_slist_prepend (icalcomps, icalcomp);
+		}
+
+		icalcomps = g_slist_reverse (icalcomps);
+
+		if (cbews->priv->cnc && g_slist_length (icalcomps) >= EWS_BULK_CREATE_MIN_ITEMS)
+			ecb_ews_bulk_create_sync (cbews, icalcomps, &item_ids, cancellable);
+
+		/* Keep the lock until the created events are saved, otherwise a refresh
+		   in the meantime could store them into the cache and the saving
+		   would refuse them as already existing */
+		if (item_ids)
+			cnc_locked = TRUE;
+		else
+			g_rec_mutex_unlock (&cbews->priv->cnc_lock);
+
+		g_hash_table_destroy (known_uids);
+		g_clear_object (&cal_cache);
+	}
+
+	/* Chain up to parent's method. */
+	E_CAL_BACKEND_SYNC_CLASS (e_cal_backend_ews_parent_class)->create_objects_sync (sync_backend, cal, cancellable, calobjs, uids, new_components, error);
+
+	/* The creation could stop on an error before all the prepared events were
+	   saved; they exist only on the server, thus remove them from there too */
+	if (icalcomps || item_ids) {
+		GSList *not_saved = NULL;
+
+		g_mutex_lock (&cbews->priv->bulk_lock);
+
+		for (link = icalcomps; link; link = g_slist_next (link)) {
+			BulkCreated *bc;
+
+			bc = g_hash_table_lookup (cbews->priv->bulk_created, icalcomponent_get_uid (link->data));
+			if (bc && bc->item_id)
+				not_saved = g_slist_prepend (not_saved, g_strdup (bc->item_id));
+
+			g_hash_table_remove (cbews->priv->bulk_created, icalcomponent_get_uid (link->data));
+		}
+
+		for (link = item_ids; link; link = g_slist_next (link)) {
+			g_hash_table_remove (cbews->priv->bulk_loaded, link->data);
+		}
+
+		g_mutex_unlock (&cbews->priv->bulk_lock);
+
+		/* Not cancellable, the cancellation is likely the reason for the leftovers */
+		if (not_saved && cbews->priv->cnc) {
+			GError *local_error = NULL;
+
+			if (!e_ews_connection_delete_items_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM, not_saved,
+				EWS_HARD_DELETE, EWS_SEND_TO_NONE, EWS_NONE_OCCURRENCES, NULL, &local_error)) {
+				g_warning ("%s: Failed to delete not saved events: %s", G_STRFUNC, local_error ? local_error->message : "Unknown error");
+			}
+
+			g_clear_error (&local_error);
+		}
+
+		g_slist_free_full (not_saved, g_free);
+	}
+
+	if (cnc_locked)
+		g_rec_mutex_unlock (&cbews->priv->cnc_lock);
+
+	g_slist_free_full (icalcomps, (GDestroyNotify) icalcomponent_free);
+	g_slist_free_full (item_ids, g_free);
+}
+
 static void
 ecb_ews_discard_alarm_sync (ECalBackendSync *cal_backend_sync,
 			    EDataCal *cal,
@@ -2957,6 +4422,7 @@ ecb_ews_discard_alarm_sync (ECalBackendSync *cal_backend_sync,
 	ECalCache *cal_cache;
 	ECalComponent *comp = NULL;
 	EwsCalendarConvertData convert_data = { 0 };
+	GSList *items = NULL;
 
 	g_return_if_fail (E_IS_CAL_BACKEND_EWS (cal_backend_sync));
 
@@ -3008,22 +4474,52 @@ ecb_ews_discard_alarm_sync (ECalBackendSync *cal_backend_sync,
 		"SendToNone", NULL,
 		e_cal_backend_ews_clear_reminder_is_set,
 		&convert_data,
-		NULL,
+		&items,
 		cancellable,
 		error)) {
 		icalcomponent *icomp = e_cal_component_get_icalcomponent (comp);
 		GSList *modified_objects;
+		gchar *new_change_key = NULL;
+
+		/* A change of an occurrence creates a detached instance on the server, which is downloaded;
+		   the same for a recurring series, whose detached instances are not part of the 'comp' */
+		if (convert_data.change_type == E_EWS_ITEMCHANGE_TYPE_ITEM && convert_data.item_id &&
+		    !e_cal_component_has_recurrences (comp))
+			new_change_key = ecb_ews_dup_response_change_key (items, convert_data.item_id);
+
+		if (new_change_key) {
+			ECalComponent *dismissed;
+
+			/* The server has no reminder for the item now */
+			dismissed = e_cal_component_clone (comp);
+			e_cal_component_remove_all_alarms (dismissed);
+
+			ecb_ews_remember_loaded (cbews, convert_data.item_id, new_change_key, dismissed);
+
+			g_object_unref (dismissed);
+		}
 
 		modified_objects = g_slist_prepend (NULL,
 			e_cal_meta_backend_info_new (icalcomponent_get_uid (icomp), NULL, NULL,
 				e_cal_util_get_x_property (icomp, "X-EVOLUTION-ITEMID")));
 
-		/* Refresh the local cache, to have up-to-date ChangeKey */
+		/* Refresh the local cache, to have up-to-date ChangeKey; the component
+		   is downloaded only when the response did not contain the ChangeKey */
 		e_cal_meta_backend_process_changes_sync (E_CAL_META_BACKEND (cbews), NULL, modified_objects, NULL, cancellable, error);
 
 		g_slist_free_full (modified_objects, e_cal_meta_backend_info_free);
+
+		if (new_change_key) {
+			/* In case it was not used */
+			g_mutex_lock (&cbews->priv->bulk_lock);
+			g_hash_table_remove (cbews->priv->bulk_loaded, convert_data.item_id);
+			g_mutex_unlock (&cbews->priv->bulk_lock);
+
+			g_free (new_change_key);
+		}
 	}
 
+	g_slist_free_full (items, g_object_unref);
 	g_object_unref (comp);
 	g_free (convert_data.item_id);
 	g_free (convert_data.change_key);
@@ -3621,7 +5117,7 @@ ecb_ews_receive_objects_sync (ECalBackendSync *sync_backend,
 				icalproperty_set_value_from_string (summary, split_subject[1] , "NO");
 				g_strfreev (split_subject);
 
-				success = ecb_ews_modify_item_sync (cbews, NULL, NULL, subcomp, cancellable, error);
+				success = ecb_ews_modify_item_sync (cbews, NULL, NULL, subcomp, NULL, cancellable, error);
 
 				do_refresh = TRUE;
 			}
@@ -3784,8 +5280,7 @@ ecb_ews_get_free_busy_sync (ECalBackendSync *sync_backend,
 {
 	ECalBackendEws *cbews;
 	EEWSFreeBusyData fbdata = { 0 };
-	GSList *freebusy = NULL;
-	gboolean success;
+	GHashTable *free_busy = NULL;
 
 	g_return_if_fail (E_IS_CAL_BACKEND_EWS (sync_backend));
 	g_return_if_fail (freebusyobjs != NULL);
@@ -3797,30 +5292,21 @@ ecb_ews_get_free_busy_sync (ECalBackendSync *sync_backend,
 	if (!e_cal_meta_backend_ensure_connected_sync (E_CAL_META_BACKEND (cbews), cancellable, error))
 		return;
 
-	/* EWS can support only 100 identities, which is the maximum number of identities that the Web service method can request
-	 see http://msdn.microsoft.com / en - us / library / aa564001 % 28v = EXCHG.140 % 29.aspx */
-	if (g_slist_length ((GSList *) users) > 100) {
-		g_propagate_error (error, EDC_ERROR (SearchSizeLimitExceeded));
-		return;
-	}
-
 	fbdata.period_start = start;
 	fbdata.period_end = end;
 	fbdata.user_mails = (GSList *) users;
 
-	success = e_ews_connection_get_free_busy_sync (cbews->priv->cnc, EWS_PRIORITY_MEDIUM,
-		e_ews_cal_utils_prepare_free_busy_request, &fbdata,
-		&freebusy, cancellable, error);
-
-	if (success) {
-		GSList *fblink, *ulink;
+	if (ecb_ews_get_free_busy_data_sync (cbews, EWS_PRIORITY_MEDIUM, &fbdata, &free_busy, cancellable, error)) {
+		GSList *ulink;
 
-		for (fblink = freebusy, ulink = (GSList *) users;
-		     fblink && ulink;
-		     fblink = g_slist_next (fblink), ulink = g_slist_next (ulink)) {
-			icalcomponent *icalcomp = fblink->data;
+		for (ulink = (GSList *) users; ulink; ulink = g_slist_next (ulink)) {
+			icalcomponent *icalcomp;
 			gchar *mailto;
 
+			icalcomp = ulink->data ? g_hash_table_lookup (free_busy, ulink->data) : NULL;
+			if (!icalcomp)
+				continue;
+
 			/* add attendee property */
 			mailto = g_strconcat ("mailto:", ulink->data, NULL);
 			icalcomponent_add_property (icalcomp, icalproperty_new_attendee (mailto));
@@ -3830,9 +5316,9 @@ ecb_ews_get_free_busy_sync (ECalBackendSync *sync_backend,
 		}
 
 		*freebusyobjs = g_slist_reverse (*freebusyobjs);
-	}
 
-	g_slist_free_full (freebusy, (GDestroyNotify) icalcomponent_free);
+		g_hash_table_destroy (free_busy);
+	}
 
 	ecb_ews_convert_error_to_edc_error (error);
 	ecb_ews_maybe_disconnect_sync (cbews, error, cancellable);
@@ -4022,8 +5508,13 @@ ecb_ews_finalize (GObject *object)
 
 	g_free (cbews->priv->folder_id);
 	g_free (cbews->priv->attachments_dir);
+	g_hash_table_destroy (cbews->priv->free_busy_cache);
+	g_hash_table_destroy (cbews->priv->bulk_created);
+	g_hash_table_destroy (cbews->priv->bulk_loaded);
 
 	g_rec_mutex_clear (&cbews->priv->cnc_lock);
+	g_mutex_clear (&cbews->priv->free_busy_lock);
+	g_mutex_clear (&cbews->priv->bulk_lock);
 
 	e_cal_backend_ews_unref_windows_zones ();
 
@@ -4037,6 +5528,12 @@ e_cal_backend_ews_init (ECalBackendEws *cbews)
 	cbews->priv = G_TYPE_INSTANCE_GET_PRIVATE (cbews, E_TYPE_CAL_BACKEND_EWS, ECalBackendEwsPrivate);
 
 	g_rec_mutex_init (&cbews->priv->cnc_lock);
+	g_mutex_init (&cbews->priv->free_busy_lock);
+	g_mutex_init (&cbews->priv->bulk_lock);
+
+	cbews->priv->free_busy_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	cbews->priv->bulk_created = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ecb_ews_bulk_created_free);
+	cbews->priv->bulk_loaded = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) icalcomponent_free);
 
 	e_cal_backend_ews_populate_windows_zones ();
 }
@@ -4061,6 +5558,7 @@ e_cal_backend_ews_class_init (ECalBackendEwsClass *klass)
 	cal_meta_backend_class->remove_component_sync = ecb_ews_remove_component_sync;
 
 	cal_backend_sync_class = E_CAL_BACKEND_SYNC_CLASS (klass);
+	cal_backend_sync_class->create_objects_sync = ecb_ews_create_objects_sync;
 	cal_backend_sync_class->discard_alarm_sync = ecb_ews_discard_alarm_sync;
 	cal_backend_sync_class->receive_objects_sync = ecb_ews_receive_objects_sync;
 	cal_backend_sync_class->send_objects_sync = ecb_ews_send_objects_sync;
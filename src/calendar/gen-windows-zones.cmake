@@ -0,0 +1,81 @@
+# gen-windows-zones.cmake
+#
+# Generates a C header with two tables, sorted by their keys, mapping
+# the Windows (MSDN) time zone names to the IANA (iCal) time zone
+# locations and back, from the CLDR's windowsZones.xml.
+#
+# Usage:
+#    cmake -DINPUT=windowsZones.xml -DOUTPUT=e-cal-backend-ews-windows-zones.h -P gen-windows-zones.cmake
+#
+# The first mapping of a name wins, the same way the runtime parsing of
+# the file does it.
+
+if(NOT INPUT OR NOT OUTPUT)
+	message(FATAL_ERROR "Both INPUT and OUTPUT need to be set")
+endif(NOT INPUT OR NOT OUTPUT)
+
+file(READ "${INPUT}" _content)
+
+# Strip comments, thus commented out zones are not picked
+string(REGEX REPLACE "<!--([^-]|-[^-])*-->" "" _content "${_content}")
+string(REGEX MATCHALL "<mapZone[^>]*>" _zones "${_content}")
+
+set(_msdn_keys)
+set(_msdn_to_ical)
+set(_ical_keys)
+set(_ical_to_msdn)
+
+# The tab separates the key from the value, it sorts before any character used in the names
+set(_sep "\t")
+
+foreach(_zone IN LISTS _zones)
+	string(REGEX MATCH "other=\"([^\"]*)\"" _match "${_zone}")
+	set(_msdn "${CMAKE_MATCH_1}")
+	string(REGEX MATCH "type=\"([^\"]*)\"" _match "${_zone}")
+	set(_types "${CMAKE_MATCH_1}")
+
+	# Zones without both names are skipped
+	if(NOT _msdn STREQUAL "" AND NOT _types STREQUAL "")
+		string(REPLACE " " ";" _types "${_types}")
+
+		foreach(_ical IN LISTS _types)
+			list(FIND _msdn_keys "${_msdn}" _index)
+			if(_index EQUAL -1)
+				list(APPEND _msdn_keys "${_msdn}")
+				list(APPEND _msdn_to_ical "${_msdn}${_sep}${_ical}")
+			endif(_index EQUAL -1)
+
+			list(FIND _ical_keys "${_ical}" _index)
+			if(_index EQUAL -1)
+				list(APPEND _ical_keys "${_ical}")
+				list(APPEND _ical_to_msdn "${_ical}${_sep}${_msdn}")
+			endif(_index EQUAL -1)
+		endforeach(_ical)
+	endif(NOT _msdn STREQUAL "" AND NOT _types STREQUAL "")
+endforeach(_zone)
+
+list(SORT _msdn_to_ical)
+list(SORT _ical_to_msdn)
+
+macro(_write_table _name _entries)
+	set(_out "${_out}static const EwsWindowsZone ${_name}[] = {\n")
+	foreach(_entry IN LISTS ${_entries})
+		string(REPLACE "${_sep}" "\", \"" _entry "${_entry}")
+		set(_out "${_out}\t{ \"${_entry}\" },\n")
+	endforeach(_entry)
+	set(_out "${_out}};\n\n")
+endmacro(_write_table)
+
+set(_out "/* Generated from windowsZones.xml by gen-windows-zones.cmake, do not edit */\n\n")
+_write_table(ews_windows_zones_msdn_to_ical _msdn_to_ical)
+_write_table(ews_windows_zones_ical_to_msdn _ical_to_msdn)
+
+# Do not touch the file when nothing changed, to not rebuild the backend needlessly
+if(EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" _old)
+	if(_old STREQUAL _out)
+		return()
+	endif(_old STREQUAL _out)
+endif(EXISTS "${OUTPUT}")
+
+file(WRITE "${OUTPUT}" "${_out}")
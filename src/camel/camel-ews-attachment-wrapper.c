@@ -0,0 +1,226 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * This library is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "evolution-ews-config.h"
+
+#include <glib/gi18n-lib.h>
+
+#include "camel-ews-attachment-wrapper.h"
+
+#define CAMEL_EWS_ATTACHMENT_WRAPPER_GET_PRIVATE(obj) \
+	(G_TYPE_INSTANCE_GET_PRIVATE \
+	((obj), CAMEL_TYPE_EWS_ATTACHMENT_WRAPPER, CamelEwsAttachmentWrapperPrivate))
+
+struct _CamelEwsAttachmentWrapperPrivate {
+	GMutex lock;
+	GWeakRef ews_folder;
+	gchar *uid;
+	gchar *attachment_id;
+	gboolean downloaded;
+};
+
+G_DEFINE_TYPE (CamelEwsAttachmentWrapper, camel_ews_attachment_wrapper, CAMEL_TYPE_DATA_WRAPPER)
+
+static gboolean
+ews_attachment_wrapper_ensure_downloaded (CamelEwsAttachmentWrapper *wrapper,
+					  GCancellable *cancellable,
+					  GError **error)
+{
+	CamelEwsFolder *ews_folder;
+	GBytes *bytes;
+	gboolean success = TRUE;
+
+	g_mutex_lock (&wrapper->priv->lock);
+
+	if (wrapper->priv->downloaded) {
+		g_mutex_unlock (&wrapper->priv->lock);
+		return TRUE;
+	}
+
+	ews_folder = g_weak_ref_get (&wrapper->priv->ews_folder);
+	if (!ews_folder) {
+		g_set_error (
+			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+			_("Cannot download attachment, the folder is no longer available"));
+		g_mutex_unlock (&wrapper->priv->lock);
+		return FALSE;
+	}
+
+	bytes = camel_ews_folder_download_attachment_sync (ews_folder,
+		wrapper->priv->uid, wrapper->priv->attachment_id, cancellable, error);
+
+	if (bytes) {
+		GByteArray *byte_array;
+		gconstpointer data;
+		gsize size = 0;
+
+		data = g_bytes_get_data (bytes, &size);
+		byte_array = camel_data_wrapper_get_byte_array (CAMEL_DATA_WRAPPER (wrapper));
+
+		g_byte_array_set_size (byte_array, 0);
+		g_byte_array_append (byte_array, data, size);
+
+		wrapper->priv->downloaded = TRUE;
+
+		g_bytes_unref (bytes);
+	} else {
+		success = FALSE;
+	}
+
+	g_object_unref (ews_folder);
+
+	g_mutex_unlock (&wrapper->priv->lock);
+
+	return success;
+}
+
+static gssize
+ews_attachment_wrapper_write_to_stream_sync (CamelDataWrapper *data_wrapper,
+					     CamelStream *stream,
+					     GCancellable *cancellable,
+					     GError **error)
+{
+	if (!ews_attachment_wrapper_ensure_downloaded (CAMEL_EWS_ATTACHMENT_WRAPPER (data_wrapper), cancellable, error))
+		return -1;
+
+	/* Chain up to parent's method. */
+	return CAMEL_DATA_WRAPPER_CLASS (camel_ews_attachment_wrapper_parent_class)->
+		write_to_stream_sync (data_wrapper, stream, cancellable, error);
+}
+
+static gssize
+ews_attachment_wrapper_decode_to_stream_sync (CamelDataWrapper *data_wrapper,
+					      CamelStream *stream,
+					      GCancellable *cancellable,
+					      GError **error)
+{
+	if (!ews_attachment_wrapper_ensure_downloaded (CAMEL_EWS_ATTACHMENT_WRAPPER (data_wrapper), cancellable, error))
+		return -1;
+
+	/* Chain up to parent's method. */
+	return CAMEL_DATA_WRAPPER_CLASS (camel_ews_attachment_wrapper_parent_class)->
+		decode_to_stream_sync (data_wrapper, stream, cancellable, error);
+}
+
+static gssize
+ews_attachment_wrapper_write_to_output_stream_sync (CamelDataWrapper *data_wrapper,
+						    GOutputStream *output_stream,
+						    GCancellable *cancellable,
+						    GError **error)
+{
+	if (!ews_attachment_wrapper_ensure_downloaded (CAMEL_EWS_ATTACHMENT_WRAPPER (data_wrapper), cancellable, error))
+		return -1;
+
+	/* Chain up to parent's method. */
+	return CAMEL_DATA_WRAPPER_CLASS (camel_ews_attachment_wrapper_parent_class)->
+		write_to_output_stream_sync (data_wrapper, output_stream, cancellable, error);
+}
+
+static gssize
+ews_attachment_wrapper_decode_to_output_stream_sync (CamelDataWrapper *data_wrapper,
+						     GOutputStream *output_stream,
+						     GCancellable *cancellable,
+						     GError **error)
+{
+	if (!ews_attachment_wrapper_ensure_downloaded (CAMEL_EWS_ATTACHMENT_WRAPPER (data_wrapper), cancellable, error))
+		return -1;
+
+	/* Chain up to parent's method. */
+	return CAMEL_DATA_WRAPPER_CLASS (camel_ews_attachment_wrapper_parent_class)->
+		decode_to_output_stream_sync (data_wrapper, output_stream, cancellable, error);
+}
+
+static void
+ews_attachment_wrapper_finalize (GObject *object)
+{
+	CamelEwsAttachmentWrapper *wrapper = CAMEL_EWS_ATTACHMENT_WRAPPER (object);
+
+	g_weak_ref_clear (&wrapper->priv->ews_folder);
+	g_mutex_clear (&wrapper->priv->lock);
+	g_free (wrapper->priv->uid);
+	g_free (wrapper->priv->attachment_id);
+
+	/* Chain up to parent's method. */
+	G_OBJECT_CLASS (camel_ews_attachment_wrapper_parent_class)->finalize (object);
+}
+
+static void
+camel_ews_attachment_wrapper_class_init (CamelEwsAttachmentWrapperClass *class)
+{
+	GObjectClass *object_class;
+	CamelDataWrapperClass *data_wrapper_class;
+
+	g_type_class_add_private (class, sizeof (CamelEwsAttachmentWrapperPrivate));
+
+	object_class = G_OBJECT_CLASS (class);
+	object_class->finalize = ews_attachment_wrapper_finalize;
+
+	data_wrapper_class = CAMEL_DATA_WRAPPER_CLASS (class);
+	data_wrapper_class->write_to_stream_sync = ews_attachment_wrapper_write_to_stream_sync;
+	data_wrapper_class->decode_to_stream_sync = ews_attachment_wrapper_decode_to_stream_sync;
+	data_wrapper_class->write_to_output_stream_sync = ews_attachment_wrapper_write_to_output_stream_sync;
+	data_wrapper_class->decode_to_output_stream_sync = ews_attachment_wrapper_decode_to_output_stream_sync;
+}
+
+static void
+camel_ews_attachment_wrapper_init (CamelEwsAttachmentWrapper *wrapper)
+{
+	wrapper->priv = CAMEL_EWS_ATTACHMENT_WRAPPER_GET_PRIVATE (wrapper);
+
+	g_mutex_init (&wrapper->priv->lock);
+	g_weak_ref_init (&wrapper->priv->ews_folder, NULL);
+}
+
+CamelDataWrapper *
+camel_ews_attachment_wrapper_new (CamelEwsFolder *ews_folder,
+				  const gchar *uid,
+				  const gchar *attachment_id)
+{
+	CamelEwsAttachmentWrapper *wrapper;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), NULL);
+	g_return_val_if_fail (uid != NULL, NULL);
+	g_return_val_if_fail (attachment_id != NULL, NULL);
+
+	wrapper = g_object_new (CAMEL_TYPE_EWS_ATTACHMENT_WRAPPER, NULL);
+
+	g_weak_ref_set (&wrapper->priv->ews_folder, ews_folder);
+	wrapper->priv->uid = g_strdup (uid);
+	wrapper->priv->attachment_id = g_strdup (attachment_id);
+
+	return CAMEL_DATA_WRAPPER (wrapper);
+}
+
+const gchar *
+camel_ews_attachment_wrapper_get_attachment_id (CamelEwsAttachmentWrapper *wrapper)
+{
+	g_return_val_if_fail (CAMEL_IS_EWS_ATTACHMENT_WRAPPER (wrapper), NULL);
+
+	return wrapper->priv->attachment_id;
+}
+
+gboolean
+camel_ews_attachment_wrapper_is_downloaded (CamelEwsAttachmentWrapper *wrapper)
+{
+	gboolean downloaded;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_ATTACHMENT_WRAPPER (wrapper), FALSE);
+
+	g_mutex_lock (&wrapper->priv->lock);
+	downloaded = wrapper->priv->downloaded;
+	g_mutex_unlock (&wrapper->priv->lock);
+
+	return downloaded;
+}
@@ -0,0 +1,725 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * This library is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "evolution-ews-config.h"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <glib/gstdio.h>
+
+#include "camel-ews-cache-budget.h"
+
+/* The file consists of a header line, an "S" line when the existing
+   caches had been seeded, the pinned folders as "P <folder>" lines and
+   the messages as "E <time> <size> <key> <folder>" lines, from the least
+   recently used; the folder names are escaped with g_strescape(). */
+#define CACHE_BUDGET_HEADER "ews-cache-budget 1"
+
+/* Names of the files in the CamelDataCache are SHA256 checksums */
+#define CACHE_KEY_LENGTH 64
+
+typedef struct _BudgetEntry {
+	gchar *folder_name;
+	gchar *key;
+	gchar *hash_key;
+	guint64 size;
+	gint64 access_time; /* in seconds */
+} BudgetEntry;
+
+struct _CamelEwsCacheBudget {
+	GMutex lock;
+	gchar *filename;
+	gboolean seeded;
+	gboolean dirty;
+	guint64 limit;
+	guint64 total_size;
+	GQueue entries;		/* BudgetEntry *, the most recently used first */
+	GHashTable *index;	/* gchar *hash_key ~> GList * link into entries */
+	GHashTable *pinned;	/* gchar *folder_name ~> NULL */
+};
+
+static void
+budget_entry_free (gpointer ptr)
+{
+	BudgetEntry *entry = ptr;
+
+	if (entry) {
+		g_free (entry->folder_name);
+		g_free (entry->key);
+		g_free (entry->hash_key);
+		g_free (entry);
+	}
+}
+
+static gchar *
+budget_make_hash_key (const gchar *folder_name,
+		      const gchar *key)
+{
+	return g_strconcat (folder_name, "\n", key, NULL);
+}
+
+/* Adds a new entry, either as the most or the least recently used;
+   call with the lock held */
+static void
+budget_add_entry_locked (CamelEwsCacheBudget *budget,
+			 const gchar *folder_name,
+			 const gchar *key,
+			 guint64 size,
+			 gint64 access_time,
+			 gboolean as_newest)
+{
+	BudgetEntry *entry;
+
+	entry = g_new0 (BudgetEntry, 1);
+	entry->folder_name = g_strdup (folder_name);
+	entry->key = g_strdup (key);
+	entry->hash_key = budget_make_hash_key (folder_name, key);
+	entry->size = size;
+	entry->access_time = access_time;
+
+	if (as_newest) {
+		g_queue_push_head (&budget->entries, entry);
+		g_hash_table_insert (budget->index, entry->hash_key, budget->entries.head);
+	} else {
+		g_queue_push_tail (&budget->entries, entry);
+		g_hash_table_insert (budget->index, entry->hash_key, budget->entries.tail);
+	}
+
+	budget->total_size += size;
+	budget->dirty = TRUE;
+}
+
+static void
+budget_load (CamelEwsCacheBudget *budget)
+{
+	gchar *contents = NULL;
+	gchar **lines;
+	guint ii;
+
+	if (!g_file_get_contents (budget->filename, &contents, NULL, NULL))
+		return;
+
+	lines = g_strsplit (contents, "\n", -1);
+	g_free (contents);
+
+	if (!lines[0] || g_strcmp0 (lines[0], CACHE_BUDGET_HEADER) != 0) {
+		g_strfreev (lines);
+		return;
+	}
+
+	for (ii = 1; lines[ii]; ii++) {
+		const gchar *line = lines[ii];
+
+		if (line[0] == 'S' && !line[1]) {
+			budget->seeded = TRUE;
+		} else if (line[0] == 'P' && line[1] == ' ' && line[2]) {
+			g_hash_table_add (budget->pinned, g_strcompress (line + 2));
+		} else if (line[0] == 'E' && line[1] == ' ') {
+			gchar **tokens;
+
+			tokens = g_strsplit (line + 2, " ", 4);
+
+			if (g_strv_length (tokens) == 4 && *tokens[2] && *tokens[3]) {
+				gchar *folder_name, *hash_key;
+
+				folder_name = g_strcompress (tokens[3]);
+				hash_key = budget_make_hash_key (folder_name, tokens[2]);
+
+				/* The lines go from the least recently used */
+				if (!g_hash_table_contains (budget->index, hash_key)) {
+					budget_add_entry_locked (budget, folder_name, tokens[2],
+						g_ascii_strtoull (tokens[1], NULL, 10),
+						g_ascii_strtoll (tokens[0], NULL, 10), TRUE);
+				}
+
+				g_free (hash_key);
+				g_free (folder_name);
+			}
+
+			g_strfreev (tokens);
+		}
+	}
+
+	g_strfreev (lines);
+
+	budget->dirty = FALSE;
+}
+
+/**
+ * camel_ews_cache_budget_new:
+ * @filename: where to store the state
+ *
+ * Creates a new #CamelEwsCacheBudget, with the state loaded from @filename,
+ * when it exists. The limit is unset, thus nothing is evicted, until
+ * camel_ews_cache_budget_set_limit() is called.
+ *
+ * Returns: (transfer full): a new #CamelEwsCacheBudget
+ **/
+CamelEwsCacheBudget *
+camel_ews_cache_budget_new (const gchar *filename)
+{
+	CamelEwsCacheBudget *budget;
+
+	g_return_val_if_fail (filename != NULL, NULL);
+
+	budget = g_new0 (CamelEwsCacheBudget, 1);
+	g_mutex_init (&budget->lock);
+	g_queue_init (&budget->entries);
+	budget->filename = g_strdup (filename);
+	budget->index = g_hash_table_new (g_str_hash, g_str_equal);
+	budget->pinned = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	budget_load (budget);
+
+	return budget;
+}
+
+void
+camel_ews_cache_budget_free (CamelEwsCacheBudget *budget)
+{
+	if (!budget)
+		return;
+
+	g_hash_table_destroy (budget->index);
+	g_hash_table_destroy (budget->pinned);
+	g_queue_foreach (&budget->entries, (GFunc) budget_entry_free, NULL);
+	g_queue_clear (&budget->entries);
+	g_mutex_clear (&budget->lock);
+	g_free (budget->filename);
+	g_free (budget);
+}
+
+/* Saves the state, when it changed since the last save */
+gboolean
+camel_ews_cache_budget_save (CamelEwsCacheBudget *budget,
+			     GError **error)
+{
+	GHashTableIter iter;
+	GString *contents;
+	GList *link;
+	gpointer key;
+	gboolean success;
+
+	g_return_val_if_fail (budget != NULL, FALSE);
+
+	g_mutex_lock (&budget->lock);
+
+	if (!budget->dirty) {
+		g_mutex_unlock (&budget->lock);
+		return TRUE;
+	}
+
+	contents = g_string_sized_new (128 * (g_queue_get_length (&budget->entries) + 1));
+	g_string_append (contents, CACHE_BUDGET_HEADER "\n");
+
+	if (budget->seeded)
+		g_string_append (contents, "S\n");
+
+	g_hash_table_iter_init (&iter, budget->pinned);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		gchar *escaped = g_strescape (key, NULL);
+
+		g_string_append_printf (contents, "P %s\n", escaped);
+
+		g_free (escaped);
+	}
+
+	for (link = budget->entries.tail; link; link = g_list_previous (link)) {
+		BudgetEntry *entry = link->data;
+		gchar *escaped = g_strescape (entry->folder_name, NULL);
+
+		g_string_append_printf (contents, "E %" G_GINT64_FORMAT " %" G_GUINT64_FORMAT " %s %s\n",
+			entry->access_time, entry->size, entry->key, escaped);
+
+		g_free (escaped);
+	}
+
+	budget->dirty = FALSE;
+
+	g_mutex_unlock (&budget->lock);
+
+	success = g_file_set_contents (budget->filename, contents->str, contents->len, error);
+
+	if (!success) {
+		g_mutex_lock (&budget->lock);
+		budget->dirty = TRUE;
+		g_mutex_unlock (&budget->lock);
+	}
+
+	g_string_free (contents, TRUE);
+
+	return success;
+}
+
+/* Whether the budget knows about the messages cached before it existed,
+   either from its saved state or from camel_ews_cache_budget_seed_from_dir() */
+gboolean
+camel_ews_cache_budget_get_seeded (CamelEwsCacheBudget *budget)
+{
+	gboolean seeded;
+
+	g_return_val_if_fail (budget != NULL, FALSE);
+
+	g_mutex_lock (&budget->lock);
+	seeded = budget->seeded;
+	g_mutex_unlock (&budget->lock);
+
+	return seeded;
+}
+
+typedef struct _SeedFile {
+	gchar *folder_name;
+	gchar *key;
+	guint64 size;
+	gint64 mtime;
+} SeedFile;
+
+static void
+seed_file_free (gpointer ptr)
+{
+	SeedFile *sf = ptr;
+
+	if (sf) {
+		g_free (sf->folder_name);
+		g_free (sf->key);
+		g_free (sf);
+	}
+}
+
+static gint
+seed_file_compare_newest_first (gconstpointer ptr1,
+				gconstpointer ptr2)
+{
+	const SeedFile *sf1 = *((const SeedFile **) ptr1);
+	const SeedFile *sf2 = *((const SeedFile **) ptr2);
+
+	if (sf1->mtime == sf2->mtime)
+		return 0;
+
+	return sf1->mtime > sf2->mtime ? -1 : 1;
+}
+
+static gboolean
+budget_is_cache_key (const gchar *name)
+{
+	gint ii;
+
+	for (ii = 0; ii < CACHE_KEY_LENGTH; ii++) {
+		if (!g_ascii_isxdigit (name[ii]))
+			return FALSE;
+	}
+
+	return name[ii] == '\0';
+}
+
+/* Collects the messages from the "cur/XX/" subdirectories of the CamelDataCache */
+static void
+budget_seed_collect_cache_dir (GPtrArray *files,
+			       const gchar *folder_name,
+			       const gchar *cur_dir)
+{
+	GDir *dir;
+	const gchar *bucket;
+
+	dir = g_dir_open (cur_dir, 0, NULL);
+	if (!dir)
+		return;
+
+	while ((bucket = g_dir_read_name (dir)) != NULL) {
+		GDir *bucket_dir;
+		gchar *bucket_path;
+		const gchar *name;
+
+		if (strlen (bucket) != 2 || !g_ascii_isxdigit (bucket[0]) || !g_ascii_isxdigit (bucket[1]))
+			continue;
+
+		bucket_path = g_build_filename (cur_dir, bucket, NULL);
+		bucket_dir = g_dir_open (bucket_path, 0, NULL);
+
+		while (bucket_dir && (name = g_dir_read_name (bucket_dir)) != NULL) {
+			GStatBuf st;
+			gchar *filename;
+
+			if (!budget_is_cache_key (name))
+				continue;
+
+			filename = g_build_filename (bucket_path, name, NULL);
+
+			if (g_stat (filename, &st) == 0 && S_ISREG (st.st_mode)) {
+				SeedFile *sf;
+
+				sf = g_new0 (SeedFile, 1);
+				sf->folder_name = g_strdup (folder_name);
+				sf->key = g_strdup (name);
+				sf->size = st.st_size;
+				sf->mtime = MAX (st.st_atime, st.st_mtime);
+
+				g_ptr_array_add (files, sf);
+			}
+
+			g_free (filename);
+		}
+
+		if (bucket_dir)
+			g_dir_close (bucket_dir);
+		g_free (bucket_path);
+	}
+
+	g_dir_close (dir);
+}
+
+static void
+budget_seed_collect (GPtrArray *files,
+		     const gchar *folder_name, /* NULL for the top directory */
+		     const gchar *path)
+{
+	GDir *dir;
+	const gchar *name;
+
+	dir = g_dir_open (path, 0, NULL);
+	if (!dir)
+		return;
+
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		gchar *subpath, *subfolder_name;
+
+		subpath = g_build_filename (path, name, NULL);
+
+		if (!g_file_test (subpath, G_FILE_TEST_IS_DIR)) {
+			g_free (subpath);
+			continue;
+		}
+
+		if (folder_name && g_strcmp0 (name, "cur") == 0) {
+			budget_seed_collect_cache_dir (files, folder_name, subpath);
+			g_free (subpath);
+			continue;
+		}
+
+		/* Subfolders are stored in the subdirectories of the folder's directory */
+		if (folder_name)
+			subfolder_name = g_strconcat (folder_name, "/", name, NULL);
+		else
+			subfolder_name = g_strdup (name);
+
+		budget_seed_collect (files, subfolder_name, subpath);
+
+		g_free (subfolder_name);
+		g_free (subpath);
+	}
+
+	g_dir_close (dir);
+}
+
+/**
+ * camel_ews_cache_budget_seed_from_dir:
+ * @budget: a #CamelEwsCacheBudget
+ * @folders_dir: the directory with the folders' directories
+ *
+ * Adds the messages, which are already in the folders' caches, but the budget
+ * does not know about them, as the least recently used, ordered by their
+ * file times. This is meant to be called once, for the caches, which
+ * existed before the budget.
+ **/
+void
+camel_ews_cache_budget_seed_from_dir (CamelEwsCacheBudget *budget,
+				      const gchar *folders_dir)
+{
+	GPtrArray *files;
+	guint ii;
+
+	g_return_if_fail (budget != NULL);
+	g_return_if_fail (folders_dir != NULL);
+
+	files = g_ptr_array_new_with_free_func (seed_file_free);
+
+	budget_seed_collect (files, NULL, folders_dir);
+
+	g_ptr_array_sort (files, seed_file_compare_newest_first);
+
+	g_mutex_lock (&budget->lock);
+
+	for (ii = 0; ii < files->len; ii++) {
+		SeedFile *sf = g_ptr_array_index (files, ii);
+		gchar *hash_key;
+
+		hash_key = budget_make_hash_key (sf->folder_name, sf->key);
+
+		/* Those accessed in the meantime are already known */
+		if (!g_hash_table_contains (budget->index, hash_key))
+			budget_add_entry_locked (budget, sf->folder_name, sf->key, sf->size, sf->mtime, FALSE);
+
+		g_free (hash_key);
+	}
+
+	budget->seeded = TRUE;
+	budget->dirty = TRUE;
+
+	g_mutex_unlock (&budget->lock);
+
+	g_ptr_array_unref (files);
+}
+
+guint64
+camel_ews_cache_budget_get_limit (CamelEwsCacheBudget *budget)
+{
+	guint64 limit;
+
+	g_return_val_if_fail (budget != NULL, 0);
+
+	g_mutex_lock (&budget->lock);
+	limit = budget->limit;
+	g_mutex_unlock (&budget->lock);
+
+	return limit;
+}
+
+/* Sets the limit of the cache size in bytes; 0 means no limit */
+void
+camel_ews_cache_budget_set_limit (CamelEwsCacheBudget *budget,
+				  guint64 limit)
+{
+	g_return_if_fail (budget != NULL);
+
+	g_mutex_lock (&budget->lock);
+	budget->limit = limit;
+	g_mutex_unlock (&budget->lock);
+}
+
+guint64
+camel_ews_cache_budget_get_total_size (CamelEwsCacheBudget *budget)
+{
+	guint64 total_size;
+
+	g_return_val_if_fail (budget != NULL, 0);
+
+	g_mutex_lock (&budget->lock);
+	total_size = budget->total_size;
+	g_mutex_unlock (&budget->lock);
+
+	return total_size;
+}
+
+guint
+camel_ews_cache_budget_get_n_entries (CamelEwsCacheBudget *budget)
+{
+	guint n_entries;
+
+	g_return_val_if_fail (budget != NULL, 0);
+
+	g_mutex_lock (&budget->lock);
+	n_entries = g_queue_get_length (&budget->entries);
+	g_mutex_unlock (&budget->lock);
+
+	return n_entries;
+}
+
+/**
+ * camel_ews_cache_budget_touch:
+ * @budget: a #CamelEwsCacheBudget
+ * @folder_name: full name of the folder
+ * @key: key of the message in the folder's cache
+ * @size: size of the cached message, in bytes
+ *
+ * Records an access to the cached message, which makes it
+ * the most recently used. It is added, when not known yet.
+ *
+ * Returns: whether the cache is over its limit, thus
+ *    camel_ews_cache_budget_evict() should be called
+ **/
+gboolean
+camel_ews_cache_budget_touch (CamelEwsCacheBudget *budget,
+			      const gchar *folder_name,
+			      const gchar *key,
+			      guint64 size)
+{
+	GList *link;
+	gchar *hash_key;
+	gboolean over_limit;
+
+	g_return_val_if_fail (budget != NULL, FALSE);
+	g_return_val_if_fail (folder_name != NULL, FALSE);
+	g_return_val_if_fail (key != NULL, FALSE);
+
+	hash_key = budget_make_hash_key (folder_name, key);
+
+	g_mutex_lock (&budget->lock);
+
+	link = g_hash_table_lookup (budget->index, hash_key);
+	if (link) {
+		BudgetEntry *entry = link->data;
+
+		budget->total_size -= entry->size;
+		budget->total_size += size;
+		entry->size = size;
+		entry->access_time = g_get_real_time () / G_USEC_PER_SEC;
+
+		if (link != budget->entries.head) {
+			g_queue_unlink (&budget->entries, link);
+			g_queue_push_head_link (&budget->entries, link);
+		}
+
+		budget->dirty = TRUE;
+	} else {
+		budget_add_entry_locked (budget, folder_name, key, size, g_get_real_time () / G_USEC_PER_SEC, TRUE);
+	}
+
+	over_limit = budget->limit > 0 && budget->total_size > budget->limit;
+
+	g_mutex_unlock (&budget->lock);
+
+	g_free (hash_key);
+
+	return over_limit;
+}
+
+/* Forgets the message, which had been removed from the cache */
+void
+camel_ews_cache_budget_remove (CamelEwsCacheBudget *budget,
+			       const gchar *folder_name,
+			       const gchar *key)
+{
+	GList *link;
+	gchar *hash_key;
+
+	g_return_if_fail (budget != NULL);
+	g_return_if_fail (folder_name != NULL);
+	g_return_if_fail (key != NULL);
+
+	hash_key = budget_make_hash_key (folder_name, key);
+
+	g_mutex_lock (&budget->lock);
+
+	link = g_hash_table_lookup (budget->index, hash_key);
+	if (link) {
+		BudgetEntry *entry = link->data;
+
+		g_hash_table_remove (budget->index, hash_key);
+		g_queue_delete_link (&budget->entries, link);
+
+		budget->total_size -= entry->size;
+		budget->dirty = TRUE;
+
+		budget_entry_free (entry);
+	}
+
+	g_mutex_unlock (&budget->lock);
+
+	g_free (hash_key);
+}
+
+gboolean
+camel_ews_cache_budget_get_folder_pinned (CamelEwsCacheBudget *budget,
+					  const gchar *folder_name)
+{
+	gboolean pinned;
+
+	g_return_val_if_fail (budget != NULL, FALSE);
+	g_return_val_if_fail (folder_name != NULL, FALSE);
+
+	g_mutex_lock (&budget->lock);
+	pinned = g_hash_table_contains (budget->pinned, folder_name);
+	g_mutex_unlock (&budget->lock);
+
+	return pinned;
+}
+
+/* Messages of the pinned folders are never evicted */
+void
+camel_ews_cache_budget_set_folder_pinned (CamelEwsCacheBudget *budget,
+					  const gchar *folder_name,
+					  gboolean pinned)
+{
+	g_return_if_fail (budget != NULL);
+	g_return_if_fail (folder_name != NULL);
+
+	g_mutex_lock (&budget->lock);
+
+	if ((pinned ? 1 : 0) != (g_hash_table_contains (budget->pinned, folder_name) ? 1 : 0)) {
+		if (pinned)
+			g_hash_table_add (budget->pinned, g_strdup (folder_name));
+		else
+			g_hash_table_remove (budget->pinned, folder_name);
+
+		budget->dirty = TRUE;
+	}
+
+	g_mutex_unlock (&budget->lock);
+}
+
+/**
+ * camel_ews_cache_budget_evict:
+ * @budget: a #CamelEwsCacheBudget
+ * @func: (scope call): function to remove a message from the cache
+ * @user_data: user data for @func
+ *
+ * Forgets the least recently used messages of the not pinned folders,
+ * until the cache fits its limit, and calls @func for each of them,
+ * without holding the @budget lock, thus they can be removed
+ * from the cache.
+ *
+ * Returns: how many messages had been evicted
+ **/
+guint
+camel_ews_cache_budget_evict (CamelEwsCacheBudget *budget,
+			      CamelEwsCacheBudgetEvictFunc func,
+			      gpointer user_data)
+{
+	GSList *evicted = NULL, *slink;
+	GList *link;
+	guint n_evicted = 0;
+
+	g_return_val_if_fail (budget != NULL, 0);
+	g_return_val_if_fail (func != NULL, 0);
+
+	g_mutex_lock (&budget->lock);
+
+	link = budget->entries.tail;
+
+	while (link && budget->limit > 0 && budget->total_size > budget->limit) {
+		BudgetEntry *entry = link->data;
+		GList *prev = g_list_previous (link);
+
+		if (!g_hash_table_contains (budget->pinned, entry->folder_name)) {
+			g_hash_table_remove (budget->index, entry->hash_key);
+			g_queue_delete_link (&budget->entries, link);
+
+			budget->total_size -= entry->size;
+			budget->dirty = TRUE;
+
+			evicted = g_slist_prepend (evicted, entry);
+			n_evicted++;
+		}
+
+		link = prev;
+	}
+
+	g_mutex_unlock (&budget->lock);
+
+	/* From the least recently used */
+	evicted = g_slist_reverse (evicted);
+
+	for (slink = evicted; slink; slink = g_slist_next (slink)) {
+		BudgetEntry *entry = slink->data;
+
+		func (entry->folder_name, entry->key, user_data);
+	}
+
+	g_slist_free_full (evicted, budget_entry_free);
+
+	return n_evicted;
+}
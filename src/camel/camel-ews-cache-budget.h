@@ -0,0 +1,70 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * This library is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAMEL_EWS_CACHE_BUDGET_H
+#define CAMEL_EWS_CACHE_BUDGET_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Keeps the size and the last access time of the cached messages of all
+   folders of a store, ordered from the most recently used, thus the least
+   recently used messages can be removed from the cache when it grows over
+   its limit. The messages are identified by the folder name and their key
+   in the folder's CamelDataCache. Messages of the pinned folders, those
+   synchronized for offline use, are never evicted. The structure is
+   thread-safe. */
+
+typedef struct _CamelEwsCacheBudget CamelEwsCacheBudget;
+
+typedef void	(* CamelEwsCacheBudgetEvictFunc)	(const gchar *folder_name,
+							 const gchar *key,
+							 gpointer user_data);
+
+CamelEwsCacheBudget *
+		camel_ews_cache_budget_new		(const gchar *filename);
+void		camel_ews_cache_budget_free		(CamelEwsCacheBudget *budget);
+gboolean	camel_ews_cache_budget_save		(CamelEwsCacheBudget *budget,
+							 GError **error);
+gboolean	camel_ews_cache_budget_get_seeded	(CamelEwsCacheBudget *budget);
+void		camel_ews_cache_budget_seed_from_dir	(CamelEwsCacheBudget *budget,
+							 const gchar *folders_dir);
+guint64		camel_ews_cache_budget_get_limit	(CamelEwsCacheBudget *budget);
+void		camel_ews_cache_budget_set_limit	(CamelEwsCacheBudget *budget,
+							 guint64 limit);
+guint64		camel_ews_cache_budget_get_total_size	(CamelEwsCacheBudget *budget);
+guint		camel_ews_cache_budget_get_n_entries	(CamelEwsCacheBudget *budget);
+gboolean	camel_ews_cache_budget_touch		(CamelEwsCacheBudget *budget,
+							 const gchar *folder_name,
+							 const gchar *key,
+							 guint64 size);
+void		camel_ews_cache_budget_remove		(CamelEwsCacheBudget *budget,
+							 const gchar *folder_name,
+							 const gchar *key);
+gboolean	camel_ews_cache_budget_get_folder_pinned
+							(CamelEwsCacheBudget *budget,
+							 const gchar *folder_name);
+void		camel_ews_cache_budget_set_folder_pinned
+							(CamelEwsCacheBudget *budget,
+							 const gchar *folder_name,
+							 gboolean pinned);
+guint		camel_ews_cache_budget_evict		(CamelEwsCacheBudget *budget,
+							 CamelEwsCacheBudgetEvictFunc func,
+							 gpointer user_data);
+
+G_END_DECLS
+
+#endif /* CAMEL_EWS_CACHE_BUDGET_H */
@@ -31,6 +31,7 @@ which needs to be better organized via functions */
 #include "evolution-ews-config.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
@@ -45,9 +46,11 @@ which needs to be better organized via functions */
 #include "server/camel-ews-settings.h"
 #include "server/e-ews-camel-common.h"
 #include "server/e-ews-connection.h"
+#include "server/e-ews-connection-utils.h"
 #include "server/e-ews-item-change.h"
 #include "server/e-ews-message.h"
 
+#include "camel-ews-attachment-wrapper.h"
 #include "camel-ews-folder.h"
 #include "camel-ews-private.h"
 #include "camel-ews-search.h"
@@ -57,8 +60,33 @@ which needs to be better organized via functions */
 
 #define EWS_MAX_FETCH_COUNT 100
 
+/* How many messages can have their flags saved with one UpdateItem request */
+#define EWS_SAVE_FLAGS_BATCH_SIZE 500
+
+/* The flag changes are saved on the server this many seconds after the first
+   unsaved change, or sooner, when at least EWS_SAVE_FLAGS_BATCH_SIZE messages changed */
+#define EWS_SAVE_FLAGS_DELAY 5
+
+/* The flags, which are stored on the server */
+#define EWS_SERVER_FLAGS (CAMEL_MESSAGE_SEEN | CAMEL_MESSAGE_ANSWERED | CAMEL_MESSAGE_FORWARDED | CAMEL_MESSAGE_FLAGGED)
+
 #define MAX_ATTACHMENT_SIZE 1*1024*1024   /*In bytes*/
 
+/* Downloaded messages larger than this, in bytes, are moved into the cache
+   uncompressed, with a rename, instead of compressing the whole file */
+#define EWS_CACHE_COMPRESS_MAX_SIZE (8 * 1024 * 1024)
+
+/* The summary uses only the already known SMTP addresses of the EX addresses;
+   the others are resolved later, at most this many in one background pass... */
+#define EWS_EX_RESOLVE_BATCH_SIZE 50
+/* ...and at most this many are waiting for it */
+#define EWS_EX_RESOLVE_MAX_QUEUED 1000
+
+/* Attachments, which are not downloaded yet, are stored in the message cache
+   as empty parts with these headers; the parts without them are complete */
+#define EWS_ATTACHMENT_ID_HEADER "X-Evolution-Ews-Attachment-Id"
+#define EWS_ATTACHMENT_SIZE_HEADER "X-Evolution-Ews-Attachment-Size"
+
 /* there are written more follow-up flags, but it's read only few of them */
 #define SUMMARY_ITEM_FLAGS "item:ResponseObjects item:Sensitivity item:Importance item:Categories"
 
@@ -74,6 +102,10 @@ which needs to be better organized via functions */
 
 #define SUMMARY_POSTITEM_PROPS ITEM_PROPS " " SUMMARY_ITEM_FLAGS " message:From message:Sender"
 
+/* What the FindItem can return, used to show the newest messages on the first sync */
+#define SUMMARY_HEADER_PROPS "item:Subject item:DateTimeReceived item:DateTimeSent item:DateTimeCreated item:Size " \
+		   "item:HasAttachments " SUMMARY_ITEM_FLAGS " message:From message:Sender message:IsRead"
+
 #define CAMEL_EWS_FOLDER_GET_PRIVATE(obj) \
 	(G_TYPE_INSTANCE_GET_PRIVATE \
 	((obj), CAMEL_TYPE_EWS_FOLDER, CamelEwsFolderPrivate))
@@ -88,8 +120,25 @@ struct _CamelEwsFolderPrivate {
 	GMutex state_lock;
 	GCond fetch_cond;
 	GHashTable *fetching_uids;
+	GHashTable *transferred_uids; /* pstring ~> NULL, items added by move/copy, not refreshed yet */
+
+	CamelIndex *body_index; /* words of the cached messages, can be NULL */
+
+	GMutex save_flags_lock;
+	guint save_flags_id;
+	guint n_flags_changed;
+	gboolean save_flags_soon;
+
+	GMutex ex_resolve_lock;
+	GHashTable *ex_unresolved; /* gchar *ex_address ~> ExUnresolved * */
+	gboolean ex_resolve_scheduled;
 };
 
+typedef struct _ExUnresolved {
+	gchar *name;
+	GHashTable *uids; /* pstring ~> NULL, messages using the address */
+} ExUnresolved;
+
 static gboolean ews_delete_messages (CamelFolder *folder, const GSList *deleted_items, gboolean expunge, GCancellable *cancellable, GError **error);
 static gboolean ews_refresh_info_sync (CamelFolder *folder, GCancellable *cancellable, GError **error);
 
@@ -97,6 +146,18 @@ static gboolean ews_refresh_info_sync (CamelFolder *folder, GCancellable *cancel
 
 G_DEFINE_TYPE (CamelEwsFolder, camel_ews_folder, CAMEL_TYPE_OFFLINE_FOLDER)
 
+/* Messages added by the ews_folder_sync_newest_sync() have an empty change key,
+   until the SyncFolderItems reports them and they are fetched completely */
+static gboolean
+ews_message_info_is_header_only (CamelMessageInfo *mi)
+{
+	const gchar *change_key;
+
+	change_key = camel_ews_message_info_get_change_key (CAMEL_EWS_MESSAGE_INFO (mi));
+
+	return change_key && !*change_key;
+}
+
 static GSList *
 ews_folder_get_summary_followup_mapi_flags (void)
 {
@@ -174,31 +235,13 @@ ews_folder_get_summary_message_mapi_flags (void)
 	return list;
 }
 
-static gchar *
-ews_get_filename (CamelFolder *folder,
-                  const gchar *uid,
-                  GError **error)
-{
-	CamelEwsFolder *ews_folder = CAMEL_EWS_FOLDER (folder);
-	GChecksum *sha = g_checksum_new (G_CHECKSUM_SHA256);
-	gchar *filename;
-
-	g_checksum_update (sha, (guchar *) uid, strlen (uid));
-	filename = camel_data_cache_get_filename (
-		ews_folder->cache, "cur", g_checksum_get_string (sha));
-	g_checksum_free (sha);
-
-	return filename;
-}
-
-static CamelStream *
+static GIOStream *
 ews_data_cache_add (CamelDataCache *cdc,
 		    const gchar *path,
 		    const gchar *key,
 		    GError **error)
 {
 	GIOStream *base_stream;
-	CamelStream *stream = NULL;
 	GChecksum *sha = g_checksum_new (G_CHECKSUM_SHA256);
 
 	g_checksum_update (sha, (guchar *) key, strlen (key));
@@ -206,12 +249,7 @@ ews_data_cache_add (CamelDataCache *cdc,
 		cdc, path, g_checksum_get_string (sha), error);
 	g_checksum_free (sha);
 
-	if (base_stream != NULL)
-		stream = camel_stream_new (base_stream);
-
-	g_object_unref (base_stream);
-
-	return stream;
+	return base_stream;
 }
 
 static gint
@@ -231,26 +269,21 @@ ews_data_cache_remove (CamelDataCache *cdc,
 	return ret;
 }
 
-static CamelStream *
+static GIOStream *
 ews_data_cache_get (CamelDataCache *cdc,
                     const gchar *path,
                     const gchar *key,
                     GError **error)
 {
 	GChecksum *sha = g_checksum_new (G_CHECKSUM_SHA256);
-	CamelStream *stream = NULL;
 	GIOStream *base_stream;
 
 	g_checksum_update (sha, (guchar *) key, strlen (key));
 	base_stream = camel_data_cache_get (
 		cdc, path, g_checksum_get_string (sha), error);
-	if (base_stream != NULL) {
-		stream = camel_stream_new (base_stream);
-		g_object_unref (base_stream);
-	}
 	g_checksum_free (sha);
 
-	return stream;
+	return base_stream;
 }
 
 static gchar *
@@ -270,21 +303,262 @@ ews_data_cache_get_filename (CamelDataCache *cdc,
 	return filename;
 }
 
+/* Stores the 'message' into the cache, compressed; it replaces
+   the previously cached message */
+static gboolean
+ews_data_cache_add_message (CamelDataCache *cdc,
+			    const gchar *path,
+			    const gchar *key,
+			    CamelMimeMessage *message,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	GIOStream *base_stream;
+	GOutputStream *output_stream;
+	gboolean success;
+
+	base_stream = ews_data_cache_add (cdc, path, key, error);
+	if (!base_stream)
+		return FALSE;
+
+	output_stream = camel_ews_utils_new_cache_output_stream (g_io_stream_get_output_stream (base_stream));
+
+	success = camel_data_wrapper_write_to_output_stream_sync (CAMEL_DATA_WRAPPER (message), output_stream, cancellable, error) != -1 &&
+		g_output_stream_close (output_stream, cancellable, error);
+
+	g_object_unref (output_stream);
+	g_object_unref (base_stream);
+
+	/* Do not leave there a partial message */
+	if (!success)
+		ews_data_cache_remove (cdc, path, key, NULL);
+
+	return success;
+}
+
+/* Moves the message downloaded into the 'filename' into the cache, compressed,
+   unless it is larger than EWS_CACHE_COMPRESS_MAX_SIZE */
+static gboolean
+ews_data_cache_add_file (CamelDataCache *cdc,
+			 const gchar *path,
+			 const gchar *key,
+			 const gchar *filename,
+			 GCancellable *cancellable,
+			 GError **error)
+{
+	GFile *file;
+	GFileInputStream *input_stream;
+	GIOStream *base_stream;
+	GOutputStream *output_stream;
+	GStatBuf st;
+	gboolean success;
+
+	if (g_stat (filename, &st) == 0 && st.st_size > EWS_CACHE_COMPRESS_MAX_SIZE) {
+		gchar *cache_file, *dir;
+
+		cache_file = ews_data_cache_get_filename (cdc, path, key, NULL);
+		dir = g_path_get_dirname (cache_file);
+
+		if (g_mkdir_with_parents (dir, 0700) == -1) {
+			g_set_error (
+				error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+				_("Unable to create cache path “%s”: %s"),
+				dir, g_strerror (errno));
+			g_free (dir);
+			g_free (cache_file);
+			return FALSE;
+		}
+
+		g_free (dir);
+
+		if (g_rename (filename, cache_file) != 0) {
+			g_set_error (
+				error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+				/* Translators: The first %s consists of the source file name,
+				   the second %s of the destination file name and
+				   the third %s of the error message. */
+				_("Failed to move message cache file from “%s” to “%s”: %s"),
+				filename, cache_file, g_strerror (errno));
+			g_free (cache_file);
+			return FALSE;
+		}
+
+		g_free (cache_file);
+
+		return TRUE;
+	}
+
+	file = g_file_new_for_path (filename);
+	input_stream = g_file_read (file, cancellable, error);
+	if (!input_stream) {
+		g_object_unref (file);
+		return FALSE;
+	}
+
+	base_stream = ews_data_cache_add (cdc, path, key, error);
+	if (!base_stream) {
+		g_object_unref (input_stream);
+		g_object_unref (file);
+		return FALSE;
+	}
+
+	output_stream = camel_ews_utils_new_cache_output_stream (g_io_stream_get_output_stream (base_stream));
+
+	success = g_output_stream_splice (output_stream, G_INPUT_STREAM (input_stream),
+		G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+		cancellable, error) != -1;
+
+	g_object_unref (output_stream);
+	g_object_unref (base_stream);
+	g_object_unref (input_stream);
+
+	if (success)
+		g_file_delete (file, NULL, NULL);
+	else
+		ews_data_cache_remove (cdc, path, key, NULL);
+
+	g_object_unref (file);
+
+	return success;
+}
+
+/* Records the access to the cached message 'uid', for the store's cache size limit */
+static void
+ews_folder_touch_cached_message (CamelEwsFolder *ews_folder,
+				 const gchar *uid)
+{
+	CamelStore *parent_store;
+	gchar *cache_file;
+	GStatBuf st;
+
+	parent_store = camel_folder_get_parent_store (CAMEL_FOLDER (ews_folder));
+	if (!parent_store)
+		return;
+
+	cache_file = ews_data_cache_get_filename (ews_folder->cache, "cur", uid, NULL);
+
+	if (cache_file && g_stat (cache_file, &st) == 0) {
+		gchar *key;
+
+		key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, uid, -1);
+
+		camel_ews_store_touch_cached_message (CAMEL_EWS_STORE (parent_store),
+			camel_folder_get_full_name (CAMEL_FOLDER (ews_folder)), key, st.st_size);
+
+		g_free (key);
+	}
+
+	g_free (cache_file);
+}
+
+/* Rewrites the cached message uncompressed, when it is stored compressed;
+   the 'filename' is the path of the cache file */
+static gboolean
+ews_data_cache_decompress (CamelDataCache *cdc,
+			   const gchar *path,
+			   const gchar *key,
+			   const gchar *filename,
+			   GError **error)
+{
+	GIOStream *base_stream;
+	GInputStream *input_stream;
+	GOutputStream *output_stream = NULL;
+	GFile *file;
+	gchar *tmp_filename;
+	gboolean success;
+
+	/* Nothing cached */
+	base_stream = ews_data_cache_get (cdc, path, key, NULL);
+	if (!base_stream)
+		return TRUE;
+
+	input_stream = camel_ews_utils_ref_cache_input_stream (g_io_stream_get_input_stream (base_stream), NULL, error);
+	if (!input_stream) {
+		g_object_unref (base_stream);
+		return FALSE;
+	}
+
+	/* Stored uncompressed */
+	if (!G_IS_CONVERTER_INPUT_STREAM (input_stream)) {
+		g_object_unref (input_stream);
+		g_object_unref (base_stream);
+		return TRUE;
+	}
+
+	tmp_filename = g_strconcat (filename, ".tmp", NULL);
+	file = g_file_new_for_path (tmp_filename);
+
+	output_stream = G_OUTPUT_STREAM (g_file_replace (file, NULL, FALSE, G_FILE_CREATE_PRIVATE, NULL, error));
+	success = output_stream && g_output_stream_splice (output_stream, input_stream,
+		G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, NULL, error) != -1;
+
+	g_clear_object (&output_stream);
+	g_object_unref (input_stream);
+	g_object_unref (base_stream);
+	g_object_unref (file);
+
+	if (success && g_rename (tmp_filename, filename) != 0) {
+		g_set_error (
+			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+			/* Translators: The first %s consists of the source file name,
+			   the second %s of the destination file name and
+			   the third %s of the error message. */
+			_("Failed to move message cache file from “%s” to “%s”: %s"),
+			tmp_filename, filename, g_strerror (errno));
+		success = FALSE;
+	}
+
+	if (!success)
+		g_unlink (tmp_filename);
+
+	g_free (tmp_filename);
+
+	return success;
+}
+
+/* The callers read the returned file as an RFC 822 message, thus the cached
+   message is stored uncompressed, when it is asked for its file name */
+static gchar *
+ews_get_filename (CamelFolder *folder,
+                  const gchar *uid,
+                  GError **error)
+{
+	CamelEwsFolder *ews_folder = CAMEL_EWS_FOLDER (folder);
+	gchar *filename;
+
+	filename = ews_data_cache_get_filename (ews_folder->cache, "cur", uid, error);
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+
+	if (ews_data_cache_decompress (ews_folder->cache, "cur", uid, filename, error)) {
+		/* The size of the cache file changed */
+		ews_folder_touch_cached_message (ews_folder, uid);
+	} else {
+		g_free (filename);
+		filename = NULL;
+	}
+
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+
+	return filename;
+}
+
 static CamelMimeMessage *
 camel_ews_folder_get_message_from_cache (CamelEwsFolder *ews_folder,
                                          const gchar *uid,
                                          GCancellable *cancellable,
                                          GError **error)
 {
-	CamelStream *stream;
+	GIOStream *base_stream;
+	GInputStream *input_stream;
 	CamelMimeMessage *msg;
 	CamelEwsFolderPrivate *priv;
 
 	priv = ews_folder->priv;
 
 	g_rec_mutex_lock (&priv->cache_lock);
-	stream = ews_data_cache_get (ews_folder->cache, "cur", uid, error);
-	if (!stream) {
+	base_stream = ews_data_cache_get (ews_folder->cache, "cur", uid, error);
+	if (!base_stream) {
 		gchar *old_fname = camel_data_cache_get_filename (
 			ews_folder->cache, "cur", uid);
 		if (!g_access (old_fname, R_OK)) {
@@ -296,25 +570,34 @@ camel_ews_folder_get_message_from_cache (CamelEwsFolder *ews_folder,
 					   old_fname, new_fname, g_strerror (errno));
 			}
 			g_free (new_fname);
-			stream = ews_data_cache_get (ews_folder->cache, "cur", uid, error);
+			base_stream = ews_data_cache_get (ews_folder->cache, "cur", uid, error);
 		}
 		g_free (old_fname);
-		if (!stream) {
+		if (!base_stream) {
 			g_rec_mutex_unlock (&priv->cache_lock);
 			return NULL;
 		}
 	}
 
+	/* Decompressed as it is parsed */
+	input_stream = camel_ews_utils_ref_cache_input_stream (g_io_stream_get_input_stream (base_stream), cancellable, error);
+	if (!input_stream) {
+		g_rec_mutex_unlock (&priv->cache_lock);
+		g_object_unref (base_stream);
+		return NULL;
+	}
+
 	msg = camel_mime_message_new ();
 
-	if (!camel_data_wrapper_construct_from_stream_sync (
-		(CamelDataWrapper *) msg, stream, cancellable, error)) {
+	if (!camel_data_wrapper_construct_from_input_stream_sync (
+		(CamelDataWrapper *) msg, input_stream, cancellable, error)) {
 		g_object_unref (msg);
 		msg = NULL;
 	}
 
 	g_rec_mutex_unlock (&priv->cache_lock);
-	g_object_unref (stream);
+	g_object_unref (input_stream);
+	g_object_unref (base_stream);
 
 	return msg;
 }
@@ -504,6 +787,87 @@ ews_fetch_cancellable_cancelled_cb (GCancellable *cancellable,
 	g_cond_broadcast (fetch_cond);
 }
 
+/* Creates a message with the headers of the 'item', without any content */
+static CamelMimeMessage *
+ews_message_new_from_item (CamelMessageInfo *mi,
+			   EEwsItem *item)
+{
+	const CamelNameValueArray *headers;
+	CamelMimeMessage *msg;
+
+	msg = camel_mime_message_new ();
+
+	headers = camel_message_info_get_headers (mi);
+	if (headers) {
+		CamelMedium *medium = CAMEL_MEDIUM (msg);
+		guint ii, len;
+
+		len = camel_name_value_array_get_length (headers);
+
+		for (ii = 0; ii < len; ii++) {
+			const gchar *name = NULL, *value = NULL;
+
+			/* Skip any content-describing headers */
+			if (camel_name_value_array_get (headers, ii, &name, &value) &&
+			    name && g_ascii_strncasecmp (name, "Content-", 8) != 0) {
+				camel_medium_add_header (medium, name, value);
+			}
+		}
+	} else {
+		CamelMedium *medium = CAMEL_MEDIUM (msg);
+
+		camel_mime_message_set_date (msg, e_ews_item_get_date_sent (item), 0);
+		camel_mime_message_set_message_id (msg, e_ews_item_get_msg_id (item));
+		if (e_ews_item_get_in_replyto (item))
+			camel_medium_set_header (medium, "In-Reply-To", e_ews_item_get_in_replyto (item));
+		if (e_ews_item_get_references (item))
+			camel_medium_set_header (medium, "References", e_ews_item_get_references (item));
+		camel_medium_set_header (medium, "From", camel_message_info_get_from (mi));
+		camel_medium_set_header (medium, "To", camel_message_info_get_to (mi));
+		camel_medium_set_header (medium, "Cc", camel_message_info_get_from (mi));
+		camel_mime_message_set_subject (msg, camel_message_info_get_subject (mi));
+	}
+
+	return msg;
+}
+
+/* Writes the 'msg' into a new file in the 'mime_dir' and sets its name
+   as the MimeContent of the 'item', the same as the GetItem does it */
+static gboolean
+ews_message_save_to_mime_dir (EEwsItem *item,
+			      CamelMimeMessage *msg,
+			      const gchar *mime_dir,
+			      GCancellable *cancellable,
+			      GError **error)
+{
+	CamelStream *new_stream;
+	gchar *mime_fname_new;
+	gboolean success;
+	gint fd;
+
+	mime_fname_new = g_build_filename (mime_dir, "XXXXXX", NULL);
+	fd = g_mkstemp (mime_fname_new);
+	if (fd != -1)
+		e_ews_item_set_mime_content (item, mime_fname_new);
+	g_free (mime_fname_new);
+
+	if (fd == -1) {
+		g_set_error (
+			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+			_("Unable to create cache file"));
+
+		return FALSE;
+	}
+
+	new_stream = camel_stream_fs_new_with_fd (fd);
+	success = camel_data_wrapper_write_to_stream_sync (CAMEL_DATA_WRAPPER (msg), new_stream, cancellable, error) != -1 &&
+		camel_stream_flush (new_stream, cancellable, error) != -1 &&
+		camel_stream_close (new_stream, cancellable, error) != -1;
+	g_clear_object (&new_stream);
+
+	return success;
+}
+
 static gboolean
 ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 				  EEwsConnection *cnc,
@@ -515,14 +879,10 @@ ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 				  GError **error)
 {
 	EEwsAdditionalProps *add_props;
-	const CamelNameValueArray *headers;
 	CamelMessageInfo *mi;
 	CamelMimeMessage *msg;
-	CamelStream *new_stream;
 	EEwsItem *item;
 	gboolean bval = FALSE;
-	gchar *mime_fname_new;
-	gint fd;
 	GSList *items = NULL;
 
 	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), FALSE);
@@ -550,52 +910,21 @@ ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 	}
 
 	item = items->data;
-	msg = camel_mime_message_new ();
+	msg = ews_message_new_from_item (mi, item);
 
-	headers = camel_message_info_get_headers (mi);
-	if (headers) {
-		CamelMedium *medium = CAMEL_MEDIUM (msg);
-		guint ii, len;
+	if (e_ews_item_has_attachments (item, &bval) && bval &&
+	    e_ews_item_get_attachments_ids (item)) {
+		CamelMimePart *part;
+		CamelMultipart *m_mixed;
+		const gchar *body = e_ews_item_get_body (item);
+		GSList *attach_ids, *attachments = NULL, *link;
 
-		len = camel_name_value_array_get_length (headers);
+		m_mixed = camel_multipart_new ();
+		camel_data_wrapper_set_mime_type (CAMEL_DATA_WRAPPER (m_mixed), "multipart/mixed");
+		camel_multipart_set_boundary (m_mixed, NULL);
 
-		for (ii = 0; ii < len; ii++) {
-			const gchar *name = NULL, *value = NULL;
-
-			/* Skip any content-describing headers */
-			if (camel_name_value_array_get (headers, ii, &name, &value) &&
-			    name && g_ascii_strncasecmp (name, "Content-", 8) != 0) {
-				camel_medium_add_header (medium, name, value);
-			}
-		}
-	} else {
-		CamelMedium *medium = CAMEL_MEDIUM (msg);
-
-		camel_mime_message_set_date (msg, e_ews_item_get_date_sent (item), 0);
-		camel_mime_message_set_message_id (msg, e_ews_item_get_msg_id (item));
-		if (e_ews_item_get_in_replyto (item))
-			camel_medium_set_header (medium, "In-Reply-To", e_ews_item_get_in_replyto (item));
-		if (e_ews_item_get_references (item))
-			camel_medium_set_header (medium, "References", e_ews_item_get_references (item));
-		camel_medium_set_header (medium, "From", camel_message_info_get_from (mi));
-		camel_medium_set_header (medium, "To", camel_message_info_get_to (mi));
-		camel_medium_set_header (medium, "Cc", camel_message_info_get_from (mi));
-		camel_mime_message_set_subject (msg, camel_message_info_get_subject (mi));
-	}
-
-	if (e_ews_item_has_attachments (item, &bval) && bval &&
-	    e_ews_item_get_attachments_ids (item)) {
-		CamelMimePart *part;
-		CamelMultipart *m_mixed;
-		const gchar *body = e_ews_item_get_body (item);
-		GSList *attach_ids, *attachments = NULL, *link;
-
-		m_mixed = camel_multipart_new ();
-		camel_data_wrapper_set_mime_type (CAMEL_DATA_WRAPPER (m_mixed), "multipart/mixed");
-		camel_multipart_set_boundary (m_mixed, NULL);
-
-		if (!body || !*body)
-			body = " ";
+		if (!body || !*body)
+			body = " ";
 
 		part = camel_mime_part_new ();
 		camel_mime_part_set_encoding (part, CAMEL_TRANSFER_ENCODING_8BIT);
@@ -658,17 +987,7 @@ ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 		camel_mime_part_set_content (CAMEL_MIME_PART (msg), body, strlen (body), "text/plain");
 	}
 
-	mime_fname_new = g_build_filename (mime_dir, "XXXXXX", NULL);
-	fd = g_mkstemp (mime_fname_new);
-	if (fd != -1)
-		e_ews_item_set_mime_content (item, mime_fname_new);
-	g_free (mime_fname_new);
-
-	if (fd == -1) {
-		g_set_error (
-			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
-			_("Unable to create cache file"));
-
+	if (!ews_message_save_to_mime_dir (item, msg, mime_dir, cancellable, error)) {
 		g_slist_free_full (items, g_object_unref);
 		g_clear_object (&msg);
 		g_clear_object (&mi);
@@ -676,19 +995,228 @@ ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 		return FALSE;
 	}
 
-	new_stream = camel_stream_fs_new_with_fd (fd);
-	if (camel_data_wrapper_write_to_stream_sync (CAMEL_DATA_WRAPPER (msg), new_stream, cancellable, error) == -1 ||
-	   camel_stream_flush (new_stream, cancellable, error) == -1 ||
-	   camel_stream_close (new_stream, cancellable, error) == -1) {
+	g_clear_object (&msg);
+	g_clear_object (&mi);
+
+	*out_items = items;
+
+	return TRUE;
+}
+
+static CamelMimePart *
+ews_attachment_placeholder_new (const EEwsAttachmentDescription *description)
+{
+	CamelDataWrapper *content;
+	CamelMimePart *part;
+
+	part = camel_mime_part_new ();
+
+	content = camel_data_wrapper_new ();
+	camel_data_wrapper_set_mime_type (content,
+		description->content_type && *description->content_type ? description->content_type : "application/octet-stream");
+	camel_medium_set_content (CAMEL_MEDIUM (part), content);
+	g_object_unref (content);
+
+	camel_mime_part_set_disposition (part, description->is_inline ? "inline" : "attachment");
+	camel_mime_part_set_encoding (part, CAMEL_TRANSFER_ENCODING_BASE64);
+
+	if (description->name && *description->name)
+		camel_mime_part_set_filename (part, description->name);
+
+	if (description->content_id && *description->content_id)
+		camel_mime_part_set_content_id (part, description->content_id);
+
+	camel_medium_set_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_ID_HEADER, description->id);
+
+	if (description->size) {
+		gchar *size;
+
+		size = g_strdup_printf ("%" G_GUINT64_FORMAT, description->size);
+		camel_medium_set_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_SIZE_HEADER, size);
+		g_free (size);
+	}
+
+	return part;
+}
+
+/* Whether the attachment is a part of a PGP or S/MIME signed or encrypted
+   message, which should be downloaded as a whole, to be able to verify
+   or decrypt it. */
+static gboolean
+ews_attachment_is_crypto (const EEwsAttachmentDescription *description)
+{
+	const gchar *content_type = description->content_type;
+	const gchar *name = description->name;
+
+	if (content_type && (
+	    g_ascii_strncasecmp (content_type, "application/pgp-signature", 25) == 0 ||
+	    g_ascii_strncasecmp (content_type, "application/pgp-encrypted", 25) == 0 ||
+	    g_ascii_strncasecmp (content_type, "application/pkcs7-", 18) == 0 ||
+	    g_ascii_strncasecmp (content_type, "application/x-pkcs7-", 20) == 0))
+		return TRUE;
+
+	if (name) {
+		gsize len = strlen (name);
+
+		if ((len >= 4 && g_ascii_strcasecmp (name + len - 4, ".asc") == 0) ||
+		    g_ascii_strcasecmp (name, "smime.p7m") == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Constructs the message from the body and the descriptions of the attachments,
+   with the attachments as placeholder parts, which are downloaded only when
+   they are opened or saved. Returns FALSE without setting the 'error' when
+   the message cannot be constructed this way, like when it is signed or
+   encrypted or when it has attached items; the whole message should be
+   downloaded in such case. */
+static gboolean
+ews_message_structure_sync (CamelEwsFolder *ews_folder,
+			    EEwsConnection *cnc,
+			    gint pri,
+			    GSList *ids,
+			    const gchar *mime_dir,
+			    GSList **out_items, /* EEwsItem * */
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	EEwsAdditionalProps *add_props;
+	const GSList *descriptions, *link;
+	CamelMessageInfo *mi;
+	CamelMimeMessage *msg;
+	CamelMimePart *body_part;
+	CamelMultipart *m_mixed, *m_related = NULL;
+	EEwsItem *item;
+	const gchar *item_class, *body;
+	gboolean is_html;
+	GSList *items = NULL;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), FALSE);
+	g_return_val_if_fail (E_IS_EWS_CONNECTION (cnc), FALSE);
+	g_return_val_if_fail (ids != NULL, FALSE);
+	g_return_val_if_fail (mime_dir != NULL, FALSE);
+	g_return_val_if_fail (out_items != NULL, FALSE);
+
+	add_props = e_ews_additional_props_new ();
+	add_props->field_uri = g_strdup (SUMMARY_MESSAGE_PROPS " item:ItemClass item:Body item:Attachments");
+	add_props->extended_furis = ews_folder_get_summary_message_mapi_flags ();
+
+	if (!e_ews_connection_get_items_sync (cnc, pri, ids, "IdOnly", add_props,
+		FALSE, NULL, E_EWS_BODY_TYPE_BEST, &items, NULL, NULL, cancellable, error) || !items) {
+		e_ews_additional_props_free (add_props);
+		g_slist_free_full (items, g_object_unref);
+		return FALSE;
+	}
+
+	e_ews_additional_props_free (add_props);
+
+	item = items->data;
+
+	/* Errors are reported by the download of the whole message */
+	if (e_ews_item_get_item_type (item) != E_EWS_ITEM_TYPE_MESSAGE) {
+		g_slist_free_full (items, g_object_unref);
+		return FALSE;
+	}
+
+	/* The signature covers the whole MIME structure, which cannot be reconstructed */
+	item_class = e_ews_item_get_item_class (item);
+	if (item_class && g_ascii_strncasecmp (item_class, "IPM.Note.SMIME", 14) == 0) {
+		g_slist_free_full (items, g_object_unref);
+		return FALSE;
+	}
+
+	descriptions = e_ews_item_get_attachments_descriptions (item);
+	if (!descriptions) {
+		g_slist_free_full (items, g_object_unref);
+		return FALSE;
+	}
+
+	for (link = descriptions; link; link = g_slist_next (link)) {
+		const EEwsAttachmentDescription *description = link->data;
+
+		if (!description || !description->id || description->is_item ||
+		    ews_attachment_is_crypto (description)) {
+			g_slist_free_full (items, g_object_unref);
+			return FALSE;
+		}
+	}
+
+	mi = camel_ews_utils_item_to_message_info (ews_folder, cnc, item, cancellable);
+	if (!mi) {
+		g_slist_free_full (items, g_object_unref);
+		return FALSE;
+	}
+
+	msg = ews_message_new_from_item (mi, item);
+
+	body = e_ews_item_get_body (item);
+	if (!body || !*body)
+		body = " ";
+
+	is_html = e_ews_item_get_body_is_html (item);
+
+	body_part = camel_mime_part_new ();
+	camel_mime_part_set_encoding (body_part, CAMEL_TRANSFER_ENCODING_8BIT);
+	camel_mime_part_set_content (body_part, body, strlen (body),
+		is_html ? "text/html; charset=utf-8" : "text/plain; charset=utf-8");
+
+	m_mixed = camel_multipart_new ();
+	camel_data_wrapper_set_mime_type (CAMEL_DATA_WRAPPER (m_mixed), "multipart/mixed");
+	camel_multipart_set_boundary (m_mixed, NULL);
+
+	/* Inline images are referenced by the HTML body through their Content-ID */
+	for (link = descriptions; link && is_html && !m_related; link = g_slist_next (link)) {
+		const EEwsAttachmentDescription *description = link->data;
+
+		if (description->is_inline && description->content_id && *description->content_id) {
+			CamelMimePart *part;
+
+			m_related = camel_multipart_new ();
+			camel_data_wrapper_set_mime_type (CAMEL_DATA_WRAPPER (m_related), "multipart/related");
+			camel_multipart_set_boundary (m_related, NULL);
+			camel_multipart_add_part (m_related, body_part);
+
+			part = camel_mime_part_new ();
+			camel_medium_set_content (CAMEL_MEDIUM (part), CAMEL_DATA_WRAPPER (m_related));
+			camel_multipart_add_part (m_mixed, part);
+			g_object_unref (part);
+		}
+	}
+
+	if (!m_related)
+		camel_multipart_add_part (m_mixed, body_part);
+
+	g_object_unref (body_part);
+
+	for (link = descriptions; link; link = g_slist_next (link)) {
+		const EEwsAttachmentDescription *description = link->data;
+		CamelMimePart *part;
+
+		part = ews_attachment_placeholder_new (description);
+
+		if (m_related && description->is_inline && description->content_id && *description->content_id)
+			camel_multipart_add_part (m_related, part);
+		else
+			camel_multipart_add_part (m_mixed, part);
+
+		g_object_unref (part);
+	}
+
+	camel_medium_set_content (CAMEL_MEDIUM (msg), CAMEL_DATA_WRAPPER (m_mixed));
+
+	g_clear_object (&m_related);
+	g_object_unref (m_mixed);
+
+	if (!ews_message_save_to_mime_dir (item, msg, mime_dir, cancellable, error)) {
 		g_slist_free_full (items, g_object_unref);
-		g_clear_object (&new_stream);
 		g_clear_object (&msg);
 		g_clear_object (&mi);
 
 		return FALSE;
 	}
 
-	g_clear_object (&new_stream);
 	g_clear_object (&msg);
 	g_clear_object (&mi);
 
@@ -697,6 +1225,401 @@ ews_message_from_properties_sync (CamelEwsFolder *ews_folder,
 	return TRUE;
 }
 
+typedef gboolean (* EwsPlaceholderFunc) (CamelMimePart *part,
+					 const gchar *attachment_id,
+					 gpointer user_data);
+
+/* Calls the 'func' for each attachment placeholder part of the 'content',
+   until the 'func' returns FALSE. Returns FALSE when it was stopped. */
+static gboolean
+ews_foreach_attachment_placeholder (CamelDataWrapper *content,
+				    EwsPlaceholderFunc func,
+				    gpointer user_data)
+{
+	guint ii, n_parts;
+
+	if (CAMEL_IS_MIME_MESSAGE (content))
+		content = camel_medium_get_content (CAMEL_MEDIUM (content));
+
+	if (!CAMEL_IS_MULTIPART (content))
+		return TRUE;
+
+	n_parts = camel_multipart_get_number (CAMEL_MULTIPART (content));
+
+	for (ii = 0; ii < n_parts; ii++) {
+		CamelMimePart *part = camel_multipart_get_part (CAMEL_MULTIPART (content), ii);
+		const gchar *value;
+
+		value = camel_medium_get_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_ID_HEADER);
+		if (value) {
+			gchar *attachment_id;
+			gboolean cont;
+
+			attachment_id = g_strstrip (g_strdup (value));
+			cont = func (part, attachment_id, user_data);
+			g_free (attachment_id);
+
+			if (!cont)
+				return FALSE;
+		} else if (!ews_foreach_attachment_placeholder (camel_medium_get_content (CAMEL_MEDIUM (part)), func, user_data)) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean
+ews_placeholder_found_cb (CamelMimePart *part,
+			  const gchar *attachment_id,
+			  gpointer user_data)
+{
+	gboolean *pfound = user_data;
+
+	*pfound = TRUE;
+
+	return FALSE;
+}
+
+/* Whether some attachments of the cached 'message' are not downloaded yet */
+static gboolean
+ews_message_has_attachment_placeholders (CamelMimeMessage *message)
+{
+	gboolean found = FALSE;
+
+	ews_foreach_attachment_placeholder (CAMEL_DATA_WRAPPER (message), ews_placeholder_found_cb, &found);
+
+	return found;
+}
+
+typedef struct _LazyPartsData {
+	CamelEwsFolder *ews_folder;
+	const gchar *uid;
+} LazyPartsData;
+
+static gboolean
+ews_placeholder_make_lazy_cb (CamelMimePart *part,
+			      const gchar *attachment_id,
+			      gpointer user_data)
+{
+	LazyPartsData *lpd = user_data;
+	CamelDataWrapper *content;
+
+	content = camel_ews_attachment_wrapper_new (lpd->ews_folder, lpd->uid, attachment_id);
+	camel_data_wrapper_set_mime_type_field (content, camel_mime_part_get_content_type (part));
+	camel_medium_set_content (CAMEL_MEDIUM (part), content);
+	g_object_unref (content);
+
+	/* Do not let the headers go out with the message, when it is saved or forwarded */
+	camel_medium_remove_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_ID_HEADER);
+	camel_medium_remove_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_SIZE_HEADER);
+
+	return TRUE;
+}
+
+/* Replaces the attachment placeholders of the cached 'message' with content,
+   which is downloaded from the server on the first use */
+static void
+ews_message_make_attachments_lazy (CamelEwsFolder *ews_folder,
+				   const gchar *uid,
+				   CamelMimeMessage *message)
+{
+	LazyPartsData lpd;
+
+	lpd.ews_folder = ews_folder;
+	lpd.uid = uid;
+
+	ews_foreach_attachment_placeholder (CAMEL_DATA_WRAPPER (message), ews_placeholder_make_lazy_cb, &lpd);
+}
+
+typedef struct _FillPlaceholderData {
+	const gchar *attachment_id;
+	GBytes *bytes;
+	gboolean filled;
+} FillPlaceholderData;
+
+static gboolean
+ews_placeholder_fill_cb (CamelMimePart *part,
+			 const gchar *attachment_id,
+			 gpointer user_data)
+{
+	FillPlaceholderData *fpd = user_data;
+	CamelDataWrapper *content;
+	gconstpointer data;
+	gsize size = 0;
+
+	if (g_strcmp0 (attachment_id, fpd->attachment_id) != 0)
+		return TRUE;
+
+	data = g_bytes_get_data (fpd->bytes, &size);
+
+	content = camel_data_wrapper_new ();
+	camel_data_wrapper_set_mime_type_field (content, camel_mime_part_get_content_type (part));
+	g_byte_array_append (camel_data_wrapper_get_byte_array (content), data, size);
+	camel_medium_set_content (CAMEL_MEDIUM (part), content);
+	g_object_unref (content);
+
+	camel_medium_remove_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_ID_HEADER);
+	camel_medium_remove_header (CAMEL_MEDIUM (part), EWS_ATTACHMENT_SIZE_HEADER);
+
+	fpd->filled = TRUE;
+
+	return FALSE;
+}
+
+static void
+ews_folder_index_content (CamelIndexName *idn,
+			  CamelDataWrapper *content,
+			  GCancellable *cancellable)
+{
+	CamelContentType *ct;
+
+	if (!content)
+		return;
+
+	if (CAMEL_IS_MULTIPART (content)) {
+		guint ii, n_parts;
+
+		n_parts = camel_multipart_get_number (CAMEL_MULTIPART (content));
+
+		for (ii = 0; ii < n_parts; ii++) {
+			CamelMimePart *part = camel_multipart_get_part (CAMEL_MULTIPART (content), ii);
+
+			ews_folder_index_content (idn, camel_medium_get_content (CAMEL_MEDIUM (part)), cancellable);
+		}
+
+		return;
+	}
+
+	if (CAMEL_IS_MIME_MESSAGE (content)) {
+		ews_folder_index_content (idn, camel_medium_get_content (CAMEL_MEDIUM (content)), cancellable);
+		return;
+	}
+
+	ct = camel_data_wrapper_get_mime_type_field (content);
+
+	if (camel_content_type_is (ct, "text", "*")) {
+		CamelStream *mem, *filtered;
+		GByteArray *bytes;
+		const gchar *charset;
+
+		mem = camel_stream_mem_new ();
+		filtered = camel_stream_filter_new (mem);
+
+		charset = camel_content_type_param (ct, "charset");
+		if (charset && *charset && g_ascii_strcasecmp (charset, "utf-8") != 0 && g_ascii_strcasecmp (charset, "utf8") != 0) {
+			CamelMimeFilter *filter;
+
+			filter = camel_mime_filter_charset_new (charset, "UTF-8");
+			if (filter) {
+				camel_stream_filter_add (CAMEL_STREAM_FILTER (filtered), filter);
+				g_object_unref (filter);
+			}
+		}
+
+		if (camel_data_wrapper_decode_to_stream_sync (content, filtered, cancellable, NULL) >= 0 &&
+		    camel_stream_flush (filtered, cancellable, NULL) == 0) {
+			bytes = camel_stream_mem_get_byte_array (CAMEL_STREAM_MEM (mem));
+
+			if (bytes && bytes->len)
+				camel_index_name_add_buffer (idn, (const gchar *) bytes->data, bytes->len);
+		}
+
+		g_object_unref (filtered);
+		g_object_unref (mem);
+	}
+}
+
+/* Adds words of the text parts of the 'message' into the body index,
+   thus the body-contains searches can be answered without reading
+   the message from the cache again */
+static void
+ews_folder_index_message (CamelEwsFolder *ews_folder,
+			  const gchar *uid,
+			  CamelMimeMessage *message,
+			  gboolean replace_existing,
+			  GCancellable *cancellable)
+{
+	CamelIndexName *idn;
+
+	if (!ews_folder->priv->body_index || !uid || !message)
+		return;
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+
+	if (camel_index_has_name (ews_folder->priv->body_index, uid)) {
+		if (!replace_existing) {
+			g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+			return;
+		}
+
+		camel_index_delete_name (ews_folder->priv->body_index, uid);
+	}
+
+	idn = camel_index_add_name (ews_folder->priv->body_index, uid);
+	if (idn) {
+		ews_folder_index_content (idn, CAMEL_DATA_WRAPPER (message), cancellable);
+
+		/* Flush the last word */
+		camel_index_name_add_buffer (idn, NULL, 0);
+		camel_index_write_name (ews_folder->priv->body_index, idn);
+
+		g_object_unref (idn);
+	}
+
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+}
+
+/* Replaces the cached message 'uid' with the 'message' */
+static gboolean
+ews_data_cache_rewrite_message (CamelEwsFolder *ews_folder,
+				const gchar *uid,
+				CamelMimeMessage *message,
+				GCancellable *cancellable)
+{
+	gboolean success;
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+
+	success = ews_data_cache_add_message (ews_folder->cache, "cur", uid, message, cancellable, NULL);
+
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+
+	return success;
+}
+
+/* Stores the downloaded attachment into the cached message, in place
+   of its placeholder, thus it is not downloaded again */
+static void
+ews_folder_fill_cached_attachment (CamelEwsFolder *ews_folder,
+				   const gchar *uid,
+				   const gchar *attachment_id,
+				   GBytes *bytes,
+				   GCancellable *cancellable)
+{
+	CamelMimeMessage *message;
+	FillPlaceholderData fpd;
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+
+	message = camel_ews_folder_get_message_from_cache (ews_folder, uid, cancellable, NULL);
+	if (!message) {
+		g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+		return;
+	}
+
+	fpd.attachment_id = attachment_id;
+	fpd.bytes = bytes;
+	fpd.filled = FALSE;
+
+	ews_foreach_attachment_placeholder (CAMEL_DATA_WRAPPER (message), ews_placeholder_fill_cb, &fpd);
+
+	if (fpd.filled && ews_data_cache_rewrite_message (ews_folder, uid, message, cancellable)) {
+		ews_folder_index_message (ews_folder, uid, message, TRUE, cancellable);
+		ews_folder_touch_cached_message (ews_folder, uid);
+	}
+
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+
+	g_object_unref (message);
+}
+
+/* Downloads the attachment 'attachment_id' of the message 'uid', which
+   had been cached without it, and stores it in the message cache */
+GBytes *
+camel_ews_folder_download_attachment_sync (CamelEwsFolder *ews_folder,
+					   const gchar *uid,
+					   const gchar *attachment_id,
+					   GCancellable *cancellable,
+					   GError **error)
+{
+	CamelEwsStore *ews_store;
+	EEwsConnection *cnc;
+	EEwsAttachmentInfo *ainfo;
+	GSList *ids, *attachments = NULL;
+	GBytes *bytes = NULL;
+	GError *local_error = NULL;
+	gboolean success;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), NULL);
+	g_return_val_if_fail (uid != NULL, NULL);
+	g_return_val_if_fail (attachment_id != NULL, NULL);
+
+	ews_store = CAMEL_EWS_STORE (camel_folder_get_parent_store (CAMEL_FOLDER (ews_folder)));
+
+	if (!camel_ews_store_connected (ews_store, cancellable, error))
+		return NULL;
+
+	cnc = camel_ews_store_ref_connection (ews_store);
+	ids = g_slist_prepend (NULL, (gpointer) attachment_id);
+
+	success = e_ews_connection_get_attachments_sync (
+		cnc, EWS_PRIORITY_MEDIUM, NULL, ids, NULL, FALSE, &attachments,
+		(ESoapProgressFn) camel_operation_progress, cancellable,
+		cancellable, &local_error);
+
+	g_slist_free (ids);
+	g_clear_object (&cnc);
+
+	if (!success) {
+		camel_ews_store_maybe_disconnect (ews_store, local_error);
+		g_propagate_error (error, local_error);
+		g_slist_free_full (attachments, (GDestroyNotify) e_ews_attachment_info_free);
+
+		return NULL;
+	}
+
+	ainfo = attachments ? attachments->data : NULL;
+
+	if (ainfo && e_ews_attachment_info_get_type (ainfo) == E_EWS_ATTACHMENT_INFO_TYPE_INLINED) {
+		const gchar *content;
+		gsize content_len = 0;
+
+		content = e_ews_attachment_info_get_inlined_data (ainfo, &content_len);
+		bytes = g_bytes_new (content, content ? content_len : 0);
+	} else {
+		g_set_error (
+			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
+			_("Failed to download attachment"));
+	}
+
+	g_slist_free_full (attachments, (GDestroyNotify) e_ews_attachment_info_free);
+
+	if (bytes)
+		ews_folder_fill_cached_attachment (ews_folder, uid, attachment_id, bytes, cancellable);
+
+	return bytes;
+}
+
+/* Whether the message 'uid' should be downloaded without its attachments */
+static gboolean
+ews_folder_get_attachments_on_demand (CamelEwsFolder *ews_folder,
+				      const gchar *uid)
+{
+	CamelSettings *settings;
+	CamelMessageInfo *mi;
+	guint on_demand_size;
+	gboolean on_demand;
+
+	settings = camel_service_ref_settings (CAMEL_SERVICE (camel_folder_get_parent_store (CAMEL_FOLDER (ews_folder))));
+	on_demand_size = camel_ews_settings_get_attachments_on_demand_size (CAMEL_EWS_SETTINGS (settings));
+	g_object_unref (settings);
+
+	if (!on_demand_size)
+		return FALSE;
+
+	mi = camel_folder_summary_get (camel_folder_get_folder_summary (CAMEL_FOLDER (ews_folder)), uid);
+	if (!mi)
+		return FALSE;
+
+	on_demand = (camel_message_info_get_flags (mi) & CAMEL_MESSAGE_ATTACHMENTS) != 0 &&
+		camel_message_info_get_size (mi) >= ((guint64) on_demand_size) * 1024;
+
+	g_object_unref (mi);
+
+	return on_demand;
+}
+
 static CamelMimeMessage *
 camel_ews_folder_get_message (CamelFolder *folder,
                               const gchar *uid,
@@ -713,8 +1636,6 @@ camel_ews_folder_get_message (CamelFolder *folder,
 	CamelMimeMessage *message = NULL;
 	GSList *ids = NULL, *items = NULL;
 	gchar *mime_dir;
-	gchar *cache_file;
-	gchar *dir;
 	gboolean res;
 	gchar *mime_fname_new = NULL;
 	GError *local_error = NULL;
@@ -731,6 +1652,10 @@ camel_ews_folder_get_message (CamelFolder *folder,
 	if (message) {
 		g_mutex_unlock (&priv->state_lock);
 
+		/* Messages cached before the index existed are added as they are read */
+		ews_folder_index_message (ews_folder, uid, message, FALSE, cancellable);
+		ews_folder_touch_cached_message (ews_folder, uid);
+
 		return message;
 	}
 
@@ -790,18 +1715,37 @@ camel_ews_folder_get_message (CamelFolder *folder,
 		goto exit;
 	}
 
-	add_props = e_ews_additional_props_new ();
-	add_props->field_uri = g_strdup ("item:MimeContent message:From message:Sender");
-	add_props->indexed_furis = g_slist_prepend (NULL, e_ews_indexed_field_uri_new ("item:InternetMessageHeader", "Date"));
+	res = FALSE;
 
-	res = e_ews_connection_get_items_sync (
-		cnc, pri, ids, "IdOnly", add_props,
-		TRUE, mime_dir, E_EWS_BODY_TYPE_ANY,
-		&items,
-		(ESoapProgressFn) camel_operation_progress,
-		(gpointer) cancellable,
-		cancellable, &local_error);
-	e_ews_additional_props_free (add_props);
+	if (ews_folder_get_attachments_on_demand (ews_folder, uid)) {
+		res = ews_message_structure_sync (ews_folder, cnc, pri, ids, mime_dir, &items, cancellable, &local_error) && items;
+
+		/* Download the whole message when the structure could not be used */
+		if (!res) {
+			if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+				g_clear_error (&local_error);
+				g_free (mime_dir);
+				goto exit;
+			}
+
+			g_clear_error (&local_error);
+		}
+	}
+
+	if (!res) {
+		add_props = e_ews_additional_props_new ();
+		add_props->field_uri = g_strdup ("item:MimeContent message:From message:Sender");
+		add_props->indexed_furis = g_slist_prepend (NULL, e_ews_indexed_field_uri_new ("item:InternetMessageHeader", "Date"));
+
+		res = e_ews_connection_get_items_sync (
+			cnc, pri, ids, "IdOnly", add_props,
+			TRUE, mime_dir, E_EWS_BODY_TYPE_ANY,
+			&items,
+			(ESoapProgressFn) camel_operation_progress,
+			(gpointer) cancellable,
+			cancellable, &local_error);
+		e_ews_additional_props_free (add_props);
+	}
 
 	if (!res || !items) {
 		camel_ews_store_maybe_disconnect (ews_store, local_error);
@@ -898,33 +1842,14 @@ camel_ews_folder_get_message (CamelFolder *folder,
 		}
 	}
 
-	cache_file = ews_data_cache_get_filename (
-		ews_folder->cache, "cur", uid, error);
-	dir = g_path_get_dirname (cache_file);
+	g_rec_mutex_lock (&priv->cache_lock);
 
-	if (g_mkdir_with_parents (dir, 0700) == -1) {
-		g_set_error (
-			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
-			_("Unable to create cache path “%s”: %s"),
-			dir, g_strerror (errno));
-		g_free (dir);
-		g_free (cache_file);
+	if (!ews_data_cache_add_file (ews_folder->cache, "cur", uid, mime_content, cancellable, error)) {
+		g_rec_mutex_unlock (&priv->cache_lock);
 		goto exit;
 	}
-	g_free (dir);
 
-	if (g_rename (mime_content, cache_file) != 0) {
-		g_set_error (
-			error, CAMEL_ERROR, CAMEL_ERROR_GENERIC,
-			/* Translators: The first %s consists of the source file name,
-			   the second %s of the destination file name and
-			   the third %s of the error message. */
-			_("Failed to move message cache file from “%s” to “%s”: %s"),
-			mime_content, cache_file, g_strerror (errno));
-		g_free (cache_file);
-		goto exit;
-	}
-	g_free (cache_file);
+	g_rec_mutex_unlock (&priv->cache_lock);
 
 	message = camel_ews_folder_get_message_from_cache (ews_folder, uid, cancellable, error);
 	if (message) {
@@ -941,16 +1866,21 @@ camel_ews_folder_get_message (CamelFolder *folder,
 			if (!mailbox)
 				mailbox = e_ews_item_get_sender (items->data);
 			if (mailbox) {
-				email = NULL;
+				gchar *mailbox_email;
+
+				/* Does not contact the server; an unknown EX address is resolved later */
+				mailbox_email = camel_ews_folder_dup_mailbox_email (ews_folder, cnc, uid, mailbox);
+				camel_ews_folder_schedule_ex_resolve (ews_folder);
 
-				if (g_strcmp0 (mailbox->routing_type, "EX") == 0)
-					email = e_ews_item_util_strip_ex_address (mailbox->email);
+				email = NULL;
 
 				from = camel_internet_address_new ();
-				camel_internet_address_add (from, mailbox->name, email ? email : mailbox->email);
+				camel_internet_address_add (from, mailbox->name, mailbox_email);
 				camel_mime_message_set_from (message, from);
 				g_object_unref (from);
 
+				g_free (mailbox_email);
+
 				resave = TRUE;
 			}
 		}
@@ -968,37 +1898,12 @@ camel_ews_folder_get_message (CamelFolder *folder,
 		}
 
 		if (resave) {
-			CamelStream *cache_stream;
-
-			g_rec_mutex_lock (&priv->cache_lock);
 			/* Ignore errors here, it's nothing fatal in this case */
-			cache_stream = ews_data_cache_get (ews_folder->cache, "cur", uid, NULL);
-			if (cache_stream) {
-				GIOStream *iostream;
-
-				/* Truncate the stream first, in case the message will be shorter
-				   than the one received from the server */
-				iostream = camel_stream_ref_base_stream (cache_stream);
-				if (iostream) {
-					GOutputStream *output_stream;
-
-					output_stream = g_io_stream_get_output_stream (iostream);
-					if (G_IS_SEEKABLE (output_stream)) {
-						GSeekable *seekable = G_SEEKABLE (output_stream);
-
-						if (g_seekable_can_truncate (seekable)) {
-							g_seekable_truncate (seekable, 0, NULL, NULL);
-						}
-					}
-
-					g_object_unref (iostream);
-				}
-
-				camel_data_wrapper_write_to_stream_sync (CAMEL_DATA_WRAPPER (message), cache_stream, cancellable, NULL);
-				g_object_unref (cache_stream);
-			}
-			g_rec_mutex_unlock (&priv->cache_lock);
+			ews_data_cache_rewrite_message (ews_folder, uid, message, cancellable);
 		}
+
+		ews_folder_index_message (ews_folder, uid, message, TRUE, cancellable);
+		ews_folder_touch_cached_message (ews_folder, uid);
 	}
 
 exit:
@@ -1090,8 +1995,10 @@ ews_folder_get_message_sync (CamelFolder *folder,
 	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (folder), NULL);
 
 	message = camel_ews_folder_get_message (folder, uid, EWS_ITEM_HIGH, cancellable, error);
-	if (message)
+	if (message) {
 		ews_folder_maybe_update_mlist (folder, uid, message);
+		ews_message_make_attachments_lazy (CAMEL_EWS_FOLDER (folder), uid, message);
+	}
 
 	return message;
 }
@@ -1101,7 +2008,15 @@ ews_folder_get_message_cached (CamelFolder *folder,
                                const gchar *message_uid,
                                GCancellable *cancellable)
 {
-	return camel_ews_folder_get_message_from_cache ((CamelEwsFolder *) folder, message_uid, cancellable, NULL);
+	CamelMimeMessage *message;
+
+	message = camel_ews_folder_get_message_from_cache ((CamelEwsFolder *) folder, message_uid, cancellable, NULL);
+	if (message) {
+		ews_message_make_attachments_lazy (CAMEL_EWS_FOLDER (folder), message_uid, message);
+		ews_folder_touch_cached_message (CAMEL_EWS_FOLDER (folder), message_uid);
+	}
+
+	return message;
 }
 
 static GPtrArray *
@@ -1221,17 +2136,26 @@ ews_folder_search_free (CamelFolder *folder,
 
 /********************* folder functions*************************/
 
+typedef struct _UpdateFlagsData {
+	const GSList *mi_list; /* CamelMessageInfo *, owned by the caller */
+	GPtrArray *written; /* CamelMessageInfo *, in the order of the item changes */
+	GArray *written_flags; /* guint32, the flags each item change sets */
+} UpdateFlagsData;
+
 static gboolean
 msg_update_flags (ESoapMessage *msg,
                   gpointer user_data,
 		  GError **error)
 {
-	/* the mi_list is owned by the caller */
-	const GSList *mi_list = user_data, *iter;
+	UpdateFlagsData *ufd = user_data;
+	const GSList *iter;
 	CamelMessageInfo *mi;
 	CamelEwsMessageInfo *emi;
 
-	for (iter = mi_list; iter; iter = g_slist_next (iter)) {
+	g_ptr_array_set_size (ufd->written, 0);
+	g_array_set_size (ufd->written_flags, 0);
+
+	for (iter = ufd->mi_list; iter; iter = g_slist_next (iter)) {
 		CamelFolderSummary *summary;
 		guint32 flags_changed, mi_flags;
 		GSList *user_flags;
@@ -1337,6 +2261,9 @@ msg_update_flags (ESoapMessage *msg,
 
 		camel_message_info_set_folder_flagged (mi, FALSE);
 
+		g_ptr_array_add (ufd->written, mi);
+		g_array_append_val (ufd->written_flags, mi_flags);
+
 		camel_message_info_property_unlock (mi);
 		if (summary)
 			camel_folder_summary_unlock (summary);
@@ -1392,6 +2319,154 @@ ews_suppress_read_receipt (ESoapMessage *msg,
 	return TRUE;
 }
 
+static gboolean
+ews_is_change_key_conflict (const GError *error)
+{
+	return g_error_matches (error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_IRRESOLVABLECONFLICT) ||
+	       g_error_matches (error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_INVALIDCHANGEKEY);
+}
+
+/* Saves the flags of the 'mi_list' with one UpdateItem request and stores the new
+   change keys from its response. The messages, which could not be saved due to
+   a connection problem or an outdated change key, are kept folder-flagged, thus
+   they are tried again with the next synchronization; those with the outdated
+   change key are also added into the 'out_conflicts'. */
+static gboolean
+ews_update_mi_flags_sync (EEwsConnection *cnc,
+			  const GSList *mi_list,
+			  GSList **out_conflicts, /* CamelMessageInfo *, not referenced */
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	UpdateFlagsData ufd;
+	GSList *items = NULL, *link;
+	GError *local_error = NULL;
+	gboolean res;
+	guint ii;
+
+	ufd.mi_list = mi_list;
+	ufd.written = g_ptr_array_new ();
+	ufd.written_flags = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	res = e_ews_connection_update_items_sync (
+		cnc, EWS_PRIORITY_LOW,
+		"AlwaysOverwrite", "SaveOnly",
+		NULL, NULL,
+		msg_update_flags, &ufd, &items,
+		cancellable, &local_error);
+
+	if (!res) {
+		/* A single item's error is returned as the request error */
+		if (out_conflicts && ufd.written->len == 1 && ews_is_change_key_conflict (local_error)) {
+			camel_message_info_set_folder_flagged (g_ptr_array_index (ufd.written, 0), TRUE);
+			*out_conflicts = g_slist_prepend (*out_conflicts, g_ptr_array_index (ufd.written, 0));
+			g_clear_error (&local_error);
+			res = TRUE;
+		}
+
+		/* Without write access the flags are saved only locally */
+		for (ii = 0; local_error && ii < ufd.written->len; ii++) {
+			if (!g_error_matches (local_error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_ACCESSDENIED))
+				camel_message_info_set_folder_flagged (g_ptr_array_index (ufd.written, ii), TRUE);
+		}
+	}
+
+	for (link = items, ii = 0; link && ii < ufd.written->len; link = g_slist_next (link), ii++) {
+		EEwsItem *item = link->data;
+		CamelMessageInfo *mi = g_ptr_array_index (ufd.written, ii);
+
+		if (!item)
+			continue;
+
+		if (e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR) {
+			if (ews_is_change_key_conflict (e_ews_item_get_error (item))) {
+				camel_message_info_set_folder_flagged (mi, TRUE);
+
+				if (out_conflicts)
+					*out_conflicts = g_slist_prepend (*out_conflicts, mi);
+			}
+		} else {
+			CamelEwsMessageInfo *emi = CAMEL_EWS_MESSAGE_INFO (mi);
+			const EwsId *id = e_ews_item_get_id (item);
+			guint32 server_flags;
+
+			camel_message_info_property_lock (mi);
+
+			if (id && id->change_key && !ews_message_info_is_header_only (mi))
+				camel_ews_message_info_set_change_key (emi, id->change_key);
+
+			/* The server has what was sent now, thus the next change
+			   of other flags will not send these again */
+			server_flags = camel_ews_message_info_get_server_flags (emi);
+			server_flags = (server_flags & ~EWS_SERVER_FLAGS) |
+				(g_array_index (ufd.written_flags, guint32, ii) & EWS_SERVER_FLAGS);
+			camel_ews_message_info_set_server_flags (emi, server_flags);
+
+			camel_message_info_property_unlock (mi);
+		}
+	}
+
+	if (local_error)
+		g_propagate_error (error, local_error);
+
+	g_slist_free_full (items, g_object_unref);
+	g_ptr_array_free (ufd.written, TRUE);
+	g_array_free (ufd.written_flags, TRUE);
+
+	return res;
+}
+
+static gboolean
+ews_refresh_change_keys_sync (EEwsConnection *cnc,
+			      const GSList *mi_list,
+			      GCancellable *cancellable,
+			      GError **error)
+{
+	GSList *ids = NULL, *items = NULL, *link;
+	gboolean res;
+
+	for (link = (GSList *) mi_list; link; link = g_slist_next (link)) {
+		ids = g_slist_prepend (ids, (gpointer) camel_message_info_get_uid (link->data));
+	}
+
+	res = e_ews_connection_get_items_sync (
+		cnc, EWS_PRIORITY_LOW, ids, "IdOnly", NULL,
+		FALSE, NULL, E_EWS_BODY_TYPE_ANY, &items,
+		NULL, NULL, cancellable, error);
+
+	if (res) {
+		GHashTable *infos;
+
+		infos = g_hash_table_new (g_str_hash, g_str_equal);
+
+		for (link = (GSList *) mi_list; link; link = g_slist_next (link)) {
+			g_hash_table_insert (infos, (gpointer) camel_message_info_get_uid (link->data), link->data);
+		}
+
+		for (link = items; link; link = g_slist_next (link)) {
+			EEwsItem *item = link->data;
+			const EwsId *id;
+			CamelMessageInfo *mi;
+
+			if (!item || e_ews_item_get_item_type (item) == E_EWS_ITEM_TYPE_ERROR)
+				continue;
+
+			id = e_ews_item_get_id (item);
+			mi = id ? g_hash_table_lookup (infos, id->id) : NULL;
+
+			if (mi && id->change_key && !ews_message_info_is_header_only (mi))
+				camel_ews_message_info_set_change_key (CAMEL_EWS_MESSAGE_INFO (mi), id->change_key);
+		}
+
+		g_hash_table_destroy (infos);
+	}
+
+	g_slist_free_full (items, g_object_unref);
+	g_slist_free (ids);
+
+	return res;
+}
+
 static gboolean
 ews_sync_mi_flags (CamelFolder *folder,
                    const GSList *mi_list,
@@ -1439,12 +2514,17 @@ ews_sync_mi_flags (CamelFolder *folder,
 	}
 
 	if (res) {
-		res = e_ews_connection_update_items_sync (
-			cnc, EWS_PRIORITY_LOW,
-			"AlwaysOverwrite", "SaveOnly",
-			NULL, NULL,
-			msg_update_flags, (gpointer) mi_list, NULL,
-			cancellable, &local_error);
+		GSList *conflicts = NULL;
+
+		res = ews_update_mi_flags_sync (cnc, mi_list, &conflicts, cancellable, &local_error);
+
+		/* The items changed on the server meanwhile; try once more with their current change keys */
+		if (res && conflicts) {
+			res = ews_refresh_change_keys_sync (cnc, conflicts, cancellable, &local_error) &&
+			      ews_update_mi_flags_sync (cnc, conflicts, NULL, cancellable, &local_error);
+		}
+
+		g_slist_free (conflicts);
 	}
 
 	camel_folder_summary_save (camel_folder_get_folder_summary (folder), NULL);
@@ -1577,7 +2657,7 @@ ews_move_to_special_folder (CamelFolder *folder,
 
 				camel_folder_change_info_remove_uid (changes, uid);
 				camel_folder_summary_remove_uid (camel_folder_get_folder_summary (folder), uid);
-				ews_data_cache_remove (ews_folder->cache, "cur", uid, NULL);
+				camel_ews_folder_remove_cached_message (ews_folder, uid);
 
 				camel_folder_summary_unlock (camel_folder_get_folder_summary (folder));
 			}
@@ -1621,6 +2701,14 @@ ews_synchronize_sync (CamelFolder *folder,
 
 	ews_store = (CamelEwsStore *) camel_folder_get_parent_store (folder);
 
+	if (CAMEL_EWS_FOLDER (folder)->priv->body_index) {
+		CamelEwsFolder *ews_folder = CAMEL_EWS_FOLDER (folder);
+
+		g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+		camel_index_sync (ews_folder->priv->body_index);
+		g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+	}
+
 	if (!camel_ews_store_connected (ews_store, cancellable, error))
 		return FALSE;
 
@@ -1679,7 +2767,7 @@ ews_synchronize_sync (CamelFolder *folder,
 			g_clear_object (&mi);
 		}
 
-		if (mi_list_len == EWS_MAX_FETCH_COUNT) {
+		if (mi_list_len == EWS_SAVE_FLAGS_BATCH_SIZE) {
 			success = ews_save_flags (folder, mi_list, cancellable, &local_error);
 			g_slist_free_full (mi_list, g_object_unref);
 			mi_list = NULL;
@@ -1771,6 +2859,131 @@ folder_has_inbox_type (CamelEwsStore *ews_store,
 	return (flags & CAMEL_FOLDER_TYPE_MASK) == CAMEL_FOLDER_TYPE_INBOX;
 }
 
+static void
+ews_folder_save_flags_done_cb (GObject *source_object,
+			       GAsyncResult *result,
+			       gpointer user_data)
+{
+	GError *local_error = NULL;
+
+	if (!camel_folder_synchronize_finish (CAMEL_FOLDER (source_object), result, &local_error) && local_error &&
+	    !g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_debug ("%s: Failed to save changes of '%s': %s", G_STRFUNC,
+			camel_folder_get_full_name (CAMEL_FOLDER (source_object)), local_error->message);
+	}
+
+	g_clear_error (&local_error);
+}
+
+static gboolean
+ews_folder_save_flags_cb (gpointer user_data)
+{
+	GWeakRef *weak_ref = user_data;
+	CamelFolder *folder;
+	CamelEwsFolder *ews_folder;
+	gboolean is_current;
+
+	folder = g_weak_ref_get (weak_ref);
+	if (!folder)
+		return FALSE;
+
+	ews_folder = CAMEL_EWS_FOLDER (folder);
+
+	g_mutex_lock (&ews_folder->priv->save_flags_lock);
+
+	is_current = ews_folder->priv->save_flags_id == g_source_get_id (g_main_current_source ());
+	if (is_current) {
+		ews_folder->priv->save_flags_id = 0;
+		ews_folder->priv->n_flags_changed = 0;
+		ews_folder->priv->save_flags_soon = FALSE;
+	}
+
+	g_mutex_unlock (&ews_folder->priv->save_flags_lock);
+
+	/* The changes are merged in the message infos, the synchronize saves
+	   all of them at once, in as few requests as possible */
+	if (is_current)
+		camel_folder_synchronize (folder, FALSE, G_PRIORITY_LOW, NULL, ews_folder_save_flags_done_cb, NULL);
+
+	g_object_unref (folder);
+
+	return FALSE;
+}
+
+/* Pins the folder's cached messages in the store's cache budget when synchronized for offline use */
+static void
+ews_folder_offline_sync_notify_cb (CamelFolder *folder,
+				   GParamSpec *param,
+				   gpointer user_data)
+{
+	CamelStore *parent_store;
+
+	parent_store = camel_folder_get_parent_store (folder);
+	if (parent_store) {
+		camel_ews_store_set_folder_cache_pinned (CAMEL_EWS_STORE (parent_store),
+			camel_folder_get_full_name (folder),
+			camel_offline_folder_can_downsync (CAMEL_OFFLINE_FOLDER (folder)));
+	}
+}
+
+/* Schedules save of the changed flags on the server, thus they do not wait
+   for the next synchronize; the not saved changes are kept in the folder
+   summary, which survives restarts */
+static void
+ews_folder_changed_cb (CamelFolder *folder,
+		       CamelFolderChangeInfo *changes,
+		       gpointer user_data)
+{
+	CamelEwsFolder *ews_folder = CAMEL_EWS_FOLDER (folder);
+	CamelFolderSummary *folder_summary;
+	CamelStore *store;
+	guint ii, n_flagged = 0;
+
+	if (!changes || !changes->uid_changed || !changes->uid_changed->len)
+		return;
+
+	store = camel_folder_get_parent_store (folder);
+	if (!store || !camel_offline_store_get_online (CAMEL_OFFLINE_STORE (store)))
+		return;
+
+	folder_summary = camel_folder_get_folder_summary (folder);
+	if (!folder_summary)
+		return;
+
+	for (ii = 0; ii < changes->uid_changed->len; ii++) {
+		CamelMessageInfo *mi;
+
+		mi = camel_folder_summary_get (folder_summary, g_ptr_array_index (changes->uid_changed, ii));
+		if (mi && camel_message_info_get_folder_flagged (mi))
+			n_flagged++;
+
+		g_clear_object (&mi);
+	}
+
+	if (!n_flagged)
+		return;
+
+	g_mutex_lock (&ews_folder->priv->save_flags_lock);
+
+	ews_folder->priv->n_flags_changed += n_flagged;
+
+	if (!ews_folder->priv->save_flags_id ||
+	    (!ews_folder->priv->save_flags_soon && ews_folder->priv->n_flags_changed >= EWS_SAVE_FLAGS_BATCH_SIZE)) {
+		if (ews_folder->priv->save_flags_id)
+			g_source_remove (ews_folder->priv->save_flags_id);
+
+		ews_folder->priv->save_flags_soon = ews_folder->priv->n_flags_changed >= EWS_SAVE_FLAGS_BATCH_SIZE;
+		ews_folder->priv->save_flags_id = e_named_timeout_add_seconds_full (
+			G_PRIORITY_LOW,
+			ews_folder->priv->save_flags_soon ? 1 : EWS_SAVE_FLAGS_DELAY,
+			ews_folder_save_flags_cb,
+			e_weak_ref_new (folder),
+			(GDestroyNotify) e_weak_ref_free);
+	}
+
+	g_mutex_unlock (&ews_folder->priv->save_flags_lock);
+}
+
 CamelFolder *
 camel_ews_folder_new (CamelStore *store,
                       const gchar *folder_name,
@@ -1790,6 +3003,7 @@ camel_ews_folder_new (CamelStore *store,
 	gint offline_limit_value = 0;
 	guint32 add_folder_flags = 0;
 	gchar *state_file;
+	gchar *index_file;
 	const gchar *short_name;
 
 	short_name = strrchr (folder_name, '/');
@@ -1866,6 +3080,15 @@ camel_ews_folder_new (CamelStore *store,
 		ews_folder->cache, "expire-enabled",
 		G_BINDING_SYNC_CREATE);
 
+	index_file = g_build_filename (folder_dir, "body.index", NULL);
+	ews_folder->priv->body_index = (CamelIndex *) camel_text_index_new (index_file, O_CREAT | O_RDWR);
+	if (!ews_folder->priv->body_index) {
+		/* Possibly broken, start from scratch */
+		camel_text_index_remove (index_file);
+		ews_folder->priv->body_index = (CamelIndex *) camel_text_index_new (index_file, O_CREAT | O_RDWR);
+	}
+	g_free (index_file);
+
 	if (!g_ascii_strcasecmp (folder_name, "Inbox") ||
 	    folder_has_inbox_type (CAMEL_EWS_STORE (store), folder_name)) {
 		settings = camel_service_ref_settings (CAMEL_SERVICE (store));
@@ -1891,6 +3114,11 @@ camel_ews_folder_new (CamelStore *store,
 
 	g_signal_connect (folder_summary, "notify::saved-count", G_CALLBACK (ews_folder_count_notify_cb), folder);
 	g_signal_connect (folder_summary, "notify::unread-count", G_CALLBACK (ews_folder_count_notify_cb), folder);
+	g_signal_connect (folder, "changed", G_CALLBACK (ews_folder_changed_cb), NULL);
+
+	/* Messages of folders synchronized for offline use are kept regardless the cache size limit */
+	ews_folder_offline_sync_notify_cb (folder, NULL, NULL);
+	g_signal_connect (folder, "notify::offline-sync", G_CALLBACK (ews_folder_offline_sync_notify_cb), NULL);
 
 	return folder;
 }
@@ -2027,10 +3255,111 @@ void
 camel_ews_folder_remove_cached_message (CamelEwsFolder *ews_folder,
 					const gchar *uid)
 {
+	CamelStore *parent_store;
+
 	g_return_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder));
 	g_return_if_fail (uid != NULL);
 
 	ews_data_cache_remove (ews_folder->cache, "cur", uid, NULL);
+
+	if (ews_folder->priv->body_index) {
+		g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+		camel_index_delete_name (ews_folder->priv->body_index, uid);
+		g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+	}
+
+	parent_store = camel_folder_get_parent_store (CAMEL_FOLDER (ews_folder));
+	if (parent_store) {
+		gchar *key;
+
+		key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, uid, -1);
+
+		camel_ews_store_forget_cached_message (CAMEL_EWS_STORE (parent_store),
+			camel_folder_get_full_name (CAMEL_FOLDER (ews_folder)), key);
+
+		g_free (key);
+	}
+}
+
+/* Removes the message with the cache key 'key' from the cache, due to the store's
+   cache size limit; its content stays in the body index, thus it can be still found */
+void
+camel_ews_folder_evict_cached_message (CamelEwsFolder *ews_folder,
+				       const gchar *key)
+{
+	g_return_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder));
+	g_return_if_fail (key != NULL);
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+	camel_data_cache_remove (ews_folder->cache, "cur", key, NULL);
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+}
+
+/**
+ * camel_ews_folder_ref_body_index:
+ * @ews_folder: a #CamelEwsFolder
+ * @uids: (element-type utf8): message UIDs
+ *
+ * Returns the index of the words in the cached message bodies, when all
+ * the @uids are in it, thus a body search over them can be done locally.
+ * Free the returned index with g_object_unref(), when no longer needed.
+ *
+ * Returns: (transfer full) (nullable): a #CamelIndex, or %NULL
+ **/
+CamelIndex *
+camel_ews_folder_ref_body_index (CamelEwsFolder *ews_folder,
+				 const GPtrArray *uids)
+{
+	CamelIndex *body_index = NULL;
+	guint ii;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), NULL);
+	g_return_val_if_fail (uids != NULL, NULL);
+
+	g_rec_mutex_lock (&ews_folder->priv->cache_lock);
+
+	if (ews_folder->priv->body_index && uids->len > 0) {
+		for (ii = 0; ii < uids->len; ii++) {
+			if (!camel_index_has_name (ews_folder->priv->body_index, g_ptr_array_index (uids, ii)))
+				break;
+		}
+
+		if (ii == uids->len)
+			body_index = g_object_ref (ews_folder->priv->body_index);
+	}
+
+	g_rec_mutex_unlock (&ews_folder->priv->cache_lock);
+
+	return body_index;
+}
+
+static void
+ews_folder_add_transferred_uid (CamelEwsFolder *ews_folder,
+				const gchar *uid)
+{
+	g_mutex_lock (&ews_folder->priv->state_lock);
+	g_hash_table_add (ews_folder->priv->transferred_uids, (gpointer) camel_pstring_strdup (uid));
+	g_mutex_unlock (&ews_folder->priv->state_lock);
+}
+
+/* Returns whether the 'uid' had been added to the summary by a move/copy
+   and forgets about it, the server reports it as created only once */
+static gboolean
+ews_folder_take_transferred_uid (CamelEwsFolder *ews_folder,
+				 const gchar *uid)
+{
+	const gchar *pooled_uid;
+	gboolean known;
+
+	pooled_uid = camel_pstring_strdup (uid);
+
+	g_mutex_lock (&ews_folder->priv->state_lock);
+	known = g_hash_table_remove (ews_folder->priv->transferred_uids, pooled_uid);
+	g_mutex_unlock (&ews_folder->priv->state_lock);
+
+	camel_pstring_free (pooled_uid);
+
+	return known;
 }
 
 static void
@@ -2076,12 +3405,27 @@ sync_created_items (CamelEwsFolder *ews_folder,
 
 			camel_pstring_free (pooled_uid);
 
+			if (known) {
+				CamelMessageInfo *mi;
+
+				mi = camel_folder_summary_get (camel_folder_get_folder_summary (CAMEL_FOLDER (ews_folder)), id->id);
+				known = mi && !ews_message_info_is_header_only (mi);
+				g_clear_object (&mi);
+			}
+
 			if (known) {
 				g_object_unref (item);
 				continue;
 			}
 		}
 
+		/* Already in the summary, with the values returned by the MoveItem/CopyItem */
+		if (ews_folder_take_transferred_uid (ews_folder, id->id) &&
+		    camel_folder_summary_check_uid (camel_folder_get_folder_summary (CAMEL_FOLDER (ews_folder)), id->id)) {
+			g_object_unref (item);
+			continue;
+		}
+
 		/* created_msg_ids are items other than generic item. We fetch them
 		 * separately since the property sets vary */
 		/* FIXME: Do we need to handle any other item types
@@ -2218,20 +3562,99 @@ ews_folder_forget_all_mails (CamelEwsFolder *ews_folder)
 	for (ii = 0; ii < known_uids->len; ii++) {
 		const gchar *uid = g_ptr_array_index (known_uids, ii);
 
-		camel_folder_change_info_remove_uid (changes, uid);
-		camel_folder_summary_remove_uid (folder_summary, uid);
-		ews_data_cache_remove (ews_folder->cache, "cur", uid, NULL);
+		camel_folder_change_info_remove_uid (changes, uid);
+		camel_folder_summary_remove_uid (folder_summary, uid);
+		camel_ews_folder_remove_cached_message (ews_folder, uid);
+	}
+	camel_folder_summary_unlock (folder_summary);
+
+	if (camel_folder_change_info_changed (changes)) {
+		camel_folder_summary_touch (folder_summary);
+		camel_folder_summary_save (folder_summary, NULL);
+		camel_folder_changed (folder, changes);
+	}
+
+	camel_folder_change_info_free (changes);
+	camel_folder_summary_free_array (known_uids);
+}
+
+/* Adds the newest messages of a folder, which is synchronized for the first time,
+   into the summary, thus they can be shown before the SyncFolderItems walks the whole
+   folder. The FindItem cannot return all the properties, thus these are stored as
+   header-only and the SyncFolderItems fetches them completely later. */
+static void
+ews_folder_sync_newest_sync (CamelEwsFolder *ews_folder,
+			     EEwsConnection *cnc,
+			     const gchar *folder_id,
+			     guint max_items,
+			     gboolean is_drafts_folder,
+			     CamelFolderChangeInfo *change_info,
+			     GCancellable *cancellable)
+{
+	CamelFolderSummary *folder_summary;
+	EEwsAdditionalProps *add_props;
+	EwsFolderId *fid;
+	EwsSortOrder sort_order;
+	GSList *items = NULL, *uids = NULL, *link;
+	GError *local_error = NULL;
+
+	add_props = e_ews_additional_props_new ();
+	add_props->field_uri = g_strdup (SUMMARY_HEADER_PROPS);
+	add_props->extended_furis = ews_folder_get_summary_message_mapi_flags ();
+
+	sort_order.order = (gchar *) "Descending";
+	sort_order.uri_type = NORMAL_FIELD_URI;
+	sort_order.field_uri = (gpointer) "item:DateTimeReceived";
+
+	fid = e_ews_folder_id_new (folder_id, NULL, FALSE);
+
+	e_ews_connection_find_folder_items_sync (
+		cnc, EWS_PRIORITY_MEDIUM, fid, "IdOnly", add_props,
+		&sort_order, max_items, NULL, NULL, E_EWS_FOLDER_TYPE_MAILBOX,
+		NULL, &items, NULL, cancellable, &local_error);
+
+	e_ews_folder_id_free (fid);
+	e_ews_additional_props_free (add_props);
+
+	if (local_error) {
+		/* Not fatal, the SyncFolderItems gets the messages too */
+		g_debug ("%s: Failed to get newest messages: %s", G_STRFUNC, local_error->message);
+		g_clear_error (&local_error);
+	}
+
+	for (link = items; link; link = g_slist_next (link)) {
+		const EwsId *id;
+
+		if (!link->data || e_ews_item_get_item_type (link->data) == E_EWS_ITEM_TYPE_ERROR)
+			continue;
+
+		id = e_ews_item_get_id (link->data);
+		if (id && id->id)
+			uids = g_slist_prepend (uids, g_strdup (id->id));
+	}
+
+	camel_ews_utils_sync_created_items (ews_folder, cnc, is_drafts_folder, items, change_info, cancellable);
+
+	folder_summary = camel_folder_get_folder_summary (CAMEL_FOLDER (ews_folder));
+
+	for (link = uids; link; link = g_slist_next (link)) {
+		CamelMessageInfo *mi;
+
+		mi = camel_folder_summary_get (folder_summary, link->data);
+		if (mi) {
+			camel_ews_message_info_set_change_key (CAMEL_EWS_MESSAGE_INFO (mi), "");
+			g_object_unref (mi);
+		}
 	}
-	camel_folder_summary_unlock (folder_summary);
 
-	if (camel_folder_change_info_changed (changes)) {
+	g_slist_free_full (uids, g_free);
+
+	if (camel_folder_change_info_changed (change_info)) {
 		camel_folder_summary_touch (folder_summary);
 		camel_folder_summary_save (folder_summary, NULL);
-		camel_folder_changed (folder, changes);
+		camel_folder_changed (CAMEL_FOLDER (ews_folder), change_info);
+		camel_folder_change_info_clear (change_info);
 	}
-
-	camel_folder_change_info_free (changes);
-	camel_folder_summary_free_array (known_uids);
 }
 
 static gboolean
@@ -2296,6 +3719,19 @@ ews_refresh_info_sync (CamelFolder *folder,
 	 * GetItem request. */
 	sync_state = camel_ews_summary_dup_sync_state (CAMEL_EWS_SUMMARY (folder_summary));
 
+	/* Show the newest messages first, the whole folder can take long to be synchronized */
+	if (!sync_state && id && camel_folder_summary_count (folder_summary) == 0) {
+		CamelSettings *settings;
+		guint first_sync_newest;
+
+		settings = camel_service_ref_settings (CAMEL_SERVICE (ews_store));
+		first_sync_newest = camel_ews_settings_get_first_sync_newest (CAMEL_EWS_SETTINGS (settings));
+		g_object_unref (settings);
+
+		if (first_sync_newest > 0)
+			ews_folder_sync_newest_sync (ews_folder, cnc, id, first_sync_newest, is_drafts_folder, change_info, cancellable);
+	}
+
 	if (!sync_state ||
 	    camel_ews_summary_get_version (CAMEL_EWS_SUMMARY (folder_summary)) < CAMEL_EWS_SUMMARY_VERSION) {
 		updating_summary_uids = camel_folder_summary_get_hash (folder_summary);
@@ -2390,7 +3826,7 @@ ews_refresh_info_sync (CamelFolder *folder,
 				const gchar *uid = key;
 
 				camel_folder_change_info_remove_uid (change_info, uid);
-				ews_data_cache_remove (ews_folder->cache, "cur", uid, NULL);
+				camel_ews_folder_remove_cached_message (ews_folder, uid);
 
 				removed_uids = g_list_prepend (removed_uids, (gpointer) uid);
 			}
@@ -2561,7 +3997,7 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 			g_clear_object (&mi);
 		}
 
-		if (mi_list_len == EWS_MAX_FETCH_COUNT) {
+		if (mi_list_len == EWS_SAVE_FLAGS_BATCH_SIZE) {
 			success = ews_save_flags (source, mi_list, cancellable, &local_error);
 			g_slist_free_full (mi_list, g_object_unref);
 			mi_list = NULL;
@@ -2591,7 +4027,6 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 
 		for (l = ret_items, i = 0; l != NULL; l = l->next, i++) {
 			CamelMimeMessage *message;
-			CamelStream *stream;
 			CamelMessageInfo *info;
 			CamelMessageInfo *clone;
 			const EwsId *id;
@@ -2605,24 +4040,25 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 			id = e_ews_item_get_id (l->data);
 			processed_items = g_slist_prepend (processed_items, uids->pdata[i]);
 
-			message = ews_folder_get_message_cached (source, uids->pdata[i], cancellable);
+			message = camel_ews_folder_get_message_from_cache (CAMEL_EWS_FOLDER (source), uids->pdata[i], cancellable, NULL);
 			if (message == NULL)
 				continue;
 
-			stream = ews_data_cache_add (
-				CAMEL_EWS_FOLDER (destination)->cache, "cur", id->id, NULL);
-			if (stream == NULL) {
-				g_object_unref (message);
+			/* The attachment IDs are not valid for the new item, thus
+			   let the message be downloaded again, when needed */
+			if (!ews_message_has_attachment_placeholders (message)) {
+				if (!ews_data_cache_add_message (CAMEL_EWS_FOLDER (destination)->cache, "cur", id->id, message, cancellable, NULL)) {
+					g_object_unref (message);
 
-				continue;
-			}
+					continue;
+				}
 
-			camel_data_wrapper_write_to_stream_sync (
-				CAMEL_DATA_WRAPPER (message), stream, cancellable, NULL);
+				ews_folder_index_message (CAMEL_EWS_FOLDER (destination), id->id, message, TRUE, cancellable);
+				ews_folder_touch_cached_message (CAMEL_EWS_FOLDER (destination), id->id);
+			}
 
 			info = camel_folder_summary_get (camel_folder_get_folder_summary (source), uids->pdata[i]);
 			if (info == NULL) {
-				g_object_unref (stream);
 				g_object_unref (message);
 
 				continue;
@@ -2630,12 +4066,13 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 
 			clone = camel_message_info_clone (info, NULL);
 
-			if (camel_ews_summary_add_message (camel_folder_get_folder_summary (destination), id->id, id->change_key, clone, message))
+			if (camel_ews_summary_add_message (camel_folder_get_folder_summary (destination), id->id, id->change_key, clone, message)) {
 				camel_folder_change_info_add_uid (changes, id->id);
+				ews_folder_add_transferred_uid (CAMEL_EWS_FOLDER (destination), id->id);
+			}
 
 			g_clear_object (&clone);
 			g_clear_object (&info);
-			g_object_unref (stream);
 			g_object_unref (message);
 		}
 
@@ -2652,7 +4089,7 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 
 				camel_folder_summary_remove_uid (camel_folder_get_folder_summary (source), uid);
 				camel_folder_change_info_remove_uid (changes, uid);
-				ews_data_cache_remove (CAMEL_EWS_FOLDER (source)->cache, "cur", uid, NULL);
+				camel_ews_folder_remove_cached_message (CAMEL_EWS_FOLDER (source), uid);
 			}
 			if (camel_folder_change_info_changed (changes)) {
 				camel_folder_summary_touch (camel_folder_get_folder_summary (source));
@@ -2663,9 +4100,12 @@ ews_transfer_messages_to_sync (CamelFolder *source,
 		}
 
 		/* update destination folder only if not frozen, to not update
-		   for each single message transfer during filtering
+		   for each single message transfer during filtering; the refresh
+		   is done in the background, thus multiple transfers into the same
+		   folder share it, the transferred messages are already known
 		 */
-		if (!camel_folder_is_frozen (destination)) {
+		if (!camel_folder_is_frozen (destination) &&
+		    !camel_ews_store_schedule_folder_refresh (dst_ews_store, dst_id)) {
 			camel_operation_progress (cancellable, -1);
 
 			ews_refresh_info_sync (destination, cancellable, NULL);
@@ -2733,7 +4173,7 @@ ews_delete_messages_from_folder (CamelFolder *folder,
 		camel_folder_summary_lock (folder_summary);
 		camel_folder_change_info_remove_uid (changes, uid);
 		camel_folder_summary_remove_uid (folder_summary, uid);
-		ews_data_cache_remove (CAMEL_EWS_FOLDER (folder)->cache, "cur", uid, NULL);
+		camel_ews_folder_remove_cached_message (CAMEL_EWS_FOLDER (folder), uid);
 		camel_folder_summary_unlock (folder_summary);
 	}
 
@@ -2792,20 +4232,273 @@ ews_delete_messages (CamelFolder *folder,
 	return TRUE;
 }
 
+/* Pre-2010 servers cannot empty the "Deleted Items" folder at once, thus its
+   subfolders and its items are deleted with multi-id requests, running
+   at most EWS_EXPUNGE_MAX_REQUESTS of them at the same time */
+#define EWS_EXPUNGE_FOLDERS_BATCH_SIZE 25
+#define EWS_EXPUNGE_ITEMS_BATCH_SIZE 500
+#define EWS_EXPUNGE_MAX_REQUESTS 4
+
+typedef struct _ExpungeBatch {
+	GSList *folder_ids; /* gchar *; either folders or items are set */
+	GSList *item_ids; /* const gchar *, borrowed */
+} ExpungeBatch;
+
+typedef struct _ExpungeRequests {
+	EEwsConnection *cnc;
+	GHashTable *folder_errors; /* gchar *folder id ~> GError * */
+	GError *items_error;
+} ExpungeRequests;
+
+static void
+ews_expunge_batch_free (gpointer ptr)
+{
+	ExpungeBatch *batch = ptr;
+
+	if (batch) {
+		g_slist_free_full (batch->folder_ids, g_free);
+		g_slist_free (batch->item_ids);
+		g_free (batch);
+	}
+}
+
+static void
+ews_expunge_folders_done (GObject *source_object,
+			  GAsyncResult *result,
+			  ExpungeBatch *batch,
+			  ExpungeRequests *requests)
+{
+	GHashTable *folder_errors = NULL;
+	GError *local_error = NULL;
+
+	if (e_ews_connection_delete_folders_finish (E_EWS_CONNECTION (source_object), result, &folder_errors, &local_error)) {
+		if (folder_errors) {
+			GHashTableIter iter;
+			gpointer key, value;
+
+			g_hash_table_iter_init (&iter, folder_errors);
+			while (g_hash_table_iter_next (&iter, &key, &value)) {
+				g_hash_table_insert (requests->folder_errors, g_strdup (key), g_error_copy (value));
+			}
+
+			g_hash_table_unref (folder_errors);
+		}
+	} else {
+		GSList *link;
+
+		/* The whole request failed, thus none of its folders was deleted */
+		for (link = batch->folder_ids; link; link = g_slist_next (link)) {
+			g_hash_table_insert (requests->folder_errors, g_strdup (link->data), g_error_copy (local_error));
+		}
+
+		g_clear_error (&local_error);
+	}
+}
+
+static void
+ews_expunge_items_done (GObject *source_object,
+			GAsyncResult *result,
+			ExpungeRequests *requests)
+{
+	GError *local_error = NULL;
+
+	/* Items already gone from the server are fine, they are being deleted anyway */
+	if (!e_ews_connection_delete_items_finish (E_EWS_CONNECTION (source_object), result, &local_error) &&
+	    !g_error_matches (local_error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_ITEMNOTFOUND) &&
+	    !requests->items_error) {
+		requests->items_error = local_error;
+		local_error = NULL;
+	}
+
+	g_clear_error (&local_error);
+}
+
+static void
+ews_expunge_batch_done (GObject *source_object,
+			GAsyncResult *result,
+			gpointer batch_ptr,
+			gpointer user_data)
+{
+	ExpungeBatch *batch = batch_ptr;
+	ExpungeRequests *requests = user_data;
+
+	if (batch->folder_ids)
+		ews_expunge_folders_done (source_object, result, batch, requests);
+	else
+		ews_expunge_items_done (source_object, result, requests);
+}
+
+static void
+ews_expunge_batch_start (gpointer batch_ptr,
+			 gpointer user_data,
+			 GCancellable *cancellable,
+			 GAsyncReadyCallback callback,
+			 gpointer callback_data)
+{
+	ExpungeBatch *batch = batch_ptr;
+	ExpungeRequests *requests = user_data;
+
+	if (batch->folder_ids) {
+		e_ews_connection_delete_folders (
+			requests->cnc,
+			EWS_PRIORITY_MEDIUM,
+			batch->folder_ids,
+			"HardDelete",
+			cancellable,
+			callback,
+			callback_data);
+	} else {
+		e_ews_connection_delete_items (
+			requests->cnc,
+			EWS_PRIORITY_MEDIUM,
+			batch->item_ids,
+			EWS_HARD_DELETE,
+			EWS_SEND_TO_NONE,
+			EWS_NONE_OCCURRENCES,
+			cancellable,
+			callback,
+			callback_data);
+	}
+}
+
+static GSList *
+ews_expunge_split_to_batches (GSList *ids,
+			      gboolean are_folders,
+			      guint batch_size)
+{
+	GSList *batches = NULL, *link;
+	ExpungeBatch *batch = NULL;
+	guint n_ids = 0;
+
+	for (link = ids; link; link = g_slist_next (link)) {
+		if (!batch || n_ids >= batch_size) {
+			batch = g_new0 (ExpungeBatch, 1);
+			batches = g_slist_prepend (batches, batch);
+			n_ids = 0;
+		}
+
+		if (are_folders)
+			batch->folder_ids = g_slist_prepend (batch->folder_ids, g_strdup (link->data));
+		else
+			batch->item_ids = g_slist_prepend (batch->item_ids, link->data);
+
+		n_ids++;
+	}
+
+	return g_slist_reverse (batches);
+}
+
+/* Deletes the first level subfolders of the "Deleted Items" folder and the 'deleted_items'
+   from the server. Folders, which could not be deleted, are kept in the summary and are
+   reported in the 'error', each with its own reason. */
+static gboolean
+ews_expunge_deleted_items_in_batches_sync (CamelEwsStore *ews_store,
+					   EEwsConnection *cnc,
+					   CamelFolderInfo *folder_info,
+					   const GSList *deleted_items,
+					   GCancellable *cancellable,
+					   GError **error)
+{
+	ExpungeRequests requests;
+	CamelFolderInfo *to_delete;
+	GSList *folder_ids = NULL, *batches = NULL;
+	GString *failures = NULL;
+	GError *first_error = NULL;
+	gboolean success = TRUE;
+
+	memset (&requests, 0, sizeof (ExpungeRequests));
+	requests.cnc = cnc;
+	requests.folder_errors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_error_free);
+
+	for (to_delete = folder_info->child; to_delete; to_delete = to_delete->next) {
+		gchar *fid;
+
+		fid = camel_ews_store_summary_get_folder_id_from_name (ews_store->summary, to_delete->full_name);
+		if (fid)
+			folder_ids = g_slist_prepend (folder_ids, fid);
+	}
+
+	folder_ids = g_slist_reverse (folder_ids);
+
+	batches = g_slist_concat (
+		ews_expunge_split_to_batches (folder_ids, TRUE, EWS_EXPUNGE_FOLDERS_BATCH_SIZE),
+		ews_expunge_split_to_batches ((GSList *) deleted_items, FALSE, EWS_EXPUNGE_ITEMS_BATCH_SIZE));
+
+	g_slist_free_full (folder_ids, g_free);
+
+	e_ews_connection_utils_run_batches_sync (batches, EWS_EXPUNGE_MAX_REQUESTS,
+		ews_expunge_batch_start, ews_expunge_batch_done, &requests, cancellable);
+
+	g_slist_free_full (batches, ews_expunge_batch_free);
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+		g_hash_table_destroy (requests.folder_errors);
+		g_clear_error (&requests.items_error);
+
+		return FALSE;
+	}
+
+	/* Remove from the summary only the folders deleted on the server */
+	for (to_delete = folder_info->child; to_delete && success; ) {
+		CamelFolderInfo *next = to_delete->next;
+		const GError *folder_error = NULL;
+		gchar *fid;
+
+		fid = camel_ews_store_summary_get_folder_id_from_name (ews_store->summary, to_delete->full_name);
+		if (fid)
+			folder_error = g_hash_table_lookup (requests.folder_errors, fid);
+		g_free (fid);
+
+		if (folder_error) {
+			if (!first_error)
+				first_error = g_error_copy (folder_error);
+
+			if (!failures)
+				failures = g_string_new ("");
+			else
+				g_string_append_c (failures, '\n');
+
+			g_string_append_printf (failures, _("Cannot remove folder “%s”: %s"), to_delete->display_name, folder_error->message);
+		} else {
+			/* Only this folder, not its siblings */
+			to_delete->next = NULL;
+			success = camel_ews_utils_delete_folders_from_summary_recursive (ews_store, to_delete, TRUE, error);
+			to_delete->next = next;
+		}
+
+		to_delete = next;
+	}
+
+	if (success && failures) {
+		g_set_error_literal (error, first_error->domain, first_error->code, failures->str);
+		success = FALSE;
+	} else if (success && requests.items_error) {
+		g_propagate_error (error, requests.items_error);
+		requests.items_error = NULL;
+		success = FALSE;
+	}
+
+	if (failures)
+		g_string_free (failures, TRUE);
+	g_clear_error (&first_error);
+	g_clear_error (&requests.items_error);
+	g_hash_table_destroy (requests.folder_errors);
+
+	return success;
+}
+
 static gboolean
 ews_expunge_deleted_items_sync (CamelFolder *folder,
 				CamelEwsStore *ews_store,
-				gboolean *delete_items,
+				const GSList *deleted_items,
 				GCancellable *cancellable,
 				GError **error)
 {
 	EEwsConnection *cnc;
 	CamelFolderInfo *folder_info = NULL;
-	CamelFolderInfo *to_delete;
 	gchar *trash_id;
 	gchar *folder_name;
 	gboolean ret = FALSE;
-	gboolean expunge_deleted_items_at_once = FALSE;
 
 	cnc = camel_ews_store_ref_connection (ews_store);
 	trash_id = camel_ews_store_summary_get_folder_id_from_folder_type (ews_store->summary, CAMEL_FOLDER_TYPE_TRASH);
@@ -2824,11 +4517,7 @@ ews_expunge_deleted_items_sync (CamelFolder *folder,
 	if (folder_info == NULL)
 		goto exit;
 
-	to_delete = folder_info->child;
-
-	expunge_deleted_items_at_once = e_ews_connection_satisfies_server_version (cnc, E_EWS_EXCHANGE_2010);
-
-	if (expunge_deleted_items_at_once) {
+	if (e_ews_connection_satisfies_server_version (cnc, E_EWS_EXCHANGE_2010)) {
 		ret = e_ews_connection_empty_folder_sync (
 			cnc,
 			EWS_PRIORITY_MEDIUM,
@@ -2841,46 +4530,22 @@ ews_expunge_deleted_items_sync (CamelFolder *folder,
 
 		if (!ret)
 			goto exit;
+
+		ret = camel_ews_utils_delete_folders_from_summary_recursive (ews_store, folder_info->child, TRUE, error);
 	} else {
 		/*
 		 * As we cannot delete the "Deleted Items" folder itself, we have to walk throught its first
-		 * level subfolders and delete each folder one by one from the server,
+		 * level subfolders and delete each folder from the server, together with the items.
 		 */
-		while (to_delete != NULL) {
-			gchar *fid;
-
-			fid = camel_ews_store_summary_get_folder_id_from_name (
-				ews_store->summary, to_delete->full_name);
-
-			ret = e_ews_connection_delete_folder_sync (
-				cnc,
-				EWS_PRIORITY_MEDIUM,
-				fid,
-				FALSE,
-				"HardDelete",
-				cancellable,
-				error);
-
-			g_free (fid);
-
-			if (!ret)
-				goto exit;
-
-			to_delete = to_delete->next;
-		}
+		ret = ews_expunge_deleted_items_in_batches_sync (ews_store, cnc, folder_info, deleted_items, cancellable, error);
 	}
 
-	to_delete = folder_info->child;
-	ret = camel_ews_utils_delete_folders_from_summary_recursive (ews_store, to_delete, TRUE, error);
-
 exit:
 	camel_folder_info_free (folder_info);
 	g_free (folder_name);
 	g_free (trash_id);
 	g_object_unref (cnc);
 
-	*delete_items = !expunge_deleted_items_at_once;
-
 	return ret;
 }
 
@@ -2893,7 +4558,6 @@ ews_expunge_sync (CamelFolder *folder,
 	GSList *deleted_items = NULL;
 	gint i;
 	gboolean is_trash;
-	gboolean delete_items_from_server = TRUE;
 	gboolean ret;
 	GPtrArray *known_uids;
 	GError *local_error = NULL;
@@ -2916,24 +4580,6 @@ ews_expunge_sync (CamelFolder *folder,
 	if (known_uids == NULL)
 		return TRUE;
 
-	if (is_trash) {
-		ews_expunge_deleted_items_sync (
-			folder,
-			CAMEL_EWS_STORE (parent_store),
-			&delete_items_from_server,
-			cancellable,
-			&local_error);
-
-		if (local_error != NULL) {
-			camel_ews_store_maybe_disconnect (CAMEL_EWS_STORE (parent_store), local_error);
-			g_propagate_error (error, local_error);
-
-			camel_folder_summary_free_array (known_uids);
-
-			return FALSE;
-		}
-	}
-
 	for (i = 0; i < known_uids->len; i++) {
 		CamelMessageInfo *info;
 		const gchar *uid = g_ptr_array_index (known_uids, i);
@@ -2946,7 +4592,23 @@ ews_expunge_sync (CamelFolder *folder,
 		g_clear_object (&info);
 	}
 
-	if (is_trash && !delete_items_from_server) {
+	if (is_trash) {
+		/* Deleted from the server together with the subfolders */
+		if (!ews_expunge_deleted_items_sync (
+			folder,
+			CAMEL_EWS_STORE (parent_store),
+			deleted_items,
+			cancellable,
+			&local_error)) {
+			camel_ews_store_maybe_disconnect (CAMEL_EWS_STORE (parent_store), local_error);
+			g_propagate_error (error, local_error);
+
+			g_slist_free_full (deleted_items, (GDestroyNotify) camel_pstring_free);
+			camel_folder_summary_free_array (known_uids);
+
+			return FALSE;
+		}
+
 		ews_delete_messages_from_folder (folder, deleted_items);
 		ret = TRUE;
 	} else {
@@ -2970,6 +4632,233 @@ ews_cmp_uids (CamelFolder *folder,
 	return strcmp (uid1, uid2);
 }
 
+static void
+ews_ex_unresolved_free (gpointer ptr)
+{
+	ExUnresolved *exu = ptr;
+
+	if (exu) {
+		g_free (exu->name);
+		g_hash_table_destroy (exu->uids);
+		g_free (exu);
+	}
+}
+
+/* Returns the email to be shown for the 'mailbox' of the message 'uid'. For an EX address
+   it is its SMTP address, when known already, otherwise the address is remembered to be
+   resolved by camel_ews_folder_schedule_ex_resolve(), which updates the message info,
+   and a readable part of the EX address is returned meanwhile. Free it with g_free(). */
+gchar *
+camel_ews_folder_dup_mailbox_email (CamelEwsFolder *ews_folder,
+				    EEwsConnection *cnc,
+				    const gchar *uid,
+				    const EwsMailbox *mailbox)
+{
+	ExUnresolved *exu;
+	gchar *smtp_address = NULL;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder), NULL);
+	g_return_val_if_fail (mailbox != NULL, NULL);
+
+	if (g_strcmp0 (mailbox->routing_type, "EX") != 0 || !mailbox->email)
+		return g_strdup (mailbox->email);
+
+	if (cnc && e_ews_connection_get_cached_smtp_address (cnc, mailbox->email, &smtp_address))
+		return smtp_address;
+
+	if (uid) {
+		g_mutex_lock (&ews_folder->priv->ex_resolve_lock);
+
+		exu = g_hash_table_lookup (ews_folder->priv->ex_unresolved, mailbox->email);
+		if (!exu && g_hash_table_size (ews_folder->priv->ex_unresolved) < EWS_EX_RESOLVE_MAX_QUEUED) {
+			exu = g_new0 (ExUnresolved, 1);
+			exu->name = g_strdup (mailbox->name);
+			exu->uids = g_hash_table_new_full (g_direct_hash, g_direct_equal, (GDestroyNotify) camel_pstring_free, NULL);
+
+			g_hash_table_insert (ews_folder->priv->ex_unresolved, g_strdup (mailbox->email), exu);
+		}
+
+		if (exu)
+			g_hash_table_add (exu->uids, (gpointer) camel_pstring_strdup (uid));
+
+		g_mutex_unlock (&ews_folder->priv->ex_resolve_lock);
+	}
+
+	return g_strdup (e_ews_item_util_strip_ex_address (mailbox->email));
+}
+
+/* Replaces all the 'old_value' occurrences in the 'text'; returns NULL when there are none */
+static gchar *
+ews_folder_replace_in_string (const gchar *text,
+			      const gchar *old_value,
+			      const gchar *new_value)
+{
+	GString *str;
+	const gchar *ptr, *found;
+
+	if (!text || !strstr (text, old_value))
+		return NULL;
+
+	str = g_string_sized_new (strlen (text) + 16);
+
+	for (ptr = text; (found = strstr (ptr, old_value)) != NULL; ptr = found + strlen (old_value)) {
+		g_string_append_len (str, ptr, found - ptr);
+		g_string_append (str, new_value);
+	}
+
+	g_string_append (str, ptr);
+
+	return g_string_free (str, FALSE);
+}
+
+static gboolean
+ews_folder_replace_address_in_info (CamelMessageInfo *mi,
+				    const gchar *old_address,
+				    const gchar *new_address)
+{
+	gchar *value;
+	gboolean changed = FALSE;
+
+	value = ews_folder_replace_in_string (camel_message_info_get_from (mi), old_address, new_address);
+	if (value) {
+		changed = camel_message_info_set_from (mi, value) || changed;
+		g_free (value);
+	}
+
+	value = ews_folder_replace_in_string (camel_message_info_get_to (mi), old_address, new_address);
+	if (value) {
+		changed = camel_message_info_set_to (mi, value) || changed;
+		g_free (value);
+	}
+
+	value = ews_folder_replace_in_string (camel_message_info_get_cc (mi), old_address, new_address);
+	if (value) {
+		changed = camel_message_info_set_cc (mi, value) || changed;
+		g_free (value);
+	}
+
+	return changed;
+}
+
+static void
+ews_folder_resolve_ex_addresses_thread (CamelSession *session,
+					GCancellable *cancellable,
+					gpointer user_data,
+					GError **error)
+{
+	CamelEwsFolder *ews_folder = user_data;
+	CamelFolder *folder = CAMEL_FOLDER (ews_folder);
+	CamelFolderSummary *folder_summary;
+	CamelFolderChangeInfo *changes;
+	EEwsConnection *cnc;
+	GHashTable *batch; /* gchar *ex_address ~> ExUnresolved * */
+	GHashTableIter iter;
+	gpointer key, value;
+
+	batch = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ews_ex_unresolved_free);
+
+	g_mutex_lock (&ews_folder->priv->ex_resolve_lock);
+
+	g_hash_table_iter_init (&iter, ews_folder->priv->ex_unresolved);
+	while (g_hash_table_size (batch) < EWS_EX_RESOLVE_BATCH_SIZE &&
+	       g_hash_table_iter_next (&iter, &key, &value)) {
+		g_hash_table_iter_steal (&iter);
+		g_hash_table_insert (batch, key, value);
+	}
+
+	ews_folder->priv->ex_resolve_scheduled = FALSE;
+
+	g_mutex_unlock (&ews_folder->priv->ex_resolve_lock);
+
+	/* When offline, the addresses are tried again with the messages
+	   the next refresh brings, or when a message is downloaded */
+	cnc = camel_ews_store_ref_connection (CAMEL_EWS_STORE (camel_folder_get_parent_store (folder)));
+	if (!cnc) {
+		g_hash_table_destroy (batch);
+		return;
+	}
+
+	folder_summary = camel_folder_get_folder_summary (folder);
+	changes = camel_folder_change_info_new ();
+
+	g_hash_table_iter_init (&iter, batch);
+	while (g_hash_table_iter_next (&iter, &key, &value) && !g_cancellable_is_cancelled (cancellable)) {
+		const gchar *ex_address = key;
+		ExUnresolved *exu = value;
+		GHashTableIter uids_iter;
+		gpointer uid;
+		gchar *smtp_address = NULL, *old_address, *new_address;
+
+		/* This remembers the result, thus the address is not asked for again */
+		if (!e_ews_connection_ex_to_smtp_sync (cnc, EWS_PRIORITY_LOW, exu->name, ex_address, &smtp_address, cancellable, NULL))
+			continue;
+
+		old_address = g_strconcat ("<", e_ews_item_util_strip_ex_address (ex_address), ">", NULL);
+		new_address = g_strconcat ("<", smtp_address, ">", NULL);
+
+		g_hash_table_iter_init (&uids_iter, exu->uids);
+		while (g_hash_table_iter_next (&uids_iter, &uid, NULL)) {
+			CamelMessageInfo *mi;
+
+			mi = camel_folder_summary_get (folder_summary, uid);
+			if (!mi)
+				continue;
+
+			if (ews_folder_replace_address_in_info (mi, old_address, new_address))
+				camel_folder_change_info_change_uid (changes, uid);
+
+			g_object_unref (mi);
+		}
+
+		g_free (old_address);
+		g_free (new_address);
+		g_free (smtp_address);
+	}
+
+	if (camel_folder_change_info_changed (changes))
+		camel_folder_changed (folder, changes);
+
+	camel_folder_change_info_free (changes);
+	g_hash_table_destroy (batch);
+	g_object_unref (cnc);
+}
+
+/* Starts a background pass to resolve the EX addresses collected by
+   camel_ews_folder_dup_mailbox_email(), unless one is pending already */
+void
+camel_ews_folder_schedule_ex_resolve (CamelEwsFolder *ews_folder)
+{
+	CamelSession *session;
+	gboolean schedule;
+
+	g_return_if_fail (CAMEL_IS_EWS_FOLDER (ews_folder));
+
+	g_mutex_lock (&ews_folder->priv->ex_resolve_lock);
+	schedule = !ews_folder->priv->ex_resolve_scheduled && g_hash_table_size (ews_folder->priv->ex_unresolved) > 0;
+	if (schedule)
+		ews_folder->priv->ex_resolve_scheduled = TRUE;
+	g_mutex_unlock (&ews_folder->priv->ex_resolve_lock);
+
+	if (!schedule)
+		return;
+
+	session = camel_service_ref_session (CAMEL_SERVICE (camel_folder_get_parent_store (CAMEL_FOLDER (ews_folder))));
+	if (!session) {
+		g_mutex_lock (&ews_folder->priv->ex_resolve_lock);
+		ews_folder->priv->ex_resolve_scheduled = FALSE;
+		g_mutex_unlock (&ews_folder->priv->ex_resolve_lock);
+		return;
+	}
+
+	camel_session_submit_job (
+		session, _("Resolving sender and recipient addresses"),
+		ews_folder_resolve_ex_addresses_thread,
+		g_object_ref (ews_folder),
+		g_object_unref);
+
+	g_object_unref (session);
+}
+
 static void
 ews_folder_dispose (GObject *object)
 {
@@ -2994,6 +4883,18 @@ ews_folder_dispose (GObject *object)
 		ews_folder->search = NULL;
 	}
 
+	if (ews_folder->priv->body_index != NULL) {
+		camel_index_sync (ews_folder->priv->body_index);
+		g_clear_object (&ews_folder->priv->body_index);
+	}
+
+	g_mutex_lock (&ews_folder->priv->save_flags_lock);
+	if (ews_folder->priv->save_flags_id) {
+		g_source_remove (ews_folder->priv->save_flags_id);
+		ews_folder->priv->save_flags_id = 0;
+	}
+	g_mutex_unlock (&ews_folder->priv->save_flags_lock);
+
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (camel_ews_folder_parent_class)->dispose (object);
 }
@@ -3007,8 +4908,12 @@ ews_folder_finalize (GObject *object)
 
 	g_mutex_clear (&ews_folder->priv->search_lock);
 	g_mutex_clear (&ews_folder->priv->state_lock);
+	g_mutex_clear (&ews_folder->priv->save_flags_lock);
+	g_mutex_clear (&ews_folder->priv->ex_resolve_lock);
 	g_rec_mutex_clear (&ews_folder->priv->cache_lock);
+	g_hash_table_destroy (ews_folder->priv->ex_unresolved);
 	g_hash_table_destroy (ews_folder->priv->fetching_uids);
+	g_hash_table_destroy (ews_folder->priv->transferred_uids);
 	g_cond_clear (&ews_folder->priv->fetch_cond);
 
 	/* Chain up to parent's finalize() method. */
@@ -3096,12 +5001,16 @@ camel_ews_folder_init (CamelEwsFolder *ews_folder)
 
 	g_mutex_init (&ews_folder->priv->search_lock);
 	g_mutex_init (&ews_folder->priv->state_lock);
+	g_mutex_init (&ews_folder->priv->save_flags_lock);
+	g_mutex_init (&ews_folder->priv->ex_resolve_lock);
 	g_rec_mutex_init (&ews_folder->priv->cache_lock);
 
 	ews_folder->priv->refreshing = FALSE;
 
 	g_cond_init (&ews_folder->priv->fetch_cond);
 	ews_folder->priv->fetching_uids = g_hash_table_new (g_str_hash, g_str_equal);
+	ews_folder->priv->transferred_uids = g_hash_table_new_full (g_direct_hash, g_direct_equal, (GDestroyNotify) camel_pstring_free, NULL);
+	ews_folder->priv->ex_unresolved = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ews_ex_unresolved_free);
 	camel_folder_set_lock_async (folder, TRUE);
 }
 
@@ -29,6 +29,8 @@
 
 #include <camel/camel.h>
 
+#include "server/e-ews-connection.h"
+
 #include "camel-ews-summary.h"
 
 /* Standard GObject macros */
@@ -75,6 +77,21 @@ CamelFolder * camel_ews_folder_new (CamelStore *store, const gchar *folder_dir,
 void ews_update_summary ( CamelFolder *folder, GList *item_list, GCancellable *cancellable, GError **error);
 void		camel_ews_folder_remove_cached_message	(CamelEwsFolder *ews_folder,
 							 const gchar *uid);
+void		camel_ews_folder_evict_cached_message	(CamelEwsFolder *ews_folder,
+							 const gchar *key);
+CamelIndex *	camel_ews_folder_ref_body_index		(CamelEwsFolder *ews_folder,
+							 const GPtrArray *uids);
+gchar *		camel_ews_folder_dup_mailbox_email	(CamelEwsFolder *ews_folder,
+							 EEwsConnection *cnc,
+							 const gchar *uid,
+							 const EwsMailbox *mailbox);
+void		camel_ews_folder_schedule_ex_resolve	(CamelEwsFolder *ews_folder);
+GBytes *	camel_ews_folder_download_attachment_sync
+							(CamelEwsFolder *ews_folder,
+							 const gchar *uid,
+							 const gchar *attachment_id,
+							 GCancellable *cancellable,
+							 GError **error);
 
 G_END_DECLS
 
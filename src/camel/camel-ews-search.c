@@ -35,8 +35,21 @@ struct _CamelEwsSearchPrivate {
 
 	GCancellable *cancellable; /* not referenced */
 	GError **error; /* not referenced */
+
+	GMutex results_lock;
+	GHashTable *results; /* gchar *folder_id ~> EwsSearchResults * */
 };
 
+/* How many different searches are remembered for one folder */
+#define EWS_SEARCH_MAX_RESULTS 50
+
+/* Results of the server-side searches in one folder, valid
+   until the folder content changes, which the sync state tells */
+typedef struct _EwsSearchResults {
+	gchar *sync_state;
+	GHashTable *found; /* gchar *words ~> GPtrArray { camel_pstring uids } */
+} EwsSearchResults;
+
 enum {
 	PROP_0,
 	PROP_STORE
@@ -47,6 +60,150 @@ G_DEFINE_TYPE (
 	camel_ews_search,
 	CAMEL_TYPE_FOLDER_SEARCH)
 
+static void
+ews_search_results_free (gpointer ptr)
+{
+	EwsSearchResults *results = ptr;
+
+	if (results) {
+		g_free (results->sync_state);
+		g_hash_table_destroy (results->found);
+		g_free (results);
+	}
+}
+
+static void
+ews_search_uids_free (gpointer ptr)
+{
+	GPtrArray *uids = ptr;
+
+	if (uids) {
+		g_ptr_array_foreach (uids, (GFunc) camel_pstring_free, NULL);
+		g_ptr_array_free (uids, TRUE);
+	}
+}
+
+static GPtrArray *
+ews_search_copy_uids (const GPtrArray *uids)
+{
+	GPtrArray *copy;
+	guint ii;
+
+	copy = g_ptr_array_sized_new (uids->len);
+
+	for (ii = 0; ii < uids->len; ii++) {
+		g_ptr_array_add (copy, (gpointer) camel_pstring_strdup (g_ptr_array_index (uids, ii)));
+	}
+
+	return copy;
+}
+
+static gint
+ews_search_compare_words (gconstpointer ptr1,
+			  gconstpointer ptr2)
+{
+	return g_strcmp0 (*((const gchar **) ptr1), *((const gchar **) ptr2));
+}
+
+/* The order and the letter case of the words do not influence the result */
+static gchar *
+ews_search_words_to_key (const GPtrArray *words)
+{
+	GPtrArray *folded;
+	GString *key;
+	guint ii;
+
+	folded = g_ptr_array_new_full (words->len, g_free);
+
+	for (ii = 0; ii < words->len; ii++) {
+		g_ptr_array_add (folded, g_utf8_casefold (g_ptr_array_index (words, ii), -1));
+	}
+
+	g_ptr_array_sort (folded, ews_search_compare_words);
+
+	key = g_string_new ("");
+
+	for (ii = 0; ii < folded->len; ii++) {
+		const gchar *word = g_ptr_array_index (folded, ii);
+
+		/* Skip duplicates, which can be there after the case folding */
+		if (ii > 0 && g_strcmp0 (word, g_ptr_array_index (folded, ii - 1)) == 0)
+			continue;
+
+		if (key->len)
+			g_string_append_c (key, '\n');
+
+		g_string_append (key, word);
+	}
+
+	g_ptr_array_free (folded, TRUE);
+
+	return g_string_free (key, FALSE);
+}
+
+/* Returns a copy of the remembered result for the 'words_key' in the folder,
+   or NULL, when there is none or the folder changed since it was stored */
+static GPtrArray *
+ews_search_lookup_results (CamelEwsSearch *ews_search,
+			   const gchar *folder_id,
+			   const gchar *sync_state,
+			   const gchar *words_key)
+{
+	EwsSearchResults *results;
+	GPtrArray *uids = NULL;
+
+	g_mutex_lock (&ews_search->priv->results_lock);
+
+	results = g_hash_table_lookup (ews_search->priv->results, folder_id);
+
+	if (results && g_strcmp0 (results->sync_state, sync_state) == 0) {
+		GPtrArray *found;
+
+		found = g_hash_table_lookup (results->found, words_key);
+		if (found)
+			uids = ews_search_copy_uids (found);
+	}
+
+	g_mutex_unlock (&ews_search->priv->results_lock);
+
+	return uids;
+}
+
+static void
+ews_search_store_results (CamelEwsSearch *ews_search,
+			  const gchar *folder_id,
+			  const gchar *sync_state,
+			  const gchar *words_key,
+			  const GPtrArray *uids)
+{
+	EwsSearchResults *results;
+
+	g_mutex_lock (&ews_search->priv->results_lock);
+
+	results = g_hash_table_lookup (ews_search->priv->results, folder_id);
+
+	/* The folder changed, thus all the older results are out of date */
+	if (results && g_strcmp0 (results->sync_state, sync_state) != 0) {
+		g_hash_table_remove (ews_search->priv->results, folder_id);
+		results = NULL;
+	}
+
+	if (!results) {
+		results = g_new0 (EwsSearchResults, 1);
+		results->sync_state = g_strdup (sync_state);
+		results->found = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ews_search_uids_free);
+
+		g_hash_table_insert (ews_search->priv->results, g_strdup (folder_id), results);
+	}
+
+	if (g_hash_table_size (results->found) >= EWS_SEARCH_MAX_RESULTS)
+		g_hash_table_remove_all (results->found);
+
+	g_hash_table_insert (results->found, g_strdup (words_key), ews_search_copy_uids (uids));
+
+	g_mutex_unlock (&ews_search->priv->results_lock);
+}
+
 static void
 ews_search_set_property (GObject *object,
 			 guint property_id,
@@ -103,6 +260,8 @@ ews_search_finalize (GObject *object)
 	priv = CAMEL_EWS_SEARCH_GET_PRIVATE (object);
 
 	g_weak_ref_clear (&priv->ews_store);
+	g_hash_table_destroy (priv->results);
+	g_mutex_clear (&priv->results_lock);
 
 	/* Chain up to parent's finalize() method. */
 	G_OBJECT_CLASS (camel_ews_search_parent_class)->finalize (object);
@@ -203,6 +362,8 @@ ews_search_process_criteria (CamelSExp *sexp,
 	if (ews_folder != NULL) {
 		EEwsConnection *connection = NULL;
 		gchar *folder_id = NULL;
+		gchar *sync_state = NULL;
+		gchar *words_key = NULL;
 		gboolean can_search;
 
 		/* there should always be one, held by one of the callers of this function */
@@ -217,6 +378,23 @@ ews_search_process_criteria (CamelSExp *sexp,
 				can_search = FALSE;
 		}
 
+		if (can_search) {
+			CamelFolderSummary *folder_summary;
+
+			/* The folder content did not change since the same search
+			   had been done, thus the server returns the same result */
+			folder_summary = camel_folder_get_folder_summary (CAMEL_FOLDER (ews_folder));
+			if (CAMEL_IS_EWS_SUMMARY (folder_summary))
+				sync_state = camel_ews_summary_dup_sync_state (CAMEL_EWS_SUMMARY (folder_summary));
+
+			if (sync_state && *sync_state) {
+				words_key = ews_search_words_to_key (words);
+				uids = ews_search_lookup_results (ews_search, folder_id, sync_state, words_key);
+				if (uids)
+					can_search = FALSE;
+			}
+		}
+
 		if (can_search) {
 			connection = camel_ews_store_ref_connection (ews_store);
 			if (!connection)
@@ -254,12 +432,19 @@ ews_search_process_criteria (CamelSExp *sexp,
 
 			if (e_ews_connection_find_folder_items_sync (
 				connection, EWS_PRIORITY_MEDIUM,
-				fid, "IdOnly", NULL, NULL, expression->str, NULL,
+				fid, "IdOnly", NULL, NULL, 0, expression->str, NULL,
 				E_EWS_FOLDER_TYPE_MAILBOX, &includes_last_item, &found_items,
 				e_ews_query_to_restriction,
 				ews_search->priv->cancellable, &local_error)) {
 
 				uids = ews_search_items_to_ptr_array (found_items);
+
+				if (!uids)
+					uids = g_ptr_array_new ();
+
+				/* Do not remember partial results */
+				if (words_key && includes_last_item)
+					ews_search_store_results (ews_search, folder_id, sync_state, words_key, uids);
 			}
 
 			g_slist_free_full (found_items, g_object_unref);
@@ -269,6 +454,8 @@ ews_search_process_criteria (CamelSExp *sexp,
 
 		g_clear_object (&connection);
 		g_free (folder_id);
+		g_free (sync_state);
+		g_free (words_key);
 	}
 
 	/* Sanity check. */
@@ -347,6 +534,40 @@ ews_search_gather_words (CamelSExpResult **argv,
 	return ptrs;
 }
 
+/* Returns the folder's body index, when it contains all the searched messages */
+static CamelIndex *
+ews_search_ref_body_index (CamelFolderSearch *search)
+{
+	CamelFolder *folder;
+	CamelMessageInfo *info;
+	CamelIndex *body_index = NULL;
+
+	folder = camel_folder_search_get_folder (search);
+	if (!CAMEL_IS_EWS_FOLDER (folder))
+		return NULL;
+
+	info = camel_folder_search_get_current_message_info (search);
+
+	if (info) {
+		GPtrArray *uids;
+
+		uids = g_ptr_array_new ();
+		g_ptr_array_add (uids, (gpointer) camel_message_info_get_uid (info));
+
+		body_index = camel_ews_folder_ref_body_index (CAMEL_EWS_FOLDER (folder), uids);
+
+		g_ptr_array_free (uids, TRUE);
+	} else {
+		GPtrArray *summary;
+
+		summary = camel_folder_search_get_summary (search);
+		if (summary)
+			body_index = camel_ews_folder_ref_body_index (CAMEL_EWS_FOLDER (folder), summary);
+	}
+
+	return body_index;
+}
+
 static CamelSExpResult *
 ews_search_body_contains (CamelSExp *sexp,
 			  gint argc,
@@ -355,6 +576,7 @@ ews_search_body_contains (CamelSExp *sexp,
 {
 	CamelEwsSearch *ews_search = CAMEL_EWS_SEARCH (search);
 	CamelEwsStore *ews_store;
+	CamelIndex *body_index;
 	CamelSExpResult *result;
 	GPtrArray *words;
 
@@ -374,11 +596,23 @@ ews_search_body_contains (CamelSExp *sexp,
 
 	ews_store = camel_ews_search_ref_store (CAMEL_EWS_SEARCH (search));
 
-	/* This will be NULL if we're offline. Search from cache. */
-	if (!ews_store) {
+	body_index = ews_search_ref_body_index (search);
+
+	/* The store will be NULL if we're offline. Search from cache,
+	   or from the local index, when all the messages are in it. */
+	if (!ews_store || body_index) {
+		camel_folder_search_set_body_index (search, body_index);
+
 		/* Chain up to parent's method. */
-		return CAMEL_FOLDER_SEARCH_CLASS (camel_ews_search_parent_class)->
+		result = CAMEL_FOLDER_SEARCH_CLASS (camel_ews_search_parent_class)->
 			body_contains (sexp, argc, argv, search);
+
+		camel_folder_search_set_body_index (search, NULL);
+
+		g_clear_object (&body_index);
+		g_clear_object (&ews_store);
+
+		return result;
 	}
 
 	words = ews_search_gather_words (argv, 0, argc);
@@ -425,8 +659,10 @@ camel_ews_search_init (CamelEwsSearch *search)
 {
 	search->priv = CAMEL_EWS_SEARCH_GET_PRIVATE (search);
 	search->priv->local_data_search = NULL;
+	search->priv->results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ews_search_results_free);
 
 	g_weak_ref_init (&search->priv->ews_store, NULL);
+	g_mutex_init (&search->priv->results_lock);
 }
 
 /**
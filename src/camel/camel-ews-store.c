@@ -43,6 +43,7 @@
 #include "server/e-ews-message.h"
 #include "server/e-ews-oof-settings.h"
 
+#include "camel-ews-cache-budget.h"
 #include "camel-ews-folder.h"
 #include "camel-ews-store.h"
 #include "camel-ews-summary.h"
@@ -84,6 +85,10 @@ struct _CamelEwsStorePrivate {
 	GRecMutex update_lock;
 
 	GSList *public_folders; /* EEwsFolder * objects */
+
+	CamelEwsCacheBudget *cache_budget;
+	volatile gint cache_eviction_scheduled;
+	gboolean cache_pins_loaded; /* only in the eviction job */
 };
 
 static gboolean	ews_store_construct	(CamelService *service, CamelSession *session,
@@ -345,6 +350,11 @@ ews_store_construct (CamelService *service,
 	camel_ews_store_summary_load (ews_store->summary, NULL);
 
 	g_free (summary_file);
+
+	summary_file = g_build_filename (ews_store->storage_path, "message-cache-budget", NULL);
+	ews_store->priv->cache_budget = camel_ews_cache_budget_new (summary_file);
+	g_free (summary_file);
+
 	return TRUE;
 }
 
@@ -910,8 +920,13 @@ get_folder_names_to_update (gpointer key,
 	gchar *folder_name;
 
 	folder_name = camel_ews_store_summary_get_folder_full_name (ews_store->summary, folder_id, NULL);
-	if (folder_name != NULL)
-		ews_store->priv->update_folder_names = g_slist_prepend (ews_store->priv->update_folder_names, folder_name);
+	if (folder_name != NULL) {
+		/* Refresh each folder only once, even when it was scheduled multiple times */
+		if (g_slist_find_custom (ews_store->priv->update_folder_names, folder_name, (GCompareFunc) g_strcmp0))
+			g_free (folder_name);
+		else
+			ews_store->priv->update_folder_names = g_slist_prepend (ews_store->priv->update_folder_names, folder_name);
+	}
 }
 
 static void
@@ -953,6 +968,37 @@ exit:
 	UPDATE_UNLOCK (ews_store);
 }
 
+/* Refreshes the folder with the 'folder_id' in a dedicated thread a moment later,
+   together with any other folder scheduled meanwhile; returns FALSE, when the store
+   is not connected and the refresh cannot be scheduled */
+gboolean
+camel_ews_store_schedule_folder_refresh (CamelEwsStore *ews_store,
+					 const gchar *folder_id)
+{
+	GHashTable *folder_ids;
+	gboolean scheduled;
+
+	g_return_val_if_fail (CAMEL_IS_EWS_STORE (ews_store), FALSE);
+	g_return_val_if_fail (folder_id != NULL, FALSE);
+
+	UPDATE_LOCK (ews_store);
+
+	scheduled = ews_store->priv->updates_cancellable != NULL;
+
+	if (scheduled) {
+		folder_ids = g_hash_table_new (g_str_hash, g_str_equal);
+		g_hash_table_insert (folder_ids, (gpointer) folder_id, GINT_TO_POINTER (1));
+
+		schedule_folder_update (ews_store, folder_ids);
+
+		g_hash_table_destroy (folder_ids);
+	}
+
+	UPDATE_UNLOCK (ews_store);
+
+	return scheduled;
+}
+
 static gboolean
 folder_list_update_cb (gpointer user_data)
 {
@@ -3714,6 +3760,187 @@ camel_ews_store_unset_oof_settings_state (CamelEwsStore *ews_store)
 	g_object_unref (session);
 }
 
+static guint64
+ews_store_get_message_cache_limit (CamelEwsStore *ews_store)
+{
+	CamelSettings *settings;
+	guint64 limit;
+
+	settings = camel_service_ref_settings (CAMEL_SERVICE (ews_store));
+	limit = camel_ews_settings_get_message_cache_size (CAMEL_EWS_SETTINGS (settings));
+	g_object_unref (settings);
+
+	return limit * 1024 * 1024;
+}
+
+static void
+ews_store_evict_cached_message_cb (const gchar *folder_name,
+				   const gchar *key,
+				   gpointer user_data)
+{
+	CamelEwsStore *ews_store = user_data;
+	CamelObjectBag *folders_bag;
+	CamelFolder *folder;
+
+	folders_bag = camel_store_get_folders_bag (CAMEL_STORE (ews_store));
+	folder = camel_object_bag_peek (folders_bag, folder_name);
+
+	if (folder) {
+		camel_ews_folder_evict_cached_message (CAMEL_EWS_FOLDER (folder), key);
+		g_object_unref (folder);
+	} else {
+		gchar *folder_dir;
+
+		folder_dir = g_build_filename (ews_store->storage_path, "folders", folder_name, NULL);
+
+		/* The folder could be renamed or deleted meanwhile */
+		if (g_file_test (folder_dir, G_FILE_TEST_IS_DIR)) {
+			CamelDataCache *cache;
+
+			cache = camel_data_cache_new (folder_dir, NULL);
+			if (cache) {
+				camel_data_cache_remove (cache, "cur", key, NULL);
+				g_object_unref (cache);
+			}
+		}
+
+		g_free (folder_dir);
+	}
+}
+
+static void
+ews_store_evict_cached_messages_thread (CamelSession *session,
+					GCancellable *cancellable,
+					gpointer user_data,
+					GError **error)
+{
+	CamelEwsStore *ews_store = user_data;
+	CamelEwsCacheBudget *budget = ews_store->priv->cache_budget;
+	CamelSettings *settings;
+	gboolean stay_synchronized;
+
+	settings = camel_service_ref_settings (CAMEL_SERVICE (ews_store));
+	stay_synchronized = camel_offline_settings_get_stay_synchronized (CAMEL_OFFLINE_SETTINGS (settings));
+	g_object_unref (settings);
+
+	/* All messages are meant to be available offline */
+	if (!stay_synchronized) {
+		/* Only the opened folders pin their messages, thus check the offline
+		   synchronization state of all of them before anything is evicted;
+		   the folders pin themselves when they are opened */
+		if (!ews_store->priv->cache_pins_loaded) {
+			GPtrArray *folders;
+
+			folders = camel_offline_store_dup_downsync_folders (CAMEL_OFFLINE_STORE (ews_store));
+			if (folders) {
+				guint ii;
+
+				for (ii = 0; ii < folders->len; ii++) {
+					CamelFolder *folder = g_ptr_array_index (folders, ii);
+
+					camel_ews_cache_budget_set_folder_pinned (budget, camel_folder_get_full_name (folder), TRUE);
+				}
+
+				g_ptr_array_unref (folders);
+			}
+
+			if (g_cancellable_is_cancelled (cancellable)) {
+				g_atomic_int_set (&ews_store->priv->cache_eviction_scheduled, 0);
+				return;
+			}
+
+			ews_store->priv->cache_pins_loaded = TRUE;
+		}
+
+		/* Messages cached before the limit had been set, or by an older version */
+		if (!camel_ews_cache_budget_get_seeded (budget)) {
+			gchar *folders_dir;
+
+			folders_dir = g_build_filename (ews_store->storage_path, "folders", NULL);
+			camel_ews_cache_budget_seed_from_dir (budget, folders_dir);
+			g_free (folders_dir);
+		}
+
+		camel_ews_cache_budget_set_limit (budget, ews_store_get_message_cache_limit (ews_store));
+		camel_ews_cache_budget_evict (budget, ews_store_evict_cached_message_cb, ews_store);
+	}
+
+	camel_ews_cache_budget_save (budget, error);
+
+	g_atomic_int_set (&ews_store->priv->cache_eviction_scheduled, 0);
+}
+
+/* Records an access to the message 'key', with the current 'size', in the cache
+   of the folder 'folder_name'; the least recently used messages are removed
+   in a background job when the cache grows over its limit. */
+void
+camel_ews_store_touch_cached_message (CamelEwsStore *ews_store,
+				      const gchar *folder_name,
+				      const gchar *key,
+				      guint64 size)
+{
+	CamelEwsCacheBudget *budget;
+	guint64 limit;
+	gboolean over_limit;
+
+	g_return_if_fail (CAMEL_IS_EWS_STORE (ews_store));
+	g_return_if_fail (folder_name != NULL);
+	g_return_if_fail (key != NULL);
+
+	budget = ews_store->priv->cache_budget;
+	if (!budget)
+		return;
+
+	limit = ews_store_get_message_cache_limit (ews_store);
+
+	camel_ews_cache_budget_set_limit (budget, limit);
+	over_limit = camel_ews_cache_budget_touch (budget, folder_name, key, size);
+
+	if ((over_limit || (limit > 0 && !camel_ews_cache_budget_get_seeded (budget))) &&
+	    g_atomic_int_compare_and_exchange (&ews_store->priv->cache_eviction_scheduled, 0, 1)) {
+		CamelSession *session;
+
+		session = camel_service_ref_session (CAMEL_SERVICE (ews_store));
+		if (session) {
+			camel_session_submit_job (
+				session, _("Freeing space in the message cache"),
+				ews_store_evict_cached_messages_thread,
+				g_object_ref (ews_store),
+				g_object_unref);
+
+			g_object_unref (session);
+		} else {
+			g_atomic_int_set (&ews_store->priv->cache_eviction_scheduled, 0);
+		}
+	}
+}
+
+void
+camel_ews_store_forget_cached_message (CamelEwsStore *ews_store,
+				       const gchar *folder_name,
+				       const gchar *key)
+{
+	g_return_if_fail (CAMEL_IS_EWS_STORE (ews_store));
+	g_return_if_fail (folder_name != NULL);
+	g_return_if_fail (key != NULL);
+
+	if (ews_store->priv->cache_budget)
+		camel_ews_cache_budget_remove (ews_store->priv->cache_budget, folder_name, key);
+}
+
+/* Cached messages of the pinned folders are never removed due to the cache size limit */
+void
+camel_ews_store_set_folder_cache_pinned (CamelEwsStore *ews_store,
+					 const gchar *folder_name,
+					 gboolean pinned)
+{
+	g_return_if_fail (CAMEL_IS_EWS_STORE (ews_store));
+	g_return_if_fail (folder_name != NULL);
+
+	if (ews_store->priv->cache_budget)
+		camel_ews_cache_budget_set_folder_pinned (ews_store->priv->cache_budget, folder_name, pinned);
+}
+
 static void
 ews_store_dispose (GObject *object)
 {
@@ -3743,6 +3970,12 @@ ews_store_dispose (GObject *object)
 	g_slist_free_full (ews_store->priv->public_folders, g_object_unref);
 	ews_store->priv->public_folders = NULL;
 
+	if (ews_store->priv->cache_budget) {
+		camel_ews_cache_budget_save (ews_store->priv->cache_budget, NULL);
+		camel_ews_cache_budget_free (ews_store->priv->cache_budget);
+		ews_store->priv->cache_budget = NULL;
+	}
+
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (camel_ews_store_parent_class)->dispose (object);
 }
@@ -88,6 +88,9 @@ void		camel_ews_store_maybe_disconnect
 						 const GError *error);
 void		camel_ews_store_ensure_virtual_folders
 						(CamelEwsStore *ews_store);
+gboolean	camel_ews_store_schedule_folder_refresh
+						(CamelEwsStore *ews_store,
+						 const gchar *folder_id);
 void		camel_ews_store_ensure_unique_path
 						(CamelEwsStore *ews_store,
 						 gchar **ppath);
@@ -107,6 +110,19 @@ CamelEwsStoreOooAlertState
 						(const CamelEwsStore *ews_store);
 void		camel_ews_store_unset_oof_settings_state
 						(CamelEwsStore *ews_store);
+void		camel_ews_store_touch_cached_message
+						(CamelEwsStore *ews_store,
+						 const gchar *folder_name,
+						 const gchar *key,
+						 guint64 size);
+void		camel_ews_store_forget_cached_message
+						(CamelEwsStore *ews_store,
+						 const gchar *folder_name,
+						 const gchar *key);
+void		camel_ews_store_set_folder_cache_pinned
+						(CamelEwsStore *ews_store,
+						 const gchar *folder_name,
+						 gboolean pinned);
 
 
 G_END_DECLS
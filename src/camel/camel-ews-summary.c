@@ -192,6 +192,9 @@ camel_ews_summary_add_message (CamelFolderSummary *summary,
 
 	camel_ews_message_info_set_change_key (CAMEL_EWS_MESSAGE_INFO (mi), change_key);
 	camel_message_info_set_flags (mi, ~0, camel_message_info_get_flags (info));
+	/* Moved/copied items keep the server state of the original */
+	if (CAMEL_IS_EWS_MESSAGE_INFO (info))
+		camel_ews_message_info_set_server_flags (CAMEL_EWS_MESSAGE_INFO (mi), camel_ews_message_info_get_server_flags (CAMEL_EWS_MESSAGE_INFO (info)));
 	camel_message_info_take_user_flags (mi, camel_message_info_dup_user_flags (info));
 	camel_message_info_take_user_tags (mi, camel_message_info_dup_user_tags (info));
 	camel_message_info_set_size (mi, camel_message_info_get_size (info));
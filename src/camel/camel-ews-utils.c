@@ -648,17 +648,19 @@ ews_utils_get_server_flags (EEwsItem *item)
 	return server_flags;
 }
 
+/* Uses only the already known SMTP addresses for the EX addresses, the rest
+   is resolved in the background, which then updates the message info */
 static gchar *
-form_email_string_from_mb (EEwsConnection *cnc,
-                           const EwsMailbox *mb,
-                           GCancellable *cancellable)
+form_email_string_from_mb (CamelEwsFolder *ews_folder,
+			   EEwsConnection *cnc,
+			   const gchar *uid,
+			   const EwsMailbox *mb)
 {
 	if (mb) {
 		GString *str;
-		const gchar *email = NULL;
+		gchar *email;
 
-		if (g_strcmp0 (mb->routing_type, "EX") == 0)
-			email = e_ews_item_util_strip_ex_address (mb->email);
+		email = camel_ews_folder_dup_mailbox_email (ews_folder, cnc, uid, mb);
 
 		str = g_string_new ("");
 		if (mb->name && mb->name[0]) {
@@ -666,21 +668,24 @@ form_email_string_from_mb (EEwsConnection *cnc,
 			g_string_append (str, " ");
 		}
 
-		if (mb->email || email) {
+		if (email) {
 			g_string_append (str, "<");
-			g_string_append (str, email ? email : mb->email);
+			g_string_append (str, email);
 			g_string_append (str, ">");
 		}
 
+		g_free (email);
+
 		return g_string_free (str, FALSE);
 	} else
 		return NULL;
 }
 
 static gchar *
-form_recipient_list (EEwsConnection *cnc,
-                     const GSList *recipients,
-                     GCancellable *cancellable)
+form_recipient_list (CamelEwsFolder *ews_folder,
+		     EEwsConnection *cnc,
+		     const gchar *uid,
+                     const GSList *recipients)
 {
 	const GSList *l;
 	GString *str = NULL;
@@ -690,7 +695,7 @@ form_recipient_list (EEwsConnection *cnc,
 
 	for (l = recipients; l != NULL; l = g_slist_next (l)) {
 		EwsMailbox *mb = (EwsMailbox *) l->data;
-		gchar *mb_str = form_email_string_from_mb (cnc, mb, cancellable);
+		gchar *mb_str = form_email_string_from_mb (ews_folder, cnc, uid, mb);
 
 		if (!str)
 			str = g_string_new ("");
@@ -1020,6 +1025,8 @@ camel_ews_utils_sync_updated_items (CamelEwsFolder *ews_folder,
 	}
 
 	g_slist_free (items_updated);
+
+	camel_ews_folder_schedule_ex_resolve (ews_folder);
 }
 
 CamelMessageInfo * /* (transfer full) */
@@ -1101,15 +1108,15 @@ camel_ews_utils_item_to_message_info (CamelEwsFolder *ews_folder,
 	from = e_ews_item_get_from (item);
 	if (!from)
 		from = e_ews_item_get_sender (item);
-	tmp = form_email_string_from_mb (cnc, from, cancellable);
+	tmp = form_email_string_from_mb (ews_folder, cnc, id->id, from);
 	camel_message_info_set_from (mi, tmp);
 	g_free (tmp);
 
-	tmp = form_recipient_list (cnc, e_ews_item_get_to_recipients (item), cancellable);
+	tmp = form_recipient_list (ews_folder, cnc, id->id, e_ews_item_get_to_recipients (item));
 	camel_message_info_set_to (mi, tmp);
 	g_free (tmp);
 
-	tmp = form_recipient_list (cnc, e_ews_item_get_cc_recipients (item), cancellable);
+	tmp = form_recipient_list (ews_folder, cnc, id->id, e_ews_item_get_cc_recipients (item));
 	camel_message_info_set_cc (mi, tmp);
 	g_free (tmp);
 
@@ -1215,6 +1222,8 @@ camel_ews_utils_sync_created_items (CamelEwsFolder *ews_folder,
 	}
 
 	g_slist_free (items_created);
+
+	camel_ews_folder_schedule_ex_resolve (ews_folder);
 }
 
 gchar *
@@ -1734,3 +1743,75 @@ camel_ews_utils_merge_category_list (CamelEwsStore *ews_store,
 		xmlXPathFreeContext (xpath_ctx);
 	xmlFreeDoc (doc);
 }
+
+/* The messages are stored in the folders' caches compressed with gzip;
+   the base64 encoded attachments and the headers compress well. Those
+   stored by older versions are not compressed, which is recognized by
+   the missing gzip magic bytes at the beginning of the file. */
+#define CACHE_GZIP_MAGIC_1 0x1f
+#define CACHE_GZIP_MAGIC_2 0x8b
+
+/* Returns a new stream, which compresses the message written to it into
+   the 'base_stream'; close it to write the remaining data, the 'base_stream'
+   is left open */
+GOutputStream *
+camel_ews_utils_new_cache_output_stream (GOutputStream *base_stream)
+{
+	GZlibCompressor *compressor;
+	GOutputStream *output_stream;
+
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (base_stream), NULL);
+
+	compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+	output_stream = g_converter_output_stream_new (base_stream, G_CONVERTER (compressor));
+	g_filter_output_stream_set_close_base_stream (G_FILTER_OUTPUT_STREAM (output_stream), FALSE);
+	g_object_unref (compressor);
+
+	return output_stream;
+}
+
+/* Returns a stream to read the cached message from the 'base_stream',
+   decompressing it on the fly, or as it is, when stored uncompressed */
+GInputStream *
+camel_ews_utils_ref_cache_input_stream (GInputStream *base_stream,
+					GCancellable *cancellable,
+					GError **error)
+{
+	GBufferedInputStream *buffered_stream;
+	const guchar *magic;
+	gsize len = 0;
+
+	g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+
+	buffered_stream = G_BUFFERED_INPUT_STREAM (g_buffered_input_stream_new (base_stream));
+	g_filter_input_stream_set_close_base_stream (G_FILTER_INPUT_STREAM (buffered_stream), FALSE);
+
+	while (g_buffered_input_stream_get_available (buffered_stream) < 2) {
+		gssize n_read;
+
+		n_read = g_buffered_input_stream_fill (buffered_stream, -1, cancellable, error);
+		if (n_read < 0) {
+			g_object_unref (buffered_stream);
+			return NULL;
+		}
+
+		if (!n_read)
+			break;
+	}
+
+	magic = g_buffered_input_stream_peek_buffer (buffered_stream, &len);
+
+	if (len >= 2 && magic[0] == CACHE_GZIP_MAGIC_1 && magic[1] == CACHE_GZIP_MAGIC_2) {
+		GZlibDecompressor *decompressor;
+		GInputStream *input_stream;
+
+		decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+		input_stream = g_converter_input_stream_new (G_INPUT_STREAM (buffered_stream), G_CONVERTER (decompressor));
+		g_object_unref (decompressor);
+		g_object_unref (buffered_stream);
+
+		return input_stream;
+	}
+
+	return G_INPUT_STREAM (buffered_stream);
+}
@@ -104,6 +104,12 @@ void		camel_ews_utils_merge_category_list
 						(CamelEwsStore *ews_store,
 						 const guchar *xml_data,
 						 gsize xml_data_len);
+GOutputStream *	camel_ews_utils_new_cache_output_stream
+						(GOutputStream *base_stream);
+GInputStream *	camel_ews_utils_ref_cache_input_stream
+						(GInputStream *base_stream,
+						 GCancellable *cancellable,
+						 GError **error);
 
 G_END_DECLS
 
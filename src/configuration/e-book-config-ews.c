@@ -122,6 +122,19 @@ book_config_ews_insert_widgets (ESourceConfigBackend *backend,
 			G_BINDING_DEFAULT);
 
 		e_source_config_insert_widget (e_source_config_backend_get_config (backend), scratch_source, NULL, checkbox);
+
+		checkbox = gtk_check_button_new_with_mnemonic (_("_Decode offline contacts on demand"));
+		gtk_widget_set_tooltip_text (checkbox, _("When checked, the offline Global Address List keeps only a compact index and the contacts are decoded when searched for, which saves disk space and speeds up the synchronization of large address lists"));
+		gtk_widget_show (checkbox);
+
+		gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (checkbox), e_source_ews_folder_get_gal_lazy_contacts (ews_folder));
+
+		e_binding_bind_property (
+			checkbox, "active",
+			ews_folder, "gal-lazy-contacts",
+			G_BINDING_DEFAULT);
+
+		e_source_config_insert_widget (e_source_config_backend_get_config (backend), scratch_source, NULL, checkbox);
 	}
 }
 
@@ -40,6 +40,9 @@ struct _CamelEwsSettingsPrivate {
 	gchar *oaburl;
 	gchar *oal_selected;
 	guint timeout;
+	guint first_sync_newest;
+	guint attachments_on_demand_size;
+	guint message_cache_size;
 	gchar *impersonate_user;
 	gboolean override_user_agent;
 	gchar *user_agent;
@@ -66,6 +69,9 @@ enum {
 	PROP_PORT,
 	PROP_SECURITY_METHOD,
 	PROP_TIMEOUT,
+	PROP_FIRST_SYNC_NEWEST,
+	PROP_ATTACHMENTS_ON_DEMAND_SIZE,
+	PROP_MESSAGE_CACHE_SIZE,
 	PROP_USER,
 	PROP_USE_IMPERSONATION,
 	PROP_IMPERSONATE_USER,
@@ -210,6 +216,24 @@ ews_settings_set_property (GObject *object,
 				g_value_get_uint (value));
 			return;
 
+		case PROP_FIRST_SYNC_NEWEST:
+			camel_ews_settings_set_first_sync_newest (
+				CAMEL_EWS_SETTINGS (object),
+				g_value_get_uint (value));
+			return;
+
+		case PROP_ATTACHMENTS_ON_DEMAND_SIZE:
+			camel_ews_settings_set_attachments_on_demand_size (
+				CAMEL_EWS_SETTINGS (object),
+				g_value_get_uint (value));
+			return;
+
+		case PROP_MESSAGE_CACHE_SIZE:
+			camel_ews_settings_set_message_cache_size (
+				CAMEL_EWS_SETTINGS (object),
+				g_value_get_uint (value));
+			return;
+
 		case PROP_USER:
 			camel_network_settings_set_user (
 				CAMEL_NETWORK_SETTINGS (object),
@@ -380,6 +404,27 @@ ews_settings_get_property (GObject *object,
 				CAMEL_EWS_SETTINGS (object)));
 			return;
 
+		case PROP_FIRST_SYNC_NEWEST:
+			g_value_set_uint (
+				value,
+				camel_ews_settings_get_first_sync_newest (
+				CAMEL_EWS_SETTINGS (object)));
+			return;
+
+		case PROP_ATTACHMENTS_ON_DEMAND_SIZE:
+			g_value_set_uint (
+				value,
+				camel_ews_settings_get_attachments_on_demand_size (
+				CAMEL_EWS_SETTINGS (object)));
+			return;
+
+		case PROP_MESSAGE_CACHE_SIZE:
+			g_value_set_uint (
+				value,
+				camel_ews_settings_get_message_cache_size (
+				CAMEL_EWS_SETTINGS (object)));
+			return;
+
 		case PROP_USER:
 			g_value_take_string (
 				value,
@@ -633,6 +678,42 @@ camel_ews_settings_class_init (CamelEwsSettingsClass *class)
 			G_PARAM_CONSTRUCT |
 			G_PARAM_STATIC_STRINGS));
 
+	g_object_class_install_property (
+		object_class,
+		PROP_FIRST_SYNC_NEWEST,
+		g_param_spec_uint (
+			"first-sync-newest",
+			"First Sync Newest",
+			"How many of the newest messages to show first, when a folder is synchronized for the first time; 0 to not do it",
+			0, G_MAXUINT, 200,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT |
+			G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_ATTACHMENTS_ON_DEMAND_SIZE,
+		g_param_spec_uint (
+			"attachments-on-demand-size",
+			"Attachments On Demand Size",
+			"Messages of this size in kilobytes or larger are downloaded without their attachments, which are downloaded when opened or saved; 0 to always download whole messages",
+			0, G_MAXUINT, 0,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT |
+			G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_MESSAGE_CACHE_SIZE,
+		g_param_spec_uint (
+			"message-cache-size",
+			"Message Cache Size",
+			"Size limit in megabytes of the cached messages of all folders, the least recently used are removed above it, except of those in folders synchronized for offline use; 0 for no limit",
+			0, G_MAXUINT, 0,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT |
+			G_PARAM_STATIC_STRINGS));
+
 	/* Inherited from CamelNetworkSettings. */
 	g_object_class_override_property (
 		object_class,
@@ -1243,6 +1324,72 @@ camel_ews_settings_set_timeout (CamelEwsSettings *settings,
 	g_object_notify (G_OBJECT (settings), "timeout");
 }
 
+guint
+camel_ews_settings_get_first_sync_newest (CamelEwsSettings *settings)
+{
+	g_return_val_if_fail (CAMEL_IS_EWS_SETTINGS (settings), 0);
+
+	return settings->priv->first_sync_newest;
+}
+
+void
+camel_ews_settings_set_first_sync_newest (CamelEwsSettings *settings,
+					  guint first_sync_newest)
+{
+	g_return_if_fail (CAMEL_IS_EWS_SETTINGS (settings));
+
+	if (settings->priv->first_sync_newest == first_sync_newest)
+		return;
+
+	settings->priv->first_sync_newest = first_sync_newest;
+
+	g_object_notify (G_OBJECT (settings), "first-sync-newest");
+}
+
+guint
+camel_ews_settings_get_attachments_on_demand_size (CamelEwsSettings *settings)
+{
+	g_return_val_if_fail (CAMEL_IS_EWS_SETTINGS (settings), 0);
+
+	return settings->priv->attachments_on_demand_size;
+}
+
+void
+camel_ews_settings_set_attachments_on_demand_size (CamelEwsSettings *settings,
+						   guint attachments_on_demand_size)
+{
+	g_return_if_fail (CAMEL_IS_EWS_SETTINGS (settings));
+
+	if (settings->priv->attachments_on_demand_size == attachments_on_demand_size)
+		return;
+
+	settings->priv->attachments_on_demand_size = attachments_on_demand_size;
+
+	g_object_notify (G_OBJECT (settings), "attachments-on-demand-size");
+}
+
+guint
+camel_ews_settings_get_message_cache_size (CamelEwsSettings *settings)
+{
+	g_return_val_if_fail (CAMEL_IS_EWS_SETTINGS (settings), 0);
+
+	return settings->priv->message_cache_size;
+}
+
+void
+camel_ews_settings_set_message_cache_size (CamelEwsSettings *settings,
+					   guint message_cache_size)
+{
+	g_return_if_fail (CAMEL_IS_EWS_SETTINGS (settings));
+
+	if (settings->priv->message_cache_size == message_cache_size)
+		return;
+
+	settings->priv->message_cache_size = message_cache_size;
+
+	g_object_notify (G_OBJECT (settings), "message-cache-size");
+}
+
 gboolean
 camel_ews_settings_get_use_impersonation (CamelEwsSettings *settings)
 {
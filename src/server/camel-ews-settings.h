@@ -117,6 +117,21 @@ void		camel_ews_settings_set_oal_selected
 guint		camel_ews_settings_get_timeout	(CamelEwsSettings *settings);
 void		camel_ews_settings_set_timeout	(CamelEwsSettings *settings,
 						 guint timeout);
+guint		camel_ews_settings_get_first_sync_newest
+						(CamelEwsSettings *settings);
+void		camel_ews_settings_set_first_sync_newest
+						(CamelEwsSettings *settings,
+						 guint first_sync_newest);
+guint		camel_ews_settings_get_attachments_on_demand_size
+						(CamelEwsSettings *settings);
+void		camel_ews_settings_set_attachments_on_demand_size
+						(CamelEwsSettings *settings,
+						 guint attachments_on_demand_size);
+guint		camel_ews_settings_get_message_cache_size
+						(CamelEwsSettings *settings);
+void		camel_ews_settings_set_message_cache_size
+						(CamelEwsSettings *settings,
+						 guint message_cache_size);
 gboolean	camel_ews_settings_get_use_impersonation
 						(CamelEwsSettings *settings);
 void		camel_ews_settings_set_use_impersonation
@@ -553,3 +553,101 @@ e_ews_connection_utils_prepare_message (EEwsConnection *cnc,
 
 	return TRUE;
 }
+
+typedef struct _BatchRunner {
+	GSList *batches; /* gpointer, not started yet */
+	guint n_running;
+	EEwsBatchStartFunc start_func;
+	EEwsBatchDoneFunc done_func;
+	gpointer user_data;
+	GCancellable *cancellable;
+} BatchRunner;
+
+typedef struct _BatchCall {
+	BatchRunner *runner;
+	gpointer batch;
+} BatchCall;
+
+static void ews_connection_utils_start_batch (BatchRunner *runner);
+
+static void
+ews_connection_utils_batch_done_cb (GObject *source_object,
+				    GAsyncResult *result,
+				    gpointer user_data)
+{
+	BatchCall *call = user_data;
+	BatchRunner *runner = call->runner;
+
+	runner->done_func (source_object, result, call->batch, runner->user_data);
+
+	g_free (call);
+
+	runner->n_running--;
+
+	ews_connection_utils_start_batch (runner);
+}
+
+static void
+ews_connection_utils_start_batch (BatchRunner *runner)
+{
+	BatchCall *call;
+
+	if (!runner->batches || g_cancellable_is_cancelled (runner->cancellable))
+		return;
+
+	call = g_new0 (BatchCall, 1);
+	call->runner = runner;
+	call->batch = runner->batches->data;
+
+	runner->batches = g_slist_remove (runner->batches, call->batch);
+	runner->n_running++;
+
+	runner->start_func (call->batch, runner->user_data, runner->cancellable, ews_connection_utils_batch_done_cb, call);
+}
+
+/* Runs asynchronous requests for all the 'batches', at most 'max_running' of them
+   at the same time, and returns when all the started requests finished. The requests
+   finish in a private main context, thus the calling thread is not blocked by the main
+   thread and no other thread can interfere with the batches. No new batch is started
+   once the 'cancellable' is cancelled; the 'done_func' is not called for such batches.
+   The caller keeps the ownership of the 'batches' and their content. */
+void
+e_ews_connection_utils_run_batches_sync (GSList *batches, /* gpointer */
+					 guint max_running,
+					 EEwsBatchStartFunc start_func,
+					 EEwsBatchDoneFunc done_func,
+					 gpointer user_data,
+					 GCancellable *cancellable)
+{
+	BatchRunner runner;
+	GMainContext *main_context;
+	guint ii;
+
+	g_return_if_fail (max_running > 0);
+	g_return_if_fail (start_func != NULL);
+	g_return_if_fail (done_func != NULL);
+
+	if (!batches)
+		return;
+
+	runner.batches = g_slist_copy (batches);
+	runner.n_running = 0;
+	runner.start_func = start_func;
+	runner.done_func = done_func;
+	runner.user_data = user_data;
+	runner.cancellable = cancellable;
+
+	main_context = g_main_context_new ();
+	g_main_context_push_thread_default (main_context);
+
+	for (ii = 0; ii < max_running; ii++)
+		ews_connection_utils_start_batch (&runner);
+
+	while (runner.n_running > 0)
+		g_main_context_iteration (main_context, TRUE);
+
+	g_main_context_pop_thread_default (main_context);
+	g_main_context_unref (main_context);
+
+	g_slist_free (runner.batches);
+}
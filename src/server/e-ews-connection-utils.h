@@ -56,6 +56,26 @@ gboolean	e_ews_connection_utils_prepare_message	(EEwsConnection *cnc,
 							 SoupMessage *message,
 							 GCancellable *cancellable);
 
+/* Starts an asynchronous request for the 'batch'; the 'callback' with the 'callback_data'
+   is to be passed to the request as its GAsyncReadyCallback and its user data */
+typedef void	(* EEwsBatchStartFunc)			(gpointer batch,
+							 gpointer user_data,
+							 GCancellable *cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer callback_data);
+/* Finishes the request started for the 'batch' */
+typedef void	(* EEwsBatchDoneFunc)			(GObject *source_object,
+							 GAsyncResult *result,
+							 gpointer batch,
+							 gpointer user_data);
+
+void		e_ews_connection_utils_run_batches_sync	(GSList *batches, /* gpointer */
+							 guint max_running,
+							 EEwsBatchStartFunc start_func,
+							 EEwsBatchDoneFunc done_func,
+							 gpointer user_data,
+							 GCancellable *cancellable);
+
 G_END_DECLS
 
 #endif /* E_EWS_CONNECTION_UTILS_H */
@@ -116,6 +116,10 @@ struct _EEwsConnectionPrivate {
 	gboolean ssl_info_set;
 	gchar *ssl_certificate_pem;
 	GTlsCertificateFlags ssl_certificate_errors;
+
+	GMutex resolved_names_lock;
+	GHashTable *resolved_names; /* gchar *key ~> EwsResolvedName *; loaded on demand */
+	guint resolved_names_changes;
 };
 
 enum {
@@ -140,6 +144,7 @@ typedef struct _EwsNode EwsNode;
 typedef struct _EwsAsyncData EwsAsyncData;
 typedef struct _EwsEventsAsyncData EwsEventsAsyncData;
 typedef struct _EwsUrls EwsUrls;
+typedef struct _EwsResolvedName EwsResolvedName;
 
 struct _EwsAsyncData {
 	GSList *items_created;
@@ -157,6 +162,9 @@ struct _EwsAsyncData {
 	EEwsFolderType folder_type;
 	EEwsConnection *cnc;
 	gchar *custom_data; /* Can be re-used by operations, will be freed with g_free() */
+	GHashTable *attachment_uids; /* gchar *attachment id ~> gchar *comp uid */
+	GSList *folder_ids; /* gchar *, the requested folder ids, in the request order */
+	GHashTable *folder_errors; /* gchar *folder id ~> GError *, the folders which failed */
 };
 
 struct _EwsNode {
@@ -171,6 +179,20 @@ struct _EwsNode {
 	gulong cancel_handler_id;
 };
 
+/* How long, in seconds, a resolved name is reused and how long
+   a name, which could not be resolved, is not asked for again */
+#define EWS_RESOLVED_NAMES_TTL (7 * 24 * 60 * 60)
+#define EWS_RESOLVED_NAMES_NEGATIVE_TTL (15 * 60)
+
+/* The resolved names are saved after this many changes and when the connection is freed */
+#define EWS_RESOLVED_NAMES_SAVE_AFTER 20
+
+struct _EwsResolvedName {
+	gchar *name; /* can be NULL */
+	gchar *email; /* SMTP address; NULL, when the name could not be resolved */
+	gint64 expires; /* real time, in seconds */
+};
+
 struct _EwsUrls {
 	xmlChar *as_url;
 	xmlChar *oab_url;
@@ -202,6 +224,11 @@ static void
 async_data_free (EwsAsyncData *async_data)
 {
 	g_free (async_data->custom_data);
+	if (async_data->attachment_uids)
+		g_hash_table_unref (async_data->attachment_uids);
+	g_slist_free_full (async_data->folder_ids, g_free);
+	if (async_data->folder_errors)
+		g_hash_table_unref (async_data->folder_errors);
 	g_free (async_data);
 }
 
@@ -1967,6 +1994,238 @@ ews_connection_constructed (GObject *object)
 		camel_ews_settings_get_auth_mechanism (cnc->priv->settings));
 }
 
+static void
+ews_resolved_name_free (gpointer ptr)
+{
+	EwsResolvedName *rn = ptr;
+
+	if (rn) {
+		g_free (rn->name);
+		g_free (rn->email);
+		g_free (rn);
+	}
+}
+
+static gchar *
+ews_connection_dup_resolved_names_filename (EEwsConnection *cnc)
+{
+	gchar *checksum, *basename, *filename;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+		cnc->priv->hash_key ? cnc->priv->hash_key : cnc->priv->uri ? cnc->priv->uri : "", -1);
+	basename = g_strconcat (checksum, ".ini", NULL);
+	filename = g_build_filename (e_get_user_cache_dir (), "ews", "names", basename, NULL);
+
+	g_free (checksum);
+	g_free (basename);
+
+	return filename;
+}
+
+/* Reads the not expired names from the file, possibly written by another
+   process, keeping the newer result of the names known already.
+   The 'resolved_names_lock' should be held when calling this */
+static void
+ews_connection_resolved_names_merge_file_locked (EEwsConnection *cnc)
+{
+	GKeyFile *key_file;
+	gchar *filename;
+	gint64 now;
+
+	filename = ews_connection_dup_resolved_names_filename (cnc);
+	key_file = g_key_file_new ();
+	now = g_get_real_time () / G_USEC_PER_SEC;
+
+	if (g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL)) {
+		gchar **groups;
+		gint ii;
+
+		groups = g_key_file_get_groups (key_file, NULL);
+
+		for (ii = 0; groups && groups[ii]; ii++) {
+			EwsResolvedName *rn;
+			gchar *key;
+			gint64 expires;
+
+			expires = g_key_file_get_int64 (key_file, groups[ii], "Expires", NULL);
+			key = g_key_file_get_string (key_file, groups[ii], "Key", NULL);
+
+			if (!key || !*key || expires <= now) {
+				g_free (key);
+				continue;
+			}
+
+			rn = g_hash_table_lookup (cnc->priv->resolved_names, key);
+			if (rn && rn->expires >= expires) {
+				g_free (key);
+				continue;
+			}
+
+			rn = g_new0 (EwsResolvedName, 1);
+			rn->name = g_key_file_get_string (key_file, groups[ii], "Name", NULL);
+			rn->email = g_key_file_get_string (key_file, groups[ii], "Email", NULL);
+			rn->expires = expires;
+
+			g_hash_table_insert (cnc->priv->resolved_names, key, rn);
+		}
+
+		g_strfreev (groups);
+	}
+
+	g_key_file_free (key_file);
+	g_free (filename);
+}
+
+/* The 'resolved_names_lock' should be held when calling this */
+static void
+ews_connection_resolved_names_ensure_loaded_locked (EEwsConnection *cnc)
+{
+	if (cnc->priv->resolved_names)
+		return;
+
+	cnc->priv->resolved_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ews_resolved_name_free);
+	cnc->priv->resolved_names_changes = 0;
+
+	ews_connection_resolved_names_merge_file_locked (cnc);
+}
+
+/* The 'resolved_names_lock' should be held when calling this */
+static void
+ews_connection_resolved_names_save_locked (EEwsConnection *cnc)
+{
+	GKeyFile *key_file;
+	GHashTableIter iter;
+	gpointer key, value;
+	gchar *filename, *dirname;
+	gint64 now;
+
+	if (!cnc->priv->resolved_names || !cnc->priv->resolved_names_changes)
+		return;
+
+	/* Do not lose the names saved by other processes since the load */
+	ews_connection_resolved_names_merge_file_locked (cnc);
+
+	key_file = g_key_file_new ();
+	now = g_get_real_time () / G_USEC_PER_SEC;
+
+	g_hash_table_iter_init (&iter, cnc->priv->resolved_names);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		EwsResolvedName *rn = value;
+		gchar *group;
+
+		if (rn->expires <= now)
+			continue;
+
+		/* The key can contain characters not allowed in the group name */
+		group = g_compute_checksum_for_string (G_CHECKSUM_MD5, key, -1);
+
+		g_key_file_set_string (key_file, group, "Key", key);
+		if (rn->name)
+			g_key_file_set_string (key_file, group, "Name", rn->name);
+		if (rn->email)
+			g_key_file_set_string (key_file, group, "Email", rn->email);
+		g_key_file_set_int64 (key_file, group, "Expires", rn->expires);
+
+		g_free (group);
+	}
+
+	filename = ews_connection_dup_resolved_names_filename (cnc);
+	dirname = g_path_get_dirname (filename);
+
+	g_mkdir_with_parents (dirname, 0700);
+
+	if (g_key_file_save_to_file (key_file, filename, NULL))
+		cnc->priv->resolved_names_changes = 0;
+
+	g_key_file_free (key_file);
+	g_free (filename);
+	g_free (dirname);
+}
+
+static gchar *
+ews_connection_build_resolved_name_key (const gchar *kind,
+					const gchar *value)
+{
+	gchar *folded, *key;
+
+	folded = g_utf8_casefold (value, -1);
+	key = g_strconcat (kind, ":", folded, NULL);
+	g_free (folded);
+
+	return key;
+}
+
+/* Returns whether the 'key' is known; the 'out_email' is set to NULL
+   for names, which had been tried, but could not be resolved */
+static gboolean
+ews_connection_lookup_resolved_name (EEwsConnection *cnc,
+				     const gchar *key,
+				     gchar **out_name,
+				     gchar **out_email)
+{
+	EwsResolvedName *rn;
+	gboolean found = FALSE;
+
+	g_mutex_lock (&cnc->priv->resolved_names_lock);
+
+	ews_connection_resolved_names_ensure_loaded_locked (cnc);
+
+	rn = g_hash_table_lookup (cnc->priv->resolved_names, key);
+	if (rn && rn->expires <= g_get_real_time () / G_USEC_PER_SEC) {
+		g_hash_table_remove (cnc->priv->resolved_names, key);
+		rn = NULL;
+	}
+
+	if (rn) {
+		if (out_name)
+			*out_name = g_strdup (rn->name);
+		if (out_email)
+			*out_email = g_strdup (rn->email);
+
+		found = TRUE;
+	}
+
+	g_mutex_unlock (&cnc->priv->resolved_names_lock);
+
+	return found;
+}
+
+/* Whether the name resolution did not fail for other reason than that
+   the name is unknown; only such results can be remembered */
+static gboolean
+ews_connection_is_resolve_result_final (const GError *error)
+{
+	return !error ||
+		g_error_matches (error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_NAMERESOLUTIONNORESULTS) ||
+		g_error_matches (error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_NAMERESOLUTIONNOMAILBOX);
+}
+
+static void
+ews_connection_store_resolved_name (EEwsConnection *cnc,
+				    const gchar *key,
+				    const gchar *name,
+				    const gchar *email)
+{
+	EwsResolvedName *rn;
+
+	rn = g_new0 (EwsResolvedName, 1);
+	rn->name = g_strdup (name);
+	rn->email = g_strdup (email);
+	rn->expires = g_get_real_time () / G_USEC_PER_SEC + (email ? EWS_RESOLVED_NAMES_TTL : EWS_RESOLVED_NAMES_NEGATIVE_TTL);
+
+	g_mutex_lock (&cnc->priv->resolved_names_lock);
+
+	ews_connection_resolved_names_ensure_loaded_locked (cnc);
+
+	g_hash_table_insert (cnc->priv->resolved_names, g_strdup (key), rn);
+	cnc->priv->resolved_names_changes++;
+
+	if (cnc->priv->resolved_names_changes >= EWS_RESOLVED_NAMES_SAVE_AFTER)
+		ews_connection_resolved_names_save_locked (cnc);
+
+	g_mutex_unlock (&cnc->priv->resolved_names_lock);
+}
+
 static void
 ews_connection_dispose (GObject *object)
 {
@@ -2034,6 +2293,11 @@ ews_connection_finalize (GObject *object)
 
 	priv = E_EWS_CONNECTION_GET_PRIVATE (object);
 
+	if (priv->resolved_names) {
+		ews_connection_resolved_names_save_locked (E_EWS_CONNECTION (object));
+		g_hash_table_destroy (priv->resolved_names);
+	}
+
 	g_free (priv->uri);
 	g_free (priv->password);
 	g_free (priv->email);
@@ -2043,6 +2307,7 @@ ews_connection_finalize (GObject *object)
 
 	g_clear_object (&priv->bearer_auth);
 
+	g_mutex_clear (&priv->resolved_names_lock);
 	g_mutex_clear (&priv->property_lock);
 	g_rec_mutex_clear (&priv->queue_lock);
 	g_mutex_clear (&priv->notification_lock);
@@ -2152,6 +2417,7 @@ e_ews_connection_init (EEwsConnection *cnc)
 			NULL, e_ews_connection_folders_list_free);
 
 	g_mutex_init (&cnc->priv->property_lock);
+	g_mutex_init (&cnc->priv->resolved_names_lock);
 	g_rec_mutex_init (&cnc->priv->queue_lock);
 	g_mutex_init (&cnc->priv->notification_lock);
 }
@@ -3537,6 +3803,8 @@ struct _oal_req_data {
 
 	/* for dowloading oal file */
 	gchar *cache_filename;
+	EwsOalChunkFn chunk_fn;
+	gpointer chunk_data;
 	GError *error;
 	EwsProgressFn progress_fn;
 	gpointer progress_data;
@@ -4015,7 +4283,8 @@ oal_download_response_cb (SoupSession *soup_session,
 	ews_connection_check_ssl_error (data->cnc, soup_message);
 
 	if (ews_connection_credentials_failed (data->cnc, soup_message, simple)) {
-		g_unlink (data->cache_filename);
+		if (data->cache_filename)
+			g_unlink (data->cache_filename);
 	} else if (soup_message->status_code != 200) {
 		g_simple_async_result_set_error (
 			simple, SOUP_HTTP_ERROR,
@@ -4023,12 +4292,14 @@ oal_download_response_cb (SoupSession *soup_session,
 			"%d %s",
 			soup_message->status_code,
 			soup_message->reason_phrase);
-		g_unlink (data->cache_filename);
+		if (data->cache_filename)
+			g_unlink (data->cache_filename);
 
 	} else if (data->error != NULL) {
 		g_simple_async_result_take_error (simple, data->error);
 		data->error = NULL;
-		g_unlink (data->cache_filename);
+		if (data->cache_filename)
+			g_unlink (data->cache_filename);
 	}
 
 	e_ews_debug_dump_raw_soup_response (soup_message);
@@ -4080,6 +4351,19 @@ ews_soup_got_chunk (SoupMessage *msg,
 		data->progress_fn (data->progress_data, pc);
 	}
 
+	if (data->chunk_fn) {
+		/* Do not feed the consumer with anything after it failed */
+		if (!data->error &&
+		    !data->chunk_fn ((gconstpointer) chunk->data, chunk->length, data->chunk_data, &data->error) &&
+		    !data->error) {
+			g_set_error_literal (
+				&data->error, EWS_CONNECTION_ERROR, EWS_CONNECTION_ERROR_UNKNOWN,
+				"Failed to process streaming data");
+		}
+
+		return;
+	}
+
 	fd = g_open (data->cache_filename, O_RDONLY | O_WRONLY | O_APPEND | O_CREAT, 0600);
 	if (fd != -1) {
 		if (write (fd, (const gchar *) chunk->data, chunk->length) != chunk->length) {
@@ -4126,14 +4410,17 @@ e_ews_connection_download_oal_file_sync (EEwsConnection *cnc,
 	return success;
 }
 
-void
-e_ews_connection_download_oal_file (EEwsConnection *cnc,
-                                    const gchar *cache_filename,
-                                    EwsProgressFn progress_fn,
-                                    gpointer progress_data,
-                                    GCancellable *cancellable,
-                                    GAsyncReadyCallback callback,
-                                    gpointer user_data)
+static void
+ews_connection_download_oal_file_internal (EEwsConnection *cnc,
+					   const gchar *cache_filename,
+					   EwsOalChunkFn chunk_fn,
+					   gpointer chunk_data,
+					   EwsProgressFn progress_fn,
+					   gpointer progress_data,
+					   GCancellable *cancellable,
+					   GAsyncReadyCallback callback,
+					   gpointer user_data,
+					   gpointer source_tag)
 {
 	GSimpleAsyncResult *simple;
 	SoupMessage *soup_message;
@@ -4146,7 +4433,7 @@ e_ews_connection_download_oal_file (EEwsConnection *cnc,
 
 	simple = g_simple_async_result_new (
 		G_OBJECT (cnc), callback, user_data,
-		e_ews_connection_download_oal_file);
+		source_tag);
 
 	if (!soup_message) {
 		g_simple_async_result_take_error (simple, error);
@@ -4158,6 +4445,8 @@ e_ews_connection_download_oal_file (EEwsConnection *cnc,
 	data->cnc = g_object_ref (cnc);
 	data->soup_message = soup_message;  /* the session owns this */
 	data->cache_filename = g_strdup (cache_filename);
+	data->chunk_fn = chunk_fn;
+	data->chunk_data = chunk_data;
 	data->progress_fn = progress_fn;
 	data->progress_data = progress_data;
 
@@ -4192,6 +4481,24 @@ e_ews_connection_download_oal_file (EEwsConnection *cnc,
 	ews_connection_schedule_queue_message (cnc, soup_message, oal_download_response_cb, simple);
 }
 
+void
+e_ews_connection_download_oal_file (EEwsConnection *cnc,
+                                    const gchar *cache_filename,
+                                    EwsProgressFn progress_fn,
+                                    gpointer progress_data,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+	g_return_if_fail (E_IS_EWS_CONNECTION (cnc));
+	g_return_if_fail (cache_filename != NULL);
+
+	ews_connection_download_oal_file_internal (
+		cnc, cache_filename, NULL, NULL,
+		progress_fn, progress_data, cancellable,
+		callback, user_data, e_ews_connection_download_oal_file);
+}
+
 gboolean
 e_ews_connection_download_oal_file_finish (EEwsConnection *cnc,
                                            GAsyncResult *result,
@@ -4211,6 +4518,83 @@ e_ews_connection_download_oal_file_finish (EEwsConnection *cnc,
 	return !g_simple_async_result_propagate_error (simple, error);
 }
 
+/* Downloads the OAL file the same way as e_ews_connection_download_oal_file(),
+   except the received data is not saved into a file, but it is passed into
+   the chunk_fn as it arrives. The chunk_fn is called from the connection's
+   dedicated thread; it can block (for example when its consumer is busy),
+   which throttles the download. When it returns FALSE, the download fails
+   with the error it set. */
+gboolean
+e_ews_connection_download_oal_file_stream_sync (EEwsConnection *cnc,
+						EwsOalChunkFn chunk_fn,
+						gpointer chunk_data,
+						EwsProgressFn progress_fn,
+						gpointer progress_data,
+						GCancellable *cancellable,
+						GError **error)
+{
+	EAsyncClosure *closure;
+	GAsyncResult *result;
+	gboolean success;
+
+	g_return_val_if_fail (E_IS_EWS_CONNECTION (cnc), FALSE);
+	g_return_val_if_fail (chunk_fn != NULL, FALSE);
+
+	closure = e_async_closure_new ();
+
+	e_ews_connection_download_oal_file_stream (
+		cnc, chunk_fn, chunk_data,
+		progress_fn, progress_data, cancellable,
+		e_async_closure_callback, closure);
+
+	result = e_async_closure_wait (closure);
+
+	success = e_ews_connection_download_oal_file_stream_finish (
+		cnc, result, error);
+
+	e_async_closure_free (closure);
+
+	return success;
+}
+
+void
+e_ews_connection_download_oal_file_stream (EEwsConnection *cnc,
+					   EwsOalChunkFn chunk_fn,
+					   gpointer chunk_data,
+					   EwsProgressFn progress_fn,
+					   gpointer progress_data,
+					   GCancellable *cancellable,
+					   GAsyncReadyCallback callback,
+					   gpointer user_data)
+{
+	g_return_if_fail (E_IS_EWS_CONNECTION (cnc));
+	g_return_if_fail (chunk_fn != NULL);
+
+	ews_connection_download_oal_file_internal (
+		cnc, NULL, chunk_fn, chunk_data,
+		progress_fn, progress_data, cancellable,
+		callback, user_data, e_ews_connection_download_oal_file_stream);
+}
+
+gboolean
+e_ews_connection_download_oal_file_stream_finish (EEwsConnection *cnc,
+						  GAsyncResult *result,
+						  GError **error)
+{
+	GSimpleAsyncResult *simple;
+
+	g_return_val_if_fail (cnc != NULL, FALSE);
+	g_return_val_if_fail (
+		g_simple_async_result_is_valid (
+		result, G_OBJECT (cnc),
+		e_ews_connection_download_oal_file_stream), FALSE);
+
+	simple = G_SIMPLE_ASYNC_RESULT (result);
+
+	/* Assume success unless a GError is set. */
+	return !g_simple_async_result_propagate_error (simple, error);
+}
+
 const gchar *
 e_ews_connection_get_mailbox (EEwsConnection *cnc)
 {
@@ -4537,6 +4921,7 @@ ews_connection_write_only_ids_restriction (ESoapMessage *msg,
  * @default_props: Can take one of the values: IdOnly,Default or AllProperties
  * @add_props: Specify any additional properties to be fetched
  * @sort_order: Specific sorting order for items
+ * @max_entries: at most how many items to return, from the beginning of the @sort_order; 0 for all
  * @query: evo query based on which items will be fetched
  * @only_ids: (element-type utf8) (nullable): a gchar * with item IDs, to check with only; can be %NULL
  * @type: type of folder
@@ -4552,6 +4937,7 @@ e_ews_connection_find_folder_items (EEwsConnection *cnc,
                                     const gchar *default_props,
                                     const EEwsAdditionalProps *add_props,
                                     EwsSortOrder *sort_order,
+				    guint max_entries,
                                     const gchar *query,
 				    GPtrArray *only_ids, /* element-type utf8 */
                                     EEwsFolderType type,
@@ -4584,6 +4970,18 @@ e_ews_connection_find_folder_items (EEwsConnection *cnc,
 
 	e_soap_message_end_element (msg);
 
+	if (max_entries > 0) {
+		gchar *tmp = g_strdup_printf ("%u", max_entries);
+
+		e_soap_message_start_element (msg, "IndexedPageItemView", "messages", NULL);
+		e_soap_message_add_attribute (msg, "MaxEntriesReturned", tmp, NULL, NULL);
+		e_soap_message_add_attribute (msg, "Offset", "0", NULL, NULL);
+		e_soap_message_add_attribute (msg, "BasePoint", "Beginning", NULL, NULL);
+		e_soap_message_end_element (msg); /* IndexedPageItemView */
+
+		g_free (tmp);
+	}
+
 	/*write restriction message based on query*/
 	if (convert_query_cb) {
 		e_soap_message_start_element (msg, "Restriction", "messages", NULL);
@@ -4672,6 +5070,7 @@ e_ews_connection_find_folder_items_sync (EEwsConnection *cnc,
                                          const gchar *default_props,
                                          const EEwsAdditionalProps *add_props,
                                          EwsSortOrder *sort_order,
+					 guint max_entries,
                                          const gchar *query,
 					 GPtrArray *only_ids, /* element-type utf8 */
                                          EEwsFolderType type,
@@ -4691,7 +5090,7 @@ e_ews_connection_find_folder_items_sync (EEwsConnection *cnc,
 
 	e_ews_connection_find_folder_items (
 		cnc, pri, fid, default_props,
-		add_props, sort_order, query,
+		add_props, sort_order, max_entries, query,
 		only_ids, type, convert_query_cb, NULL,
 		e_async_closure_callback, closure);
 
@@ -4705,72 +5104,223 @@ e_ews_connection_find_folder_items_sync (EEwsConnection *cnc,
 	return success;
 }
 
+static gchar *
+ews_connection_make_timestamp (time_t tt)
+{
+	GDateTime *dt;
+	gchar *timestamp;
+
+	dt = g_date_time_new_from_unix_utc (tt);
+	timestamp = g_date_time_format (dt, "%Y-%m-%dT%H:%M:%SZ");
+	g_date_time_unref (dt);
+
+	return timestamp;
+}
+
+/**
+ * e_ews_connection_find_calendar_view_items:
+ * @cnc: The EWS Connection
+ * @pri: The priority associated with the request
+ * @fid: The calendar folder id
+ * @add_props: Specify any additional properties to be fetched
+ * @start: start of the time window
+ * @end: end of the time window
+ * @max_entries: how many items to return at most, or 0 to not limit
+ * @cancellable: a GCancellable to monitor cancelled operations
+ * @callback: Responses are parsed and returned to this callback
+ * @user_data: user data passed to callback
+ *
+ * Finds the calendar items, including expanded occurrences of recurring
+ * series, which overlap the time window, using FindItem with CalendarView.
+ * The items have set only their IDs and the @add_props. When not all
+ * the items fit into @max_entries, the next page can be asked for with
+ * the @start set to the start of the last returned item.
+ *
+ * Finish the call with e_ews_connection_find_folder_items_finish().
+ **/
 void
-e_ews_connection_sync_folder_hierarchy (EEwsConnection *cnc,
-                                        gint pri,
-                                        const gchar *sync_state,
-                                        GCancellable *cancellable,
-                                        GAsyncReadyCallback callback,
-                                        gpointer user_data)
+e_ews_connection_find_calendar_view_items (EEwsConnection *cnc,
+					   gint pri,
+					   EwsFolderId *fid,
+					   const EEwsAdditionalProps *add_props,
+					   time_t start,
+					   time_t end,
+					   guint max_entries,
+					   GCancellable *cancellable,
+					   GAsyncReadyCallback callback,
+					   gpointer user_data)
 {
 	ESoapMessage *msg;
 	GSimpleAsyncResult *simple;
 	EwsAsyncData *async_data;
+	gchar *start_str, *end_str;
 
 	g_return_if_fail (cnc != NULL);
+	g_return_if_fail (fid != NULL);
 
 	msg = e_ews_message_new_with_header (
 			cnc->priv->settings,
 			cnc->priv->uri,
 			cnc->priv->impersonate_user,
-			"SyncFolderHierarchy",
-			NULL,
-			NULL,
+			"FindItem",
+			"Traversal",
+			"Shallow",
 			cnc->priv->version,
 			E_EWS_EXCHANGE_2007_SP1,
 			FALSE,
 			TRUE);
-	e_soap_message_start_element (msg, "FolderShape", "messages", NULL);
-	e_ews_message_write_string_parameter (msg, "BaseShape", NULL, "AllProperties");
+	e_soap_message_start_element (msg, "ItemShape", "messages", NULL);
+	e_ews_message_write_string_parameter (msg, "BaseShape", NULL, "IdOnly");
+
+	ews_append_additional_props_to_msg (msg, add_props);
+
 	e_soap_message_end_element (msg);
 
-	if (sync_state)
-		e_ews_message_write_string_parameter (msg, "SyncState", "messages", sync_state);
+	start_str = ews_connection_make_timestamp (start);
+	end_str = ews_connection_make_timestamp (end);
+
+	e_soap_message_start_element (msg, "CalendarView", "messages", NULL);
+	if (max_entries > 0) {
+		gchar *tmp = g_strdup_printf ("%u", max_entries);
+		e_soap_message_add_attribute (msg, "MaxEntriesReturned", tmp, NULL, NULL);
+		g_free (tmp);
+	}
+	e_soap_message_add_attribute (msg, "StartDate", start_str, NULL, NULL);
+	e_soap_message_add_attribute (msg, "EndDate", end_str, NULL, NULL);
+	e_soap_message_end_element (msg); /* CalendarView */
 
+	g_free (start_str);
+	g_free (end_str);
+
+	e_soap_message_start_element (msg, "ParentFolderIds", "messages", NULL);
+
+	if (fid->is_distinguished_id)
+		e_ews_message_write_string_parameter_with_attribute (msg, "DistinguishedFolderId", NULL, NULL, "Id", fid->id);
+	else
+		e_ews_message_write_string_parameter_with_attribute (msg, "FolderId", NULL, NULL, "Id", fid->id);
+
+	e_soap_message_end_element (msg);
+
+	/* Complete the footer and print the request */
 	e_ews_message_write_footer (msg);
 
+	/* Shares the finish function with e_ews_connection_find_folder_items() */
 	simple = g_simple_async_result_new (
 		G_OBJECT (cnc), callback, user_data,
-		e_ews_connection_sync_folder_hierarchy);
+		e_ews_connection_find_folder_items);
 
 	async_data = g_new0 (EwsAsyncData, 1);
-	async_data->cnc = cnc;
 	g_simple_async_result_set_op_res_gpointer (
 		simple, async_data, (GDestroyNotify) async_data_free);
 
 	e_ews_connection_queue_request (
-		cnc, msg, sync_hierarchy_response_cb,
+		cnc, msg, find_folder_items_response_cb,
 		pri, cancellable, simple);
 
 	g_object_unref (simple);
 }
 
 gboolean
-e_ews_connection_sync_folder_hierarchy_finish (EEwsConnection *cnc,
-                                               GAsyncResult *result,
-                                               gchar **sync_state,
-                                               gboolean *includes_last_folder,
-                                               GSList **folders_created,
-                                               GSList **folders_updated,
-                                               GSList **folders_deleted,
-                                               GError **error)
+e_ews_connection_find_calendar_view_items_sync (EEwsConnection *cnc,
+						gint pri,
+						EwsFolderId *fid,
+						const EEwsAdditionalProps *add_props,
+						time_t start,
+						time_t end,
+						guint max_entries,
+						gboolean *includes_last_item,
+						GSList **items,
+						GCancellable *cancellable,
+						GError **error)
 {
-	GSimpleAsyncResult *simple;
-	EwsAsyncData *async_data;
+	EAsyncClosure *closure;
+	GAsyncResult *result;
+	gboolean success;
 
 	g_return_val_if_fail (cnc != NULL, FALSE);
-	g_return_val_if_fail (
-		g_simple_async_result_is_valid (
+
+	closure = e_async_closure_new ();
+
+	e_ews_connection_find_calendar_view_items (
+		cnc, pri, fid, add_props, start, end, max_entries,
+		cancellable, e_async_closure_callback, closure);
+
+	result = e_async_closure_wait (closure);
+
+	success = e_ews_connection_find_folder_items_finish (
+		cnc, result, includes_last_item, items, error);
+
+	e_async_closure_free (closure);
+
+	return success;
+}
+
+void
+e_ews_connection_sync_folder_hierarchy (EEwsConnection *cnc,
+                                        gint pri,
+                                        const gchar *sync_state,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data)
+{
+	ESoapMessage *msg;
+	GSimpleAsyncResult *simple;
+	EwsAsyncData *async_data;
+
+	g_return_if_fail (cnc != NULL);
+
+	msg = e_ews_message_new_with_header (
+			cnc->priv->settings,
+			cnc->priv->uri,
+			cnc->priv->impersonate_user,
+			"SyncFolderHierarchy",
+			NULL,
+			NULL,
+			cnc->priv->version,
+			E_EWS_EXCHANGE_2007_SP1,
+			FALSE,
+			TRUE);
+	e_soap_message_start_element (msg, "FolderShape", "messages", NULL);
+	e_ews_message_write_string_parameter (msg, "BaseShape", NULL, "AllProperties");
+	e_soap_message_end_element (msg);
+
+	if (sync_state)
+		e_ews_message_write_string_parameter (msg, "SyncState", "messages", sync_state);
+
+	e_ews_message_write_footer (msg);
+
+	simple = g_simple_async_result_new (
+		G_OBJECT (cnc), callback, user_data,
+		e_ews_connection_sync_folder_hierarchy);
+
+	async_data = g_new0 (EwsAsyncData, 1);
+	async_data->cnc = cnc;
+	g_simple_async_result_set_op_res_gpointer (
+		simple, async_data, (GDestroyNotify) async_data_free);
+
+	e_ews_connection_queue_request (
+		cnc, msg, sync_hierarchy_response_cb,
+		pri, cancellable, simple);
+
+	g_object_unref (simple);
+}
+
+gboolean
+e_ews_connection_sync_folder_hierarchy_finish (EEwsConnection *cnc,
+                                               GAsyncResult *result,
+                                               gchar **sync_state,
+                                               gboolean *includes_last_folder,
+                                               GSList **folders_created,
+                                               GSList **folders_updated,
+                                               GSList **folders_deleted,
+                                               GError **error)
+{
+	GSimpleAsyncResult *simple;
+	EwsAsyncData *async_data;
+
+	g_return_val_if_fail (cnc != NULL, FALSE);
+	g_return_val_if_fail (
+		g_simple_async_result_is_valid (
 		result, G_OBJECT (cnc), e_ews_connection_sync_folder_hierarchy),
 		FALSE);
 
@@ -5046,6 +5596,115 @@ e_ews_connection_get_items_sync (EEwsConnection *cnc,
 	return success;
 }
 
+/**
+ * e_ews_connection_get_recurring_masters:
+ * @cnc: The EWS Connection
+ * @pri: The priority associated with the request
+ * @occurrence_ids: (element-type utf8): IDs of occurrences or exceptions of recurring series
+ * @default_props: Can take one of the values: IdOnly, Default or AllProperties
+ * @add_props: Specify any additional properties to be fetched
+ * @cancellable: a GCancellable to monitor cancelled operations
+ * @callback: Responses are parsed and returned to this callback
+ * @user_data: user data passed to callback
+ *
+ * Gets the recurring master items of the series the @occurrence_ids belong to.
+ * The items are returned in the same order as the @occurrence_ids.
+ *
+ * Finish the call with e_ews_connection_get_items_finish().
+ **/
+void
+e_ews_connection_get_recurring_masters (EEwsConnection *cnc,
+					gint pri,
+					const GSList *occurrence_ids,
+					const gchar *default_props,
+					const EEwsAdditionalProps *add_props,
+					GCancellable *cancellable,
+					GAsyncReadyCallback callback,
+					gpointer user_data)
+{
+	ESoapMessage *msg;
+	GSimpleAsyncResult *simple;
+	EwsAsyncData *async_data;
+	const GSList *l;
+
+	g_return_if_fail (cnc != NULL);
+
+	msg = e_ews_message_new_with_header (
+			cnc->priv->settings,
+			cnc->priv->uri,
+			cnc->priv->impersonate_user,
+			"GetItem",
+			NULL,
+			NULL,
+			cnc->priv->version,
+			E_EWS_EXCHANGE_2007_SP1,
+			FALSE,
+			TRUE);
+
+	e_soap_message_start_element (msg, "ItemShape", "messages", NULL);
+	e_ews_message_write_string_parameter (msg, "BaseShape", NULL, default_props);
+
+	ews_append_additional_props_to_msg (msg, add_props);
+
+	e_soap_message_end_element (msg);
+
+	e_soap_message_start_element (msg, "ItemIds", "messages", NULL);
+
+	for (l = occurrence_ids; l != NULL; l = g_slist_next (l))
+		e_ews_message_write_string_parameter_with_attribute (msg, "RecurringMasterItemId", NULL, NULL, "OccurrenceId", l->data);
+
+	e_soap_message_end_element (msg);
+
+	e_ews_message_write_footer (msg);
+
+	/* Shares the finish function with e_ews_connection_get_items() */
+	simple = g_simple_async_result_new (
+		G_OBJECT (cnc), callback, user_data,
+		e_ews_connection_get_items);
+
+	async_data = g_new0 (EwsAsyncData, 1);
+	g_simple_async_result_set_op_res_gpointer (
+		simple, async_data, (GDestroyNotify) async_data_free);
+
+	e_ews_connection_queue_request (
+		cnc, msg, get_items_response_cb,
+		pri, cancellable, simple);
+
+	g_object_unref (simple);
+}
+
+gboolean
+e_ews_connection_get_recurring_masters_sync (EEwsConnection *cnc,
+					     gint pri,
+					     const GSList *occurrence_ids,
+					     const gchar *default_props,
+					     const EEwsAdditionalProps *add_props,
+					     GSList **items,
+					     GCancellable *cancellable,
+					     GError **error)
+{
+	EAsyncClosure *closure;
+	GAsyncResult *result;
+	gboolean success;
+
+	g_return_val_if_fail (cnc != NULL, FALSE);
+
+	closure = e_async_closure_new ();
+
+	e_ews_connection_get_recurring_masters (
+		cnc, pri, occurrence_ids, default_props, add_props,
+		cancellable, e_async_closure_callback, closure);
+
+	result = e_async_closure_wait (closure);
+
+	success = e_ews_connection_get_items_finish (
+		cnc, result, items, error);
+
+	e_async_closure_free (closure);
+
+	return success;
+}
+
 static const gchar *
 ews_delete_type_to_str (EwsDeleteType delete_type)
 {
@@ -5983,7 +6642,8 @@ ews_connection_resolve_by_name (EEwsConnection *cnc,
                                 const gchar *usename,
                                 gboolean is_user_name,
                                 gchar **smtp_address,
-                                GCancellable *cancellable)
+                                GCancellable *cancellable,
+                                GError **error)
 {
 	GSList *mailboxes = NULL;
 	GSList *contacts = NULL;
@@ -6002,11 +6662,10 @@ ews_connection_resolve_by_name (EEwsConnection *cnc,
 	mailboxes = NULL;
 	contacts = NULL;
 
-	/* use the first error, not the guess-part error */
 	e_ews_connection_resolve_names_sync (
 		cnc, pri, usename,
 		EWS_SEARCH_AD_CONTACTS, NULL, TRUE, &mailboxes, &contacts,
-		&includes_last_item, cancellable, NULL);
+		&includes_last_item, cancellable, error);
 
 	for (miter = mailboxes; miter; miter = miter->next) {
 		const EwsMailbox *mailbox = miter->data;
@@ -6077,6 +6736,9 @@ e_ews_connection_ex_to_smtp_sync (EEwsConnection *cnc,
 	GSList *mailboxes = NULL;
 	GSList *contacts = NULL;
 	gboolean includes_last_item = FALSE;
+	gboolean is_final;
+	gchar *key;
+	GError *local_error = NULL;
 
 	g_return_val_if_fail (cnc != NULL, FALSE);
 	g_return_val_if_fail (ex_address != NULL, FALSE);
@@ -6084,10 +6746,20 @@ e_ews_connection_ex_to_smtp_sync (EEwsConnection *cnc,
 
 	*smtp_address = NULL;
 
+	key = ews_connection_build_resolved_name_key ("ex", ex_address);
+
+	if (ews_connection_lookup_resolved_name (cnc, key, NULL, smtp_address)) {
+		g_free (key);
+
+		return *smtp_address != NULL;
+	}
+
 	e_ews_connection_resolve_names_sync (
 		cnc, pri, ex_address,
 		EWS_SEARCH_AD_CONTACTS, NULL, TRUE, &mailboxes, &contacts,
-		&includes_last_item, cancellable, error);
+		&includes_last_item, cancellable, &local_error);
+
+	is_final = ews_connection_is_resolve_result_final (local_error);
 
 	/* only one mailbox matches */
 	if (mailboxes && !mailboxes->next && mailboxes->data) {
@@ -6121,27 +6793,157 @@ e_ews_connection_ex_to_smtp_sync (EEwsConnection *cnc,
 
 	if (!*smtp_address) {
 		const gchar *usename;
+		GError *guess_error = NULL;
 
+		/* use the first error, not the guess-part error */
 		usename = strrchr (ex_address, '/');
 		if (usename && g_ascii_strncasecmp (usename, "/cn=", 4) == 0) {
 			usename += 4;
 
 			/* try to guess from common name of the EX address */
-			ews_connection_resolve_by_name (cnc, pri, usename, FALSE, smtp_address, cancellable);
+			ews_connection_resolve_by_name (cnc, pri, usename, FALSE, smtp_address, cancellable, &guess_error);
+
+			is_final = is_final && ews_connection_is_resolve_result_final (guess_error);
+			g_clear_error (&guess_error);
 		}
 
 		if (!*smtp_address && name && *name) {
 			/* try to guess from mailbox name */
-			ews_connection_resolve_by_name (cnc, pri, name, TRUE, smtp_address, cancellable);
+			ews_connection_resolve_by_name (cnc, pri, name, TRUE, smtp_address, cancellable, &guess_error);
+
+			is_final = is_final && ews_connection_is_resolve_result_final (guess_error);
+			g_clear_error (&guess_error);
 		}
 	}
 
-	if (*smtp_address)
-		g_clear_error (error);
+	/* Do not remember failures caused by the connection or a cancellation */
+	if (*smtp_address || is_final)
+		ews_connection_store_resolved_name (cnc, key, name, *smtp_address);
+
+	if (local_error && !*smtp_address)
+		g_propagate_error (error, local_error);
+	else
+		g_clear_error (&local_error);
+
+	g_free (key);
 
 	return *smtp_address != NULL;
 }
 
+/**
+ * e_ews_connection_get_cached_smtp_address:
+ * @cnc: an #EEwsConnection
+ * @ex_address: an Exchange (EX) address
+ * @out_smtp_address: (out) (transfer full): return location for the SMTP address
+ *
+ * Looks up the SMTP address for the @ex_address, which had been resolved
+ * by e_ews_connection_ex_to_smtp_sync() before, possibly in a previous
+ * session. It never contacts the server.
+ *
+ * Returns: Whether the SMTP address is known; free the @out_smtp_address
+ *    with g_free(), when no longer needed.
+ **/
+gboolean
+e_ews_connection_get_cached_smtp_address (EEwsConnection *cnc,
+					  const gchar *ex_address,
+					  gchar **out_smtp_address)
+{
+	gchar *key;
+	gboolean found;
+
+	g_return_val_if_fail (E_IS_EWS_CONNECTION (cnc), FALSE);
+	g_return_val_if_fail (out_smtp_address != NULL, FALSE);
+
+	*out_smtp_address = NULL;
+
+	if (!ex_address || !*ex_address)
+		return FALSE;
+
+	key = ews_connection_build_resolved_name_key ("ex", ex_address);
+	found = ews_connection_lookup_resolved_name (cnc, key, NULL, out_smtp_address) && *out_smtp_address;
+	g_free (key);
+
+	return found;
+}
+
+/**
+ * e_ews_connection_resolve_mailbox_cached_sync:
+ * @cnc: an #EEwsConnection
+ * @pri: the request priority
+ * @name: a display name or an address to resolve
+ * @out_mailbox: (out) (transfer full): return location for the resolved mailbox
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Resolves the @name in the Active Directory to a mailbox with an SMTP address,
+ * the same as e_ews_connection_resolve_names_sync() does, only the results,
+ * including names which cannot be resolved, are remembered per connection
+ * and between sessions, thus the server is not asked for the same name
+ * repeatedly. When more mailboxes match, the first is used.
+ *
+ * Returns: Whether the @name had been resolved; free the @out_mailbox
+ *    with e_ews_mailbox_free(), when no longer needed.
+ **/
+gboolean
+e_ews_connection_resolve_mailbox_cached_sync (EEwsConnection *cnc,
+					      gint pri,
+					      const gchar *name,
+					      EwsMailbox **out_mailbox,
+					      GCancellable *cancellable,
+					      GError **error)
+{
+	GSList *mailboxes = NULL, *link;
+	gboolean includes_last_item = FALSE;
+	gchar *key, *found_name = NULL, *found_email = NULL;
+	GError *local_error = NULL;
+
+	g_return_val_if_fail (E_IS_EWS_CONNECTION (cnc), FALSE);
+	g_return_val_if_fail (name != NULL, FALSE);
+	g_return_val_if_fail (out_mailbox != NULL, FALSE);
+
+	*out_mailbox = NULL;
+
+	key = ews_connection_build_resolved_name_key ("name", name);
+
+	if (!ews_connection_lookup_resolved_name (cnc, key, &found_name, &found_email)) {
+		e_ews_connection_resolve_names_sync (
+			cnc, pri, name,
+			EWS_SEARCH_AD, NULL, FALSE, &mailboxes, NULL,
+			&includes_last_item, cancellable, &local_error);
+
+		for (link = mailboxes; link && !found_email; link = g_slist_next (link)) {
+			EwsMailbox *mb = link->data;
+
+			if (mb && mb->email && *mb->email) {
+				found_name = g_strdup (mb->name);
+				found_email = g_strdup (mb->email);
+			}
+		}
+
+		g_slist_free_full (mailboxes, (GDestroyNotify) e_ews_mailbox_free);
+
+		if (found_email || ews_connection_is_resolve_result_final (local_error))
+			ews_connection_store_resolved_name (cnc, key, found_name, found_email);
+	}
+
+	if (found_email) {
+		*out_mailbox = g_new0 (EwsMailbox, 1);
+		(*out_mailbox)->name = found_name;
+		(*out_mailbox)->email = found_email;
+
+		g_clear_error (&local_error);
+	} else {
+		g_free (found_name);
+
+		if (local_error)
+			g_propagate_error (error, local_error);
+	}
+
+	g_free (key);
+
+	return *out_mailbox != NULL;
+}
+
 void
 e_ews_connection_expand_dl (EEwsConnection *cnc,
                             gint pri,
@@ -7215,6 +8017,158 @@ e_ews_connection_delete_folder_sync (EEwsConnection *cnc,
 	return success;
 }
 
+static void
+delete_folders_response_cb (ESoapResponse *response,
+			    GSimpleAsyncResult *simple)
+{
+	EwsAsyncData *async_data;
+	ESoapParameter *param;
+	ESoapParameter *subparam;
+	GSList *link;
+	GError *error = NULL;
+
+	async_data = g_simple_async_result_get_op_res_gpointer (simple);
+
+	param = e_soap_response_get_first_parameter_by_name (
+		response, "ResponseMessages", &error);
+
+	/* Sanity check */
+	g_return_if_fail (
+		(param != NULL && error == NULL) ||
+		(param == NULL && error != NULL));
+
+	if (error != NULL) {
+		g_simple_async_result_take_error (simple, error);
+		return;
+	}
+
+	/* The response messages are in the same order as the requested folders */
+	for (subparam = e_soap_parameter_get_first_child (param), link = async_data->folder_ids;
+	     subparam && link;
+	     subparam = e_soap_parameter_get_next_child (subparam), link = g_slist_next (link)) {
+		if (!ews_get_response_status (subparam, &error))
+			g_hash_table_insert (async_data->folder_errors, g_strdup (link->data), error);
+
+		error = NULL;
+	}
+}
+
+/**
+ * e_ews_connection_delete_folders:
+ * @cnc:
+ * @pri:
+ * @folder_ids: (element-type utf8): folders to be deleted
+ * @delete_type: "HardDelete", "SoftDelete", "MoveToDeletedItems"
+ * @cancellable:
+ * @callback:
+ * @user_data:
+ *
+ * Deletes all the @folder_ids with a single DeleteFolder request. Unlike
+ * e_ews_connection_delete_folder(), a failure to delete one of the folders
+ * does not fail the whole operation, see e_ews_connection_delete_folders_finish().
+ **/
+void
+e_ews_connection_delete_folders (EEwsConnection *cnc,
+				 gint pri,
+				 const GSList *folder_ids,
+				 const gchar *delete_type,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer user_data)
+{
+	ESoapMessage *msg;
+	GSimpleAsyncResult *simple;
+	EwsAsyncData *async_data;
+	const GSList *link;
+
+	g_return_if_fail (cnc != NULL);
+	g_return_if_fail (folder_ids != NULL);
+
+	msg = e_ews_message_new_with_header (
+			cnc->priv->settings,
+			cnc->priv->uri,
+			cnc->priv->impersonate_user,
+			"DeleteFolder",
+			"DeleteType",
+			delete_type,
+			cnc->priv->version,
+			E_EWS_EXCHANGE_2007_SP1,
+			FALSE,
+			TRUE);
+
+	e_soap_message_start_element (msg, "FolderIds", "messages", NULL);
+
+	for (link = folder_ids; link; link = g_slist_next (link)) {
+		e_soap_message_start_element (msg, "FolderId", NULL, NULL);
+		e_soap_message_add_attribute (msg, "Id", link->data, NULL, NULL);
+		e_soap_message_end_element (msg); /* </FolderId> */
+	}
+
+	e_soap_message_end_element (msg); /* </FolderIds> */
+
+	e_ews_message_write_footer (msg);
+
+	simple = g_simple_async_result_new (
+		G_OBJECT (cnc), callback, user_data,
+		e_ews_connection_delete_folders);
+
+	async_data = g_new0 (EwsAsyncData, 1);
+	async_data->folder_ids = g_slist_copy_deep ((GSList *) folder_ids, (GCopyFunc) g_strdup, NULL);
+	async_data->folder_errors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_error_free);
+	g_simple_async_result_set_op_res_gpointer (
+		simple, async_data, (GDestroyNotify) async_data_free);
+
+	e_ews_connection_queue_request (
+		cnc, msg, delete_folders_response_cb,
+		pri, cancellable, simple);
+
+	g_object_unref (simple);
+}
+
+/**
+ * e_ews_connection_delete_folders_finish:
+ * @cnc:
+ * @result:
+ * @out_folder_errors: (out) (optional) (transfer full): the folders, which could not be deleted
+ * @error:
+ *
+ * Finishes e_ews_connection_delete_folders(). The @out_folder_errors is set
+ * to a #GHashTable with folder id ~> #GError for each folder, which failed
+ * to be deleted, or to %NULL, when all of them had been deleted. Free it
+ * with g_hash_table_unref(), when done with it.
+ *
+ * Returns: whether the request itself succeeded
+ **/
+gboolean
+e_ews_connection_delete_folders_finish (EEwsConnection *cnc,
+					GAsyncResult *result,
+					GHashTable **out_folder_errors,
+					GError **error)
+{
+	GSimpleAsyncResult *simple;
+	EwsAsyncData *async_data;
+
+	g_return_val_if_fail (cnc != NULL, FALSE);
+	g_return_val_if_fail (
+		g_simple_async_result_is_valid (
+		result, G_OBJECT (cnc), e_ews_connection_delete_folders),
+		FALSE);
+
+	simple = G_SIMPLE_ASYNC_RESULT (result);
+	async_data = g_simple_async_result_get_op_res_gpointer (simple);
+
+	if (out_folder_errors)
+		*out_folder_errors = NULL;
+
+	if (g_simple_async_result_propagate_error (simple, error))
+		return FALSE;
+
+	if (out_folder_errors && g_hash_table_size (async_data->folder_errors) > 0)
+		*out_folder_errors = g_hash_table_ref (async_data->folder_errors);
+
+	return TRUE;
+}
+
 static void
 empty_folder_response_cb (ESoapResponse *response,
 			  GSimpleAsyncResult *simple)
@@ -7827,24 +8781,50 @@ ews_handle_attachments_param (ESoapParameter *param,
 	attspara = e_soap_parameter_get_first_child_by_name (param, "Attachments");
 
 	for (subparam = e_soap_parameter_get_first_child (attspara); subparam != NULL; subparam = e_soap_parameter_get_next_child (subparam)) {
+		ESoapParameter *attach_id;
+		gchar *id = NULL;
+
 		name = e_soap_parameter_get_name (subparam);
 
+		attach_id = e_soap_parameter_get_first_child_by_name (subparam, "AttachmentId");
+		if (attach_id)
+			id = e_soap_parameter_get_property (attach_id, "Id");
+
 		if (!g_ascii_strcasecmp (name, "ItemAttachment")) {
 			item = e_ews_item_new_from_soap_parameter (subparam);
 			info = e_ews_item_dump_mime_content (item, async_data->directory);
 			g_clear_object (&item);
 
 		} else if (!g_ascii_strcasecmp (name, "FileAttachment")) {
+			const gchar *comp_uid = async_data->sync_state;
+
+			if (async_data->attachment_uids) {
+				comp_uid = id ? g_hash_table_lookup (async_data->attachment_uids, id) : NULL;
+
+				/* Unknown attachment; without the component uid the file would land
+				   directly in the cache directory, where it could overwrite a file
+				   of the same name of another component. */
+				if (!comp_uid) {
+					g_free (id);
+					continue;
+				}
+			}
+
 			info = e_ews_dump_file_attachment_from_soap_parameter (
 					subparam,
 					async_data->directory,
-					async_data->sync_state);
+					comp_uid);
 		}
 
-		if (info)
+		if (info) {
+			if (id && !e_ews_attachment_info_get_id (info))
+				e_ews_attachment_info_set_id (info, id);
+
 			async_data->items = g_slist_append (async_data->items, info);
+		}
 
 		info = NULL;
+		g_free (id);
 	}
 }
 
@@ -7889,18 +8869,19 @@ get_attachments_response_cb (ESoapResponse *response,
 	}
 }
 
-void
-e_ews_connection_get_attachments (EEwsConnection *cnc,
-                                  gint pri,
-                                  const gchar *uid,
-                                  const GSList *ids,
-                                  const gchar *cache,
-                                  gboolean include_mime,
-                                  ESoapProgressFn progress_fn,
-                                  gpointer progress_data,
-                                  GCancellable *cancellable,
-                                  GAsyncReadyCallback callback,
-                                  gpointer user_data)
+static void
+ews_connection_get_attachments_internal (EEwsConnection *cnc,
+					 gint pri,
+					 const gchar *uid,
+					 const GSList *ids,
+					 GHashTable *attachment_uids,
+					 const gchar *cache,
+					 gboolean include_mime,
+					 ESoapProgressFn progress_fn,
+					 gpointer progress_data,
+					 GCancellable *cancellable,
+					 GAsyncReadyCallback callback,
+					 gpointer user_data)
 {
 	ESoapMessage *msg;
 	GSimpleAsyncResult *simple;
@@ -7950,6 +8931,8 @@ e_ews_connection_get_attachments (EEwsConnection *cnc,
 	async_data = g_new0 (EwsAsyncData, 1);
 	async_data->directory = cache;
 	async_data->sync_state = (gchar *) uid;
+	if (attachment_uids)
+		async_data->attachment_uids = g_hash_table_ref (attachment_uids);
 	g_simple_async_result_set_op_res_gpointer (
 		simple, async_data, (GDestroyNotify) async_data_free);
 
@@ -7960,6 +8943,57 @@ e_ews_connection_get_attachments (EEwsConnection *cnc,
 	g_object_unref (simple);
 }
 
+void
+e_ews_connection_get_attachments (EEwsConnection *cnc,
+                                  gint pri,
+                                  const gchar *uid,
+                                  const GSList *ids,
+                                  const gchar *cache,
+                                  gboolean include_mime,
+                                  ESoapProgressFn progress_fn,
+                                  gpointer progress_data,
+                                  GCancellable *cancellable,
+                                  GAsyncReadyCallback callback,
+                                  gpointer user_data)
+{
+	g_return_if_fail (cnc != NULL);
+
+	ews_connection_get_attachments_internal (
+		cnc, pri, uid, ids, NULL, cache, include_mime,
+		progress_fn, progress_data, cancellable,
+		callback, user_data);
+}
+
+/* The same as e_ews_connection_get_attachments(), except the attachments can belong
+   to different components. The attachment_uids maps the attachment id to the component
+   uid, which is used to place the attachment file. Finish the call with
+   e_ews_connection_get_attachments_finish(). The returned EEwsAttachmentInfo-s have set
+   their attachment id, thus the caller can match them with the components. */
+void
+e_ews_connection_get_attachments_for_uids (EEwsConnection *cnc,
+					   gint pri,
+					   GHashTable *attachment_uids,
+					   const gchar *cache,
+					   gboolean include_mime,
+					   GCancellable *cancellable,
+					   GAsyncReadyCallback callback,
+					   gpointer user_data)
+{
+	GSList *ids;
+
+	g_return_if_fail (cnc != NULL);
+	g_return_if_fail (attachment_uids != NULL);
+
+	ids = g_hash_table_get_keys (attachment_uids);
+
+	ews_connection_get_attachments_internal (
+		cnc, pri, NULL, ids, attachment_uids, cache, include_mime,
+		NULL, NULL, cancellable,
+		callback, user_data);
+
+	g_slist_free (ids);
+}
+
 gboolean
 e_ews_connection_get_attachments_finish (EEwsConnection *cnc,
                                          GAsyncResult *result,
@@ -10713,6 +11747,264 @@ exit:
 	return tzd;
 }
 
+/* The GetServerTimeZones definitions are cached on the disk, per server and its version,
+   thus all the calendar, task and memo backends of the account share them, even when
+   running in different processes. The cache file contains the TimeZoneDefinition
+   elements as received from the server. The server version is too coarse to notice
+   updated definitions on the server, thus the file is dropped after EWS_TZ_CACHE_MAX_AGE
+   seconds since it had been created, which is stored in its root element. */
+#define EWS_TZ_CACHE_FORMAT_VERSION 1
+#define EWS_TZ_CACHE_MAX_AGE (7 * 24 * 60 * 60)
+
+typedef struct _EwsTzCache {
+	/* Of the file, when it had been read; the file is always replaced on write,
+	   thus the inode changes even when the mtime resolution is too coarse */
+	time_t mtime;
+	goffset size;
+	guint64 ino;
+	xmlDocPtr doc;
+	GHashTable *nodes; /* const gchar *id ~> xmlNodePtr, owned by 'doc' */
+} EwsTzCache;
+
+static GMutex tz_caches_lock;
+static GHashTable *tz_caches = NULL; /* gchar *filename ~> EwsTzCache * */
+
+static void
+ews_tz_cache_clear (EwsTzCache *tz_cache)
+{
+	g_hash_table_remove_all (tz_cache->nodes);
+	g_clear_pointer (&tz_cache->doc, xmlFreeDoc);
+	tz_cache->mtime = 0;
+	tz_cache->size = 0;
+	tz_cache->ino = 0;
+}
+
+static void
+ews_tz_cache_set_stat (EwsTzCache *tz_cache,
+		       const GStatBuf *st)
+{
+	tz_cache->mtime = st->st_mtime;
+	tz_cache->size = st->st_size;
+	tz_cache->ino = st->st_ino;
+}
+
+static gboolean
+ews_tz_cache_is_expired (xmlNodePtr root)
+{
+	xmlChar *value;
+	gint64 created, now;
+
+	value = xmlGetProp (root, BAD_CAST "Created");
+	created = value ? g_ascii_strtoll ((const gchar *) value, NULL, 10) : 0;
+	xmlFree (value);
+
+	now = (gint64) time (NULL);
+
+	return created <= 0 || created > now || created + EWS_TZ_CACHE_MAX_AGE < now;
+}
+
+/* Returns the Id attribute value, which is owned by the node's document */
+static const gchar *
+ews_tz_cache_get_node_id (xmlNodePtr node)
+{
+	xmlAttrPtr attr;
+
+	attr = xmlHasProp (node, BAD_CAST "Id");
+	if (!attr || !attr->children || !attr->children->content || !*attr->children->content)
+		return NULL;
+
+	return (const gchar *) attr->children->content;
+}
+
+static gchar *
+ews_tz_cache_dup_filename (EEwsConnection *cnc)
+{
+	gchar *checksum, *basename, *filename;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, cnc->priv->uri ? cnc->priv->uri : "", -1);
+	basename = g_strdup_printf ("%s-%d-v%d.xml", checksum, cnc->priv->version, EWS_TZ_CACHE_FORMAT_VERSION);
+	filename = g_build_filename (e_get_user_cache_dir (), "ews", "timezones", basename, NULL);
+
+	g_free (checksum);
+	g_free (basename);
+
+	return filename;
+}
+
+/* Returns the cache for the 'filename', re-reading the file when it changed since
+   it had been read the last time; the 'tz_caches_lock' should be held when calling this */
+static EwsTzCache *
+ews_tz_cache_get_locked (const gchar *filename)
+{
+	EwsTzCache *tz_cache;
+	GStatBuf st;
+	xmlNodePtr root, node;
+
+	if (!tz_caches)
+		tz_caches = g_hash_table_new (g_str_hash, g_str_equal);
+
+	tz_cache = g_hash_table_lookup (tz_caches, filename);
+	if (!tz_cache) {
+		tz_cache = g_new0 (EwsTzCache, 1);
+		tz_cache->nodes = g_hash_table_new (g_str_hash, g_str_equal);
+
+		g_hash_table_insert (tz_caches, g_strdup (filename), tz_cache);
+	}
+
+	if (g_stat (filename, &st) != 0) {
+		ews_tz_cache_clear (tz_cache);
+		return tz_cache;
+	}
+
+	if (tz_cache->doc &&
+	    tz_cache->mtime == st.st_mtime &&
+	    tz_cache->size == st.st_size &&
+	    tz_cache->ino == (guint64) st.st_ino) {
+		root = xmlDocGetRootElement (tz_cache->doc);
+
+		if (root && !ews_tz_cache_is_expired (root))
+			return tz_cache;
+	}
+
+	ews_tz_cache_clear (tz_cache);
+
+	tz_cache->doc = xmlReadFile (filename, NULL, XML_PARSE_NONET);
+	ews_tz_cache_set_stat (tz_cache, &st);
+
+	/* An expired cache is treated as an empty one, to be replaced on the next store */
+	root = tz_cache->doc ? xmlDocGetRootElement (tz_cache->doc) : NULL;
+	if (!root || g_strcmp0 ((const gchar *) root->name, "TimeZoneCache") != 0 ||
+	    ews_tz_cache_is_expired (root)) {
+		ews_tz_cache_clear (tz_cache);
+		return tz_cache;
+	}
+
+	for (node = root->children; node; node = node->next) {
+		const gchar *id;
+
+		if (node->type != XML_ELEMENT_NODE || g_strcmp0 ((const gchar *) node->name, "TimeZoneDefinition") != 0)
+			continue;
+
+		id = ews_tz_cache_get_node_id (node);
+		if (id && !g_hash_table_contains (tz_cache->nodes, id))
+			g_hash_table_insert (tz_cache->nodes, (gpointer) id, node);
+	}
+
+	return tz_cache;
+}
+
+/* Returns the definitions for all the 'msdn_locations' in the same order,
+   or NULL, when any of them is not in the cache */
+static GSList * /* EEwsCalendarTimeZoneDefinition * */
+ews_tz_cache_lookup (const gchar *filename,
+		     GSList *msdn_locations)
+{
+	EwsTzCache *tz_cache;
+	GSList *tzds = NULL, *link;
+
+	if (!msdn_locations)
+		return NULL;
+
+	g_mutex_lock (&tz_caches_lock);
+
+	tz_cache = ews_tz_cache_get_locked (filename);
+
+	for (link = msdn_locations; link; link = g_slist_next (link)) {
+		EEwsCalendarTimeZoneDefinition *tzd = NULL;
+		xmlNodePtr node;
+
+		node = link->data ? g_hash_table_lookup (tz_cache->nodes, link->data) : NULL;
+		if (node)
+			tzd = ews_get_time_zone_definition (node);
+
+		if (!tzd) {
+			g_slist_free_full (tzds, (GDestroyNotify) e_ews_calendar_time_zone_definition_free);
+			tzds = NULL;
+			break;
+		}
+
+		tzds = g_slist_prepend (tzds, tzd);
+	}
+
+	g_mutex_unlock (&tz_caches_lock);
+
+	return g_slist_reverse (tzds);
+}
+
+/* Adds the TimeZoneDefinition elements from the server response into the cache */
+static void
+ews_tz_cache_store (const gchar *filename,
+		    GSList *tzd_nodes) /* xmlNodePtr */
+{
+	EwsTzCache *tz_cache;
+	xmlNodePtr root;
+	GSList *link;
+	gboolean changed = FALSE;
+
+	g_mutex_lock (&tz_caches_lock);
+
+	/* This also picks up what other processes added meanwhile */
+	tz_cache = ews_tz_cache_get_locked (filename);
+
+	if (!tz_cache->doc) {
+		gchar *created;
+
+		tz_cache->doc = xmlNewDoc (BAD_CAST "1.0");
+		root = xmlNewDocNode (tz_cache->doc, NULL, BAD_CAST "TimeZoneCache", NULL);
+		xmlDocSetRootElement (tz_cache->doc, root);
+
+		created = g_strdup_printf ("%" G_GINT64_FORMAT, (gint64) time (NULL));
+		xmlSetProp (root, BAD_CAST "Created", BAD_CAST created);
+		g_free (created);
+	} else {
+		root = xmlDocGetRootElement (tz_cache->doc);
+	}
+
+	for (link = tzd_nodes; link; link = g_slist_next (link)) {
+		xmlNodePtr node;
+		const gchar *id;
+
+		id = ews_tz_cache_get_node_id (link->data);
+		if (!id || g_hash_table_contains (tz_cache->nodes, id))
+			continue;
+
+		node = xmlDocCopyNode (link->data, tz_cache->doc, 1);
+		if (!node)
+			continue;
+
+		xmlAddChild (root, node);
+
+		id = ews_tz_cache_get_node_id (node);
+		if (id)
+			g_hash_table_insert (tz_cache->nodes, (gpointer) id, node);
+
+		changed = TRUE;
+	}
+
+	if (changed) {
+		xmlChar *contents = NULL;
+		gchar *dirname;
+		gint length = 0;
+
+		dirname = g_path_get_dirname (filename);
+		g_mkdir_with_parents (dirname, 0700);
+		g_free (dirname);
+
+		xmlDocDumpMemory (tz_cache->doc, &contents, &length);
+
+		if (contents && g_file_set_contents (filename, (const gchar *) contents, length, NULL)) {
+			GStatBuf st;
+
+			if (g_stat (filename, &st) == 0)
+				ews_tz_cache_set_stat (tz_cache, &st);
+		}
+
+		xmlFree (contents);
+	}
+
+	g_mutex_unlock (&tz_caches_lock);
+}
+
 static void
 get_server_time_zones_response_cb (ESoapResponse *response,
 				   GSimpleAsyncResult *simple)
@@ -10720,6 +12012,7 @@ get_server_time_zones_response_cb (ESoapResponse *response,
 	EwsAsyncData *async_data;
 	ESoapParameter *param;
 	ESoapParameter *subparam;
+	GSList *tzd_nodes = NULL; /* ESoapParameter * */
 	GError *error = NULL;
 
 	async_data = g_simple_async_result_get_op_res_gpointer (simple);
@@ -10744,6 +12037,7 @@ get_server_time_zones_response_cb (ESoapResponse *response,
 
 		if (!ews_get_response_status (subparam, &error)) {
 			g_simple_async_result_take_error (simple, error);
+			g_slist_free (tzd_nodes);
 			return;
 		}
 
@@ -10751,14 +12045,18 @@ get_server_time_zones_response_cb (ESoapResponse *response,
 			ESoapParameter *node, *node2;
 
 			node = e_soap_parameter_get_first_child_by_name (subparam, "TimeZoneDefinitions");
-			if (node != NULL) {
-				node2 = e_soap_parameter_get_first_child_by_name (node, "TimeZoneDefinition");
-				if (node2 != NULL) {
-					EEwsCalendarTimeZoneDefinition *tzd;
-
-					tzd = ews_get_time_zone_definition (node2);
-					if (tzd != NULL)
-						async_data->tzds = g_slist_prepend (async_data->tzds, tzd);
+			for (node2 = node ? e_soap_parameter_get_first_child (node) : NULL;
+			     node2 != NULL;
+			     node2 = e_soap_parameter_get_next_child (node2)) {
+				EEwsCalendarTimeZoneDefinition *tzd;
+
+				if (!E_EWS_CONNECTION_UTILS_CHECK_ELEMENT ((const gchar *) node2->name, "TimeZoneDefinition"))
+					continue;
+
+				tzd = ews_get_time_zone_definition (node2);
+				if (tzd != NULL) {
+					async_data->tzds = g_slist_prepend (async_data->tzds, tzd);
+					tzd_nodes = g_slist_prepend (tzd_nodes, node2);
 				}
 			}
 		}
@@ -10767,6 +12065,12 @@ get_server_time_zones_response_cb (ESoapResponse *response,
 	}
 
 	async_data->tzds = g_slist_reverse (async_data->tzds);
+
+	/* The 'custom_data' holds the cache file name */
+	if (tzd_nodes && async_data->custom_data)
+		ews_tz_cache_store (async_data->custom_data, tzd_nodes);
+
+	g_slist_free (tzd_nodes);
 }
 
 void
@@ -10800,6 +12104,15 @@ e_ews_connection_get_server_time_zones (EEwsConnection *cnc,
 		return;
 	}
 
+	async_data->custom_data = ews_tz_cache_dup_filename (cnc);
+	async_data->tzds = ews_tz_cache_lookup (async_data->custom_data, msdn_locations);
+
+	if (async_data->tzds) {
+		g_simple_async_result_complete_in_idle (simple);
+		g_object_unref (simple);
+		return;
+	}
+
 	msg = e_ews_message_new_with_header (
 		cnc->priv->settings,
 		cnc->priv->uri,
@@ -85,6 +85,10 @@ typedef gboolean(*EEwsRequestCreationCallback)	(ESoapMessage *msg,
 						 GError **error);
 typedef void	(*EwsProgressFn)		(gpointer object,
 						 gint percent);
+typedef gboolean (*EwsOalChunkFn)		(gconstpointer data,
+						 gsize data_len,
+						 gpointer user_data,
+						 GError **error);
 typedef void	(*EEwsResponseCallback)		(ESoapResponse *response,
 						 GSimpleAsyncResult *simple);
 
@@ -562,6 +566,7 @@ void		e_ews_connection_find_folder_items
 						 const gchar *props,
 						 const EEwsAdditionalProps *add_props,
 						 EwsSortOrder *sort_order,
+						 guint max_entries,
 						 const gchar *query,
 						 GPtrArray *only_ids, /* element-type utf8 */
 						 EEwsFolderType type,
@@ -582,6 +587,7 @@ gboolean	e_ews_connection_find_folder_items_sync
 						 const gchar *default_props,
 						 const EEwsAdditionalProps *add_props,
 						 EwsSortOrder *sort_order,
+						 guint max_entries,
 						 const gchar *query,
 						 GPtrArray *only_ids, /* element-type utf8 */
 						 EEwsFolderType type,
@@ -591,6 +597,30 @@ gboolean	e_ews_connection_find_folder_items_sync
 						 GCancellable *cancellable,
 						 GError **error);
 
+void		e_ews_connection_find_calendar_view_items
+						(EEwsConnection *cnc,
+						 gint pri,
+						 EwsFolderId *fid,
+						 const EEwsAdditionalProps *add_props,
+						 time_t start,
+						 time_t end,
+						 guint max_entries,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
+gboolean	e_ews_connection_find_calendar_view_items_sync
+						(EEwsConnection *cnc,
+						 gint pri,
+						 EwsFolderId *fid,
+						 const EEwsAdditionalProps *add_props,
+						 time_t start,
+						 time_t end,
+						 guint max_entries,
+						 gboolean *includes_last_item,
+						 GSList **items,
+						 GCancellable *cancellable,
+						 GError **error);
+
 EEwsServerVersion
 		e_ews_connection_get_server_version
 						(EEwsConnection *cnc);
@@ -635,6 +665,24 @@ gboolean	e_ews_connection_get_items_sync	(EEwsConnection *cnc,
 						 gpointer progress_data,
 						 GCancellable *cancellable,
 						 GError **error);
+void		e_ews_connection_get_recurring_masters
+						(EEwsConnection *cnc,
+						 gint pri,
+						 const GSList *occurrence_ids,
+						 const gchar *default_props,
+						 const EEwsAdditionalProps *add_props,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
+gboolean	e_ews_connection_get_recurring_masters_sync
+						(EEwsConnection *cnc,
+						 gint pri,
+						 const GSList *occurrence_ids,
+						 const gchar *default_props,
+						 const EEwsAdditionalProps *add_props,
+						 GSList **items,
+						 GCancellable *cancellable,
+						 GError **error);
 
 void		e_ews_connection_delete_items	(EEwsConnection *cnc,
 						 gint pri,
@@ -829,6 +877,17 @@ gboolean	e_ews_connection_ex_to_smtp_sync
 						 gchar **smtp_address,
 						 GCancellable *cancellable,
 						 GError **error);
+gboolean	e_ews_connection_get_cached_smtp_address
+						(EEwsConnection *cnc,
+						 const gchar *ex_address,
+						 gchar **out_smtp_address);
+gboolean	e_ews_connection_resolve_mailbox_cached_sync
+						(EEwsConnection *cnc,
+						 gint pri,
+						 const gchar *name,
+						 EwsMailbox **out_mailbox,
+						 GCancellable *cancellable,
+						 GError **error);
 
 void		e_ews_connection_create_folder	(EEwsConnection *cnc,
 						 gint pri,
@@ -875,6 +934,18 @@ gboolean	e_ews_connection_delete_folder_sync
 						 const gchar *delete_type,
 						 GCancellable *cancellable,
 						 GError **error);
+void		e_ews_connection_delete_folders	(EEwsConnection *cnc,
+						 gint pri,
+						 const GSList *folder_ids,
+						 const gchar *delete_type,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
+gboolean	e_ews_connection_delete_folders_finish
+						(EEwsConnection *cnc,
+						 GAsyncResult *result,
+						 GHashTable **out_folder_errors,
+						 GError **error);
 
 void		e_ews_connection_empty_folder	(EEwsConnection *cnc,
 						 gint pri,
@@ -1067,6 +1138,15 @@ gboolean	e_ews_connection_get_attachments_sync
 						 gpointer progress_data,
 						 GCancellable *cancellable,
 						 GError **error);
+void		e_ews_connection_get_attachments_for_uids
+						(EEwsConnection *cnc,
+						 gint pri,
+						 GHashTable *attachment_uids,
+						 const gchar *cache,
+						 gboolean include_mime,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
 
 gboolean	e_ews_connection_get_oal_list_sync
 						(EEwsConnection *cnc,
@@ -1144,6 +1224,27 @@ gboolean	e_ews_connection_download_oal_file_finish
 						(EEwsConnection *cnc,
 						 GAsyncResult *result,
 						 GError **error);
+gboolean	e_ews_connection_download_oal_file_stream_sync
+						(EEwsConnection *cnc,
+						 EwsOalChunkFn chunk_fn,
+						 gpointer chunk_data,
+						 EwsProgressFn progress_fn,
+						 gpointer progress_data,
+						 GCancellable *cancellable,
+						 GError **error);
+void		e_ews_connection_download_oal_file_stream
+						(EEwsConnection *cnc,
+						 EwsOalChunkFn chunk_fn,
+						 gpointer chunk_data,
+						 EwsProgressFn progress_fn,
+						 gpointer progress_data,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback cb,
+						 gpointer user_data);
+gboolean	e_ews_connection_download_oal_file_stream_finish
+						(EEwsConnection *cnc,
+						 GAsyncResult *result,
+						 GError **error);
 
 void		e_ews_connection_get_delegate	(EEwsConnection *cnc,
 						 gint pri,
@@ -127,6 +127,26 @@ e_ews_message_start_set_item_field (ESoapMessage *msg,
 	g_free (fielduri);
 }
 
+/* Closed with e_ews_message_end_set_item_field(); the content is appended
+   to the existing value, which is supported only by some of the fields,
+   like the body or the attendee and recipient lists */
+void
+e_ews_message_start_append_to_item_field (ESoapMessage *msg,
+                                          const gchar *name,
+                                          const gchar *fielduri_prefix,
+                                          const gchar *field_kind)
+{
+	gchar * fielduri = NULL;
+	fielduri = g_strconcat (fielduri_prefix, ":", name, NULL);
+
+	e_soap_message_start_element (msg, "AppendToItemField", NULL, NULL);
+	e_ews_message_write_string_parameter_with_attribute (
+		msg, "FieldURI", NULL, NULL, "FieldURI", fielduri);
+	e_soap_message_start_element (msg, field_kind, NULL, NULL);
+
+	g_free (fielduri);
+}
+
 void
 e_ews_message_start_set_indexed_item_field (ESoapMessage *msg,
                                             const gchar *name,
@@ -43,6 +43,8 @@ void e_ews_message_end_item_change (ESoapMessage *msg);
 
 void e_ews_message_start_set_item_field (ESoapMessage *msg, const gchar *name, const gchar * fielduri_prefix, const gchar *field_kind);
 
+void e_ews_message_start_append_to_item_field (ESoapMessage *msg, const gchar *name, const gchar *fielduri_prefix, const gchar *field_kind);
+
 void e_ews_message_start_set_indexed_item_field (ESoapMessage *msg, const gchar *name, const gchar * fielduri_prefix, const gchar *field_kind, const gchar *field_index, gboolean delete_field);
 
 void e_ews_message_end_set_indexed_item_field (ESoapMessage *msg, gboolean delete_field);
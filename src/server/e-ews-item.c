@@ -131,6 +131,8 @@ struct _EEwsItemPrivate {
 	gchar *contact_photo_id;
 	gchar *iana_start_time_zone;
 	gchar *iana_end_time_zone;
+	gchar *item_class;
+	gboolean body_is_html;
 
 	GSList *to_recipients;
 	GSList *cc_recipients;
@@ -143,8 +145,11 @@ struct _EEwsItemPrivate {
 	gboolean is_response_requested;
 	GSList *modified_occurrences;
 	GSList *attachments_ids;
+	GSList *attachments_descriptions; /* EEwsAttachmentDescription * */
 	gchar *my_response_type;
 	GSList *attendees;
+	time_t calendar_start;
+	gchar *calendar_item_type;
 
 	EwsId *calendar_item_accept_id;
 
@@ -218,6 +223,7 @@ e_ews_item_dispose (GObject *object)
 	g_clear_pointer (&priv->contact_photo_id, g_free);
 	g_clear_pointer (&priv->iana_start_time_zone, g_free);
 	g_clear_pointer (&priv->iana_end_time_zone, g_free);
+	g_clear_pointer (&priv->item_class, g_free);
 
 	g_slist_free_full (priv->to_recipients, (GDestroyNotify) e_ews_mailbox_free);
 	priv->to_recipients = NULL;
@@ -234,7 +240,11 @@ e_ews_item_dispose (GObject *object)
 	g_slist_free_full (priv->attachments_ids, g_free);
 	priv->attachments_ids = NULL;
 
+	g_slist_free_full (priv->attachments_descriptions, (GDestroyNotify) e_ews_attachment_description_free);
+	priv->attachments_descriptions = NULL;
+
 	g_clear_pointer (&priv->my_response_type, g_free);
+	g_clear_pointer (&priv->calendar_item_type, g_free);
 
 	g_slist_free_full (priv->attendees, (GDestroyNotify) ews_item_free_attendee);
 	priv->attendees = NULL;
@@ -604,9 +614,10 @@ process_attachments_list (EEwsItemPrivate *priv,
 {
 	ESoapParameter *subparam, *subparam1;
 
-	GSList *ids = NULL;
+	GSList *ids = NULL, *descriptions = NULL;
 
 	for (subparam = e_soap_parameter_get_first_child (param); subparam != NULL; subparam = e_soap_parameter_get_next_child (subparam)) {
+		EEwsAttachmentDescription *description;
 		gchar *id;
 
 		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "AttachmentId");
@@ -624,9 +635,44 @@ process_attachments_list (EEwsItemPrivate *priv,
 		}
 
 		ids = g_slist_append (ids, id);
+
+		/* The Attachments of the GetItem describe the attachments,
+		   the content itself is returned only by the GetAttachment */
+		description = g_new0 (EEwsAttachmentDescription, 1);
+		description->id = g_strdup (id);
+		description->is_item = g_strcmp0 (e_soap_parameter_get_name (subparam), "ItemAttachment") == 0;
+
+		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "Name");
+		if (subparam1)
+			description->name = e_soap_parameter_get_string_value (subparam1);
+
+		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "ContentType");
+		if (subparam1)
+			description->content_type = e_soap_parameter_get_string_value (subparam1);
+
+		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "ContentId");
+		if (subparam1)
+			description->content_id = e_soap_parameter_get_string_value (subparam1);
+
+		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "Size");
+		if (subparam1) {
+			gchar *value = e_soap_parameter_get_string_value (subparam1);
+			description->size = value ? g_ascii_strtoull (value, NULL, 10) : 0;
+			g_free (value);
+		}
+
+		subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "IsInline");
+		if (subparam1) {
+			gchar *value = e_soap_parameter_get_string_value (subparam1);
+			description->is_inline = g_strcmp0 (value, "true") == 0;
+			g_free (value);
+		}
+
+		descriptions = g_slist_prepend (descriptions, description);
 	}
 
 	priv->attachments_ids = ids;
+	priv->attachments_descriptions = g_slist_reverse (descriptions);
 	return;
 }
 
@@ -1528,6 +1574,9 @@ e_ews_item_set_from_soap_parameter (EEwsItem *item,
 			priv->item_id->change_key = e_soap_parameter_get_property (subparam, "ChangeKey");
 		} else if (!g_ascii_strcasecmp (name, "Subject")) {
 			priv->subject = e_soap_parameter_get_string_value (subparam);
+		} else if (!g_ascii_strcasecmp (name, "ItemClass")) {
+			g_free (priv->item_class);
+			priv->item_class = e_soap_parameter_get_string_value (subparam);
 		} else if (!g_ascii_strcasecmp (name, "InternetMessageHeaders")) {
 			for (subparam1 = e_soap_parameter_get_first_child_by_name (subparam, "InternetMessageHeader");
 			     subparam1;
@@ -1638,6 +1687,11 @@ e_ews_item_set_from_soap_parameter (EEwsItem *item,
 		} else if (!g_ascii_strcasecmp (name, "MyResponseType")) {
 			g_free (priv->my_response_type);
 			priv->my_response_type = e_soap_parameter_get_string_value (subparam);
+		} else if (!g_ascii_strcasecmp (name, "Start")) {
+			priv->calendar_start = ews_item_parse_date (subparam);
+		} else if (!g_ascii_strcasecmp (name, "CalendarItemType")) {
+			g_free (priv->calendar_item_type);
+			priv->calendar_item_type = e_soap_parameter_get_string_value (subparam);
 		} else if (!g_ascii_strcasecmp (name, "RequiredAttendees")) {
 			process_attendees (priv, subparam, "Required");
 		} else if (!g_ascii_strcasecmp (name, "OptionalAttendees")) {
@@ -1653,7 +1707,12 @@ e_ews_item_set_from_soap_parameter (EEwsItem *item,
 		} else if (!g_ascii_strcasecmp (name, "EndTimeZone")) {
 			priv->end_timezone = e_soap_parameter_get_property (subparam, "Id");
 		} else if (!g_ascii_strcasecmp (name, "Body")) {
+			gchar *body_type = e_soap_parameter_get_property (subparam, "BodyType");
+
 			priv->body = e_soap_parameter_get_string_value (subparam);
+			priv->body_is_html = g_strcmp0 (body_type, "HTML") == 0;
+
+			g_free (body_type);
 		}
 	}
 
@@ -1814,6 +1873,25 @@ e_ews_item_get_uid (EEwsItem *item)
 	return (const gchar *) item->priv->uid;
 }
 
+/* The calendar:Start of a calendar item, when it had been requested */
+time_t
+e_ews_item_get_start (EEwsItem *item)
+{
+	g_return_val_if_fail (E_IS_EWS_ITEM (item), (time_t) 0);
+
+	return item->priv->calendar_start;
+}
+
+/* The calendar:CalendarItemType of a calendar item, when it had been requested;
+   one of "Single", "Occurrence", "Exception" and "RecurringMaster" */
+const gchar *
+e_ews_item_get_calendar_item_type (EEwsItem *item)
+{
+	g_return_val_if_fail (E_IS_EWS_ITEM (item), NULL);
+
+	return item->priv->calendar_item_type;
+}
+
 const gchar *
 e_ews_item_get_in_replyto (EEwsItem *item)
 {
@@ -2086,6 +2164,27 @@ e_ews_item_get_attachments_ids (EEwsItem *item)
 	return item->priv->attachments_ids;
 }
 
+const GSList *
+e_ews_item_get_attachments_descriptions (EEwsItem *item)
+{
+	g_return_val_if_fail (E_IS_EWS_ITEM (item), NULL);
+
+	return item->priv->attachments_descriptions;
+}
+
+void
+e_ews_attachment_description_free (EEwsAttachmentDescription *description)
+{
+	if (!description)
+		return;
+
+	g_free (description->id);
+	g_free (description->name);
+	g_free (description->content_type);
+	g_free (description->content_id);
+	g_free (description);
+}
+
 const gchar *
 e_ews_item_get_extended_tag (EEwsItem *item,
 			     guint32 prop_tag)
@@ -2274,10 +2373,9 @@ e_ews_dump_file_attachment_from_soap_parameter (ESoapParameter *param,
 		}
 	}
 
-	/* Make sure we have needed data */
-	if (!content || !name) {
+	/* Make sure we have needed data; the Name is optional */
+	if (!content) {
 		g_free (name);
-		g_free (content);
 		return NULL;
 	}
 
@@ -2294,6 +2392,12 @@ e_ews_dump_file_attachment_from_soap_parameter (ESoapParameter *param,
 			g_warning ("Failed create directory to place file in [%s]: %s\n", dirname, g_strerror (errno));
 		}
 
+		/* An attachment without a name keeps the name of the temporary file */
+		if (!name || !*name) {
+			g_free (name);
+			name = g_path_get_basename (tmpfilename);
+		}
+
 		filename = g_build_filename (dirname, name, NULL);
 		if (g_rename (tmpfilename, filename) != 0) {
 			g_warning ("Failed to move attachment cache file [%s -> %s]: %s\n",
@@ -2776,6 +2880,23 @@ e_ews_item_get_body (EEwsItem *item)
 	return item->priv->task_fields ? item->priv->task_fields->body : NULL;
 }
 
+/* Whether the body returned by e_ews_item_get_body() is HTML, not plain text */
+gboolean
+e_ews_item_get_body_is_html (EEwsItem *item)
+{
+	g_return_val_if_fail (E_IS_EWS_ITEM (item), FALSE);
+
+	return item->priv->body && item->priv->body_is_html;
+}
+
+const gchar *
+e_ews_item_get_item_class (EEwsItem *item)
+{
+	g_return_val_if_fail (E_IS_EWS_ITEM (item), NULL);
+
+	return item->priv->item_class;
+}
+
 const gchar *
 e_ews_item_get_owner (EEwsItem *item)
 {
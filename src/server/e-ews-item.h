@@ -132,6 +132,16 @@ typedef struct {
 	gchar *id;
 } EEwsAttachmentInfo;
 
+typedef struct {
+	gchar *id;
+	gchar *name;
+	gchar *content_type;
+	gchar *content_id;
+	guint64 size; /* 0, when not known */
+	gboolean is_inline;
+	gboolean is_item; /* an attached item, not a file */
+} EEwsAttachmentDescription;
+
 typedef enum {
 	E_EWS_PERMISSION_BIT_FREE_BUSY_DETAILED	= 0x00001000,
 	E_EWS_PERMISSION_BIT_FREE_BUSY_SIMPLE	= 0x00000800,
@@ -271,6 +281,9 @@ const EwsId *	e_ews_item_get_attachment_id	(EEwsItem *item);
 gsize		e_ews_item_get_size		(EEwsItem *item);
 const gchar *	e_ews_item_get_msg_id		(EEwsItem *item);
 const gchar *	e_ews_item_get_uid		(EEwsItem *item);
+time_t		e_ews_item_get_start		(EEwsItem *item);
+const gchar *	e_ews_item_get_calendar_item_type
+						(EEwsItem *item);
 const gchar *	e_ews_item_get_in_replyto	(EEwsItem *item);
 const gchar *	e_ews_item_get_references	(EEwsItem *item);
 const gchar *	e_ews_item_get_date_header	(EEwsItem *item);
@@ -318,6 +331,10 @@ const GSList *	e_ews_item_get_modified_occurrences
 gchar *		e_ews_embed_attachment_id_in_uri (const gchar *olduri, const gchar *attach_id);
 GSList *	e_ews_item_get_attachments_ids
 						(EEwsItem *item);
+const GSList *	e_ews_item_get_attachments_descriptions
+						(EEwsItem *item);
+void		e_ews_attachment_description_free
+						(EEwsAttachmentDescription *description);
 const gchar *	e_ews_item_get_extended_tag	(EEwsItem *item,
 						 guint32 prop_tag);
 const gchar *	e_ews_item_get_extended_distinguished_tag
@@ -436,6 +453,8 @@ const gchar *	e_ews_item_get_status		(EEwsItem *item);
 const gchar *	e_ews_item_get_percent_complete (EEwsItem *item);
 const gchar *	e_ews_item_get_sensitivity	(EEwsItem *item);
 const gchar *	e_ews_item_get_body		(EEwsItem *item);
+gboolean	e_ews_item_get_body_is_html	(EEwsItem *item);
+const gchar *	e_ews_item_get_item_class	(EEwsItem *item);
 const gchar *	e_ews_item_get_owner		(EEwsItem *item);
 const gchar *	e_ews_item_get_delegator	(EEwsItem *item);
 time_t		e_ews_item_get_due_date		(EEwsItem *item);
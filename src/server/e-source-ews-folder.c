@@ -35,6 +35,8 @@ struct _ESourceEwsFolderPrivate {
 	guint freebusy_weeks_after;
 	gboolean use_primary_address;
 	gboolean fetch_gal_photos;
+	gboolean gal_lazy_contacts;
+	guint sync_window_weeks;
 };
 
 enum {
@@ -48,7 +50,9 @@ enum {
 	PROP_FREEBUSY_WEEKS_AFTER,
 	PROP_PUBLIC,
 	PROP_USE_PRIMARY_ADDRESS,
-	PROP_FETCH_GAL_PHOTOS
+	PROP_FETCH_GAL_PHOTOS,
+	PROP_GAL_LAZY_CONTACTS,
+	PROP_SYNC_WINDOW_WEEKS
 };
 
 G_DEFINE_TYPE (
@@ -122,6 +126,18 @@ source_ews_folder_set_property (GObject *object,
 				E_SOURCE_EWS_FOLDER (object),
 				g_value_get_boolean (value));
 			return;
+
+		case PROP_GAL_LAZY_CONTACTS:
+			e_source_ews_folder_set_gal_lazy_contacts (
+				E_SOURCE_EWS_FOLDER (object),
+				g_value_get_boolean (value));
+			return;
+
+		case PROP_SYNC_WINDOW_WEEKS:
+			e_source_ews_folder_set_sync_window_weeks (
+				E_SOURCE_EWS_FOLDER (object),
+				g_value_get_uint (value));
+			return;
 	}
 
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -203,6 +219,20 @@ source_ews_folder_get_property (GObject *object,
 				e_source_ews_folder_get_fetch_gal_photos (
 				E_SOURCE_EWS_FOLDER (object)));
 			return;
+
+		case PROP_GAL_LAZY_CONTACTS:
+			g_value_set_boolean (
+				value,
+				e_source_ews_folder_get_gal_lazy_contacts (
+				E_SOURCE_EWS_FOLDER (object)));
+			return;
+
+		case PROP_SYNC_WINDOW_WEEKS:
+			g_value_set_uint (
+				value,
+				e_source_ews_folder_get_sync_window_weeks (
+				E_SOURCE_EWS_FOLDER (object)));
+			return;
 	}
 
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -369,6 +399,32 @@ e_source_ews_folder_class_init (ESourceEwsFolderClass *class)
 			G_PARAM_CONSTRUCT |
 			G_PARAM_STATIC_STRINGS |
 			E_SOURCE_PARAM_SETTING));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_GAL_LAZY_CONTACTS,
+		g_param_spec_boolean (
+			"gal-lazy-contacts",
+			"GAL Lazy Contacts",
+			"Whether offline GAL should store only an index and decode contacts on demand",
+			FALSE,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT |
+			G_PARAM_STATIC_STRINGS |
+			E_SOURCE_PARAM_SETTING));
+
+	g_object_class_install_property (
+		object_class,
+		PROP_SYNC_WINDOW_WEEKS,
+		g_param_spec_uint (
+			"sync-window-weeks",
+			"SyncWindowWeeks",
+			"How many weeks around today to download first, before the rest of the calendar; 0 to download the whole calendar at once",
+			0, 104, 0,
+			G_PARAM_READWRITE |
+			G_PARAM_CONSTRUCT |
+			G_PARAM_STATIC_STRINGS |
+			E_SOURCE_PARAM_SETTING));
 }
 
 static void
@@ -697,3 +753,47 @@ e_source_ews_folder_set_fetch_gal_photos (ESourceEwsFolder *extension,
 
 	g_object_notify (G_OBJECT (extension), "fetch-gal-photos");
 }
+
+gboolean
+e_source_ews_folder_get_gal_lazy_contacts (ESourceEwsFolder *extension)
+{
+	g_return_val_if_fail (E_IS_SOURCE_EWS_FOLDER (extension), FALSE);
+
+	return extension->priv->gal_lazy_contacts;
+}
+
+void
+e_source_ews_folder_set_gal_lazy_contacts (ESourceEwsFolder *extension,
+					   gboolean gal_lazy_contacts)
+{
+	g_return_if_fail (E_IS_SOURCE_EWS_FOLDER (extension));
+
+	if ((extension->priv->gal_lazy_contacts ? 1 : 0) == (gal_lazy_contacts ? 1 : 0))
+		return;
+
+	extension->priv->gal_lazy_contacts = gal_lazy_contacts;
+
+	g_object_notify (G_OBJECT (extension), "gal-lazy-contacts");
+}
+
+guint
+e_source_ews_folder_get_sync_window_weeks (ESourceEwsFolder *extension)
+{
+	g_return_val_if_fail (E_IS_SOURCE_EWS_FOLDER (extension), 0);
+
+	return extension->priv->sync_window_weeks;
+}
+
+void
+e_source_ews_folder_set_sync_window_weeks (ESourceEwsFolder *extension,
+					   guint sync_window_weeks)
+{
+	g_return_if_fail (E_IS_SOURCE_EWS_FOLDER (extension));
+
+	if (extension->priv->sync_window_weeks == sync_window_weeks)
+		return;
+
+	extension->priv->sync_window_weeks = sync_window_weeks;
+
+	g_object_notify (G_OBJECT (extension), "sync-window-weeks");
+}
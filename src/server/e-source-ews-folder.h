@@ -114,6 +114,16 @@ gboolean	e_source_ews_folder_get_fetch_gal_photos
 void		e_source_ews_folder_set_fetch_gal_photos
 						(ESourceEwsFolder *extension,
 						 gboolean fetch_gal_photos);
+gboolean	e_source_ews_folder_get_gal_lazy_contacts
+						(ESourceEwsFolder *extension);
+void		e_source_ews_folder_set_gal_lazy_contacts
+						(ESourceEwsFolder *extension,
+						 gboolean gal_lazy_contacts);
+guint		e_source_ews_folder_get_sync_window_weeks
+						(ESourceEwsFolder *extension);
+void		e_source_ews_folder_set_sync_window_weeks
+						(ESourceEwsFolder *extension,
+						 guint sync_window_weeks);
 
 G_END_DECLS
 
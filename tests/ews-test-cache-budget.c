@@ -0,0 +1,486 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
+
+#include "camel/camel-ews-cache-budget.h"
+
+/* The number of accesses of the synthetic load */
+#define N_ACCESSES 10000
+
+CamelEwsCacheBudget * (* budget_new) (const gchar *filename);
+void (* budget_free) (CamelEwsCacheBudget *budget);
+gboolean (* budget_save) (CamelEwsCacheBudget *budget, GError **error);
+gboolean (* budget_get_seeded) (CamelEwsCacheBudget *budget);
+void (* budget_seed_from_dir) (CamelEwsCacheBudget *budget, const gchar *folders_dir);
+void (* budget_set_limit) (CamelEwsCacheBudget *budget, guint64 limit);
+guint64 (* budget_get_total_size) (CamelEwsCacheBudget *budget);
+guint (* budget_get_n_entries) (CamelEwsCacheBudget *budget);
+gboolean (* budget_touch) (CamelEwsCacheBudget *budget, const gchar *folder_name, const gchar *key, guint64 size);
+void (* budget_remove) (CamelEwsCacheBudget *budget, const gchar *folder_name, const gchar *key);
+gboolean (* budget_get_folder_pinned) (CamelEwsCacheBudget *budget, const gchar *folder_name);
+void (* budget_set_folder_pinned) (CamelEwsCacheBudget *budget, const gchar *folder_name, gboolean pinned);
+guint (* budget_evict) (CamelEwsCacheBudget *budget, CamelEwsCacheBudgetEvictFunc func, gpointer user_data);
+
+static const struct _symbols {
+	const gchar *name;
+	gpointer *ptr;
+} symbols[] = {
+	{ "camel_ews_cache_budget_new", (gpointer *) &budget_new },
+	{ "camel_ews_cache_budget_free", (gpointer *) &budget_free },
+	{ "camel_ews_cache_budget_save", (gpointer *) &budget_save },
+	{ "camel_ews_cache_budget_get_seeded", (gpointer *) &budget_get_seeded },
+	{ "camel_ews_cache_budget_seed_from_dir", (gpointer *) &budget_seed_from_dir },
+	{ "camel_ews_cache_budget_set_limit", (gpointer *) &budget_set_limit },
+	{ "camel_ews_cache_budget_get_total_size", (gpointer *) &budget_get_total_size },
+	{ "camel_ews_cache_budget_get_n_entries", (gpointer *) &budget_get_n_entries },
+	{ "camel_ews_cache_budget_touch", (gpointer *) &budget_touch },
+	{ "camel_ews_cache_budget_remove", (gpointer *) &budget_remove },
+	{ "camel_ews_cache_budget_get_folder_pinned", (gpointer *) &budget_get_folder_pinned },
+	{ "camel_ews_cache_budget_set_folder_pinned", (gpointer *) &budget_set_folder_pinned },
+	{ "camel_ews_cache_budget_evict", (gpointer *) &budget_evict }
+};
+
+typedef struct _Fixture {
+	gchar *tmp_dir;
+	gchar *filename;
+	CamelEwsCacheBudget *budget;
+} Fixture;
+
+static void
+fixture_setup (Fixture *fixture,
+	       gconstpointer user_data)
+{
+	fixture->tmp_dir = g_dir_make_tmp ("ews-test-cache-budget-XXXXXX", NULL);
+	g_assert_nonnull (fixture->tmp_dir);
+
+	fixture->filename = g_build_filename (fixture->tmp_dir, "message-cache-budget", NULL);
+	fixture->budget = budget_new (fixture->filename);
+	g_assert_nonnull (fixture->budget);
+}
+
+static void
+remove_recursively (const gchar *path)
+{
+	if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+		GDir *dir;
+		const gchar *name;
+
+		dir = g_dir_open (path, 0, NULL);
+
+		while (dir && (name = g_dir_read_name (dir)) != NULL) {
+			gchar *subpath = g_build_filename (path, name, NULL);
+
+			remove_recursively (subpath);
+
+			g_free (subpath);
+		}
+
+		if (dir)
+			g_dir_close (dir);
+	}
+
+	g_remove (path);
+}
+
+static void
+fixture_teardown (Fixture *fixture,
+		  gconstpointer user_data)
+{
+	budget_free (fixture->budget);
+	remove_recursively (fixture->tmp_dir);
+	g_free (fixture->filename);
+	g_free (fixture->tmp_dir);
+}
+
+/* Collects the evicted messages as "folder:key" strings */
+static void
+collect_evicted_cb (const gchar *folder_name,
+		    const gchar *key,
+		    gpointer user_data)
+{
+	GPtrArray *evicted = user_data;
+
+	g_ptr_array_add (evicted, g_strconcat (folder_name, ":", key, NULL));
+}
+
+static void
+check_evicted (CamelEwsCacheBudget *budget,
+	       const gchar * const *expected)
+{
+	GPtrArray *evicted;
+	guint ii, n_expected;
+
+	n_expected = expected ? g_strv_length ((gchar **) expected) : 0;
+
+	evicted = g_ptr_array_new_with_free_func (g_free);
+
+	g_assert_cmpuint (budget_evict (budget, collect_evicted_cb, evicted), ==, n_expected);
+	g_assert_cmpuint (evicted->len, ==, n_expected);
+
+	for (ii = 0; ii < n_expected; ii++) {
+		g_assert_cmpstr (g_ptr_array_index (evicted, ii), ==, expected[ii]);
+	}
+
+	g_ptr_array_unref (evicted);
+}
+
+static void
+test_cache_budget_lru (Fixture *fixture,
+		       gconstpointer user_data)
+{
+	const gchar *expected1[] = { "Inbox:b", NULL };
+	const gchar *expected2[] = { "Inbox:c", "Sent:d", NULL };
+
+	/* Nothing is over the limit without the limit */
+	g_assert_false (budget_touch (fixture->budget, "Inbox", "a", 100));
+	g_assert_false (budget_touch (fixture->budget, "Inbox", "b", 100));
+	g_assert_false (budget_touch (fixture->budget, "Inbox", "c", 100));
+	g_assert_false (budget_touch (fixture->budget, "Sent", "d", 100));
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 4);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 400);
+
+	/* Makes 'a' the most recently used */
+	g_assert_false (budget_touch (fixture->budget, "Inbox", "a", 100));
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 4);
+
+	budget_set_limit (fixture->budget, 300);
+	check_evicted (fixture->budget, expected1);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 300);
+
+	/* The size of an already known message is updated */
+	g_assert_true (budget_touch (fixture->budget, "Inbox", "a", 250));
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 450);
+
+	check_evicted (fixture->budget, expected2);
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 1);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 250);
+
+	/* Removed messages do not count anymore */
+	budget_remove (fixture->budget, "Inbox", "a");
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 0);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 0);
+
+	check_evicted (fixture->budget, NULL);
+}
+
+static void
+test_cache_budget_pinned (Fixture *fixture,
+			  gconstpointer user_data)
+{
+	const gchar *expected[] = { "Inbox:b", "Inbox:c", NULL };
+	const gchar *expected_unpinned[] = { "Offline:a", NULL };
+
+	budget_set_folder_pinned (fixture->budget, "Offline", TRUE);
+	g_assert_true (budget_get_folder_pinned (fixture->budget, "Offline"));
+	g_assert_false (budget_get_folder_pinned (fixture->budget, "Inbox"));
+
+	budget_touch (fixture->budget, "Offline", "a", 100);
+	budget_touch (fixture->budget, "Inbox", "b", 100);
+	budget_touch (fixture->budget, "Offline", "x", 100);
+	budget_touch (fixture->budget, "Inbox", "c", 100);
+
+	/* The pinned folder's messages stay, even when they alone are over the limit */
+	budget_set_limit (fixture->budget, 150);
+	check_evicted (fixture->budget, expected);
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 2);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 200);
+
+	budget_set_folder_pinned (fixture->budget, "Offline", FALSE);
+	g_assert_false (budget_get_folder_pinned (fixture->budget, "Offline"));
+
+	check_evicted (fixture->budget, expected_unpinned);
+
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 100);
+}
+
+typedef struct _LoadData {
+	GHashTable *cached; /* gchar *"folder:key" ~> size */
+	guint64 cached_size;
+} LoadData;
+
+static void
+load_evicted_cb (const gchar *folder_name,
+		 const gchar *key,
+		 gpointer user_data)
+{
+	LoadData *ld = user_data;
+	gchar *hash_key;
+	gpointer size;
+
+	hash_key = g_strconcat (folder_name, ":", key, NULL);
+
+	g_assert_true (g_hash_table_lookup_extended (ld->cached, hash_key, NULL, &size));
+	g_assert_cmpstr (folder_name, !=, "Offline");
+
+	ld->cached_size -= GPOINTER_TO_UINT (size);
+	g_hash_table_remove (ld->cached, hash_key);
+
+	g_free (hash_key);
+}
+
+static void
+test_cache_budget_synthetic_load (Fixture *fixture,
+				  gconstpointer user_data)
+{
+	const gchar *folders[] = { "Inbox", "Inbox/Lists", "Sent", "Archive" };
+	const guint64 limit = 4 * 1024 * 1024;
+	guint64 pinned_size = 0;
+	LoadData ld;
+	guint ii, n_evicted = 0;
+
+	ld.cached = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	ld.cached_size = 0;
+
+	budget_set_limit (fixture->budget, limit);
+	budget_set_folder_pinned (fixture->budget, "Offline", TRUE);
+
+	/* A few messages are synchronized for offline use */
+	for (ii = 0; ii < 10; ii++) {
+		gchar *key = g_strdup_printf ("pinned-%u", ii);
+
+		budget_touch (fixture->budget, "Offline", key, 64 * 1024);
+		pinned_size += 64 * 1024;
+
+		g_free (key);
+	}
+
+	for (ii = 0; ii < N_ACCESSES; ii++) {
+		const gchar *folder_name;
+		gchar *key, *hash_key;
+		guint size;
+		gpointer old_size;
+
+		/* Some messages are read often, most of them only once */
+		folder_name = folders[g_test_rand_int_range (0, G_N_ELEMENTS (folders))];
+		if (g_test_rand_int_range (0, 4) == 0)
+			key = g_strdup_printf ("hot-%d", g_test_rand_int_range (0, 20));
+		else
+			key = g_strdup_printf ("msg-%d", g_test_rand_int_range (0, 5000));
+
+		/* From small text messages up to a message with attachments */
+		size = g_test_rand_int_range (0, 10) == 0 ?
+			g_test_rand_int_range (256 * 1024, 1024 * 1024) :
+			g_test_rand_int_range (1024, 64 * 1024);
+
+		hash_key = g_strconcat (folder_name, ":", key, NULL);
+
+		if (g_hash_table_lookup_extended (ld.cached, hash_key, NULL, &old_size)) {
+			/* A cached message keeps its size */
+			size = GPOINTER_TO_UINT (old_size);
+			g_free (hash_key);
+		} else {
+			g_hash_table_insert (ld.cached, hash_key, GUINT_TO_POINTER (size));
+			ld.cached_size += size;
+		}
+
+		if (budget_touch (fixture->budget, folder_name, key, size))
+			n_evicted += budget_evict (fixture->budget, load_evicted_cb, &ld);
+
+		g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, ld.cached_size + pinned_size);
+		g_assert_cmpuint (budget_get_total_size (fixture->budget), <=, limit);
+
+		g_free (key);
+	}
+
+	g_assert_cmpuint (n_evicted, >, 0);
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, g_hash_table_size (ld.cached) + 10);
+
+	g_test_message ("%u accesses: %u entries of %" G_GUINT64_FORMAT " bytes kept, %u evicted",
+		N_ACCESSES, budget_get_n_entries (fixture->budget), budget_get_total_size (fixture->budget), n_evicted);
+
+	g_hash_table_destroy (ld.cached);
+}
+
+static void
+test_cache_budget_save_load (Fixture *fixture,
+			     gconstpointer user_data)
+{
+	CamelEwsCacheBudget *loaded;
+	const gchar *expected[] = { "Inbox:b", "Inbox/With Space:c", NULL };
+	GError *error = NULL;
+
+	budget_set_folder_pinned (fixture->budget, "Offline\nFolder", TRUE);
+	budget_touch (fixture->budget, "Inbox", "a", 100);
+	budget_touch (fixture->budget, "Inbox", "b", 200);
+	budget_touch (fixture->budget, "Inbox/With Space", "c", 300);
+	budget_touch (fixture->budget, "Offline\nFolder", "d", 400);
+	budget_touch (fixture->budget, "Inbox", "a", 100);
+
+	g_assert_true (budget_save (fixture->budget, &error));
+	g_assert_no_error (error);
+
+	loaded = budget_new (fixture->filename);
+	g_assert_nonnull (loaded);
+
+	g_assert_false (budget_get_seeded (loaded));
+	g_assert_true (budget_get_folder_pinned (loaded, "Offline\nFolder"));
+	g_assert_cmpuint (budget_get_n_entries (loaded), ==, 4);
+	g_assert_cmpuint (budget_get_total_size (loaded), ==, 1000);
+
+	/* The order of use is preserved */
+	budget_set_limit (loaded, 500);
+	check_evicted (loaded, expected);
+
+	budget_free (loaded);
+
+	/* An unknown file format is ignored */
+	g_assert_true (g_file_set_contents (fixture->filename, "something else\nE 1 2 k f\n", -1, NULL));
+
+	loaded = budget_new (fixture->filename);
+	g_assert_cmpuint (budget_get_n_entries (loaded), ==, 0);
+	budget_free (loaded);
+}
+
+static void
+write_cache_file (const gchar *folders_dir,
+		  const gchar *folder_name,
+		  const gchar *uid,
+		  gsize size,
+		  time_t file_time)
+{
+	struct utimbuf times;
+	gchar *key, *bucket, *dir, *filename, *contents;
+
+	key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, uid, -1);
+	bucket = g_strndup (key, 2);
+	dir = g_build_filename (folders_dir, folder_name, "cur", bucket, NULL);
+	filename = g_build_filename (dir, key, NULL);
+
+	g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+
+	contents = g_malloc0 (size);
+	g_assert_true (g_file_set_contents (filename, contents, size, NULL));
+
+	times.actime = file_time;
+	times.modtime = file_time;
+	g_assert_cmpint (g_utime (filename, &times), ==, 0);
+
+	g_free (contents);
+	g_free (filename);
+	g_free (dir);
+	g_free (bucket);
+	g_free (key);
+}
+
+static void
+test_cache_budget_seed (Fixture *fixture,
+			gconstpointer user_data)
+{
+	GPtrArray *evicted;
+	gchar *folders_dir, *expected_first, *key;
+	time_t now = time (NULL);
+
+	folders_dir = g_build_filename (fixture->tmp_dir, "folders", NULL);
+
+	write_cache_file (folders_dir, "Inbox", "old", 100, now - 3000);
+	write_cache_file (folders_dir, "Inbox/Sub", "older", 200, now - 4000);
+	write_cache_file (folders_dir, "Sent", "new", 300, now - 1000);
+	write_cache_file (folders_dir, "Sent", "known", 400, now - 5000);
+
+	/* Files which are not messages */
+	key = g_build_filename (folders_dir, "Sent", "cmeta", NULL);
+	g_assert_true (g_file_set_contents (key, "state", -1, NULL));
+	g_free (key);
+
+	/* Accessed before the seed, thus it is the most recently used */
+	key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, "known", -1);
+	budget_touch (fixture->budget, "Sent", key, 400);
+	g_free (key);
+
+	g_assert_false (budget_get_seeded (fixture->budget));
+	budget_seed_from_dir (fixture->budget, folders_dir);
+	g_assert_true (budget_get_seeded (fixture->budget));
+
+	g_assert_cmpuint (budget_get_n_entries (fixture->budget), ==, 4);
+	g_assert_cmpuint (budget_get_total_size (fixture->budget), ==, 1000);
+
+	budget_set_limit (fixture->budget, 700);
+
+	evicted = g_ptr_array_new_with_free_func (g_free);
+	g_assert_cmpuint (budget_evict (fixture->budget, collect_evicted_cb, evicted), ==, 2);
+
+	key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, "older", -1);
+	expected_first = g_strconcat ("Inbox/Sub:", key, NULL);
+	g_assert_cmpstr (g_ptr_array_index (evicted, 0), ==, expected_first);
+	g_free (expected_first);
+	g_free (key);
+
+	key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, "old", -1);
+	expected_first = g_strconcat ("Inbox:", key, NULL);
+	g_assert_cmpstr (g_ptr_array_index (evicted, 1), ==, expected_first);
+	g_free (expected_first);
+	g_free (key);
+
+	g_ptr_array_unref (evicted);
+	g_free (folders_dir);
+}
+
+int
+main (int argc,
+      char **argv)
+{
+	const gchar *module_path;
+	GModule *module = NULL;
+	gint retval;
+	guint ii;
+
+	g_test_init (&argc, &argv, NULL);
+
+	if (!g_module_supported ()) {
+		g_printerr ("GModule not supported\n");
+		return 1;
+	}
+
+	module_path = CAMEL_MODULE_DIR "libcamelews-priv.so";
+	module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+
+	if (module == NULL) {
+		g_printerr ("Failed to load module '%s': %s\n", module_path, g_module_error ());
+		return 2;
+	}
+
+	for (ii = 0; ii < G_N_ELEMENTS (symbols); ii++) {
+		if (!g_module_symbol (module, symbols[ii].name, symbols[ii].ptr)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 3;
+		}
+	}
+
+	g_test_add ("/camel/cache-budget/lru", Fixture, NULL,
+		fixture_setup, test_cache_budget_lru, fixture_teardown);
+	g_test_add ("/camel/cache-budget/pinned", Fixture, NULL,
+		fixture_setup, test_cache_budget_pinned, fixture_teardown);
+	g_test_add ("/camel/cache-budget/synthetic-load", Fixture, NULL,
+		fixture_setup, test_cache_budget_synthetic_load, fixture_teardown);
+	g_test_add ("/camel/cache-budget/save-load", Fixture, NULL,
+		fixture_setup, test_cache_budget_save_load, fixture_teardown);
+	g_test_add ("/camel/cache-budget/seed", Fixture, NULL,
+		fixture_setup, test_cache_budget_seed, fixture_teardown);
+
+	retval = g_test_run ();
+
+	g_module_close (module);
+
+	return retval;
+}
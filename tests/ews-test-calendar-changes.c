@@ -0,0 +1,404 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <libecal/libecal.h>
+#include <libxml/tree.h>
+
+#include "calendar/e-cal-backend-ews-utils.h"
+#include "server/camel-ews-settings.h"
+#include "server/e-ews-message.h"
+
+EwsCalendarChangeFlags (* get_component_changes) (EwsCalendarConvertData *convert_data);
+gboolean (* convert_component_to_updatexml) (ESoapMessage *msg, gpointer user_data, GError **error);
+
+#define USER_EMAIL "organizer@provider.com"
+
+static const gchar *str_meeting =
+	"BEGIN:VEVENT\n"
+	"UID:20140114T172626Z-2238-1000-5564-0@srv\n"
+	"DTSTAMP:20140114T172620Z\n"
+	"DTSTART:20140114T160000Z\n"
+	"DTEND:20140114T163000Z\n"
+	"TRANSP:OPAQUE\n"
+	"SEQUENCE:2\n"
+	"SUMMARY:Weekly status meeting\n"
+	"LOCATION:Meeting room 4\n"
+	"CLASS:PUBLIC\n"
+	"CATEGORIES:Work\n"
+	"ORGANIZER;CN=Organizer:MAILTO:" USER_EMAIL "\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=REQ-PARTICIPANT;PARTSTAT=ACCEPTED;\n"
+	" RSVP=TRUE;CN=First:MAILTO:first@provider.com\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=REQ-PARTICIPANT;PARTSTAT=NEEDS-ACTION;\n"
+	" RSVP=TRUE;CN=Second:MAILTO:second@provider.com\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=OPT-PARTICIPANT;PARTSTAT=TENTATIVE;\n"
+	" RSVP=TRUE;CN=Third:MAILTO:third@provider.com\n"
+	"X-EVOLUTION-ITEMID:AAMkADk2ZWY5ZGFlLTNhNmUtNDdkNC1hYjM5LWQ1Y2YzNmE5ZTRhNABGAAAA\n"
+	"X-EVOLUTION-CHANGEKEY:DwAAABYAAAA7xLqM2zK8S5d7a3mDkp+PAAAMxcam\n"
+	"END:VEVENT";
+
+/* The smallest time zone cache, the tests use only UTC times */
+typedef struct _TestTzCache {
+	GObject parent;
+} TestTzCache;
+
+typedef struct _TestTzCacheClass {
+	GObjectClass parent_class;
+} TestTzCacheClass;
+
+static GType test_tz_cache_get_type (void);
+static void test_tz_cache_timezone_cache_init (ETimezoneCacheInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestTzCache, test_tz_cache, G_TYPE_OBJECT,
+	G_IMPLEMENT_INTERFACE (E_TYPE_TIMEZONE_CACHE, test_tz_cache_timezone_cache_init))
+
+static void
+test_tz_cache_add_timezone (ETimezoneCache *cache,
+			    icaltimezone *zone)
+{
+}
+
+static icaltimezone *
+test_tz_cache_get_timezone (ETimezoneCache *cache,
+			    const gchar *tzid)
+{
+	return icaltimezone_get_builtin_timezone_from_tzid (tzid);
+}
+
+static GList *
+test_tz_cache_list_timezones (ETimezoneCache *cache)
+{
+	return NULL;
+}
+
+static void
+test_tz_cache_class_init (TestTzCacheClass *klass)
+{
+}
+
+static void
+test_tz_cache_timezone_cache_init (ETimezoneCacheInterface *iface)
+{
+	iface->add_timezone = test_tz_cache_add_timezone;
+	iface->get_timezone = test_tz_cache_get_timezone;
+	iface->list_timezones = test_tz_cache_list_timezones;
+}
+
+static void
+test_tz_cache_init (TestTzCache *cache)
+{
+}
+
+typedef struct {
+	ETimezoneCache *timezone_cache;
+	ECalComponent *old_comp;
+	ECalComponent *comp;
+} Fixture;
+
+static void
+fixture_set_up (Fixture *fixture,
+		gconstpointer user_data)
+{
+	fixture->timezone_cache = g_object_new (test_tz_cache_get_type (), NULL);
+	fixture->old_comp = e_cal_component_new_from_string (str_meeting);
+	fixture->comp = e_cal_component_new_from_string (str_meeting);
+
+	g_assert_nonnull (fixture->old_comp);
+	g_assert_nonnull (fixture->comp);
+}
+
+static void
+fixture_tear_down (Fixture *fixture,
+		   gconstpointer user_data)
+{
+	g_clear_object (&fixture->timezone_cache);
+	g_clear_object (&fixture->old_comp);
+	g_clear_object (&fixture->comp);
+}
+
+static void
+fixture_fill_convert_data (Fixture *fixture,
+			   EwsCalendarConvertData *convert_data,
+			   const gchar *user_email)
+{
+	memset (convert_data, 0, sizeof (EwsCalendarConvertData));
+
+	convert_data->timezone_cache = fixture->timezone_cache;
+	convert_data->user_email = (gchar *) user_email;
+	convert_data->comp = fixture->comp;
+	convert_data->old_comp = fixture->old_comp;
+	convert_data->item_id = (gchar *) "item-id";
+	convert_data->change_key = (gchar *) "change-key";
+	convert_data->default_zone = icaltimezone_get_utc_timezone ();
+}
+
+static EwsCalendarChangeFlags
+fixture_get_changes (Fixture *fixture,
+		     const gchar *user_email)
+{
+	EwsCalendarConvertData convert_data;
+
+	fixture_fill_convert_data (fixture, &convert_data, user_email);
+
+	return get_component_changes (&convert_data);
+}
+
+/* Returns the UpdateItem request, with the ItemChange written by the e_cal_backend_ews_convert_component_to_updatexml() */
+static gchar *
+fixture_get_update_xml (Fixture *fixture)
+{
+	EwsCalendarConvertData convert_data;
+	CamelEwsSettings *settings;
+	ESoapMessage *msg;
+	xmlChar *xml = NULL;
+	gchar *result;
+	gint len = 0;
+
+	fixture_fill_convert_data (fixture, &convert_data, USER_EMAIL);
+
+	settings = g_object_new (CAMEL_TYPE_EWS_SETTINGS, NULL);
+
+	msg = e_ews_message_new_with_header (settings, "https://localhost/EWS/Exchange.asmx", NULL,
+		"UpdateItem", NULL, NULL, E_EWS_EXCHANGE_2010, E_EWS_EXCHANGE_2007_SP1, FALSE, FALSE);
+	g_assert_nonnull (msg);
+
+	e_soap_message_start_element (msg, "ItemChanges", "messages", NULL);
+	g_assert_true (convert_component_to_updatexml (msg, &convert_data, NULL));
+	e_soap_message_end_element (msg); /* ItemChanges */
+
+	e_ews_message_write_footer (msg);
+
+	xmlDocDumpMemory (e_soap_message_get_xml_doc (msg), &xml, &len);
+	g_assert_nonnull (xml);
+
+	result = g_strdup ((const gchar *) xml);
+
+	xmlFree (xml);
+	g_object_unref (msg);
+	g_object_unref (settings);
+
+	return result;
+}
+
+static void
+test_changes_none (Fixture *fixture,
+		   gconstpointer user_data)
+{
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_NONE);
+
+	/* Properties not stored on the server */
+	e_cal_util_set_x_property (e_cal_component_get_icalcomponent (fixture->comp), "X-EVOLUTION-TEST", "1");
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_NONE);
+}
+
+static void
+test_changes_subject (Fixture *fixture,
+		      gconstpointer user_data)
+{
+	gchar *xml;
+
+	icalcomponent_set_summary (e_cal_component_get_icalcomponent (fixture->comp), "Weekly Status Meeting");
+
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_SUBJECT);
+
+	xml = fixture_get_update_xml (fixture);
+
+	g_assert_nonnull (strstr (xml, "Weekly Status Meeting"));
+	g_assert_null (strstr (xml, "Attendee"));
+	g_assert_null (strstr (xml, "Categories"));
+	g_assert_null (strstr (xml, "IsResponseRequested"));
+
+	g_free (xml);
+}
+
+static void
+test_changes_attendee_added (Fixture *fixture,
+			     gconstpointer user_data)
+{
+	icalproperty *prop;
+	gchar *xml;
+
+	prop = icalproperty_new_attendee ("MAILTO:fourth@provider.com");
+	icalproperty_add_parameter (prop, icalparameter_new_role (ICAL_ROLE_REQPARTICIPANT));
+	icalcomponent_add_property (e_cal_component_get_icalcomponent (fixture->comp), prop);
+
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES);
+
+	xml = fixture_get_update_xml (fixture);
+
+	/* Only the new attendee is sent */
+	g_assert_nonnull (strstr (xml, "AppendToItemField"));
+	g_assert_nonnull (strstr (xml, "fourth@provider.com"));
+	g_assert_null (strstr (xml, "first@provider.com"));
+	g_assert_null (strstr (xml, "second@provider.com"));
+	g_assert_null (strstr (xml, "third@provider.com"));
+
+	g_free (xml);
+}
+
+static void
+test_changes_attendee_removed (Fixture *fixture,
+			       gconstpointer user_data)
+{
+	icalcomponent *icalcomp;
+	icalproperty *prop;
+	gchar *xml;
+
+	icalcomp = e_cal_component_get_icalcomponent (fixture->comp);
+
+	for (prop = icalcomponent_get_first_property (icalcomp, ICAL_ATTENDEE_PROPERTY);
+	     prop;
+	     prop = icalcomponent_get_next_property (icalcomp, ICAL_ATTENDEE_PROPERTY)) {
+		if (g_strcmp0 (icalproperty_get_attendee (prop), "MAILTO:second@provider.com") == 0) {
+			icalcomponent_remove_property (icalcomp, prop);
+			icalproperty_free (prop);
+			break;
+		}
+	}
+
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES);
+
+	xml = fixture_get_update_xml (fixture);
+
+	/* The required attendees are replaced, the optional are untouched */
+	g_assert_null (strstr (xml, "AppendToItemField"));
+	g_assert_nonnull (strstr (xml, "first@provider.com"));
+	g_assert_null (strstr (xml, "second@provider.com"));
+	g_assert_null (strstr (xml, "third@provider.com"));
+
+	g_free (xml);
+}
+
+static void
+test_changes_attendee_case (Fixture *fixture,
+			    gconstpointer user_data)
+{
+	icalcomponent *icalcomp;
+	icalproperty *prop;
+
+	icalcomp = e_cal_component_get_icalcomponent (fixture->comp);
+
+	for (prop = icalcomponent_get_first_property (icalcomp, ICAL_ATTENDEE_PROPERTY);
+	     prop;
+	     prop = icalcomponent_get_next_property (icalcomp, ICAL_ATTENDEE_PROPERTY)) {
+		if (g_strcmp0 (icalproperty_get_attendee (prop), "MAILTO:first@provider.com") == 0) {
+			icalproperty_set_attendee (prop, "mailto:First@Provider.com");
+			break;
+		}
+	}
+
+	g_assert_cmpuint (fixture_get_changes (fixture, USER_EMAIL), ==, EWS_CALENDAR_CHANGE_NONE);
+}
+
+static void
+test_changes_not_organizer (Fixture *fixture,
+			    gconstpointer user_data)
+{
+	icalcomponent *icalcomp;
+	icalproperty *prop;
+
+	icalcomp = e_cal_component_get_icalcomponent (fixture->comp);
+
+	prop = icalproperty_new_attendee ("MAILTO:fourth@provider.com");
+	icalproperty_add_parameter (prop, icalparameter_new_role (ICAL_ROLE_REQPARTICIPANT));
+	icalcomponent_add_property (icalcomp, prop);
+
+	/* Attendees can change only what the organizer does not control */
+	g_assert_cmpuint (fixture_get_changes (fixture, "first@provider.com"), ==, EWS_CALENDAR_CHANGE_NONE);
+
+	icalcomponent_set_location (icalcomp, "Meeting room 5");
+	e_cal_component_set_categories (fixture->comp, "Work,Important");
+
+	g_assert_cmpuint (fixture_get_changes (fixture, "first@provider.com"), ==,
+		EWS_CALENDAR_CHANGE_LOCATION | EWS_CALENDAR_CHANGE_CATEGORIES);
+}
+
+static void
+test_changes_force_basic (Fixture *fixture,
+			  gconstpointer user_data)
+{
+	EwsCalendarConvertData convert_data;
+
+	icalcomponent_set_summary (e_cal_component_get_icalcomponent (fixture->comp), "Status meeting");
+
+	fixture_fill_convert_data (fixture, &convert_data, USER_EMAIL);
+	convert_data.force_basic_properties = TRUE;
+
+	g_assert_cmpuint (get_component_changes (&convert_data), ==,
+		EWS_CALENDAR_CHANGE_SUBJECT |
+		EWS_CALENDAR_CHANGE_CATEGORIES |
+		EWS_CALENDAR_CHANGE_RESPONSE_REQUESTED |
+		EWS_CALENDAR_CHANGE_REQUIRED_ATTENDEES |
+		EWS_CALENDAR_CHANGE_OPTIONAL_ATTENDEES |
+		EWS_CALENDAR_CHANGE_RESOURCES);
+}
+
+int
+main (int argc,
+      char **argv)
+{
+	const gchar *module_path;
+	GModule *module = NULL;
+	gint retval;
+
+	g_test_init (&argc, &argv, NULL);
+
+	if (!g_module_supported ()) {
+		g_printerr ("GModule not supported\n");
+		return 1;
+	}
+
+	module_path = CALENDAR_MODULE_DIR "libecalbackendews.so";
+	module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+
+	if (module == NULL) {
+		g_printerr ("Failed to load module '%s': %s\n", module_path, g_module_error ());
+		return 2;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"e_cal_backend_ews_get_component_changes",
+		(gpointer *) &get_component_changes)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 3;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"e_cal_backend_ews_convert_component_to_updatexml",
+		(gpointer *) &convert_component_to_updatexml)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 4;
+	}
+
+	g_test_add ("/calendar/changes/none", Fixture, NULL, fixture_set_up, test_changes_none, fixture_tear_down);
+	g_test_add ("/calendar/changes/subject", Fixture, NULL, fixture_set_up, test_changes_subject, fixture_tear_down);
+	g_test_add ("/calendar/changes/attendee-added", Fixture, NULL, fixture_set_up, test_changes_attendee_added, fixture_tear_down);
+	g_test_add ("/calendar/changes/attendee-removed", Fixture, NULL, fixture_set_up, test_changes_attendee_removed, fixture_tear_down);
+	g_test_add ("/calendar/changes/attendee-case", Fixture, NULL, fixture_set_up, test_changes_attendee_case, fixture_tear_down);
+	g_test_add ("/calendar/changes/not-organizer", Fixture, NULL, fixture_set_up, test_changes_not_organizer, fixture_tear_down);
+	g_test_add ("/calendar/changes/force-basic", Fixture, NULL, fixture_set_up, test_changes_force_basic, fixture_tear_down);
+
+	retval = g_test_run ();
+
+	g_module_close (module);
+
+	return retval;
+}
@@ -0,0 +1,352 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gmodule.h>
+#include <libedata-book/libedata-book.h>
+
+#include "addressbook/ews-oab-index.h"
+#include "addressbook/ews-oab-props.h"
+
+gboolean (* gal_needs_reprocess) (EBookCache *book_cache, gboolean lazy);
+gboolean (* gal_index_oab_file) (EBookCache *book_cache, const gchar *oab_filename, const gchar *attachments_dir,
+				 GSList **out_removed_objects, GCancellable *cancellable, GError **error);
+EwsOabIndex * (* oab_index_new) (const gchar *filename, GError **error);
+void (* oab_index_free) (EwsOabIndex *index);
+guint (* oab_index_get_n_entries) (EwsOabIndex *index);
+gboolean (* oab_index_lookup_uid) (EwsOabIndex *index, const gchar *uid, goffset *out_offset);
+GPtrArray * (* oab_index_search) (EwsOabIndex *index, const gchar *text, guint max_results);
+
+static const struct _symbols {
+	const gchar *name;
+	gpointer *ptr;
+} symbols[] = {
+	{ "e_book_backend_ews_gal_needs_reprocess", (gpointer *) &gal_needs_reprocess },
+	{ "e_book_backend_ews_gal_index_oab_file", (gpointer *) &gal_index_oab_file },
+	{ "ews_oab_index_new", (gpointer *) &oab_index_new },
+	{ "ews_oab_index_free", (gpointer *) &oab_index_free },
+	{ "ews_oab_index_get_n_entries", (gpointer *) &oab_index_get_n_entries },
+	{ "ews_oab_index_lookup_uid", (gpointer *) &oab_index_lookup_uid },
+	{ "ews_oab_index_search", (gpointer *) &oab_index_search }
+};
+
+static const struct _records {
+	const gchar *display_name;
+	const gchar *email;
+} records[] = {
+	{ "Alice Adams", "alice@example.com" },
+	{ "Bob Brown", "bob@example.com" },
+	{ "Carol Clark", "carol@example.com" }
+};
+
+typedef struct _Fixture {
+	gchar *tmp_dir;
+	gchar *oab_filename;
+	gchar *index_filename;
+	EBookCache *book_cache;
+} Fixture;
+
+static void
+append_uint32 (GByteArray *bytes,
+	       guint32 value)
+{
+	guint8 data[4];
+
+	data[0] = value & 0xFF;
+	data[1] = (value >> 8) & 0xFF;
+	data[2] = (value >> 16) & 0xFF;
+	data[3] = (value >> 24) & 0xFF;
+
+	g_byte_array_append (bytes, data, 4);
+}
+
+static void
+append_string (GByteArray *bytes,
+	       const gchar *str)
+{
+	g_byte_array_append (bytes, (const guint8 *) str, strlen (str) + 1);
+}
+
+/* Writes a minimal OAB v4 full details file, with the display name
+   and the SMTP address of each record */
+static void
+write_oab_file (const gchar *filename)
+{
+	GByteArray *bytes, *chunk;
+	guint8 no_presence = 0;
+	GError *error = NULL;
+	guint ii;
+
+	bytes = g_byte_array_new ();
+
+	/* The header: the version, the serial number and the number of records */
+	append_uint32 (bytes, 0x00000020);
+	append_uint32 (bytes, 1);
+	append_uint32 (bytes, G_N_ELEMENTS (records));
+
+	/* The metadata: one header property and two record properties */
+	chunk = g_byte_array_new ();
+	append_uint32 (chunk, 1);
+	append_uint32 (chunk, EWS_PT_DISPLAY_NAME);
+	append_uint32 (chunk, 0);
+	append_uint32 (chunk, 2);
+	append_uint32 (chunk, EWS_PT_DISPLAY_NAME);
+	append_uint32 (chunk, 0);
+	append_uint32 (chunk, EWS_PT_SMTP_ADDRESS);
+	append_uint32 (chunk, 0);
+
+	append_uint32 (bytes, chunk->len + 4);
+	g_byte_array_append (bytes, chunk->data, chunk->len);
+	g_byte_array_unref (chunk);
+
+	/* The header record, without any property set */
+	append_uint32 (bytes, 5);
+	g_byte_array_append (bytes, &no_presence, 1);
+
+	for (ii = 0; ii < G_N_ELEMENTS (records); ii++) {
+		guint8 presence = 0xC0; /* both properties are set */
+
+		chunk = g_byte_array_new ();
+		g_byte_array_append (chunk, &presence, 1);
+		append_string (chunk, records[ii].display_name);
+		append_string (chunk, records[ii].email);
+
+		append_uint32 (bytes, chunk->len + 4);
+		g_byte_array_append (bytes, chunk->data, chunk->len);
+		g_byte_array_unref (chunk);
+	}
+
+	g_file_set_contents (filename, (const gchar *) bytes->data, bytes->len, &error);
+	g_assert_no_error (error);
+
+	g_byte_array_unref (bytes);
+}
+
+/* Populates the cache as the GAL synchronization without the lazy contacts does */
+static void
+populate_cache (Fixture *fixture)
+{
+	GError *error = NULL;
+	guint ii;
+
+	for (ii = 0; ii < G_N_ELEMENTS (records); ii++) {
+		EContact *contact;
+
+		contact = e_contact_new ();
+		e_contact_set (contact, E_CONTACT_UID, records[ii].email);
+		e_contact_set (contact, E_CONTACT_FULL_NAME, records[ii].display_name);
+		e_contact_set (contact, E_CONTACT_EMAIL_1, records[ii].email);
+
+		g_assert_true (e_book_cache_put_contact (fixture->book_cache, contact, NULL, E_CACHE_IS_ONLINE, NULL, &error));
+		g_assert_no_error (error);
+
+		g_object_unref (contact);
+	}
+
+	g_assert_true (e_cache_set_key (E_CACHE (fixture->book_cache), "oab-filename", fixture->oab_filename, &error));
+	g_assert_no_error (error);
+
+	g_assert_true (e_cache_set_key_int (E_CACHE (fixture->book_cache), "gal-sequence", 5, &error));
+	g_assert_no_error (error);
+}
+
+static void
+fixture_setup (Fixture *fixture,
+	       gconstpointer user_data)
+{
+	gchar *cache_filename;
+	GError *error = NULL;
+
+	fixture->tmp_dir = g_dir_make_tmp ("ews-test-gal-index-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	fixture->oab_filename = g_build_filename (fixture->tmp_dir, "Global Address List-5.oab", NULL);
+	fixture->index_filename = g_strconcat (fixture->oab_filename, ".idx", NULL);
+
+	cache_filename = g_build_filename (fixture->tmp_dir, "contacts.db", NULL);
+	fixture->book_cache = e_book_cache_new (cache_filename, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (fixture->book_cache);
+	g_free (cache_filename);
+
+	write_oab_file (fixture->oab_filename);
+	populate_cache (fixture);
+}
+
+static void
+fixture_teardown (Fixture *fixture,
+		  gconstpointer user_data)
+{
+	GDir *dir;
+	const gchar *name;
+
+	g_clear_object (&fixture->book_cache);
+
+	dir = g_dir_open (fixture->tmp_dir, 0, NULL);
+	if (dir) {
+		while (name = g_dir_read_name (dir), name) {
+			gchar *filename;
+
+			filename = g_build_filename (fixture->tmp_dir, name, NULL);
+			g_unlink (filename);
+			g_free (filename);
+		}
+
+		g_dir_close (dir);
+	}
+
+	g_rmdir (fixture->tmp_dir);
+
+	g_free (fixture->index_filename);
+	g_free (fixture->oab_filename);
+	g_free (fixture->tmp_dir);
+}
+
+static void
+test_gal_index_enable_populated (Fixture *fixture,
+				 gconstpointer user_data)
+{
+	EwsOabIndex *index;
+	GSList *removed = NULL, *link;
+	GPtrArray *uids;
+	goffset offset = 0;
+	guint ii;
+	GError *error = NULL;
+
+	/* The cache holds the full contacts, which match the option being off */
+	g_assert_false (gal_needs_reprocess (fixture->book_cache, FALSE));
+
+	/* Turning the option on needs the OAB file to be indexed, even when
+	   there is no newer OAB file on the server */
+	g_assert_true (gal_needs_reprocess (fixture->book_cache, TRUE));
+
+	g_assert_true (gal_index_oab_file (fixture->book_cache, fixture->oab_filename, fixture->tmp_dir, &removed, NULL, &error));
+	g_assert_no_error (error);
+
+	g_assert_true (g_file_test (fixture->index_filename, G_FILE_TEST_IS_REGULAR));
+	g_assert_false (gal_needs_reprocess (fixture->book_cache, TRUE));
+
+	/* The stored full contacts are to be removed */
+	g_assert_cmpuint (g_slist_length (removed), ==, G_N_ELEMENTS (records));
+
+	for (ii = 0; ii < G_N_ELEMENTS (records); ii++) {
+		for (link = removed; link; link = g_slist_next (link)) {
+			EBookMetaBackendInfo *nfo = link->data;
+
+			if (g_strcmp0 (nfo->uid, records[ii].email) == 0)
+				break;
+		}
+
+		g_assert_nonnull (link);
+	}
+
+	g_slist_free_full (removed, e_book_meta_backend_info_free);
+
+	index = oab_index_new (fixture->index_filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (index);
+
+	g_assert_cmpuint (oab_index_get_n_entries (index), ==, G_N_ELEMENTS (records));
+
+	for (ii = 0; ii < G_N_ELEMENTS (records); ii++) {
+		g_assert_true (oab_index_lookup_uid (index, records[ii].email, &offset));
+		g_assert_cmpint (offset, >, 0);
+	}
+
+	uids = oab_index_search (index, "bob", 10);
+	g_assert_cmpuint (uids->len, ==, 1);
+	g_assert_cmpstr (g_ptr_array_index (uids, 0), ==, "bob@example.com");
+	g_ptr_array_unref (uids);
+
+	oab_index_free (index);
+
+	/* An index in an unknown format, like from an older version, is rebuilt */
+	g_assert_true (g_file_set_contents (fixture->index_filename, "EWSOABX1", -1, &error));
+	g_assert_no_error (error);
+	g_assert_true (gal_needs_reprocess (fixture->book_cache, TRUE));
+
+	/* A lost index is rebuilt */
+	g_assert_cmpint (g_unlink (fixture->index_filename), ==, 0);
+	g_assert_true (gal_needs_reprocess (fixture->book_cache, TRUE));
+
+	/* Turning the option off again needs the full contacts to be stored */
+	g_assert_true (gal_needs_reprocess (fixture->book_cache, FALSE));
+}
+
+static void
+test_gal_index_no_oab_file (Fixture *fixture,
+			    gconstpointer user_data)
+{
+	GSList *removed = NULL;
+	GError *error = NULL;
+
+	g_assert_cmpint (g_unlink (fixture->oab_filename), ==, 0);
+
+	g_assert_false (gal_index_oab_file (fixture->book_cache, fixture->oab_filename, fixture->tmp_dir, &removed, NULL, &error));
+	g_assert_nonnull (error);
+	g_assert_null (removed);
+	g_clear_error (&error);
+
+	/* Still needs it, the full OAB file is downloaded again then */
+	g_assert_true (gal_needs_reprocess (fixture->book_cache, TRUE));
+	g_assert_false (g_file_test (fixture->index_filename, G_FILE_TEST_EXISTS));
+}
+
+int
+main (int argc,
+      char **argv)
+{
+	const gchar *module_path;
+	GModule *module = NULL;
+	gint retval;
+	guint ii;
+
+	g_test_init (&argc, &argv, NULL);
+
+	if (!g_module_supported ()) {
+		g_printerr ("GModule not supported\n");
+		return 1;
+	}
+
+	module_path = ADDRESSBOOK_MODULE_DIR "libebookbackendews.so";
+	module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+
+	if (module == NULL) {
+		g_printerr ("Failed to load module '%s': %s\n", module_path, g_module_error ());
+		return 2;
+	}
+
+	for (ii = 0; ii < G_N_ELEMENTS (symbols); ii++) {
+		if (!g_module_symbol (module, symbols[ii].name, symbols[ii].ptr)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 3;
+		}
+	}
+
+	g_test_add ("/addressbook/gal-index/enable-populated", Fixture, NULL,
+		fixture_setup, test_gal_index_enable_populated, fixture_teardown);
+	g_test_add ("/addressbook/gal-index/no-oab-file", Fixture, NULL,
+		fixture_setup, test_gal_index_no_oab_file, fixture_teardown);
+
+	retval = g_test_run ();
+
+	g_module_close (module);
+
+	return retval;
+}
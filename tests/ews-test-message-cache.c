@@ -0,0 +1,496 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gmodule.h>
+#include <camel/camel.h>
+
+/* The number of messages in the synthetic corpus */
+#define CORPUS_SIZE 200
+
+GOutputStream * (* new_cache_output_stream) (GOutputStream *base_stream);
+GInputStream * (* ref_cache_input_stream) (GInputStream *base_stream, GCancellable *cancellable, GError **error);
+
+static const gchar *words[] = {
+	"the", "meeting", "project", "status", "please", "review", "attached", "report",
+	"quarterly", "budget", "thanks", "regards", "schedule", "update", "customer", "release"
+};
+
+/* A message similar to those in the mailboxes, with the Received headers,
+   a text part, an HTML part and an attachment, which is either
+   a document-like text or random binary data, like images are */
+static gchar *
+build_message (guint index,
+	       gsize attachment_size,
+	       gboolean binary_attachment)
+{
+	GString *msg, *text;
+	guchar *attachment;
+	gchar *base64;
+	gsize ii;
+
+	msg = g_string_sized_new (attachment_size * 4 / 3 + 8192);
+	text = g_string_sized_new (2048);
+
+	for (ii = 0; ii < 300; ii++) {
+		g_string_append (text, words[g_test_rand_int_range (0, G_N_ELEMENTS (words))]);
+		g_string_append_c (text, (ii % 12) == 11 ? '\n' : ' ');
+	}
+
+	g_string_append_printf (msg,
+		"Received: from mail%u.example.com (10.0.%u.%u) by exchange.example.com\r\n"
+		" (15.1.2375.31) with Microsoft SMTP Server id 15.1.2375.31; Mon, 4 Mar 2019\r\n"
+		" 10:%02u:00 +0100\r\n"
+		"Received: from relay.example.com ([192.168.%u.%u]) by mail%u.example.com\r\n"
+		" with ESMTPS id x24A0Y9kA0%05u; Mon, 4 Mar 2019 10:%02u:00 +0100\r\n"
+		"From: Someone <someone%u@example.com>\r\n"
+		"To: Someone Else <someone.else@example.com>\r\n"
+		"Subject: Status report %u\r\n"
+		"Date: Mon, 4 Mar 2019 10:%02u:00 +0100\r\n"
+		"Message-ID: <message%u@example.com>\r\n"
+		"MIME-Version: 1.0\r\n"
+		"Content-Type: multipart/mixed; boundary=\"=-outer-%u\"\r\n"
+		"\r\n"
+		"--=-outer-%u\r\n"
+		"Content-Type: multipart/alternative; boundary=\"=-inner-%u\"\r\n"
+		"\r\n"
+		"--=-inner-%u\r\n"
+		"Content-Type: text/plain; charset=\"utf-8\"\r\n"
+		"Content-Transfer-Encoding: 8bit\r\n"
+		"\r\n"
+		"%s\r\n"
+		"--=-inner-%u\r\n"
+		"Content-Type: text/html; charset=\"utf-8\"\r\n"
+		"Content-Transfer-Encoding: 8bit\r\n"
+		"\r\n"
+		"<html><head><meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\"></head>"
+		"<body><div style=\"font-family: Calibri, sans-serif; font-size: 11pt\">%s</div></body></html>\r\n"
+		"--=-inner-%u--\r\n",
+		index % 7, index % 250, index % 200, index % 60, index % 250, index % 100, index % 7,
+		index, index % 60, index, index, index % 60, index, index, index, index, index,
+		text->str, index, text->str, index);
+
+	if (attachment_size > 0) {
+		attachment = g_malloc (attachment_size);
+
+		for (ii = 0; ii < attachment_size; ii++) {
+			if (binary_attachment)
+				attachment[ii] = g_test_rand_int_range (0, 256);
+			else
+				attachment[ii] = text->str[ii % text->len];
+		}
+
+		base64 = g_base64_encode (attachment, attachment_size);
+
+		g_string_append_printf (msg,
+			"--=-outer-%u\r\n"
+			"Content-Type: application/octet-stream; name=\"attachment%u\"\r\n"
+			"Content-Disposition: attachment; filename=\"attachment%u\"\r\n"
+			"Content-Transfer-Encoding: base64\r\n"
+			"\r\n",
+			index, index, index);
+
+		for (ii = 0; base64[ii]; ii += 76) {
+			g_string_append_len (msg, base64 + ii, MIN (76, strlen (base64 + ii)));
+			g_string_append (msg, "\r\n");
+		}
+
+		g_free (base64);
+		g_free (attachment);
+	}
+
+	g_string_append_printf (msg, "--=-outer-%u--\r\n", index);
+
+	g_string_free (text, TRUE);
+
+	return g_string_free (msg, FALSE);
+}
+
+static void
+write_cache_file (const gchar *filename,
+		  const gchar *content,
+		  gboolean compress)
+{
+	GFile *file;
+	GFileOutputStream *file_stream;
+	GOutputStream *output_stream;
+	GError *error = NULL;
+
+	file = g_file_new_for_path (filename);
+	file_stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_PRIVATE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (file_stream);
+
+	if (compress)
+		output_stream = new_cache_output_stream (G_OUTPUT_STREAM (file_stream));
+	else
+		output_stream = g_object_ref (file_stream);
+
+	g_assert_true (g_output_stream_write_all (output_stream, content, strlen (content), NULL, NULL, &error));
+	g_assert_no_error (error);
+	g_assert_true (g_output_stream_close (output_stream, NULL, &error));
+	g_assert_no_error (error);
+
+	/* The cache stream leaves its base stream open */
+	if (compress) {
+		g_assert_false (g_output_stream_is_closed (G_OUTPUT_STREAM (file_stream)));
+		g_assert_true (g_output_stream_close (G_OUTPUT_STREAM (file_stream), NULL, &error));
+		g_assert_no_error (error);
+	}
+
+	g_object_unref (output_stream);
+	g_object_unref (file_stream);
+	g_object_unref (file);
+}
+
+static CamelMimeMessage *
+read_cache_file (const gchar *filename)
+{
+	CamelMimeMessage *message;
+	GFile *file;
+	GFileInputStream *file_stream;
+	GInputStream *input_stream;
+	GError *error = NULL;
+
+	file = g_file_new_for_path (filename);
+	file_stream = g_file_read (file, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (file_stream);
+
+	input_stream = ref_cache_input_stream (G_INPUT_STREAM (file_stream), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (input_stream);
+
+	message = camel_mime_message_new ();
+	g_assert_true (camel_data_wrapper_construct_from_input_stream_sync (CAMEL_DATA_WRAPPER (message), input_stream, NULL, &error));
+	g_assert_no_error (error);
+
+	g_object_unref (input_stream);
+	g_object_unref (file_stream);
+	g_object_unref (file);
+
+	return message;
+}
+
+static gchar *
+read_cache_file_content (const gchar *filename)
+{
+	GFile *file;
+	GFileInputStream *file_stream;
+	GInputStream *input_stream;
+	GByteArray *content;
+	gchar buffer[1024];
+	gssize n_read;
+	GError *error = NULL;
+
+	file = g_file_new_for_path (filename);
+	file_stream = g_file_read (file, NULL, &error);
+	g_assert_no_error (error);
+
+	input_stream = ref_cache_input_stream (G_INPUT_STREAM (file_stream), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (input_stream);
+
+	content = g_byte_array_new ();
+
+	while ((n_read = g_input_stream_read (input_stream, buffer, sizeof (buffer), NULL, &error)) > 0) {
+		g_byte_array_append (content, (const guint8 *) buffer, n_read);
+	}
+
+	g_assert_no_error (error);
+	g_assert_cmpint (n_read, ==, 0);
+
+	g_byte_array_append (content, (const guint8 *) "", 1);
+
+	g_object_unref (input_stream);
+	g_object_unref (file_stream);
+	g_object_unref (file);
+
+	return (gchar *) g_byte_array_free (content, FALSE);
+}
+
+static gsize
+get_file_size (const gchar *filename)
+{
+	GStatBuf st;
+
+	g_assert_cmpint (g_stat (filename, &st), ==, 0);
+
+	return st.st_size;
+}
+
+static gchar *
+message_to_string (CamelMimeMessage *message)
+{
+	CamelStream *stream;
+	GByteArray *bytes;
+	gchar *str;
+
+	stream = camel_stream_mem_new ();
+	camel_data_wrapper_write_to_stream_sync (CAMEL_DATA_WRAPPER (message), stream, NULL, NULL);
+	bytes = camel_stream_mem_get_byte_array (CAMEL_STREAM_MEM (stream));
+	str = g_strndup ((const gchar *) bytes->data, bytes->len);
+	g_object_unref (stream);
+
+	return str;
+}
+
+static void
+test_message_cache_roundtrip (void)
+{
+	CamelMimeMessage *expected, *message;
+	gchar *tmp_dir, *plain_file, *compressed_file, *content, *str1, *str2;
+
+	tmp_dir = g_dir_make_tmp ("ews-test-message-cache-XXXXXX", NULL);
+	g_assert_nonnull (tmp_dir);
+
+	plain_file = g_build_filename (tmp_dir, "plain", NULL);
+	compressed_file = g_build_filename (tmp_dir, "compressed", NULL);
+
+	content = build_message (1, 64 * 1024, FALSE);
+
+	write_cache_file (plain_file, content, FALSE);
+	write_cache_file (compressed_file, content, TRUE);
+
+	/* The gzip header */
+	str1 = NULL;
+	g_assert_true (g_file_get_contents (compressed_file, &str1, NULL, NULL));
+	g_assert_cmpint ((guchar) str1[0], ==, 0x1f);
+	g_assert_cmpint ((guchar) str1[1], ==, 0x8b);
+	g_free (str1);
+
+	g_assert_cmpuint (get_file_size (compressed_file), <, get_file_size (plain_file) / 2);
+
+	/* Both read the same content, the uncompressed as stored by the older versions */
+	str1 = read_cache_file_content (plain_file);
+	str2 = read_cache_file_content (compressed_file);
+	g_assert_cmpstr (str1, ==, content);
+	g_assert_cmpstr (str2, ==, content);
+	g_free (str1);
+	g_free (str2);
+
+	expected = read_cache_file (plain_file);
+	message = read_cache_file (compressed_file);
+
+	g_assert_cmpstr (camel_mime_message_get_subject (message), ==, "Status report 1");
+
+	str1 = message_to_string (expected);
+	str2 = message_to_string (message);
+	g_assert_cmpstr (str1, ==, str2);
+	g_free (str1);
+	g_free (str2);
+
+	g_object_unref (expected);
+	g_object_unref (message);
+
+	g_remove (plain_file);
+	g_remove (compressed_file);
+	g_rmdir (tmp_dir);
+
+	g_free (content);
+	g_free (plain_file);
+	g_free (compressed_file);
+	g_free (tmp_dir);
+}
+
+static void
+test_message_cache_short (void)
+{
+	gchar *tmp_dir, *filename, *content;
+
+	tmp_dir = g_dir_make_tmp ("ews-test-message-cache-XXXXXX", NULL);
+	g_assert_nonnull (tmp_dir);
+
+	filename = g_build_filename (tmp_dir, "short", NULL);
+
+	/* Files shorter than the gzip magic bytes are read as they are */
+	g_assert_true (g_file_set_contents (filename, "", 0, NULL));
+	content = read_cache_file_content (filename);
+	g_assert_cmpstr (content, ==, "");
+	g_free (content);
+
+	g_assert_true (g_file_set_contents (filename, "\x1f", 1, NULL));
+	content = read_cache_file_content (filename);
+	g_assert_cmpstr (content, ==, "\x1f");
+	g_free (content);
+
+	write_cache_file (filename, "x", TRUE);
+	content = read_cache_file_content (filename);
+	g_assert_cmpstr (content, ==, "x");
+	g_free (content);
+
+	g_remove (filename);
+	g_rmdir (tmp_dir);
+
+	g_free (filename);
+	g_free (tmp_dir);
+}
+
+static void
+benchmark_corpus (GPtrArray *corpus,
+		  const gchar *tmp_dir,
+		  gboolean compress,
+		  gsize *out_disk_size,
+		  gdouble *out_open_time)
+{
+	gsize disk_size = 0;
+	guint ii;
+
+	for (ii = 0; ii < corpus->len; ii++) {
+		gchar *filename, *name;
+
+		name = g_strdup_printf ("%s-%u", compress ? "compressed" : "plain", ii);
+		filename = g_build_filename (tmp_dir, name, NULL);
+
+		write_cache_file (filename, g_ptr_array_index (corpus, ii), compress);
+		disk_size += get_file_size (filename);
+
+		g_free (filename);
+		g_free (name);
+	}
+
+	g_test_timer_start ();
+
+	for (ii = 0; ii < corpus->len; ii++) {
+		gchar *filename, *name;
+
+		name = g_strdup_printf ("%s-%u", compress ? "compressed" : "plain", ii);
+		filename = g_build_filename (tmp_dir, name, NULL);
+
+		g_object_unref (read_cache_file (filename));
+
+		g_remove (filename);
+		g_free (filename);
+		g_free (name);
+	}
+
+	*out_open_time = g_test_timer_elapsed ();
+	*out_disk_size = disk_size;
+}
+
+static void
+test_message_cache_benchmark (void)
+{
+	GPtrArray *corpus;
+	gchar *tmp_dir;
+	gsize content_size = 0, plain_size, compressed_size;
+	gdouble plain_time, compressed_time;
+	guint ii;
+
+	tmp_dir = g_dir_make_tmp ("ews-test-message-cache-XXXXXX", NULL);
+	g_assert_nonnull (tmp_dir);
+
+	corpus = g_ptr_array_new_with_free_func (g_free);
+
+	/* Most messages are short, some carry documents or images */
+	for (ii = 0; ii < CORPUS_SIZE; ii++) {
+		gsize attachment_size = 0;
+		gchar *content;
+
+		switch (ii % 10) {
+		case 0:
+		case 1:
+			attachment_size = g_test_rand_int_range (16 * 1024, 512 * 1024);
+			break;
+		case 2:
+			attachment_size = g_test_rand_int_range (1024, 128 * 1024);
+			break;
+		default:
+			break;
+		}
+
+		content = build_message (ii, attachment_size, (ii % 10) == 1);
+		content_size += strlen (content);
+
+		g_ptr_array_add (corpus, content);
+	}
+
+	benchmark_corpus (corpus, tmp_dir, FALSE, &plain_size, &plain_time);
+	benchmark_corpus (corpus, tmp_dir, TRUE, &compressed_size, &compressed_time);
+
+	g_test_message ("corpus of %u messages, %" G_GSIZE_FORMAT " bytes", corpus->len, content_size);
+	g_test_message ("uncompressed: %" G_GSIZE_FORMAT " bytes on disk, opened in %.3f ms (%.3f ms per message)",
+		plain_size, plain_time * 1000.0, plain_time * 1000.0 / corpus->len);
+	g_test_message ("compressed: %" G_GSIZE_FORMAT " bytes on disk (%.1f%%), opened in %.3f ms (%.3f ms per message)",
+		compressed_size, 100.0 * compressed_size / plain_size,
+		compressed_time * 1000.0, compressed_time * 1000.0 / corpus->len);
+
+	g_test_minimized_result (compressed_size, "compressed disk footprint: %" G_GSIZE_FORMAT " bytes", compressed_size);
+	g_test_minimized_result (compressed_time, "compressed corpus open: %.3f ms", compressed_time * 1000.0);
+
+	g_assert_cmpuint (compressed_size, <, plain_size);
+
+	g_ptr_array_unref (corpus);
+	g_rmdir (tmp_dir);
+	g_free (tmp_dir);
+}
+
+int
+main (int argc,
+      char **argv)
+{
+	const gchar *module_path;
+	GModule *module = NULL;
+	gint retval;
+
+	g_test_init (&argc, &argv, NULL);
+
+	if (!g_module_supported ()) {
+		g_printerr ("GModule not supported\n");
+		return 1;
+	}
+
+	module_path = CAMEL_MODULE_DIR "libcamelews-priv.so";
+	module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+
+	if (module == NULL) {
+		g_printerr ("Failed to load module '%s': %s\n", module_path, g_module_error ());
+		return 2;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"camel_ews_utils_new_cache_output_stream",
+		(gpointer *) &new_cache_output_stream)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 3;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"camel_ews_utils_ref_cache_input_stream",
+		(gpointer *) &ref_cache_input_stream)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 4;
+	}
+
+	g_test_add_func ("/camel/message-cache/roundtrip", test_message_cache_roundtrip);
+	g_test_add_func ("/camel/message-cache/short", test_message_cache_short);
+
+	/* Run with '-m perf' to measure the disk footprint and the open latency of a synthetic corpus */
+	if (g_test_perf ())
+		g_test_add_func ("/camel/message-cache/benchmark", test_message_cache_benchmark);
+
+	retval = g_test_run ();
+
+	g_module_close (module);
+
+	return retval;
+}
@@ -0,0 +1,261 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <libecal/libecal.h>
+
+#include "calendar/e-cal-backend-ews-utils.h"
+
+/* The number of components in one SyncFolderItems page */
+#define PAGE_SIZE 100
+
+void (* store_original_comp) (ECalComponent *comp);
+ECalComponent * (* restore_original_comp) (ECalComponent *from_comp);
+
+static const gchar *str_comp =
+	"BEGIN:VEVENT\n"
+	"UID:20140114T172626Z-2238-1000-5564-0@srv\n"
+	"DTSTAMP:20140114T172620Z\n"
+	"DTSTART;TZID=Europe/Berlin:20140114T160000\n"
+	"DTEND;TZID=Europe/Berlin:20140114T163000\n"
+	"RRULE:FREQ=WEEKLY;COUNT=10\n"
+	"TRANSP:OPAQUE\n"
+	"SEQUENCE:2\n"
+	"SUMMARY:Weekly status meeting\n"
+	"DESCRIPTION:Let's go through the status of the running projects\\, one by\n"
+	" one\\, and then decide what to do next. Bring your notes\\, please.\n"
+	"LOCATION:Meeting room 4\n"
+	"CLASS:PUBLIC\n"
+	"ORGANIZER;CN=Someone:MAILTO:someone@provider.com\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=REQ-PARTICIPANT;PARTSTAT=ACCEPTED;\n"
+	" RSVP=TRUE;CN=Someone;LANGUAGE=en:MAILTO:someone@provider.com\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=REQ-PARTICIPANT;PARTSTAT=NEEDS-ACTION;\n"
+	" RSVP=TRUE;CN=Someone Else;LANGUAGE=en:MAILTO:someone.else@provider.com\n"
+	"ATTENDEE;CUTYPE=INDIVIDUAL;ROLE=OPT-PARTICIPANT;PARTSTAT=TENTATIVE;\n"
+	" RSVP=TRUE;CN=Anyone;LANGUAGE=en:MAILTO:anyone@provider.com\n"
+	"X-EVOLUTION-ITEMID:AAMkADk2ZWY5ZGFlLTNhNmUtNDdkNC1hYjM5LWQ1Y2YzNmE5ZTRhNABGAAAA\n"
+	"X-EVOLUTION-CHANGEKEY:DwAAABYAAAA7xLqM2zK8S5d7a3mDkp+PAAAMxcam\n"
+	"END:VEVENT";
+
+/* How the original component had been stored before it was compressed */
+static void
+store_original_comp_uncompressed (ECalComponent *comp)
+{
+	gchar *comp_str;
+	gchar *base64;
+
+	e_cal_util_remove_x_property (e_cal_component_get_icalcomponent (comp), "X-EWS-ORIGINAL-COMP");
+
+	comp_str = e_cal_component_get_as_string (comp);
+	base64 = g_base64_encode ((const guchar *) comp_str, strlen (comp_str) + 1);
+
+	e_cal_util_set_x_property (e_cal_component_get_icalcomponent (comp), "X-EWS-ORIGINAL-COMP", base64);
+
+	g_free (base64);
+	g_free (comp_str);
+}
+
+static gsize
+get_original_comp_size (ECalComponent *comp)
+{
+	const gchar *value;
+
+	value = e_cal_util_get_x_property (e_cal_component_get_icalcomponent (comp), "X-EWS-ORIGINAL-COMP");
+	g_assert_nonnull (value);
+
+	return strlen (value);
+}
+
+static void
+check_restored (ECalComponent *comp,
+		ECalComponent *expected)
+{
+	ECalComponent *restored;
+	gchar *str1, *str2;
+
+	restored = restore_original_comp (comp);
+	g_assert_nonnull (restored);
+
+	str1 = e_cal_component_get_as_string (restored);
+	str2 = e_cal_component_get_as_string (expected);
+
+	g_assert_cmpstr (str1, ==, str2);
+
+	g_object_unref (restored);
+	g_free (str1);
+	g_free (str2);
+}
+
+static void
+test_original_comp_roundtrip (void)
+{
+	ECalComponent *comp, *expected;
+
+	comp = e_cal_component_new_from_string (str_comp);
+	expected = e_cal_component_new_from_string (str_comp);
+	g_assert_nonnull (comp);
+	g_assert_nonnull (expected);
+
+	g_assert_null (restore_original_comp (comp));
+
+	store_original_comp (comp);
+	check_restored (comp, expected);
+
+	/* Storing again does not include the previous value */
+	store_original_comp (comp);
+	check_restored (comp, expected);
+
+	/* Modifications made after the store are not part of the original */
+	e_cal_component_set_location (comp, "Meeting room 5");
+	check_restored (comp, expected);
+
+	g_object_unref (comp);
+	g_object_unref (expected);
+}
+
+static void
+test_original_comp_uncompressed (void)
+{
+	ECalComponent *comp, *expected;
+	gsize uncompressed_size;
+
+	comp = e_cal_component_new_from_string (str_comp);
+	expected = e_cal_component_new_from_string (str_comp);
+	g_assert_nonnull (comp);
+	g_assert_nonnull (expected);
+
+	/* Values stored by the older versions can be still read */
+	store_original_comp_uncompressed (comp);
+	check_restored (comp, expected);
+
+	uncompressed_size = get_original_comp_size (comp);
+
+	store_original_comp (comp);
+	check_restored (comp, expected);
+
+	g_assert_cmpuint (get_original_comp_size (comp), <, uncompressed_size);
+
+	g_object_unref (comp);
+	g_object_unref (expected);
+}
+
+static void
+benchmark_page (const gchar *what,
+		void (* store_func) (ECalComponent *comp))
+{
+	GSList *components = NULL, *link;
+	gsize stored_size = 0;
+	gdouble store_time, restore_time;
+	gint ii;
+
+	for (ii = 0; ii < PAGE_SIZE; ii++) {
+		components = g_slist_prepend (components, e_cal_component_new_from_string (str_comp));
+	}
+
+	g_test_timer_start ();
+
+	for (link = components; link; link = g_slist_next (link)) {
+		ECalComponent *comp = link->data;
+		gchar *str;
+
+		store_func (comp);
+
+		/* The ECalMetaBackend receives the components as strings */
+		str = e_cal_component_get_as_string (comp);
+		stored_size += strlen (str);
+		g_free (str);
+	}
+
+	store_time = g_test_timer_elapsed ();
+
+	g_test_timer_start ();
+
+	for (link = components; link; link = g_slist_next (link)) {
+		g_object_unref (restore_original_comp (link->data));
+	}
+
+	restore_time = g_test_timer_elapsed ();
+
+	g_test_message ("%s: page of %d components stored in %.3f ms (%" G_GSIZE_FORMAT " bytes), restored in %.3f ms",
+		what, PAGE_SIZE, store_time * 1000.0, stored_size, restore_time * 1000.0);
+
+	g_test_minimized_result (store_time, "%s page conversion: %.3f ms", what, store_time * 1000.0);
+
+	g_slist_free_full (components, g_object_unref);
+}
+
+static void
+test_original_comp_benchmark (void)
+{
+	benchmark_page ("uncompressed", store_original_comp_uncompressed);
+	benchmark_page ("compressed", store_original_comp);
+}
+
+int
+main (int argc,
+      char **argv)
+{
+	const gchar *module_path;
+	GModule *module = NULL;
+	gint retval;
+
+	g_test_init (&argc, &argv, NULL);
+
+	if (!g_module_supported ()) {
+		g_printerr ("GModule not supported\n");
+		return 1;
+	}
+
+	module_path = CALENDAR_MODULE_DIR "libecalbackendews.so";
+	module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+
+	if (module == NULL) {
+		g_printerr ("Failed to load module '%s': %s\n", module_path, g_module_error ());
+		return 2;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"e_cal_backend_ews_store_original_comp",
+		(gpointer *) &store_original_comp)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 3;
+	}
+
+	if (!g_module_symbol (
+		module,
+		"e_cal_backend_ews_restore_original_comp",
+		(gpointer *) &restore_original_comp)) {
+			g_printerr ("\n%s\n", g_module_error ());
+			g_module_close (module);
+			return 4;
+	}
+
+	g_test_add_func ("/calendar/original-comp/roundtrip", test_original_comp_roundtrip);
+	g_test_add_func ("/calendar/original-comp/uncompressed", test_original_comp_uncompressed);
+
+	/* Run with '-m perf' to measure the conversion of a page of components */
+	if (g_test_perf ())
+		g_test_add_func ("/calendar/original-comp/benchmark", test_original_comp_benchmark);
+
+	retval = g_test_run ();
+
+	g_module_close (module);
+
+	return retval;
+}